@@ -0,0 +1,835 @@
+// ---------------- AUDIO ----------------
+// See Audio.h.
+
+#include "Audio.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <mmsystem.h>
+#include <cguid.h>
+#include <propidl.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+#endif
+
+// ---------------- CLIPS ----------------
+struct AudioClip {
+    std::vector<short> samples;   // interleaved stereo at AUDIO_RATE
+    int frames = 0;
+    int maxVoices = 1, priority = 0;
+};
+static AudioClip g_clips[MAX_AUDIO_CLIPS];
+
+// Channel mix (mono is doubled, extra channels dropped) and linear
+// resampling in 16.16 fixed point
+void SetAudioClip(int id, const short* samples, int frames, int channels, int rate) {
+    if (id < 0 || id >= MAX_AUDIO_CLIPS) return;
+    AudioClip& clip = g_clips[id];
+    clip.samples.clear();
+    clip.frames = 0;
+    if (!samples || frames <= 0 || channels <= 0 || rate <= 0) return;
+    const long long outFrames = (long long)frames * AUDIO_RATE / rate;
+    const unsigned long long step = ((unsigned long long)rate << 16) / AUDIO_RATE;
+    clip.samples.resize((size_t)outFrames * AUDIO_CHANNELS);
+    unsigned long long pos = 0;
+    for (long long i = 0; i < outFrames; ++i, pos += step) {
+        const int at = (int)(pos >> 16), next = at + 1 < frames ? at + 1 : at;
+        const int frac = (int)(pos & 0xFFFF);
+        for (int c = 0; c < AUDIO_CHANNELS; ++c) {
+            const int from = c < channels ? c : 0;
+            const int a = samples[at * channels + from], b = samples[next * channels + from];
+            clip.samples[i * AUDIO_CHANNELS + c] = (short)(a + (((b - a) * frac) >> 16));
+        }
+    }
+    clip.frames = (int)outFrames;
+}
+
+int AudioClipFrames(int id) {
+    return id >= 0 && id < MAX_AUDIO_CLIPS ? g_clips[id].frames : 0;
+}
+
+void SetClipLimits(int id, int maxVoices, int priority) {
+    if (id < 0 || id >= MAX_AUDIO_CLIPS) return;
+    g_clips[id].maxVoices = maxVoices < 1 ? 1 : maxVoices > MAX_AUDIO_VOICES ? MAX_AUDIO_VOICES : maxVoices;
+    g_clips[id].priority = priority;
+}
+
+static FILE* OpenWide(const wchar_t* path, const char* mode) {
+#ifdef _WIN32
+    wchar_t wideMode[8];
+    mbstowcs(wideMode, mode, 8);
+    return _wfopen(path, wideMode);
+#else
+    char narrow[1024];
+    if (wcstombs(narrow, path, sizeof(narrow)) == (size_t)-1) return nullptr;
+    return fopen(narrow, mode);
+#endif
+}
+
+static unsigned ReadLE(const unsigned char* p, int bytes) {
+    unsigned v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+// 16-bit PCM RIFF only; that's all the game or a bench writes
+static bool LoadWav(int id, const wchar_t* path) {
+    FILE* f = OpenWide(path, "rb");
+    if (!f) return false;
+    unsigned char header[12], chunk[8], fmt[16];
+    int channels = 0, rate = 0, bits = 0;
+    bool ok = fread(header, 1, 12, f) == 12 && !memcmp(header, "RIFF", 4) && !memcmp(header + 8, "WAVE", 4);
+    while (ok && fread(chunk, 1, 8, f) == 8) {
+        const unsigned size = ReadLE(chunk + 4, 4);
+        if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+            ok = fread(fmt, 1, 16, f) == 16 && ReadLE(fmt, 2) == 1;
+            channels = (int)ReadLE(fmt + 2, 2); rate = (int)ReadLE(fmt + 4, 4); bits = (int)ReadLE(fmt + 14, 2);
+            fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (!channels || bits != 16) { ok = false; break; }
+            std::vector<short> pcm(size / 2);
+            const int frames = (int)(fread(pcm.data(), 2, pcm.size(), f) / channels);
+            SetAudioClip(id, pcm.data(), frames, channels, rate);
+            fclose(f);
+            return frames > 0;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return false;
+}
+
+#ifdef _WIN32
+// The source reader picks the codec (MP3 ships with Windows) and converts
+// to 16-bit PCM at the file's own rate and channel count
+static bool LoadWithMediaFoundation(int id, const wchar_t* path) {
+    const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(MFStartup(MF_VERSION))) { if (SUCCEEDED(com)) CoUninitialize(); return false; }
+    std::vector<short> pcm;
+    UINT32 channels = 0, rate = 0;
+    IMFSourceReader* reader = nullptr;
+    HRESULT hr = MFCreateSourceReaderFromURL(path, nullptr, &reader);
+    if (SUCCEEDED(hr)) {
+        IMFMediaType* wanted = nullptr;
+        hr = MFCreateMediaType(&wanted);
+        if (SUCCEEDED(hr)) {
+            wanted->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+            wanted->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+            wanted->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+            hr = reader->SetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, nullptr, wanted);
+            wanted->Release();
+        }
+        IMFMediaType* actual = nullptr;
+        if (SUCCEEDED(hr)) hr = reader->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, &actual);
+        if (SUCCEEDED(hr)) {
+            channels = MFGetAttributeUINT32(actual, MF_MT_AUDIO_NUM_CHANNELS, 0);
+            rate = MFGetAttributeUINT32(actual, MF_MT_AUDIO_SAMPLES_PER_SECOND, 0);
+            actual->Release();
+        }
+        while (SUCCEEDED(hr)) {
+            DWORD flags = 0;
+            IMFSample* sample = nullptr;
+            hr = reader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, 0, nullptr, &flags, nullptr, &sample);
+            if (sample) {
+                IMFMediaBuffer* buffer = nullptr;
+                if (SUCCEEDED(sample->ConvertToContiguousBuffer(&buffer))) {
+                    BYTE* data = nullptr; DWORD bytes = 0;
+                    if (SUCCEEDED(buffer->Lock(&data, nullptr, &bytes))) {
+                        const short* s = reinterpret_cast<const short*>(data);
+                        pcm.insert(pcm.end(), s, s + bytes / 2);
+                        buffer->Unlock();
+                    }
+                    buffer->Release();
+                }
+                sample->Release();
+            }
+            if (flags & MF_SOURCE_READERF_ENDOFSTREAM) break;
+        }
+        reader->Release();
+    }
+    MFShutdown();
+    if (SUCCEEDED(com)) CoUninitialize();
+    if (!channels || !rate || pcm.empty()) return false;
+    SetAudioClip(id, pcm.data(), (int)(pcm.size() / channels), (int)channels, (int)rate);
+    return true;
+}
+#endif
+
+bool LoadAudioClip(int id, const wchar_t* path) {
+    if (id < 0 || id >= MAX_AUDIO_CLIPS || !path) return false;
+    const size_t len = wcslen(path);
+    if (len > 4 && (!wcscmp(path + len - 4, L".wav") || !wcscmp(path + len - 4, L".WAV")))
+        return LoadWav(id, path);
+#ifdef _WIN32
+    return LoadWithMediaFoundation(id, path);
+#else
+    return false;
+#endif
+}
+
+// ---------------- COMMAND QUEUE ----------------
+// Bounded queue with a sequence number per slot (Vyukov): producers claim a
+// slot with one compare-exchange and publish it with a release store; each
+// queue has one consumer. Clip commands and deck fades go to the mixer,
+// music commands to the streamer.
+enum AudioOp { AUDIO_PLAY, AUDIO_LOOP, AUDIO_STOP, AUDIO_DECK_FADE_IN, AUDIO_DECK_FADE_OUT, AUDIO_MUSIC_PLAY, AUDIO_MUSIC_STOP };
+struct AudioCommand { int op; int id; int arg; };
+struct CommandSlot { std::atomic<unsigned> sequence; AudioCommand command; };
+
+static const unsigned COMMAND_SLOTS = 256;   // power of two
+
+struct CommandQueue {
+    CommandSlot slots[COMMAND_SLOTS];
+    std::atomic<unsigned> tail;   // next slot to claim
+    unsigned head = 0;            // next slot to read; consumer only
+    CommandQueue() : tail(0) {
+        for (unsigned i = 0; i < COMMAND_SLOTS; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+};
+static CommandQueue g_commands, g_musicCommands;
+
+struct AudioCounters {
+    std::atomic<int> voices, blocks, underruns, dropped, stolen, refused, musicStarved, mixMicros;
+    AudioCounters() : voices(0), blocks(0), underruns(0), dropped(0), stolen(0), refused(0), musicStarved(0), mixMicros(0) {}
+};
+static AudioCounters g_counters;
+
+static void PushCommand(CommandQueue& q, int op, int id, int arg = 0) {
+    unsigned pos = q.tail.load(std::memory_order_relaxed);
+    for (;;) {
+        CommandSlot& slot = q.slots[pos & (COMMAND_SLOTS - 1)];
+        const int lag = (int)(slot.sequence.load(std::memory_order_acquire) - pos);
+        if (lag == 0) {
+            if (q.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.command.op = op;
+                slot.command.id = id;
+                slot.command.arg = arg;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return;
+            }
+        } else if (lag < 0) {
+            g_counters.dropped.fetch_add(1, std::memory_order_relaxed);   // full: the consumer is a lap behind
+            return;
+        } else {
+            pos = q.tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static bool PopCommand(CommandQueue& q, AudioCommand& command) {
+    CommandSlot& slot = q.slots[q.head & (COMMAND_SLOTS - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != q.head + 1) return false;
+    command = slot.command;
+    slot.sequence.store(q.head + COMMAND_SLOTS, std::memory_order_release);
+    ++q.head;
+    return true;
+}
+
+static bool IsClip(int id) { return id >= 0 && id < MAX_AUDIO_CLIPS; }
+
+void PlayClip(int id) { if (IsClip(id)) PushCommand(g_commands, AUDIO_PLAY, id); }
+void LoopClip(int id) { if (IsClip(id)) PushCommand(g_commands, AUDIO_LOOP, id); }
+void StopClip(int id) { if (IsClip(id)) PushCommand(g_commands, AUDIO_STOP, id); }
+
+static int MsToFrames(int ms) { return ms > 0 ? (int)((long long)ms * AUDIO_RATE / 1000) : 0; }
+
+void PlayMusic(int track, int fadeMs) {
+    if (track >= 0 && track < MAX_MUSIC_TRACKS) PushCommand(g_musicCommands, AUDIO_MUSIC_PLAY, track, MsToFrames(fadeMs));
+}
+void StopMusic(int fadeMs) { PushCommand(g_musicCommands, AUDIO_MUSIC_STOP, 0, MsToFrames(fadeMs)); }
+
+// ---------------- MUSIC DECKS ----------------
+// Each deck has a single-producer ring (the streamer writes, the mixer
+// reads) and is handed between the two with 'active': the streamer sets it
+// once the ring is prefilled, before asking the mixer to fade the deck in,
+// and the mixer clears it when the deck has faded to silence, after its
+// last read. Only then does the streamer close the stream and reuse it.
+static const int MUSIC_DECKS = 2;
+static const int MUSIC_CHUNK_FRAMES = 2048;   // source frames decoded at a time
+
+struct MusicRing {
+    short samples[MUSIC_RING_FRAMES * AUDIO_CHANNELS];
+    std::atomic<unsigned> written, read;   // frames, wrapping
+    MusicRing() : written(0), read(0) {}
+};
+
+// A track being decoded: a .wav file read in place, or (Windows) a Media
+// Foundation source reader, resampled into the mix format as it goes
+struct MusicStream {
+    FILE* wav = nullptr;
+    long wavStart = 0;
+    unsigned wavBytes = 0, wavRead = 0;
+#ifdef _WIN32
+    IMFSourceReader* reader = nullptr;
+    std::vector<short> decoded;   // the last sample's PCM not yet used
+    size_t decodedAt = 0;
+#endif
+    int channels = 0, rate = 0;
+    unsigned long long step = 0, pos = 0;   // resampler, 16.16 source frames
+    short prev[AUDIO_CHANNELS];
+    std::vector<short> in, out;             // one chunk, sized at open
+};
+
+struct MusicDeck {
+    MusicRing ring;
+    std::atomic<int> active;
+    MusicStream stream;      // streamer only
+    int track = -1;          // streamer only; -1 = closed
+    float gain = 0.0f, gainStep = 0.0f;   // mixer only
+    float target = 0.0f;                  // mixer only; where the ramp ends, exactly
+    int rampLeft = 0;
+    bool mixing = false;
+    MusicDeck() : active(0) {}
+};
+static MusicDeck g_decks[MUSIC_DECKS];
+static const wchar_t* g_musicPaths[MAX_MUSIC_TRACKS];
+
+void SetMusicTrack(int track, const wchar_t* path) {
+    if (track >= 0 && track < MAX_MUSIC_TRACKS) g_musicPaths[track] = path;
+}
+
+static bool OpenWavStream(MusicStream& m, const wchar_t* path) {
+    FILE* f = OpenWide(path, "rb");
+    if (!f) return false;
+    unsigned char header[12], chunk[8], fmt[16];
+    int bits = 0;
+    bool ok = fread(header, 1, 12, f) == 12 && !memcmp(header, "RIFF", 4) && !memcmp(header + 8, "WAVE", 4);
+    while (ok && fread(chunk, 1, 8, f) == 8) {
+        const unsigned size = ReadLE(chunk + 4, 4);
+        if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+            ok = fread(fmt, 1, 16, f) == 16 && ReadLE(fmt, 2) == 1;
+            m.channels = (int)ReadLE(fmt + 2, 2); m.rate = (int)ReadLE(fmt + 4, 4); bits = (int)ReadLE(fmt + 14, 2);
+            fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR);
+        } else if (!memcmp(chunk, "data", 4)) {
+            if (!m.channels || !m.rate || bits != 16) break;
+            m.wav = f;
+            m.wavStart = ftell(f);
+            m.wavBytes = size;
+            m.wavRead = 0;
+            return true;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return false;
+}
+
+#ifdef _WIN32
+static bool OpenMediaFoundationStream(MusicStream& m, const wchar_t* path) {
+    if (FAILED(MFCreateSourceReaderFromURL(path, nullptr, &m.reader))) { m.reader = nullptr; return false; }
+    IMFMediaType* wanted = nullptr;
+    HRESULT hr = MFCreateMediaType(&wanted);
+    if (SUCCEEDED(hr)) {
+        wanted->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Audio);
+        wanted->SetGUID(MF_MT_SUBTYPE, MFAudioFormat_PCM);
+        wanted->SetUINT32(MF_MT_AUDIO_BITS_PER_SAMPLE, 16);
+        hr = m.reader->SetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, nullptr, wanted);
+        wanted->Release();
+    }
+    IMFMediaType* actual = nullptr;
+    if (SUCCEEDED(hr)) hr = m.reader->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, &actual);
+    if (SUCCEEDED(hr)) {
+        m.channels = (int)MFGetAttributeUINT32(actual, MF_MT_AUDIO_NUM_CHANNELS, 0);
+        m.rate = (int)MFGetAttributeUINT32(actual, MF_MT_AUDIO_SAMPLES_PER_SECOND, 0);
+        actual->Release();
+    }
+    if (FAILED(hr) || !m.channels || !m.rate) { m.reader->Release(); m.reader = nullptr; return false; }
+    m.decoded.clear();
+    m.decodedAt = 0;
+    return true;
+}
+#endif
+
+static void CloseStream(MusicStream& m) {
+    if (m.wav) { fclose(m.wav); m.wav = nullptr; }
+#ifdef _WIN32
+    if (m.reader) { m.reader->Release(); m.reader = nullptr; }
+#endif
+}
+
+static bool OpenStream(MusicStream& m, const wchar_t* path) {
+    const size_t len = wcslen(path);
+    bool ok;
+    if (len > 4 && (!wcscmp(path + len - 4, L".wav") || !wcscmp(path + len - 4, L".WAV"))) ok = OpenWavStream(m, path);
+#ifdef _WIN32
+    else ok = OpenMediaFoundationStream(m, path);
+#else
+    else ok = false;
+#endif
+    if (!ok) return false;
+    m.step = ((unsigned long long)m.rate << 16) / AUDIO_RATE;
+    m.pos = 1ull << 16;   // the first output frame is the first source frame
+    memset(m.prev, 0, sizeof(m.prev));
+    m.in.resize((size_t)MUSIC_CHUNK_FRAMES * m.channels);
+    m.out.resize(((size_t)MUSIC_CHUNK_FRAMES * AUDIO_RATE / m.rate + 2) * AUDIO_CHANNELS);
+    return true;
+}
+
+// Up to frames source frames into m.in; 0 at the end of the track
+static int ReadSource(MusicStream& m, int frames) {
+    if (m.wav) {
+        const unsigned frameBytes = (unsigned)m.channels * 2;
+        unsigned want = (unsigned)frames * frameBytes;
+        if (want > m.wavBytes - m.wavRead) want = (m.wavBytes - m.wavRead) / frameBytes * frameBytes;
+        const size_t got = fread(m.in.data(), 1, want, m.wav);
+        m.wavRead += (unsigned)got;
+        return (int)(got / frameBytes);
+    }
+#ifdef _WIN32
+    while (m.reader && m.decodedAt == m.decoded.size()) {
+        m.decoded.clear();
+        m.decodedAt = 0;
+        DWORD flags = 0;
+        IMFSample* sample = nullptr;
+        if (FAILED(m.reader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM, 0, nullptr, &flags, nullptr, &sample))) return 0;
+        if (sample) {
+            IMFMediaBuffer* buffer = nullptr;
+            if (SUCCEEDED(sample->ConvertToContiguousBuffer(&buffer))) {
+                BYTE* data = nullptr; DWORD bytes = 0;
+                if (SUCCEEDED(buffer->Lock(&data, nullptr, &bytes))) {
+                    const short* s = reinterpret_cast<const short*>(data);
+                    m.decoded.assign(s, s + bytes / 2);
+                    buffer->Unlock();
+                }
+                buffer->Release();
+            }
+            sample->Release();
+        }
+        if ((flags & MF_SOURCE_READERF_ENDOFSTREAM) && m.decoded.empty()) return 0;
+    }
+    if (m.reader) {
+        const size_t have = (m.decoded.size() - m.decodedAt) / m.channels;
+        const int n = (int)(have < (size_t)frames ? have : (size_t)frames);
+        memcpy(m.in.data(), m.decoded.data() + m.decodedAt, (size_t)n * m.channels * 2);
+        m.decodedAt += (size_t)n * m.channels;
+        return n;
+    }
+#endif
+    return 0;
+}
+
+static bool RewindStream(MusicStream& m) {
+    if (m.wav) { m.wavRead = 0; return fseek(m.wav, m.wavStart, SEEK_SET) == 0; }
+#ifdef _WIN32
+    if (m.reader) {
+        PROPVARIANT start;
+        PropVariantInit(&start);
+        start.vt = VT_I8;
+        start.hVal.QuadPart = 0;
+        m.decoded.clear();
+        m.decodedAt = 0;
+        return SUCCEEDED(m.reader->SetCurrentPosition(GUID_NULL, start));
+    }
+#endif
+    return false;
+}
+
+// Linear interpolation over the source as one sequence: prev, then m.in.
+// pos counts from prev, so it carries over from chunk to chunk and the
+// loop point, and the output is the same whatever the chunk sizes.
+static int Resample(MusicStream& m, int n) {
+    int written = 0;
+    const unsigned long long end = (unsigned long long)n << 16;
+    for (; m.pos < end; m.pos += m.step, ++written) {
+        const int at = (int)(m.pos >> 16);
+        const int frac = (int)(m.pos & 0xFFFF);
+        for (int c = 0; c < AUDIO_CHANNELS; ++c) {
+            const int from = c < m.channels ? c : 0;
+            const int a = at == 0 ? m.prev[c] : m.in[(at - 1) * m.channels + from];
+            const int b = m.in[at * m.channels + from];
+            m.out[written * AUDIO_CHANNELS + c] = (short)(a + (((b - a) * frac) >> 16));
+        }
+    }
+    m.pos -= end;
+    for (int c = 0; c < AUDIO_CHANNELS; ++c) m.prev[c] = m.in[(n - 1) * m.channels + (c < m.channels ? c : 0)];
+    return written;
+}
+
+// Tops the ring up a chunk at a time, looping at the end of the track.
+// Only decodes when a whole chunk's output fits, so nothing is left over.
+static void FillDeck(MusicDeck& d) {
+    MusicRing& r = d.ring;
+    const unsigned outCapacity = (unsigned)(d.stream.out.size() / AUDIO_CHANNELS);
+    for (int rewinds = 0; rewinds < 2;) {
+        const unsigned written = r.written.load(std::memory_order_relaxed);
+        if (MUSIC_RING_FRAMES - (written - r.read.load(std::memory_order_acquire)) < outCapacity) return;
+        const int n = ReadSource(d.stream, MUSIC_CHUNK_FRAMES);
+        if (n == 0) {
+            if (!RewindStream(d.stream)) return;
+            ++rewinds;   // an empty track must not spin
+            continue;
+        }
+        rewinds = 0;
+        const int frames = Resample(d.stream, n);
+        for (int i = 0; i < frames; ++i) {
+            short* dst = r.samples + ((written + i) & (MUSIC_RING_FRAMES - 1)) * AUDIO_CHANNELS;
+            for (int c = 0; c < AUDIO_CHANNELS; ++c) dst[c] = d.stream.out[i * AUDIO_CHANNELS + c];
+        }
+        r.written.store(written + frames, std::memory_order_release);
+    }
+}
+
+// ---------------- MIXER ----------------
+// The pool is only ever touched by the mixer. Playing voices are packed at
+// the front, so a block walks exactly the voices that are playing.
+struct Voice { int clip; int position; int priority; unsigned started; bool looping; };
+static Voice g_voices[MAX_AUDIO_VOICES];
+static int g_voiceCount = 0;
+static unsigned g_voiceSerial = 0;   // start order, for "oldest"
+
+static void RemoveVoice(int i) { g_voices[i] = g_voices[--g_voiceCount]; }
+
+static void StartVoice(int clipId, bool looping) {
+    const AudioClip& clip = g_clips[clipId];
+    if (clip.frames == 0) return;
+    int slot = -1, instances = 0;
+    for (int i = 0; i < g_voiceCount; ++i) {
+        if (g_voices[i].clip != clipId) continue;
+        ++instances;
+        if (slot < 0 || g_voices[i].started < g_voices[slot].started) slot = i;
+    }
+    if (instances < clip.maxVoices) {
+        slot = -1;
+        if (g_voiceCount < MAX_AUDIO_VOICES) {
+            slot = g_voiceCount++;
+        } else {
+            for (int i = 0; i < g_voiceCount; ++i) {
+                const Voice& v = g_voices[i];
+                if (v.priority > clip.priority) continue;
+                if (slot < 0 || v.priority < g_voices[slot].priority || (v.priority == g_voices[slot].priority && v.started < g_voices[slot].started))
+                    slot = i;
+            }
+            if (slot < 0) { g_counters.refused.fetch_add(1, std::memory_order_relaxed); return; }
+            g_counters.stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    const Voice v = { clipId, 0, clip.priority, g_voiceSerial++, looping };
+    g_voices[slot] = v;
+}
+
+static void StopVoices(int clipId) {
+    for (int i = g_voiceCount - 1; i >= 0; --i)
+        if (g_voices[i].clip == clipId) RemoveVoice(i);
+}
+
+static void FadeDeck(MusicDeck& d, float target, int frames) {
+    d.mixing = true;
+    d.target = target;
+    if (frames <= 0) { d.gain = target; d.rampLeft = 0; return; }
+    d.gainStep = (target - d.gain) / frames;
+    d.rampLeft = frames;
+}
+
+// The gain moves every frame, so a crossfade is exact to the sample. A
+// deck that reaches silence hands itself back to the streamer; the last
+// step lands on the target rather than on the summed steps, which can
+// stop short of zero.
+static void MixDeck(MusicDeck& d, int* mix, int frames) {
+    MusicRing& r = d.ring;
+    const unsigned read = r.read.load(std::memory_order_relaxed);
+    const unsigned available = r.written.load(std::memory_order_acquire) - read;
+    const int n = available < (unsigned)frames ? (int)available : frames;
+    if (n < frames) g_counters.musicStarved.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        const short* src = r.samples + ((read + i) & (MUSIC_RING_FRAMES - 1)) * AUDIO_CHANNELS;
+        if (d.rampLeft > 0) d.gain = --d.rampLeft > 0 ? d.gain + d.gainStep : d.target;
+        for (int c = 0; c < AUDIO_CHANNELS; ++c) mix[i * AUDIO_CHANNELS + c] += (int)(src[c] * d.gain);
+    }
+    r.read.store(read + n, std::memory_order_release);
+    if (d.rampLeft == 0 && d.target <= 0.0f) {
+        d.mixing = false;
+        d.gain = 0.0f;
+        d.active.store(0, std::memory_order_release);
+    }
+}
+
+static void MixBlock(short* out, int frames) {
+    int mix[AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS];
+    memset(mix, 0, sizeof(int) * frames * AUDIO_CHANNELS);
+    for (int i = g_voiceCount - 1; i >= 0; --i) {
+        Voice& v = g_voices[i];
+        const AudioClip& clip = g_clips[v.clip];
+        bool playing = true;
+        int done = 0;
+        while (done < frames && playing) {
+            const int left = clip.frames - v.position;
+            const int n = frames - done < left ? frames - done : left;
+            const short* src = clip.samples.data() + v.position * AUDIO_CHANNELS;
+            int* dst = mix + done * AUDIO_CHANNELS;
+            for (int k = 0; k < n * AUDIO_CHANNELS; ++k) dst[k] += src[k];
+            done += n;
+            v.position += n;
+            if (v.position == clip.frames) { v.position = 0; playing = v.looping; }
+        }
+        if (!playing) RemoveVoice(i);
+    }
+    for (MusicDeck& d : g_decks)
+        if (d.mixing) MixDeck(d, mix, frames);
+    for (int i = 0; i < frames * AUDIO_CHANNELS; ++i)
+        out[i] = (short)(mix[i] > 32767 ? 32767 : mix[i] < -32768 ? -32768 : mix[i]);
+    g_counters.voices.store(g_voiceCount, std::memory_order_relaxed);
+    g_counters.blocks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MixAudio(short* out, int frames) {
+    const auto start = std::chrono::steady_clock::now();
+    AudioCommand command;
+    while (PopCommand(g_commands, command)) {
+        if (command.op == AUDIO_STOP) StopVoices(command.id);
+        else if (command.op == AUDIO_DECK_FADE_IN) FadeDeck(g_decks[command.id], 1.0f, command.arg);
+        else if (command.op == AUDIO_DECK_FADE_OUT) FadeDeck(g_decks[command.id], 0.0f, command.arg);
+        else StartVoice(command.id, command.op == AUDIO_LOOP);
+    }
+    for (int done = 0; done < frames; done += AUDIO_BLOCK_FRAMES) {
+        const int n = frames - done < AUDIO_BLOCK_FRAMES ? frames - done : AUDIO_BLOCK_FRAMES;
+        MixBlock(out + done * AUDIO_CHANNELS, n);
+    }
+    g_counters.mixMicros.store((int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+}
+
+AudioStats GetAudioStats() {
+    AudioStats s = {
+        g_counters.voices.load(), g_counters.blocks.load(), g_counters.underruns.load(),
+        g_counters.dropped.load(), g_counters.stolen.load(), g_counters.refused.load(),
+        g_counters.musicStarved.load(), g_counters.mixMicros.load() / 1000.0f
+    };
+    return s;
+}
+
+// ---------------- STREAMER ----------------
+// Decodes off the game and mixer threads. Runs every few milliseconds,
+// which the rings cover many times over.
+static const int STREAMER_PERIOD_MS = 5;
+
+struct Streamer {
+    std::thread thread;
+    std::atomic<bool> quit;
+    int current = -1;          // the deck last faded in and not faded out since
+    bool waiting = false;      // a play command is waiting for a free deck
+    AudioCommand next;
+    Streamer() : quit(false) {}
+};
+static Streamer g_streamer;
+
+// False if it has to wait for a deck to finish fading out
+static bool RunMusicCommand(const AudioCommand& command) {
+    const int current = g_streamer.current;
+    if (command.op == AUDIO_MUSIC_STOP) {
+        if (current >= 0) PushCommand(g_commands, AUDIO_DECK_FADE_OUT, current, command.arg);
+        g_streamer.current = -1;
+        return true;
+    }
+    if (current >= 0 && g_decks[current].track == command.id) return true;
+    if (!g_musicPaths[command.id]) return true;
+    int free = -1;
+    for (int i = 0; i < MUSIC_DECKS; ++i) if (g_decks[i].track < 0) free = i;
+    if (free < 0) return false;
+    MusicDeck& d = g_decks[free];
+    if (!OpenStream(d.stream, g_musicPaths[command.id])) return true;
+    d.track = command.id;
+    d.ring.read.store(0, std::memory_order_relaxed);
+    d.ring.written.store(0, std::memory_order_relaxed);
+    FillDeck(d);
+    d.active.store(1, std::memory_order_release);
+    PushCommand(g_commands, AUDIO_DECK_FADE_IN, free, command.arg);
+    if (current >= 0) PushCommand(g_commands, AUDIO_DECK_FADE_OUT, current, command.arg);
+    g_streamer.current = free;
+    return true;
+}
+
+static void StreamerMain() {
+#ifdef _WIN32
+    const HRESULT com = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    const bool mf = SUCCEEDED(MFStartup(MF_VERSION));
+#endif
+    while (!g_streamer.quit.load()) {
+        if (!g_streamer.waiting) g_streamer.waiting = PopCommand(g_musicCommands, g_streamer.next);
+        if (g_streamer.waiting) g_streamer.waiting = !RunMusicCommand(g_streamer.next);
+        for (MusicDeck& d : g_decks) {
+            if (d.track < 0) continue;
+            if (d.active.load(std::memory_order_acquire)) { FillDeck(d); continue; }
+            CloseStream(d.stream);   // faded out: the mixer is done with it
+            d.track = -1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(STREAMER_PERIOD_MS));
+    }
+    for (MusicDeck& d : g_decks) { CloseStream(d.stream); d.track = -1; d.active.store(0); }
+    g_streamer.current = -1;
+    g_streamer.waiting = false;
+#ifdef _WIN32
+    if (mf) MFShutdown();
+    if (SUCCEEDED(com)) CoUninitialize();
+#endif
+}
+
+// ---------------- OUTPUTS ----------------
+static const int DEVICE_BUFFERS = 3;   // ~35 ms queued ahead of the device
+
+struct AudioEngine {
+    std::thread thread;
+    std::atomic<bool> quit;
+    AudioOutput output = AUDIO_NULL;
+    FILE* wav = nullptr;
+    unsigned wavBytes = 0;
+#ifdef _WIN32
+    HWAVEOUT device = nullptr;
+    HANDLE ready = nullptr;
+    WAVEHDR headers[DEVICE_BUFFERS];
+    short buffers[DEVICE_BUFFERS][AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS];
+#endif
+    AudioEngine() : quit(false) {}
+};
+static AudioEngine g_audio;
+
+static void WriteWavHeader(FILE* f, unsigned dataBytes) {
+    unsigned char h[44];
+    const unsigned rate = AUDIO_RATE, byteRate = AUDIO_RATE * AUDIO_CHANNELS * 2;
+    const unsigned fields[] = { 36 + dataBytes, 16, 1 | (AUDIO_CHANNELS << 16), rate, byteRate,
+                                (AUDIO_CHANNELS * 2) | (16 << 16), dataBytes };
+    memcpy(h, "RIFF", 4); memcpy(h + 8, "WAVEfmt ", 8); memcpy(h + 36, "data", 4);
+    const int at[] = { 4, 16, 20, 24, 28, 32, 40 };
+    for (int i = 0; i < 7; ++i)
+        for (int b = 0; b < 4; ++b) h[at[i] + b] = (unsigned char)(fields[i] >> (8 * b));
+    fseek(f, 0, SEEK_SET);
+    fwrite(h, 1, 44, f);
+}
+
+// Null and .wav sinks: a block every block's worth of wall time
+static void PacedMain() {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::microseconds(1000000LL * AUDIO_BLOCK_FRAMES / AUDIO_RATE);
+    short block[AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS];
+    Clock::time_point next = Clock::now();
+    while (!g_audio.quit.load()) {
+        MixAudio(block, AUDIO_BLOCK_FRAMES);
+        if (g_audio.wav) g_audio.wavBytes += (unsigned)fwrite(block, 1, sizeof(block), g_audio.wav);
+        next += period;
+        const Clock::time_point now = Clock::now();
+        if (now > next + period) next = now;   // a stall is not made up for with a burst
+        std::this_thread::sleep_until(next);
+    }
+}
+
+#ifdef _WIN32
+// waveOut signals the event whenever a buffer comes back; every finished
+// buffer is mixed again and requeued. All of them back at once means the
+// device played out everything it had.
+static void DeviceMain() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    while (!g_audio.quit.load()) {
+        WaitForSingleObject(g_audio.ready, 100);
+        int finished = 0;
+        for (int i = 0; i < DEVICE_BUFFERS; ++i) {
+            WAVEHDR& h = g_audio.headers[i];
+            if (!(h.dwFlags & WHDR_DONE)) continue;
+            ++finished;
+            MixAudio(g_audio.buffers[i], AUDIO_BLOCK_FRAMES);
+            h.dwFlags &= ~WHDR_DONE;
+            waveOutWrite(g_audio.device, &h, sizeof(WAVEHDR));
+        }
+        if (finished == DEVICE_BUFFERS) g_counters.underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static bool OpenDevice() {
+    WAVEFORMATEX format = {};
+    format.wFormatTag = WAVE_FORMAT_PCM;
+    format.nChannels = AUDIO_CHANNELS;
+    format.nSamplesPerSec = AUDIO_RATE;
+    format.wBitsPerSample = 16;
+    format.nBlockAlign = AUDIO_CHANNELS * 2;
+    format.nAvgBytesPerSec = AUDIO_RATE * format.nBlockAlign;
+    g_audio.ready = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (waveOutOpen(&g_audio.device, WAVE_MAPPER, &format, (DWORD_PTR)g_audio.ready, 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+        CloseHandle(g_audio.ready);
+        g_audio.ready = nullptr;
+        g_audio.device = nullptr;
+        return false;
+    }
+    // Queue silence so the device starts straight away; the thread takes
+    // over as the buffers come back
+    for (int i = 0; i < DEVICE_BUFFERS; ++i) {
+        WAVEHDR& h = g_audio.headers[i];
+        memset(&h, 0, sizeof(h));
+        memset(g_audio.buffers[i], 0, sizeof(g_audio.buffers[i]));
+        h.lpData = reinterpret_cast<LPSTR>(g_audio.buffers[i]);
+        h.dwBufferLength = sizeof(g_audio.buffers[i]);
+        waveOutPrepareHeader(g_audio.device, &h, sizeof(WAVEHDR));
+        waveOutWrite(g_audio.device, &h, sizeof(WAVEHDR));
+    }
+    return true;
+}
+
+static void CloseDevice() {
+    waveOutReset(g_audio.device);   // returns every buffer
+    for (int i = 0; i < DEVICE_BUFFERS; ++i) waveOutUnprepareHeader(g_audio.device, &g_audio.headers[i], sizeof(WAVEHDR));
+    waveOutClose(g_audio.device);
+    CloseHandle(g_audio.ready);
+    g_audio.device = nullptr;
+    g_audio.ready = nullptr;
+}
+#endif
+
+static bool OpenOutput(AudioOutput output, const char* wavPath) {
+    if (output == AUDIO_DEVICE) {
+#ifdef _WIN32
+        if (!OpenDevice()) return false;
+        g_audio.thread = std::thread(DeviceMain);
+        return true;
+#else
+        return false;
+#endif
+    }
+    if (output == AUDIO_WAV) {
+        g_audio.wav = wavPath ? fopen(wavPath, "wb") : nullptr;
+        if (!g_audio.wav) return false;
+        g_audio.wavBytes = 0;
+        WriteWavHeader(g_audio.wav, 0);
+    }
+    g_audio.thread = std::thread(PacedMain);
+    return true;
+}
+
+bool StartAudio(AudioOutput output, const char* wavPath) {
+    if (g_audio.thread.joinable()) return true;
+    g_audio.quit = false;
+    g_audio.output = output;
+    if (!OpenOutput(output, wavPath)) return false;
+    g_streamer.quit = false;
+    g_streamer.thread = std::thread(StreamerMain);
+    return true;
+}
+
+void StopAudio() {
+    if (!g_audio.thread.joinable()) return;
+    g_streamer.quit = true;
+    g_streamer.thread.join();
+    g_audio.quit = true;
+    g_audio.thread.join();
+#ifdef _WIN32
+    if (g_audio.output == AUDIO_DEVICE) CloseDevice();
+#endif
+    if (g_audio.wav) {
+        WriteWavHeader(g_audio.wav, g_audio.wavBytes);
+        fclose(g_audio.wav);
+        g_audio.wav = nullptr;
+    }
+    // Both threads are gone; a later StartAudio begins without music
+    for (MusicDeck& d : g_decks) { d.mixing = false; d.gain = d.target = 0.0f; d.rampLeft = 0; }
+}
+
+bool AudioRunning() { return g_audio.thread.joinable(); }
@@ -0,0 +1,92 @@
+// ---------------- AUDIO ----------------
+// In-process sound, replacing MCI. Every clip is decoded once, at load,
+// into 16-bit stereo PCM at AUDIO_RATE (Media Foundation for the .mp3s on
+// Windows, plain RIFF .wav anywhere). A mixer thread adds the playing
+// voices up in blocks of AUDIO_BLOCK_FRAMES and hands each block to the
+// output: waveOut on Windows, or a null or .wav file sink that keeps
+// real-time pace without a device, for benchmarks and build boxes.
+//
+// PlayClip, LoopClip and StopClip only put a command into a bounded
+// lock-free queue that the mixer drains at the start of every block: no
+// system call, allocation or lock, so they are safe from any thread,
+// including the simulation. A full queue drops the command (counted).
+//
+// Voices come from a fixed pool of MAX_AUDIO_VOICES, so the mixing cost
+// per block is bounded whatever the game triggers. Each clip may have up to
+// its own cap of voices at once (default 1, like an MCI alias); one more
+// restarts its oldest. With the pool full, a new voice takes the one with
+// the lowest priority, oldest first, but never one above its own priority;
+// otherwise it is refused (counted).
+//
+// Music is streamed instead: a decoder thread reads each track in small
+// chunks into the ring buffer of one of two decks, and the mixer fades
+// the decks per frame, so a track change is a sample-accurate crossfade
+// and music memory is the two rings whatever the track lengths.
+//
+// No GL or GLUT; the Windows parts are behind _WIN32.
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+static const int AUDIO_RATE = 44100;
+static const int AUDIO_CHANNELS = 2;
+static const int AUDIO_BLOCK_FRAMES = 512;    // ~11.6 ms
+static const int MAX_AUDIO_CLIPS = 32;
+static const int MAX_AUDIO_VOICES = 32;
+
+// Decodes path into clip id, replacing what was there. Only before
+// StartAudio (the mixer reads clips without locking).
+bool LoadAudioClip(int id, const wchar_t* path);
+// Same, from interleaved 16-bit samples in any rate and channel count
+void SetAudioClip(int id, const short* samples, int frames, int channels, int rate);
+// Decoded length, 0 if not loaded
+int AudioClipFrames(int id);
+// Voices the clip may play at once, and its priority for the pool (higher
+// wins). Only before StartAudio, like the clips.
+void SetClipLimits(int id, int maxVoices, int priority);
+
+static const int MAX_MUSIC_TRACKS = 8;
+static const int MUSIC_RING_FRAMES = 32768;   // per deck, ~0.74 s; a power of two
+
+// Registers a track for streaming; path must stay valid. Only before
+// StartAudio.
+void SetMusicTrack(int track, const wchar_t* path);
+
+enum AudioOutput {
+    AUDIO_DEVICE,   // the default waveOut device
+    AUDIO_NULL,     // mixes at real-time pace and discards
+    AUDIO_WAV       // mixes at real-time pace into a .wav file
+};
+// Starts the mixer thread; false if the output could not be opened
+bool StartAudio(AudioOutput output, const char* wavPath = nullptr);
+void StopAudio();
+bool AudioRunning();
+
+void PlayClip(int id);   // a new voice from the start, once
+void LoopClip(int id);   // a new voice from the start, repeating
+void StopClip(int id);   // every voice of the clip
+
+// Fades track in over fadeMs, looping, and whatever music was playing out
+// over the same time. Playing the track that is already playing does
+// nothing.
+void PlayMusic(int track, int fadeMs);
+void StopMusic(int fadeMs);
+
+// Drains the queue and mixes frames into out (interleaved stereo) on the
+// calling thread; what the mixer thread does per block. Only while the
+// thread is not running (so without music).
+void MixAudio(short* out, int frames);
+
+struct AudioStats {
+    int voices;        // playing after the last block
+    int blocks;        // mixed since StartAudio
+    int underruns;     // the device ran out of queued blocks
+    int dropped;       // commands lost to a full queue
+    int stolen;        // voices taken over by a higher or equal priority
+    int refused;       // triggers with every voice above their priority
+    int musicStarved;  // blocks where a deck's ring ran dry
+    float mixMs;       // time the last MixAudio took
+};
+AudioStats GetAudioStats();
+
+#endif // AUDIO_H
@@ -0,0 +1,125 @@
+// ---------------- OFFSCREEN CAPTURE ----------------
+// See Capture.h.
+
+#include "glew.h"
+#include "Capture.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+typedef std::chrono::high_resolution_clock CaptureClock;
+
+static GLuint g_captureFbo = 0, g_captureColor = 0, g_captureDepth = 0;
+static int g_captureWidth = 0, g_captureHeight = 0;
+static bool g_captureReady = false;
+
+// Timestamps rather than GL_TIME_ELAPSED: elapsed queries cannot nest, and
+// the shadow cascades already run theirs inside the frame
+static bool g_captureTimers = false;
+static GLuint g_frameQueries[2];
+static CaptureClock::time_point g_frameStart;
+
+bool InitCaptureTarget(int width, int height) {
+    if (!(GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object)) return false;
+    glGenRenderbuffers(1, &g_captureColor);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_captureColor);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &g_captureDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_captureDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &g_captureFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_captureFbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_captureColor);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_captureDepth);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Capture framebuffer incomplete (0x%x)\n", status);
+        return false;
+    }
+
+    g_captureTimers = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (g_captureTimers) glGenQueries(2, g_frameQueries);
+    g_captureWidth = width; g_captureHeight = height;
+    g_captureReady = true;
+    return true;
+}
+
+void BeginCaptureFrame() {
+    if (!g_captureReady) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, g_captureFbo);
+    glViewport(0, 0, g_captureWidth, g_captureHeight);
+    g_frameStart = CaptureClock::now();
+    if (g_captureTimers) glQueryCounter(g_frameQueries[0], GL_TIMESTAMP);
+}
+
+CaptureTiming EndCaptureFrame() {
+    CaptureTiming t = { 0.0f, 0.0f, -1.0f };
+    if (!g_captureReady) return t;
+    if (g_captureTimers) glQueryCounter(g_frameQueries[1], GL_TIMESTAMP);
+    t.cpuMs = std::chrono::duration<float, std::milli>(CaptureClock::now() - g_frameStart).count();
+    glFinish();
+    t.frameMs = std::chrono::duration<float, std::milli>(CaptureClock::now() - g_frameStart).count();
+    if (g_captureTimers) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(g_frameQueries[0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(g_frameQueries[1], GL_QUERY_RESULT, &end);
+        t.gpuMs = (float)((end - begin) / 1.0e6);
+    }
+    return t;
+}
+
+bool WriteCaptureImage(const char* path) {
+    if (!g_captureReady) return false;
+    std::vector<unsigned char> pixels(g_captureWidth * g_captureHeight * 3);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_captureFbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // Bottom row first and BGR, which is what an uncompressed .tga holds
+    glReadPixels(0, 0, g_captureWidth, g_captureHeight, GL_BGR, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    unsigned char header[18] = { 0 };
+    header[2] = 2;   // uncompressed true colour
+    header[12] = (unsigned char)(g_captureWidth & 0xFF); header[13] = (unsigned char)(g_captureWidth >> 8);
+    header[14] = (unsigned char)(g_captureHeight & 0xFF); header[15] = (unsigned char)(g_captureHeight >> 8);
+    header[16] = 24;
+    fwrite(header, 1, sizeof(header), f);
+    fwrite(&pixels[0], 1, pixels.size(), f);
+    fclose(f);
+    return true;
+}
+
+static float Percentile(const std::vector<float>& sorted, float p) {
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5f)];
+}
+
+void PrintCaptureSummary(const std::vector<CaptureSegment>& segments) {
+    printf("%-10s %7s %9s %9s %9s %9s %9s %9s %9s\n", "segment", "frames", "mean ms", "p50", "p95", "p99", "worst", "cpu ms", "gpu ms");
+    for (const CaptureSegment& s : segments) {
+        if (s.frames.empty()) continue;
+        std::vector<float> frameMs;
+        double cpu = 0.0, gpu = 0.0, total = 0.0;
+        for (const CaptureTiming& t : s.frames) { frameMs.push_back(t.frameMs); total += t.frameMs; cpu += t.cpuMs; gpu += t.gpuMs; }
+        std::sort(frameMs.begin(), frameMs.end());
+        const double n = (double)s.frames.size();
+        printf("%-10s %7d %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f ", s.name, (int)s.frames.size(), total / n,
+            Percentile(frameMs, 0.5f), Percentile(frameMs, 0.95f), Percentile(frameMs, 0.99f), frameMs.back(), cpu / n);
+        if (s.frames[0].gpuMs < 0.0f) printf("%9s\n", "n/a");
+        else printf("%9.2f\n", gpu / n);
+    }
+}
+
+bool WriteCaptureTimings(const char* path, const std::vector<CaptureSegment>& segments) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "segment,frame,cpu_ms,frame_ms,gpu_ms\n");
+    for (const CaptureSegment& s : segments)
+        for (size_t i = 0; i < s.frames.size(); ++i)
+            fprintf(f, "%s,%d,%.3f,%.3f,%.3f\n", s.name, (int)i, s.frames[i].cpuMs, s.frames[i].frameMs, s.frames[i].gpuMs);
+    fclose(f);
+    return true;
+}
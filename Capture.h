@@ -0,0 +1,45 @@
+// ---------------- OFFSCREEN CAPTURE ----------------
+// Render target and frame recording for the headless capture mode
+// (--capture, see OpenGLMeshLoader.cpp). Frames draw into a framebuffer
+// object of a fixed size instead of the window, so the window never has to
+// be shown and the result does not depend on the desktop. Each frame is
+// timed on the CPU (submission, and submission plus glFinish) and, with
+// ARB_timer_query, on the GPU; chosen frames are read back as .tga.
+//
+// Needs framebuffer objects (GL 3.0 or ARB_framebuffer_object);
+// InitCaptureTarget reports false without them.
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <vector>
+
+struct CaptureTiming {
+    float cpuMs;     // BeginCaptureFrame to the end of submission
+    float frameMs;   // BeginCaptureFrame to glFinish returning
+    float gpuMs;     // between the GPU timestamps; -1 without ARB_timer_query
+};
+
+// One run of frames reported together, e.g. one level
+struct CaptureSegment {
+    const char* name;
+    std::vector<CaptureTiming> frames;
+};
+
+bool InitCaptureTarget(int width, int height);
+
+// Binds the target with a full viewport and starts the clocks
+void BeginCaptureFrame();
+// Waits for the GPU to finish the frame and returns its times. The target
+// stays bound, so the frame can still be read back.
+CaptureTiming EndCaptureFrame();
+
+// Colour of the target as a 24-bit .tga; the directory must exist
+bool WriteCaptureImage(const char* path);
+
+// Frames, mean, percentiles and worst frame of every segment, to stdout
+void PrintCaptureSummary(const std::vector<CaptureSegment>& segments);
+// One row per frame: segment, frame, cpu_ms, frame_ms, gpu_ms
+bool WriteCaptureTimings(const char* path, const std::vector<CaptureSegment>& segments);
+
+#endif // CAPTURE_H
@@ -0,0 +1,224 @@
+// ---------------- VIEW FRUSTUM CULLING ----------------
+// See Culling.h.
+
+#include "Culling.h"
+#include <math.h>
+#include <algorithm>
+#include <map>
+
+void MultiplyMatrix4(const float a[16], const float b[16], float out[16]) {
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 4; ++r) {
+            out[c * 4 + r] = a[0 * 4 + r] * b[c * 4 + 0] + a[1 * 4 + r] * b[c * 4 + 1] +
+                             a[2 * 4 + r] * b[c * 4 + 2] + a[3 * 4 + r] * b[c * 4 + 3];
+        }
+    }
+}
+
+// Gribb/Hartmann: each plane is row 3 of the clip matrix plus or minus rows 0..2
+void ExtractFrustum(const float m[16], Frustum& f) {
+    for (int i = 0; i < 6; ++i) {
+        const int row = i / 2;
+        const float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+        float* p = f.planes[i];
+        for (int k = 0; k < 4; ++k) p[k] = m[k * 4 + 3] + sign * m[k * 4 + row];
+        float len = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        if (len > 0.0f) { p[0] /= len; p[1] /= len; p[2] /= len; p[3] /= len; }
+    }
+}
+
+bool SphereInFrustum(const Frustum& f, float x, float y, float z, float radius) {
+    for (int i = 0; i < 6; ++i) {
+        const float* p = f.planes[i];
+        if (p[0] * x + p[1] * y + p[2] * z + p[3] < -radius) return false;
+    }
+    return true;
+}
+
+CullResult ClassifyBox(const Frustum& f, const float boxMin[3], const float boxMax[3]) {
+    CullResult result = CULL_INSIDE;
+    for (int i = 0; i < 6; ++i) {
+        const float* p = f.planes[i];
+        // Corner furthest along the plane normal, and the one opposite
+        float px = p[0] >= 0.0f ? boxMax[0] : boxMin[0], nx = p[0] >= 0.0f ? boxMin[0] : boxMax[0];
+        float py = p[1] >= 0.0f ? boxMax[1] : boxMin[1], ny = p[1] >= 0.0f ? boxMin[1] : boxMax[1];
+        float pz = p[2] >= 0.0f ? boxMax[2] : boxMin[2], nz = p[2] >= 0.0f ? boxMin[2] : boxMax[2];
+        if (p[0] * px + p[1] * py + p[2] * pz + p[3] < 0.0f) return CULL_OUTSIDE;
+        if (p[0] * nx + p[1] * ny + p[2] * nz + p[3] < 0.0f) result = CULL_INTERSECT;
+    }
+    return result;
+}
+
+void BuildCullGrid(CullGrid& g, const std::vector<BoundSphere>& spheres, float cellSize) {
+    g.spheres = spheres;
+    g.cells.clear();
+
+    // Bucket by the cell under each sphere's centre; the cell box grows to
+    // cover the whole sphere, so membership stays unique
+    std::map<long long, int> cellOf;
+    for (int i = 0; i < (int)spheres.size(); ++i) {
+        const BoundSphere& s = spheres[i];
+        long long key = ((long long)floorf(s.x / cellSize) << 32) ^ (long long)(unsigned int)(int)floorf(s.z / cellSize);
+        auto it = cellOf.find(key);
+        if (it == cellOf.end()) {
+            it = cellOf.insert(std::make_pair(key, (int)g.cells.size())).first;
+            CullCell cell;
+            cell.boxMin[0] = s.x - s.radius; cell.boxMin[1] = s.y - s.radius; cell.boxMin[2] = s.z - s.radius;
+            cell.boxMax[0] = s.x + s.radius; cell.boxMax[1] = s.y + s.radius; cell.boxMax[2] = s.z + s.radius;
+            g.cells.push_back(cell);
+        }
+        CullCell& cell = g.cells[it->second];
+        const float lo[3] = { s.x - s.radius, s.y - s.radius, s.z - s.radius };
+        const float hi[3] = { s.x + s.radius, s.y + s.radius, s.z + s.radius };
+        for (int k = 0; k < 3; ++k) {
+            if (lo[k] < cell.boxMin[k]) cell.boxMin[k] = lo[k];
+            if (hi[k] > cell.boxMax[k]) cell.boxMax[k] = hi[k];
+        }
+        cell.items.push_back(i);
+    }
+}
+
+void CullGridQuery(const CullGrid& g, const Frustum& f, std::vector<int>& visible, CullStats& stats) {
+    CullGridQueryCells(g, f, 0, (int)g.cells.size(), visible, stats);
+}
+
+void CullGridQueryCells(const CullGrid& g, const Frustum& f, int firstCell, int endCell, std::vector<int>& visible, CullStats& stats) {
+    for (int c = firstCell; c < endCell; ++c) {
+        const CullCell& cell = g.cells[c];
+        CullResult r = ClassifyBox(f, cell.boxMin, cell.boxMax);
+        if (r == CULL_OUTSIDE) { stats.culled += (int)cell.items.size(); continue; }
+        if (r == CULL_INSIDE) {
+            visible.insert(visible.end(), cell.items.begin(), cell.items.end());
+            stats.visible += (int)cell.items.size();
+            continue;
+        }
+        for (int i : cell.items) {
+            const BoundSphere& s = g.spheres[i];
+            if (SphereInFrustum(f, s.x, s.y, s.z, s.radius)) { visible.push_back(i); stats.visible++; }
+            else stats.culled++;
+        }
+    }
+}
+
+// ---------------- OCCLUSION CULLING ----------------
+
+// Clip-space position of a world point
+static inline void TransformPoint(const float m[16], float x, float y, float z, float out[4]) {
+    for (int r = 0; r < 4; ++r) out[r] = m[0 * 4 + r] * x + m[1 * 4 + r] * y + m[2 * 4 + r] * z + m[3 * 4 + r];
+}
+
+void BeginOcclusionFrame(OcclusionBuffer& ob, int width, int height, const float clip[16]) {
+    for (int i = 0; i < 16; ++i) ob.clip[i] = clip[i];
+    if (ob.width != width || ob.height != height || ob.levels.empty()) {
+        ob.width = width; ob.height = height;
+        ob.levels.clear(); ob.levelWidth.clear(); ob.levelHeight.clear();
+        int w = width, h = height;
+        for (;;) {
+            ob.levels.push_back(std::vector<float>(w * h, 1.0f));
+            ob.levelWidth.push_back(w); ob.levelHeight.push_back(h);
+            if (w == 1 && h == 1) break;
+            w = (w + 1) / 2; h = (h + 1) / 2;
+        }
+    }
+    for (auto& level : ob.levels) std::fill(level.begin(), level.end(), 1.0f);
+}
+
+// Screen-space vertex: pixel coordinates and depth in [0,1]
+struct RasterVertex { float x, y, depth; };
+
+static void RasterizeTriangle(OcclusionBuffer& ob, const RasterVertex& a, const RasterVertex& b, const RasterVertex& c) {
+    const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (fabsf(area) < 1e-6f) return;
+    const float depth = fmaxf(a.depth, fmaxf(b.depth, c.depth));   // farthest point of the triangle
+    if (depth >= 1.0f) return;
+
+    int x0 = (int)floorf(fminf(a.x, fminf(b.x, c.x))), x1 = (int)ceilf(fmaxf(a.x, fmaxf(b.x, c.x)));
+    int y0 = (int)floorf(fminf(a.y, fminf(b.y, c.y))), y1 = (int)ceilf(fmaxf(a.y, fmaxf(b.y, c.y)));
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > ob.width - 1) x1 = ob.width - 1;
+    if (y1 > ob.height - 1) y1 = ob.height - 1;
+
+    const float sign = area > 0.0f ? 1.0f : -1.0f;
+    std::vector<float>& buf = ob.levels[0];
+    for (int y = y0; y <= y1; ++y) {
+        const float py = y + 0.5f;
+        for (int x = x0; x <= x1; ++x) {
+            const float px = x + 0.5f;
+            // Pixel centre must be inside all three edges
+            float e0 = ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x)) * sign;
+            float e1 = ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x)) * sign;
+            float e2 = ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x)) * sign;
+            if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) continue;
+            float& d = buf[y * ob.width + x];
+            if (depth < d) d = depth;
+        }
+    }
+}
+
+void RasterizeOccluderBox(OcclusionBuffer& ob, const OccluderBox& box) {
+    RasterVertex v[8];
+    for (int i = 0; i < 8; ++i) {
+        float p[4];
+        TransformPoint(ob.clip, box.corners[i][0], box.corners[i][1], box.corners[i][2], p);
+        if (p[3] < 0.1f) return;   // crosses the near plane: not worth clipping, just skip it
+        v[i].x = (p[0] / p[3] * 0.5f + 0.5f) * ob.width;
+        v[i].y = (p[1] / p[3] * 0.5f + 0.5f) * ob.height;
+        v[i].depth = p[2] / p[3] * 0.5f + 0.5f;
+    }
+    // Two triangles per face; corner index bits are x, y, z
+    static const int faces[6][4] = {
+        { 0, 2, 6, 4 }, { 1, 3, 7, 5 },   // -x, +x
+        { 0, 1, 5, 4 }, { 2, 3, 7, 6 },   // -y, +y
+        { 0, 1, 3, 2 }, { 4, 5, 7, 6 }    // -z, +z
+    };
+    for (const auto& f : faces) {
+        RasterizeTriangle(ob, v[f[0]], v[f[1]], v[f[2]]);
+        RasterizeTriangle(ob, v[f[0]], v[f[2]], v[f[3]]);
+    }
+}
+
+void FinishOccluders(OcclusionBuffer& ob) {
+    for (size_t l = 1; l < ob.levels.size(); ++l) {
+        const std::vector<float>& src = ob.levels[l - 1];
+        std::vector<float>& dst = ob.levels[l];
+        const int sw = ob.levelWidth[l - 1], sh = ob.levelHeight[l - 1];
+        const int dw = ob.levelWidth[l], dh = ob.levelHeight[l];
+        for (int y = 0; y < dh; ++y) {
+            for (int x = 0; x < dw; ++x) {
+                // Farthest of the (up to) 2x2 texels below
+                const int sx0 = 2 * x, sy0 = 2 * y;
+                const int sx1 = (sx0 + 1 < sw) ? sx0 + 1 : sx0, sy1 = (sy0 + 1 < sh) ? sy0 + 1 : sy0;
+                dst[y * dw + x] = fmaxf(fmaxf(src[sy0 * sw + sx0], src[sy0 * sw + sx1]), fmaxf(src[sy1 * sw + sx0], src[sy1 * sw + sx1]));
+            }
+        }
+    }
+}
+
+bool SphereOccluded(const OcclusionBuffer& ob, float x, float y, float z, float radius) {
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearest = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        float p[4];
+        TransformPoint(ob.clip, x + ((i & 1) ? radius : -radius), y + ((i & 2) ? radius : -radius), z + ((i & 4) ? radius : -radius), p);
+        if (p[3] < 0.1f) return false;   // reaches the camera
+        const float sx = (p[0] / p[3] * 0.5f + 0.5f) * ob.width;
+        const float sy = (p[1] / p[3] * 0.5f + 0.5f) * ob.height;
+        const float d = p[2] / p[3] * 0.5f + 0.5f;
+        minX = fminf(minX, sx); maxX = fmaxf(maxX, sx);
+        minY = fminf(minY, sy); maxY = fmaxf(maxY, sy);
+        nearest = fminf(nearest, d);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= ob.width || minY >= ob.height) return false;   // off screen: the frustum test's call
+    int x0 = (int)fmaxf(minX, 0.0f), y0 = (int)fmaxf(minY, 0.0f);
+    int x1 = (int)fminf(maxX, (float)(ob.width - 1)), y1 = (int)fminf(maxY, (float)(ob.height - 1));
+
+    // Coarsest level where the rectangle covers at most 2x2 texels
+    size_t level = 0;
+    while (level + 1 < ob.levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) level++;
+    const int lw = ob.levelWidth[level];
+    const std::vector<float>& buf = ob.levels[level];
+    float farthest = 0.0f;
+    for (int ty = y0 >> level; ty <= (y1 >> level); ++ty)
+        for (int tx = x0 >> level; tx <= (x1 >> level); ++tx) farthest = fmaxf(farthest, buf[ty * lw + tx]);
+    return nearest > farthest;
+}
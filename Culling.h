@@ -0,0 +1,78 @@
+// ---------------- VIEW FRUSTUM CULLING ----------------
+// Frustum extraction and bounding-volume tests for the render passes, plus
+// a coarse grid of static instances so whole blocks of the island can be
+// rejected with one box test before any instance is looked at. Like
+// GameWorld this is plain math: matrices come in as float[16] in OpenGL
+// (column-major) layout, and nothing here calls GL.
+
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <vector>
+
+// Planes are normalised and point inwards: a*x + b*y + c*z + d >= 0 is inside
+struct Frustum { float planes[6][4]; };
+
+struct BoundSphere { float x, y, z, radius; };
+
+enum CullResult { CULL_OUTSIDE, CULL_INTERSECT, CULL_INSIDE };
+
+// Objects tested / rejected this frame, shown on the stats overlay
+struct CullStats { int visible; int culled; };
+
+// out = a * b (all column-major, out may not alias a or b)
+void MultiplyMatrix4(const float a[16], const float b[16], float out[16]);
+// clip = projection * modelview; gives a world-space frustum when the
+// modelview holds only the camera transform
+void ExtractFrustum(const float clip[16], Frustum& f);
+bool SphereInFrustum(const Frustum& f, float x, float y, float z, float radius);
+CullResult ClassifyBox(const Frustum& f, const float boxMin[3], const float boxMax[3]);
+
+// Static instances bucketed into square cells on the XZ plane. Each cell
+// keeps the box around its members' spheres; a cell fully inside the
+// frustum accepts all its members without testing them one by one.
+struct CullCell {
+    float boxMin[3], boxMax[3];
+    std::vector<int> items;
+};
+struct CullGrid {
+    std::vector<BoundSphere> spheres;
+    std::vector<CullCell> cells;       // only non-empty cells are kept
+};
+
+void BuildCullGrid(CullGrid& g, const std::vector<BoundSphere>& spheres, float cellSize);
+// Appends the indices of potentially visible spheres to visible
+void CullGridQuery(const CullGrid& g, const Frustum& f, std::vector<int>& visible, CullStats& stats);
+// The same over cells [firstCell, endCell) only, so ranges can be culled
+// on different threads into different lists
+void CullGridQueryCells(const CullGrid& g, const Frustum& f, int firstCell, int endCell, std::vector<int>& visible, CullStats& stats);
+
+// ---------------- OCCLUSION CULLING ----------------
+// Software hierarchical depth buffer. Big occluders (the street houses, the
+// boat) are rasterised as boxes into a small depth buffer each frame, a
+// max-depth pyramid is built on top, and occludees are tested as the
+// screen rectangle and nearest depth of their bounding sphere. Occluder
+// boxes must sit inside the real geometry; a triangle is written at its
+// farthest depth and anything that crosses the near plane is skipped, so
+// the buffer only ever underestimates what is hidden.
+
+struct OcclusionBuffer {
+    int width, height;
+    float clip[16];                          // projection * view of this frame
+    std::vector<std::vector<float> > levels; // levels[0] is full res; depth in [0,1], 1 = far
+    std::vector<int> levelWidth, levelHeight;
+};
+
+// Objects tested / hidden and triangles not submitted because of it
+struct OcclusionStats { int occluders; int tested; int occluded; int trianglesSkipped; };
+
+void BeginOcclusionFrame(OcclusionBuffer& ob, int width, int height, const float clip[16]);
+// Box given by its 8 world-space corners; corner i has bit 0/1/2 set for
+// the max side along its own x/y/z axis, so oriented boxes work too
+struct OccluderBox { float corners[8][3]; };
+void RasterizeOccluderBox(OcclusionBuffer& ob, const OccluderBox& box);
+// Builds the pyramid; call once after the last occluder
+void FinishOccluders(OcclusionBuffer& ob);
+bool SphereOccluded(const OcclusionBuffer& ob, float x, float y, float z, float radius);
+
+#endif // CULLING_H
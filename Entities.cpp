@@ -0,0 +1,80 @@
+// ---------------- ENTITY STORE ----------------
+// See Entities.h.
+
+#include "Entities.h"
+#include <string.h>
+
+bool IsAlive(const EntityWorld& world, Entity e) {
+    return e.index < world.slots.size() && world.slots[e.index].archetype >= 0 && world.slots[e.index].generation == e.generation;
+}
+
+int FindArchetype(EntityWorld& world, ComponentMask mask, const unsigned int componentSize[MAX_COMPONENT_TYPES]) {
+    for (size_t i = 0; i < world.archetypes.size(); ++i)
+        if (world.archetypes[i].mask == mask) return (int)i;
+    world.archetypes.push_back(EntityArchetype());
+    EntityArchetype& a = world.archetypes.back();
+    a.mask = mask;
+    for (int c = 0; c < MAX_COMPONENT_TYPES; ++c) a.componentSize[c] = (mask & (1u << c)) ? componentSize[c] : 0;
+    return (int)world.archetypes.size() - 1;
+}
+
+Entity AppendEntity(EntityWorld& world, int archetype) {
+    unsigned int index;
+    if (!world.freeSlots.empty()) { index = world.freeSlots.back(); world.freeSlots.pop_back(); }
+    else { index = (unsigned int)world.slots.size(); world.slots.push_back(EntitySlot{ -1, 0, 0 }); }
+
+    EntityArchetype& a = world.archetypes[archetype];
+    EntitySlot& slot = world.slots[index];
+    slot.archetype = archetype;
+    slot.row = (int)a.entities.size();
+    const Entity e = { index, slot.generation };
+    a.entities.push_back(e);
+    for (int c = 0; c < MAX_COMPONENT_TYPES; ++c)
+        if (a.componentSize[c]) a.columns[c].resize(a.entities.size() * a.componentSize[c]);
+    world.version++;
+    return e;
+}
+
+void DestroyEntity(EntityWorld& world, Entity e) {
+    if (!IsAlive(world, e)) return;
+    EntitySlot& slot = world.slots[e.index];
+    EntityArchetype& a = world.archetypes[slot.archetype];
+    const int row = slot.row, last = (int)a.entities.size() - 1;
+
+    // The last row fills the hole
+    if (row != last) {
+        for (int c = 0; c < MAX_COMPONENT_TYPES; ++c) {
+            const unsigned int size = a.componentSize[c];
+            if (size) memcpy(&a.columns[c][row * size], &a.columns[c][last * size], size);
+        }
+        a.entities[row] = a.entities[last];
+        world.slots[a.entities[row].index].row = row;
+    }
+    a.entities.pop_back();
+    for (int c = 0; c < MAX_COMPONENT_TYPES; ++c)
+        if (a.componentSize[c]) a.columns[c].resize(a.entities.size() * a.componentSize[c]);
+
+    slot.archetype = -1;
+    slot.generation++;
+    world.freeSlots.push_back(e.index);
+    world.version++;
+}
+
+void ClearEntities(EntityWorld& world) {
+    for (EntityArchetype& a : world.archetypes) {
+        for (const Entity& e : a.entities) {
+            world.slots[e.index].archetype = -1;
+            world.slots[e.index].generation++;
+            world.freeSlots.push_back(e.index);
+        }
+        a.entities.clear();
+        for (int c = 0; c < MAX_COMPONENT_TYPES; ++c) a.columns[c].clear();
+    }
+    world.version++;
+}
+
+int EntityCount(const EntityWorld& world) {
+    int count = 0;
+    for (const EntityArchetype& a : world.archetypes) count += (int)a.entities.size();
+    return count;
+}
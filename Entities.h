@@ -0,0 +1,145 @@
+// ---------------- ENTITY STORE ----------------
+// Archetype entity-component store. Entities with the same set of
+// components share an archetype, which keeps one packed array per
+// component, so a query walks a few contiguous arrays per archetype and
+// never looks at entities without the components it asked for:
+//
+//   ForEach<Transform, Spin>(world, [&](Entity e, Transform& t, Spin& s) { ... });
+//
+// Components are plain structs (trivially copyable), each declared once
+// with a bit of its own:
+//
+//   struct Spin { float degPerSec; };
+//   DECLARE_COMPONENT(Spin, 1)
+//
+// Destroying an entity moves the last one of its archetype into its row.
+// Handles stay valid (they go through a generation-checked slot table) but
+// rows, and pointers into the arrays, do not; EntityWorld::version changes
+// with every create and destroy so caches know when to rebuild. Nothing
+// may be created or destroyed inside ForEach.
+//
+// No GL, GLUT or Windows, like GameWorld.h.
+
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include "Jobs.h"
+#include <type_traits>
+#include <vector>
+
+static const int MAX_COMPONENT_TYPES = 32;
+typedef unsigned int ComponentMask;
+
+template <typename T> struct ComponentBit;
+#define DECLARE_COMPONENT(T, BIT) template <> struct ComponentBit<T> { static const int value = BIT; };
+
+struct Entity { unsigned int index, generation; };
+static const Entity NO_ENTITY = { 0xFFFFFFFFu, 0 };
+
+struct EntityArchetype {
+    ComponentMask mask;
+    std::vector<Entity> entities;                               // row -> entity
+    std::vector<unsigned char> columns[MAX_COMPONENT_TYPES];   // only the mask's bits are used
+    unsigned int componentSize[MAX_COMPONENT_TYPES];
+};
+
+struct EntitySlot { int archetype; int row; unsigned int generation; };
+
+struct EntityWorld {
+    std::vector<EntityArchetype> archetypes;
+    std::vector<EntitySlot> slots;
+    std::vector<unsigned int> freeSlots;
+    unsigned int version = 0;
+};
+
+bool IsAlive(const EntityWorld& world, Entity e);
+void DestroyEntity(EntityWorld& world, Entity e);
+// Every entity, keeping the archetypes and their capacity
+void ClearEntities(EntityWorld& world);
+int EntityCount(const EntityWorld& world);
+
+// Used by the templates below
+int FindArchetype(EntityWorld& world, ComponentMask mask, const unsigned int componentSize[MAX_COMPONENT_TYPES]);
+Entity AppendEntity(EntityWorld& world, int archetype);
+
+template <typename T> inline ComponentMask MaskOf() {
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved with memcpy");
+    return 1u << ComponentBit<T>::value;
+}
+template <typename T, typename U, typename... Rest> inline ComponentMask MaskOf() { return MaskOf<T>() | MaskOf<U, Rest...>(); }
+
+template <typename T> inline T* Column(EntityArchetype& a) {
+    return reinterpret_cast<T*>(a.columns[ComponentBit<T>::value].data());
+}
+
+template <typename... C>
+Entity CreateEntity(EntityWorld& world, const C&... components) {
+    unsigned int size[MAX_COMPONENT_TYPES] = { 0 };
+    int sized[] = { (size[ComponentBit<C>::value] = sizeof(C), 0)... };
+    (void)sized;
+    const int archetype = FindArchetype(world, MaskOf<C...>(), size);
+    const Entity e = AppendEntity(world, archetype);
+    EntityArchetype& a = world.archetypes[archetype];
+    const int row = (int)a.entities.size() - 1;
+    int stored[] = { (Column<C>(a)[row] = components, 0)... };
+    (void)stored;
+    return e;
+}
+
+// Null if e is gone or has no T
+template <typename T>
+T* GetComponent(EntityWorld& world, Entity e) {
+    if (!IsAlive(world, e)) return nullptr;
+    const EntitySlot& s = world.slots[e.index];
+    EntityArchetype& a = world.archetypes[s.archetype];
+    if (!(a.mask & MaskOf<T>())) return nullptr;
+    return Column<T>(a) + s.row;
+}
+
+template <typename F, typename... P>
+inline void ForEachRow(F& f, const Entity* entities, int count, P*... columns) {
+    for (int i = 0; i < count; ++i) f(entities[i], columns[i]...);
+}
+
+// f(Entity, C&...) for every entity that has all of C (and maybe more)
+template <typename... C, typename F>
+void ForEach(EntityWorld& world, F f) {
+    const ComponentMask need = MaskOf<C...>();
+    for (EntityArchetype& a : world.archetypes) {
+        if ((a.mask & need) != need || a.entities.empty()) continue;
+        ForEachRow(f, a.entities.data(), (int)a.entities.size(), Column<C>(a)...);
+    }
+}
+
+// ForEach split into jobs of up to grain rows (Jobs.h), across archetypes,
+// waiting for all of them. f runs on several threads at once: it may
+// write its own row and nothing else.
+template <typename... C, typename F>
+void ParallelForEach(EntityWorld& world, int grain, F f) {
+    const ComponentMask need = MaskOf<C...>();
+    int rows = 0;
+    for (const EntityArchetype& a : world.archetypes)
+        if ((a.mask & need) == need) rows += (int)a.entities.size();
+    // Rows are numbered through the matching archetypes in order
+    ParallelFor(rows, grain, [&](int begin, int end) {
+        int base = 0;
+        for (EntityArchetype& a : world.archetypes) {
+            if ((a.mask & need) != need) continue;
+            const int count = (int)a.entities.size();
+            const int lo = begin > base ? begin : base, hi = end < base + count ? end : base + count;
+            if (lo < hi) ForEachRow(f, a.entities.data() + (lo - base), hi - lo, (Column<C>(a) + (lo - base))...);
+            base += count;
+            if (base >= end) break;
+        }
+    });
+}
+
+// Destroys every entity with all of C for which remove(Entity, C&...) is true
+template <typename... C, typename F>
+void DestroyIf(EntityWorld& world, F remove) {
+    std::vector<Entity> doomed;
+    ForEach<C...>(world, [&](Entity e, C&... c) { if (remove(e, c...)) doomed.push_back(e); });
+    for (const Entity& e : doomed) DestroyEntity(world, e);
+}
+
+#endif // ENTITIES_H
@@ -0,0 +1,121 @@
+// ---------------- FRAME PACER ----------------
+// See FramePacer.h.
+
+#include "FramePacer.h"
+#include <chrono>
+#include <math.h>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+typedef std::chrono::steady_clock PacerClock;
+
+// Everything here belongs to the thread with the event loop
+static PacerOptions g_pacer = { 60.0f, 10.0f, false, 0.0f };
+static int g_swapInterval = 0;
+static bool g_vsyncHonoured = true;   // cleared for good once frames outrun the swap
+static PacerClock::time_point g_awakeUntil;  // static screens run at the full rate until then
+static PacerClock::time_point g_lastFrame;   // deadline of the last frame, or when it was drawn if that was over a period late
+static double g_overshootPeakNs = 1.0e6;     // how late sleeps wake, decaying towards the recent worst
+static double g_frameSleepNs = 0.0, g_frameSpinNs = 0.0;
+static double g_intervalMsAvg = 0.0;
+static int g_intervalSamples = 0;
+static PacerStats g_stats = {};
+
+static const double MIN_SPIN_MARGIN_NS = 0.5e6, MAX_SPIN_MARGIN_NS = 4.0e6;
+static const float STATS_SMOOTHING = 0.05f;
+static const int VSYNC_CHECK_FRAMES = 60;
+
+void SetPacerOptions(const PacerOptions& options) {
+#ifdef _WIN32
+    static bool timerPeriodSet = false;   // 1 ms sleeps instead of the 15.6 ms default tick
+    if (!timerPeriodSet) timerPeriodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+#endif
+    g_pacer = options;
+    if (g_pacer.targetHz <= 0.0f) g_pacer.vsync = false;   // uncapped means not waiting for the display either
+    if (!g_pacer.vsync) g_swapInterval = 0;
+    else if (g_pacer.refreshHz > 0.0f && g_pacer.targetHz > 0.0f) {
+        g_swapInterval = (int)ceilf(g_pacer.refreshHz / g_pacer.targetHz - 0.01f);   // 59.94 Hz still counts as 60
+        if (g_swapInterval < 1) g_swapInterval = 1;
+    }
+    else g_swapInterval = 1;
+    g_vsyncHonoured = true;
+    g_intervalMsAvg = 0.0;
+    g_intervalSamples = 0;
+    g_lastFrame = PacerClock::now();
+}
+
+int PacerSwapInterval() { return g_swapInterval; }
+
+static bool VsyncPacing() { return g_pacer.vsync && g_vsyncHonoured; }
+
+static double PeriodNs(bool lowPower) {
+    if (lowPower && g_pacer.lowPowerHz > 0.0f) return 1.0e9 / g_pacer.lowPowerHz;
+    if (VsyncPacing() || g_pacer.targetHz <= 0.0f) return 0.0;
+    return 1.0e9 / g_pacer.targetHz;
+}
+
+static double NsBetween(PacerClock::time_point a, PacerClock::time_point b) {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+}
+
+static bool FrameDue(PacerClock::time_point now, PacerClock::time_point deadline, double periodNs, bool lowPower) {
+    // A swap interval's worth of refreshes is what a vsynced frame should
+    // take; a quarter less on average, after the first second or so, means
+    // the driver is not waiting
+    const double intervalMs = NsBetween(g_lastFrame, now) / 1.0e6;
+    if (VsyncPacing() && !lowPower && g_pacer.refreshHz > 0.0f) {
+        g_intervalMsAvg = g_intervalSamples++ > 0 ? g_intervalMsAvg * 0.9 + intervalMs * 0.1 : intervalMs;
+        if (g_intervalSamples > VSYNC_CHECK_FRAMES && g_intervalMsAvg < 0.75 * g_swapInterval * 1000.0 / g_pacer.refreshHz) g_vsyncHonoured = false;
+    }
+
+    g_lastFrame = NsBetween(deadline, now) < periodNs ? deadline : now;
+    g_stats.periodMs = (float)(periodNs / 1.0e6);
+    g_stats.sleepMs += ((float)(g_frameSleepNs / 1.0e6) - g_stats.sleepMs) * STATS_SMOOTHING;
+    g_stats.spinMs += ((float)(g_frameSpinNs / 1.0e6) - g_stats.spinMs) * STATS_SMOOTHING;
+    g_frameSleepNs = g_frameSpinNs = 0.0;
+    return true;
+}
+
+static double SpinMarginNs() {
+    const double margin = g_overshootPeakNs + 0.25e6;
+    return margin < MIN_SPIN_MARGIN_NS ? MIN_SPIN_MARGIN_NS : margin > MAX_SPIN_MARGIN_NS ? MAX_SPIN_MARGIN_NS : margin;
+}
+
+bool PacerFrameDue(bool lowPower) {
+    const PacerClock::time_point now = PacerClock::now();
+    if (lowPower && now < g_awakeUntil) lowPower = false;
+    const double periodNs = PeriodNs(lowPower);
+    const PacerClock::time_point deadline = g_lastFrame + std::chrono::nanoseconds((long long)periodNs);
+    if (periodNs <= 0.0) return FrameDue(now, now, periodNs, lowPower);
+
+    const double remainingNs = NsBetween(now, deadline);
+    const double marginNs = SpinMarginNs();
+    if (remainingNs > marginNs) {
+        double sleepNs = remainingNs - marginNs;
+        if (sleepNs > PACER_MAX_SLEEP_MS * 1.0e6) sleepNs = PACER_MAX_SLEEP_MS * 1.0e6;
+        std::this_thread::sleep_for(std::chrono::nanoseconds((long long)sleepNs));
+        const double sleptNs = NsBetween(now, PacerClock::now());
+        const double overshootNs = sleptNs - sleepNs;
+        g_overshootPeakNs = overshootNs > g_overshootPeakNs * 0.98 ? overshootNs : g_overshootPeakNs * 0.98;
+        g_frameSleepNs += sleptNs;
+        return false;   // back to the event loop; the spin comes on a later call
+    }
+    PacerClock::time_point spun = now;
+    while (spun < deadline) { std::this_thread::yield(); spun = PacerClock::now(); }
+    g_frameSpinNs += NsBetween(now, spun);
+    return FrameDue(spun, deadline, periodNs, lowPower);
+}
+
+void PacerWake() { g_awakeUntil = PacerClock::now() + std::chrono::milliseconds(PACER_WAKE_MS); }
+
+PacerStats GetPacerStats() {
+    PacerStats stats = g_stats;
+    stats.spinMarginMs = (float)(SpinMarginNs() / 1.0e6);
+    stats.vsyncPacing = VsyncPacing();
+    return stats;
+}
@@ -0,0 +1,54 @@
+// ---------------- FRAME PACER ----------------
+// Decides when the next frame is drawn, from the GLUT idle callback:
+//
+//   void Anim() { if (PacerFrameDue(lowPower)) glutPostRedisplay(); }
+//
+// Frames are due every 1/targetHz, or every 1/lowPowerHz on screens that
+// do not move (menu, win, lose). Waiting is a hybrid: sleep until a spin
+// margin before the deadline, then yield-spin the rest, with the margin
+// following how late the OS wakes the thread (about 1 ms with a 1 ms timer
+// period, up to a whole 15.6 ms tick without). A single sleep never lasts
+// more than PACER_MAX_SLEEP_MS, so the caller gets back to its event loop
+// and input is not held up by a long wait.
+//
+// With vsync on, the swap already waits for the display: the pacer sets
+// the swap interval that gives the nearest rate at or under the target and
+// does not wait itself, unless frames come noticeably faster than that
+// (the driver overrides vsync), when it goes back to its own timing.
+//
+// No GL or GLUT; the host sets the swap interval and reads the refresh rate.
+
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+static const int PACER_MAX_SLEEP_MS = 5;
+static const int PACER_WAKE_MS = 250;
+
+struct PacerOptions {
+    float targetHz;     // 0: as fast as possible, vsync or not
+    float lowPowerHz;   // static screens; 0 treats them like the rest
+    bool vsync;         // the host managed to turn vsync on
+    float refreshHz;    // display refresh, 0 if unknown
+};
+void SetPacerOptions(const PacerOptions& options);
+// Swap interval for the host to set: 0 without vsync, else how many
+// refreshes one frame at the target rate lasts (at least 1)
+int PacerSwapInterval();
+
+// True when the next frame should be drawn; otherwise it has slept (at
+// most PACER_MAX_SLEEP_MS) and should be asked again
+bool PacerFrameDue(bool lowPower);
+// Input arrived: static screens run at the full rate for PACER_WAKE_MS,
+// so a click is answered, and what it led to shown, without waiting out
+// the low rate
+void PacerWake();
+
+struct PacerStats {
+    float periodMs;        // what the pacer aims for now, 0 uncapped or left to vsync
+    float sleepMs, spinMs; // per frame, averaged
+    float spinMarginMs;    // how early sleeping stops
+    bool vsyncPacing;      // frames are being paced by the swap
+};
+PacerStats GetPacerStats();
+
+#endif // FRAME_PACER_H
@@ -6,7 +6,7 @@
 // GLTexture.cpp: implementation of the GLTexture class.
 // This class loads a texture file and prepares it
 // to be used in OpenGL. It can open a bitmap or a
-// targa file. The min filter is set to mipmap b/c
+// targa file, or a png/jpeg through WIC. The min filter is set to mipmap b/c
 // they look better and the performance cost on
 // modern video cards in negligible. I leave all of
 // the texture management to the application. I have
@@ -35,10 +35,15 @@
 //////////////////////////////////////////////////////////////////////
 
 #include "GLTexture.h"
+#include "Telemetry.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs")
+#pragma comment(lib, "ole32")
 
 
 //////////////////////////////////////////////////////////////////////
@@ -47,7 +52,8 @@
 
 GLTexture::GLTexture()
 {
-
+	// No texture until one is loaded or built
+	texture[0] = 0;
 }
 
 GLTexture::~GLTexture()
@@ -69,6 +75,8 @@ void GLTexture::Load(char *name)
 		LoadBMP(texturename);
 	if(strstr(texturename, ".tga"))	
 		LoadTGA(texturename);
+	if(strstr(texturename, ".png") || strstr(texturename, ".jpg") || strstr(texturename, ".jpeg"))
+		LoadWIC(texturename);
 }
 
 void GLTexture::LoadFromResource(char *name)
@@ -83,10 +91,13 @@ void GLTexture::LoadFromResource(char *name)
 		LoadTGAResource(name);
 }
 
+static const int CTR_TEXTURE_BINDS = RegisterCounter("texture_binds", "Textures bound for drawing.");
+
 void GLTexture::Use()
 {
 	glEnable(GL_TEXTURE_2D);								// Enable texture mapping
 	glBindTexture(GL_TEXTURE_2D, texture[0]);				// Bind the texture as the current one
+	CountAdd(CTR_TEXTURE_BINDS);
 }
 
 void GLTexture::LoadBMP(char *name)
@@ -131,6 +142,70 @@ void GLTexture::LoadBMP(char *name)
 	}
 }
 
+void GLTexture::LoadWIC(char *name)
+{
+	// COM may already be initialized by someone else; it is usable either way
+	HRESULT com = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+
+	IWICImagingFactory *factory = NULL;
+	IWICBitmapDecoder *decoder = NULL;
+	IWICBitmapFrameDecode *frame = NULL;
+	IWICFormatConverter *converter = NULL;
+	unsigned char *data = NULL;
+
+	wchar_t wideName[MAX_PATH];
+	MultiByteToWideChar(CP_ACP, 0, name, -1, wideName, MAX_PATH);
+
+	// Decode the first frame and convert it to 24 bit RGB
+	if (SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_IWICImagingFactory, (void**)&factory)) &&
+		SUCCEEDED(factory->CreateDecoderFromFilename(wideName, NULL, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder)) &&
+		SUCCEEDED(decoder->GetFrame(0, &frame)) &&
+		SUCCEEDED(factory->CreateFormatConverter(&converter)) &&
+		SUCCEEDED(converter->Initialize(frame, GUID_WICPixelFormat24bppRGB, WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom)))
+	{
+		UINT w = 0, h = 0;
+		converter->GetSize(&w, &h);
+		data = new unsigned char[w * h * 3];
+		if (SUCCEEDED(converter->CopyPixels(NULL, w * 3, w * h * 3, data)))
+		{
+			width = w;
+			height = h;
+
+			// WIC rows run top down, OpenGL's bottom up (like the bitmaps)
+			unsigned char *row = new unsigned char[w * 3];
+			for (UINT y = 0; y < h / 2; y++)
+			{
+				memcpy(row, data + y * w * 3, w * 3);
+				memcpy(data + y * w * 3, data + (h - 1 - y) * w * 3, w * 3);
+				memcpy(data + (h - 1 - y) * w * 3, row, w * 3);
+			}
+			delete[] row;
+
+			// Generate the OpenGL texture id
+			glGenTextures(1, &texture[0]);
+
+			// Bind this texture to its id
+			glBindTexture(GL_TEXTURE_2D, texture[0]);
+
+			// Use mipmapping filter
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+
+			// Generate the mipmaps
+			gluBuild2DMipmaps(GL_TEXTURE_2D, 3, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
+		}
+	}
+
+	// Cleanup
+	delete[] data;
+	if (converter) converter->Release();
+	if (frame) frame->Release();
+	if (decoder) decoder->Release();
+	if (factory) factory->Release();
+	if (SUCCEEDED(com))
+		CoUninitialize();
+}
+
 void GLTexture::LoadTGA(char *name)
 {
 	GLubyte		TGAheader[12]	= {0,0,2,0,0,0,0,0,0,0,0,0};// Uncompressed TGA header
@@ -6,7 +6,7 @@
 // GLTexture.h: interface for the GLTexture class.
 // This class loads a texture file and prepares it
 // to be used in OpenGL. It can open a bitmap or a
-// targa file. The min filter is set to mipmap b/c
+// targa file, or a png/jpeg through WIC. The min filter is set to mipmap b/c
 // they look better and the performance cost on
 // modern video cards in negligible. I leave all of
 // the texture management to the application. I have
@@ -58,6 +58,7 @@ public:
 	void LoadFromResource(char *name);				// Load the texture from a resource
 	void LoadTGA(char *name);						// Loads a targa file
 	void LoadBMP(char *name);						// Loads a bitmap file
+	void LoadWIC(char *name);						// Loads a png or jpeg file (Windows Imaging Component)
 	void Load(char *name);							// Load the texture
 	GLTexture();									// Constructor
 	virtual ~GLTexture();							// Destructor
@@ -0,0 +1,1378 @@
+// ---------------- GAME WORLD ----------------
+// Simulation side of Pirate's Run. See GameWorld.h for what may and may not
+// live in this file.
+
+#include "GameWorld.h"
+#include "Profiler.h"
+#include "Telemetry.h"
+#include <math.h>
+#include <stdlib.h>
+
+GameState gameState = MENU; // Start in Menu
+
+static bool winSoundPlayed = false;
+static bool loseSoundPlayed = false;
+
+static int lastCollisionTime = 0;
+const int COLLISION_SOUND_COOLDOWN = 300;
+
+// Level 1 -> 2 fades to black and back at FADE_SPEED (fadeAlpha per
+// second); each level's music fades with the picture
+const float FADE_SPEED = 0.8f;
+const int FADE_MS = (int)(1000.0f / FADE_SPEED);
+const int MUSIC_CROSSFADE_MS = 500;   // new run from level 2
+const int MUSIC_STOP_FADE_MS = 250;   // win or lose
+
+// --- SUN MOVEMENT VARIABLES ---
+float sunAngle = 0.0f;      // Rotation angle
+float sunSpeed = 0.3f;      // Speed of day/night cycle
+float sunRadius = 250.0f;   // Distance from center
+
+// ---------------- LEVEL 1 OBJECTS ----------------
+bool hasMap = false;
+
+NPCInstance g_npc = { 5.0f, 0.0f, 5.0f, 180.0f, 0.02f, true };
+
+bool showInteractPrompt = false;
+bool showNPCDialogue = false;
+float dialogueTimer = 0.0f;
+
+BoatInstance g_boat = { 0.0f, GROUND_Y, 0.0f, 0.0f, 1.0f, false };
+
+bool showBoatPrompt = false;
+bool showBoatDialogue = false;
+bool showBoatDialogue2 = false;
+bool showBoatInsufficient = false;
+float boatDialogueTimer = 0.0f;
+
+bool paidForBoat = false;
+
+// Level 1 Environment Instances
+std::vector<TreeInstance> g_trees;
+std::vector<HouseInstance> g_houses;
+std::vector<RockInstance> g_rocks;
+
+// Level 1 Platforms
+Platform g_platforms[PLATFORM_COUNT] = {
+    { (WORLD_SIZE * 0.5f) - 8.0f, 2.0f, (WORLD_SIZE * 0.5f) - 6.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) + 6.0f, 4.0f, (WORLD_SIZE * 0.5f) - 3.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) - 5.0f, 6.4f, (WORLD_SIZE * 0.5f) + 4.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) + 8.0f, 8.8f, (WORLD_SIZE * 0.5f) + 2.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) - 10.0f, 10.2f, (WORLD_SIZE * 0.5f) - 1.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) + 10.0f, 12.6f, (WORLD_SIZE * 0.5f) - 7.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) - 7.0f, 14.0f, (WORLD_SIZE * 0.5f) + 8.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) + 2.0f, 16.4f, (WORLD_SIZE * 0.5f) + 10.0f, 2.5f },
+    { (WORLD_SIZE * 0.5f) - 12.0f, 18.8f, (WORLD_SIZE * 0.5f) + 12.0f, 2.5f },
+};
+
+// ---------------- LEVEL 2 OBJECTS ----------------
+std::vector<Lvl2Platform> lvl2_platforms;
+
+std::vector<Pendulum> lvl2_pendulums;
+
+Chest lvl2_chest = { 0.0f, 2.0f, 130.0f, false }; // Level 2 Chest
+
+bool hasLvl2Key = false;
+int score = 1000; // Start at 1000
+// --- COIN STARTING VALUE ---
+int coinsCollected = 0;
+float gameTimer = 0.0f;
+int gemsCollected = 0;
+// --- LIVES SYSTEM ---
+int lives = 5;
+
+// ---------------- LEVEL ENTITIES ----------------
+EntityWorld g_level1Entities, g_level2Entities;
+
+EntityWorld& LevelEntities() { return gameState == LEVEL_2 ? g_level2Entities : g_level1Entities; }
+
+static const int CTR_COLLISION_QUERIES = RegisterCounter("collision_queries", "Movement collision tests, two per player or agent step.");
+static const int CTR_PICKUPS = RegisterCounter("pickups", "Coins, gems, keys and maps taken by the player or agents.");
+
+// What taking each PickupKind does
+struct PickupRule { int score; int* counter; bool* flag; SoundId sound; bool agents; };
+static const PickupRule PICKUP_RULES[PICKUP_KIND_COUNT] = {
+    { 1, &coinsCollected, nullptr, SND_COIN_PICKUP, true },   // PICKUP_COIN
+    { 10, &gemsCollected, nullptr, SND_COIN_PICKUP, true },   // PICKUP_GEM
+    { 10, nullptr, &hasMap, SND_MAP_PICKUP, false },          // PICKUP_MAP
+    { 0, nullptr, &hasLvl2Key, SND_COIN_PICKUP, false },      // PICKUP_KEY
+};
+
+static std::vector<Entity> g_takenPickups;   // reused by the player and agent pickup passes
+
+Entity SpawnCoin(float x, float z) {
+    return CreateEntity(g_level1Entities, Transform{ x, 1.0f, z, 0.0f, 2.0f }, Spin{ 120.0f }, Pickup{ PICKUP_COIN, 2.0f }, Renderable{ RENDER_COIN });
+}
+
+int CountPickups(EntityWorld& world, PickupKind kind) {
+    int count = 0;
+    ForEach<Pickup>(world, [&](Entity, const Pickup& p) { if (p.kind == kind) count++; });
+    return count;
+}
+
+static void DestroyPickups(EntityWorld& world, PickupKind kind) {
+    DestroyIf<Pickup>(world, [kind](Entity, const Pickup& p) { return p.kind == kind; });
+}
+
+// Everything within reach of the player goes
+static void TakePickups(EntityWorld& world) {
+    ForEach<Transform, Pickup>(world, [&](Entity e, const Transform& t, const Pickup& p) {
+        const float dx = playerX - t.x, dz = playerZ - t.z;
+        if (dx * dx + dz * dz < p.reach * p.reach) g_takenPickups.push_back(e);
+    });
+    for (const Entity& e : g_takenPickups) {
+        const PickupRule& rule = PICKUP_RULES[GetComponent<Pickup>(world, e)->kind];
+        score += rule.score;
+        if (rule.counter) (*rule.counter)++;
+        if (rule.flag) *rule.flag = true;
+        Game_PlaySound(rule.sound);
+        DestroyEntity(world, e);
+    }
+    CountAdd(CTR_PICKUPS, (long long)g_takenPickups.size());
+    g_takenPickups.clear();
+}
+
+// Helper to handle player death (lose a life)
+void HandlePlayerDeath() {
+    lives -= 1;
+    if (lives < 0) lives = 0;
+    // Scoring penalty on death
+    score -= 15;
+    if (score < 0) score = 0;
+    // Play collision sound
+    Game_PlaySound(SND_OOF);
+    Game_PlaySound(SND_COLLISION);
+    if (lives == 0) {
+        gameState = LOSE;
+        // --- UPDATED: Stop Music on Game Over ---
+        Game_StopMusic(MUSIC_STOP_FADE_MS);
+        if (!loseSoundPlayed) {
+            Game_PlaySound(SND_LOSE); loseSoundPlayed = true;
+        }
+    }
+}
+
+// ---------------- TRANSITION STATE ----------------
+float fadeAlpha = 0.0f;
+bool isFadingOut = false;
+bool isFadingIn = false;
+
+// ---------------- PLAYER STATE ----------------
+float playerX = 2.0f;
+float playerZ = 2.0f;
+float playerY = 0.0f;
+float playerYaw = 0.0f;
+
+float velX = 0.0f, velZ = 0.0f;
+float velY = 0.0f;
+
+bool keyW = false, keyA = false, keyS = false, keyD = false;
+bool spaceTrigger = false;
+bool grounded = true;
+int jumpCount = 0;
+
+// ---------------- BROAD-PHASE GRID ----------------
+// Uniform grid of discs stored CSR-style: every disc is listed in each cell
+// its bounding square touches, so a query only walks the cells under its
+// own bounding square. Positions outside the grid clamp to the border cells
+// (discs and queries alike), which keeps off-island tests correct.
+
+struct GridDisc { float x, z, radius; int kind; };
+enum { OBSTACLE_TREE = 1, OBSTACLE_ROCK = 2, OBSTACLE_HOUSE = 4, OBSTACLE_ANY = 7, KEEPOUT_SPAWN = 8 };
+
+struct DiscGrid {
+    float minX, minZ, cellSize;
+    int cols, rows;
+    std::vector<int> cellStart;       // CSR offsets into discIndex, cols*rows+1 entries
+    std::vector<int> discIndex;
+    std::vector<GridDisc> discs;
+};
+
+static inline void DiscGridCellRange(const DiscGrid& g, float x, float z, float radius, int& c0, int& r0, int& c1, int& r1) {
+    c0 = (int)floorf((x - radius - g.minX) / g.cellSize); c1 = (int)floorf((x + radius - g.minX) / g.cellSize);
+    r0 = (int)floorf((z - radius - g.minZ) / g.cellSize); r1 = (int)floorf((z + radius - g.minZ) / g.cellSize);
+    c0 = c0 < 0 ? 0 : (c0 >= g.cols ? g.cols - 1 : c0);
+    c1 = c1 < 0 ? 0 : (c1 >= g.cols ? g.cols - 1 : c1);
+    r0 = r0 < 0 ? 0 : (r0 >= g.rows ? g.rows - 1 : r0);
+    r1 = r1 < 0 ? 0 : (r1 >= g.rows ? g.rows - 1 : r1);
+}
+
+static void BuildDiscGrid(DiscGrid& g, const std::vector<GridDisc>& discs, float minX, float minZ, float maxX, float maxZ, float cellSize) {
+    g.minX = minX; g.minZ = minZ; g.cellSize = cellSize;
+    g.cols = (int)ceilf((maxX - minX) / cellSize); if (g.cols < 1) g.cols = 1;
+    g.rows = (int)ceilf((maxZ - minZ) / cellSize); if (g.rows < 1) g.rows = 1;
+    g.discs = discs;
+    g.cellStart.assign(g.cols * g.rows + 1, 0);
+
+    // Two passes: count per cell, then fill
+    for (const auto& d : discs) {
+        int c0, r0, c1, r1; DiscGridCellRange(g, d.x, d.z, d.radius, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; ++r) for (int c = c0; c <= c1; ++c) g.cellStart[r * g.cols + c + 1]++;
+    }
+    for (int i = 0; i < g.cols * g.rows; ++i) g.cellStart[i + 1] += g.cellStart[i];
+    g.discIndex.resize(g.cellStart.back());
+    std::vector<int> fill(g.cellStart.begin(), g.cellStart.end() - 1);
+    for (int i = 0; i < (int)discs.size(); ++i) {
+        int c0, r0, c1, r1; DiscGridCellRange(g, discs[i].x, discs[i].z, discs[i].radius, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; ++r) for (int c = c0; c <= c1; ++c) g.discIndex[fill[r * g.cols + c]++] = i;
+    }
+}
+
+// True if a circle of the given radius overlaps any disc whose kind is in kindMask
+static bool DiscGridOverlaps(const DiscGrid& g, float x, float z, float radius, int kindMask) {
+    int c0, r0, c1, r1; DiscGridCellRange(g, x, z, radius, c0, r0, c1, r1);
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const int cell = r * g.cols + c;
+            for (int k = g.cellStart[cell]; k < g.cellStart[cell + 1]; ++k) {
+                const GridDisc& d = g.discs[g.discIndex[k]];
+                if (!(d.kind & kindMask)) continue;
+                float dx = x - d.x, dz = z - d.z, reach = radius + d.radius;
+                if ((dx * dx + dz * dz) < (reach * reach)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Level 1 obstacles, rebuilt on first use after InvalidateBroadPhase() or
+// when the obstacle lists change size under us.
+static DiscGrid g_obstacleGrid;
+static bool g_obstacleGridDirty = true;
+static size_t g_obstacleGridCounts[3] = { 0, 0, 0 };
+// Coins (Level 1) or gems (Level 2) for agent pickups, see UpdateAgents
+static bool g_pickupGridDirty = true;
+// Pendulum arc bounds and ground surfaces, see PENDULUM SWEEP / GROUND QUERIES
+static bool g_pendulumBoundsDirty = true;
+static bool g_groundDirty = true;
+
+unsigned int g_layoutVersion = 0;
+
+void InvalidateBroadPhase() {
+    g_obstacleGridDirty = true; g_pickupGridDirty = true;
+    g_pendulumBoundsDirty = true; g_groundDirty = true;
+    g_layoutVersion++;
+}
+
+static const DiscGrid& ObstacleGrid() {
+    if (g_obstacleGridDirty || g_obstacleGridCounts[0] != g_trees.size() || g_obstacleGridCounts[1] != g_rocks.size() || g_obstacleGridCounts[2] != g_houses.size()) {
+        std::vector<GridDisc> discs;
+        discs.reserve(g_trees.size() + g_rocks.size() + g_houses.size());
+        for (const auto& t : g_trees) discs.push_back(GridDisc{ t.x, t.z, TREE_RADIUS, OBSTACLE_TREE });
+        for (const auto& r : g_rocks) discs.push_back(GridDisc{ r.x, r.z, ROCK_RADIUS, OBSTACLE_ROCK });
+        for (const auto& h : g_houses) discs.push_back(GridDisc{ h.x, h.z, HOUSE_RADIUS, OBSTACLE_HOUSE });
+
+        // Aim for a couple of discs per cell, but never cells smaller than a tree
+        float cellSize = sqrtf(2.0f * LAND_SIZE * LAND_SIZE / (float)(discs.size() + 1));
+        if (cellSize < 2.0f * TREE_RADIUS) cellSize = 2.0f * TREE_RADIUS;
+        if (cellSize > 16.0f) cellSize = 16.0f;
+        BuildDiscGrid(g_obstacleGrid, discs, 0.0f, 0.0f, LAND_SIZE, LAND_SIZE, cellSize);
+
+        g_obstacleGridCounts[0] = g_trees.size(); g_obstacleGridCounts[1] = g_rocks.size(); g_obstacleGridCounts[2] = g_houses.size();
+        g_obstacleGridDirty = false;
+    }
+    return g_obstacleGrid;
+}
+
+// ---------------- GROUND QUERIES ----------------
+// Everything the player can stand on, as axis-aligned rectangles with a top
+// height, bucketed into a uniform grid per level:
+//   floors  - the Level 1 island and the Level 2 platforms. A body below a
+//             floor's top is pushed up onto it; no floor means water/void.
+//   ledges  - the Level 1 jump platforms. A falling body within
+//             [top - 0.5, top + 1] of a ledge lands on it.
+// Each grid is rebuilt on first use after InvalidateBroadPhase() or a change
+// in the Level 2 platform count.
+
+enum { SURFACE_FLOOR = 1, SURFACE_LEDGE = 2 };
+struct GroundSurface { float minX, minZ, maxX, maxZ, topY; int kind; };
+
+struct SurfaceGrid {
+    float minX, minZ, cellSize;
+    int cols, rows;
+    std::vector<int> cellStart;       // CSR offsets into surfaceIndex, cols*rows+1 entries
+    std::vector<int> surfaceIndex;
+    std::vector<GroundSurface> surfaces;
+    bool built = false;
+    size_t sourceCount = 0;
+};
+
+static SurfaceGrid g_groundLevel1, g_groundLevel2;
+
+static inline int SurfaceGridCol(const SurfaceGrid& g, float x) {
+    int c = (int)floorf((x - g.minX) / g.cellSize);
+    return c < 0 ? 0 : (c >= g.cols ? g.cols - 1 : c);
+}
+static inline int SurfaceGridRow(const SurfaceGrid& g, float z) {
+    int r = (int)floorf((z - g.minZ) / g.cellSize);
+    return r < 0 ? 0 : (r >= g.rows ? g.rows - 1 : r);
+}
+
+static void BuildSurfaceGrid(SurfaceGrid& g, const std::vector<GroundSurface>& surfaces) {
+    g.surfaces = surfaces;
+    float minX = 0.0f, minZ = 0.0f, maxX = 1.0f, maxZ = 1.0f;
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        const GroundSurface& s = surfaces[i];
+        if (i == 0 || s.minX < minX) minX = s.minX;
+        if (i == 0 || s.minZ < minZ) minZ = s.minZ;
+        if (i == 0 || s.maxX > maxX) maxX = s.maxX;
+        if (i == 0 || s.maxZ > maxZ) maxZ = s.maxZ;
+    }
+    // Roughly one cell per surface, at most 256 cells a side
+    float cellSize = sqrtf((maxX - minX) * (maxZ - minZ) / (float)(surfaces.size() + 1));
+    if (cellSize < 2.0f) cellSize = 2.0f;
+    if (cellSize < (maxX - minX) / 256.0f) cellSize = (maxX - minX) / 256.0f;
+    if (cellSize < (maxZ - minZ) / 256.0f) cellSize = (maxZ - minZ) / 256.0f;
+    g.minX = minX; g.minZ = minZ; g.cellSize = cellSize;
+    g.cols = (int)ceilf((maxX - minX) / cellSize); if (g.cols < 1) g.cols = 1;
+    g.rows = (int)ceilf((maxZ - minZ) / cellSize); if (g.rows < 1) g.rows = 1;
+    g.cellStart.assign(g.cols * g.rows + 1, 0);
+
+    // Two passes: count per cell, then fill
+    for (const auto& s : surfaces) {
+        for (int r = SurfaceGridRow(g, s.minZ); r <= SurfaceGridRow(g, s.maxZ); ++r)
+            for (int c = SurfaceGridCol(g, s.minX); c <= SurfaceGridCol(g, s.maxX); ++c) g.cellStart[r * g.cols + c + 1]++;
+    }
+    for (int i = 0; i < g.cols * g.rows; ++i) g.cellStart[i + 1] += g.cellStart[i];
+    g.surfaceIndex.resize(g.cellStart.back());
+    std::vector<int> fill(g.cellStart.begin(), g.cellStart.end() - 1);
+    for (int i = 0; i < (int)surfaces.size(); ++i) {
+        const GroundSurface& s = surfaces[i];
+        for (int r = SurfaceGridRow(g, s.minZ); r <= SurfaceGridRow(g, s.maxZ); ++r)
+            for (int c = SurfaceGridCol(g, s.minX); c <= SurfaceGridCol(g, s.maxX); ++c) g.surfaceIndex[fill[r * g.cols + c]++] = i;
+    }
+    g.built = true;
+}
+
+static const SurfaceGrid& GroundGrid(bool level2) {
+    if (g_groundDirty) { g_groundLevel1.built = false; g_groundLevel2.built = false; g_groundDirty = false; }
+    SurfaceGrid& g = level2 ? g_groundLevel2 : g_groundLevel1;
+    const size_t sourceCount = level2 ? lvl2_platforms.size() : (size_t)PLATFORM_COUNT;
+    if (g.built && g.sourceCount == sourceCount) return g;
+
+    std::vector<GroundSurface> surfaces;
+    if (level2) {
+        for (const auto& p : lvl2_platforms) {
+            const float hw = p.width / 2.0f, hl = p.length / 2.0f;
+            surfaces.push_back(GroundSurface{ p.x - hw, p.z - hl, p.x + hw, p.z + hl, p.y, SURFACE_FLOOR });
+        }
+    }
+    else {
+        surfaces.push_back(GroundSurface{ 0.0f, 0.0f, LAND_SIZE, LAND_SIZE, GROUND_Y, SURFACE_FLOOR });
+        for (int i = 0; i < PLATFORM_COUNT; ++i) {
+            const Platform& p = g_platforms[i];
+            surfaces.push_back(GroundSurface{ p.x - p.size, p.z - p.size, p.x + p.size, p.z + p.size, p.y, SURFACE_LEDGE });
+        }
+    }
+    BuildSurfaceGrid(g, surfaces);
+    g.sourceCount = sourceCount;
+    return g;
+}
+
+static inline bool SurfaceContains(const GroundSurface& s, float x, float z) {
+    return x >= s.minX && x <= s.maxX && z >= s.minZ && z <= s.maxZ;
+}
+
+// Highest floor top under (x, z) in grid g, or NO_GROUND
+static inline float FloorHeightIn(const SurfaceGrid& g, float x, float z) {
+    float best = NO_GROUND;
+    const int cell = SurfaceGridRow(g, z) * g.cols + SurfaceGridCol(g, x);
+    for (int k = g.cellStart[cell]; k < g.cellStart[cell + 1]; ++k) {
+        const GroundSurface& s = g.surfaces[g.surfaceIndex[k]];
+        if (s.kind == SURFACE_FLOOR && s.topY > best && SurfaceContains(s, x, z)) best = s.topY;
+    }
+    return best;
+}
+
+float FloorHeightAt(float x, float z) {
+    return FloorHeightIn(GroundGrid(gameState == LEVEL_2), x, z);
+}
+
+void FloorHeightsAt(const float* xs, const float* zs, float* heights, int count) {
+    const SurfaceGrid& g = GroundGrid(gameState == LEVEL_2);
+    for (int i = 0; i < count; ++i) heights[i] = FloorHeightIn(g, xs[i], zs[i]);
+}
+
+bool LedgeLandingAt(float x, float z, float y, float* topY) {
+    const SurfaceGrid& g = GroundGrid(gameState == LEVEL_2);
+    const int cell = SurfaceGridRow(g, z) * g.cols + SurfaceGridCol(g, x);
+    bool found = false;
+    for (int k = g.cellStart[cell]; k < g.cellStart[cell + 1]; ++k) {
+        const GroundSurface& s = g.surfaces[g.surfaceIndex[k]];
+        if (s.kind != SURFACE_LEDGE || !SurfaceContains(s, x, z)) continue;
+        if (y >= s.topY - 0.5f && y <= s.topY + 1.0f && (!found || s.topY > *topY)) { *topY = s.topY; found = true; }
+    }
+    return found;
+}
+
+// ---------------- HELPER FUNCTIONS & COLLISION ----------------
+
+static float frand(float minV, float maxV) { return minV + (maxV - minV) * (rand() / (float)RAND_MAX); }
+
+bool IsOnLevel2Platform(float x, float z) {
+    return FloorHeightIn(GroundGrid(true), x, z) != NO_GROUND;
+}
+
+bool IsOverLand(float x, float z) {
+    return FloorHeightIn(GroundGrid(gameState == LEVEL_2), x, z) != NO_GROUND;
+}
+
+bool CollidesWithTree(float x, float z, float radius) {
+    if (gameState != LEVEL_1) return false;
+    return DiscGridOverlaps(ObstacleGrid(), x, z, radius, OBSTACLE_TREE);
+}
+bool CollidesWithRock(float x, float z, float radius) {
+    if (gameState != LEVEL_1) return false;
+    return DiscGridOverlaps(ObstacleGrid(), x, z, radius, OBSTACLE_ROCK);
+}
+bool CollidesWithHouse(float x, float z, float radius) {
+    if (gameState != LEVEL_1) return false;
+    return DiscGridOverlaps(ObstacleGrid(), x, z, radius, OBSTACLE_HOUSE);
+}
+bool CollidesWithBoat(float x, float z, float radius) {
+    if (gameState != LEVEL_1 || !g_boat.placed) return false;
+    return ((pow(x - g_boat.x, 2) + pow(z - g_boat.z, 2)) < pow(radius + 4.0f, 2));
+}
+bool CollidesWithNPC(float x, float z, float radius) {
+    if (gameState != LEVEL_1 || !g_npc.placed) return false;
+    return ((pow(x - g_npc.x, 2) + pow(z - g_npc.z, 2)) < pow(radius + 1.0f, 2));
+}
+
+bool CollidesWithAnyObject(float x, float z, float radius) {
+    if (gameState != LEVEL_1) return false;
+    return DiscGridOverlaps(ObstacleGrid(), x, z, radius, OBSTACLE_ANY);
+}
+static inline bool CollidesWithNPCSilent(float x, float z, float radius) {
+    return CollidesWithNPC(x, z, radius);
+}
+static inline bool CollidesWithBoatSilent(float x, float z, float radius) {
+    return CollidesWithBoat(x, z, radius);
+}
+
+// ---------------- PENDULUM SWEEP ----------------
+// A pendulum's spike follows angle(t) = maxAngle * sin(speed * t) (t in
+// seconds of game clock), i.e. it stays on a known arc and moves no faster
+// than length * maxAngle * speed. Both facts are precomputed per pendulum:
+// the arc's bounding box rejects far-away queries without any trig, and the
+// speed bound drives conservative advancement for swept queries, which can
+// step straight to the next instant a hit is even possible instead of
+// sampling frames. Rebuilt on first use after InvalidateBroadPhase().
+
+static const float PENDULUM_HIT_RADIUS = 3.5f;   // Extended hitbox radius
+static const float PENDULUM_MIN_STEP = 1e-4f;    // seconds; grazing contacts resolve to this
+
+struct PendulumBounds {
+    float minX, minY, minZ, maxX, maxY, maxZ;    // swept arc, not yet padded by the hit radius
+    float maxRad;                                // swing amplitude in radians
+    float maxSpikeSpeed;                         // units/s
+};
+static std::vector<PendulumBounds> g_pendulumBounds;
+static float g_pendulumTime = 0.0f;              // game clock of the current tick, seconds
+
+static const std::vector<PendulumBounds>& PendulumBoundsList() {
+    if (g_pendulumBoundsDirty || g_pendulumBounds.size() != lvl2_pendulums.size()) {
+        g_pendulumBounds.resize(lvl2_pendulums.size());
+        for (size_t i = 0; i < lvl2_pendulums.size(); ++i) {
+            const Pendulum& p = lvl2_pendulums[i];
+            PendulumBounds& b = g_pendulumBounds[i];
+            b.maxRad = fabsf(p.maxAngle) * PI / 180.0f;
+            const float reach = p.length * sinf(fminf(b.maxRad, PI * 0.5f));
+            b.minY = p.pivotY - p.length; b.maxY = p.pivotY - p.length * cosf(fminf(b.maxRad, PI));
+            b.minX = b.maxX = p.pivotX; b.minZ = b.maxZ = p.pivotZ;
+            if (p.axisZ) { b.minX -= reach; b.maxX += reach; }
+            else { b.minZ -= reach; b.maxZ += reach; }
+            b.maxSpikeSpeed = p.length * b.maxRad * fabsf(p.speed);
+        }
+        g_pendulumBoundsDirty = false;
+    }
+    return g_pendulumBounds;
+}
+
+static inline void PendulumSpikeAt(const Pendulum& p, float t, float& sx, float& sy, float& sz) {
+    const float rad = p.maxAngle * sinf(t * p.speed) * PI / 180.0f;
+    sx = p.pivotX; sy = p.pivotY - p.length * cosf(rad); sz = p.pivotZ;
+    if (p.axisZ) sx += p.length * sinf(rad);
+    else sz += p.length * sinf(rad);
+}
+
+static inline bool BoxesOverlap(const PendulumBounds& b, float pad, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+    return minX <= b.maxX + pad && maxX >= b.minX - pad && minY <= b.maxY + pad && maxY >= b.minY - pad && minZ <= b.maxZ + pad && maxZ >= b.minZ - pad;
+}
+
+bool CollidesWithPendulum(float x, float z, float y, float radius) {
+    if (gameState != LEVEL_2) return false;
+    const std::vector<PendulumBounds>& bounds = PendulumBoundsList();
+    const float hitR = PENDULUM_HIT_RADIUS + radius;
+    for (size_t i = 0; i < lvl2_pendulums.size(); ++i) {
+        if (!BoxesOverlap(bounds[i], hitR, x, y + 1.0f, z, x, y + 1.0f, z)) continue;
+        const Pendulum& p = lvl2_pendulums[i];
+        float rad = p.currentAngle * PI / 180.0f;
+        float spikeX = p.pivotX;
+        float spikeY = p.pivotY - p.length * cos(rad);
+        float spikeZ = p.pivotZ;
+
+        if (p.axisZ) spikeX += p.length * sin(rad);
+        else spikeZ += p.length * sin(rad);
+
+        float dist = sqrt(pow(x - spikeX, 2) + pow(y + 1.0f - spikeY, 2) + pow(z - spikeZ, 2));
+        if (dist < hitR) return true;
+    }
+    return false;
+}
+
+bool PendulumEarliestHit(float t0, float t1, float x0, float y0, float z0, float x1, float y1, float z1, float radius, float* hitTime) {
+    if (gameState != LEVEL_2 || t1 < t0) return false;
+    const std::vector<PendulumBounds>& bounds = PendulumBoundsList();
+    const float hitR = PENDULUM_HIT_RADIUS + radius;
+    const float span = t1 - t0;
+    // Body reference point is 1 unit above its feet, as in CollidesWithPendulum
+    const float minX = fminf(x0, x1), maxX = fmaxf(x0, x1);
+    const float minY = fminf(y0, y1) + 1.0f, maxY = fmaxf(y0, y1) + 1.0f;
+    const float minZ = fminf(z0, z1), maxZ = fmaxf(z0, z1);
+    const float bodySpeed = (span > 0.0f) ? sqrtf((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0) + (z1 - z0) * (z1 - z0)) / span : 0.0f;
+
+    bool hit = false;
+    float best = t1;
+    for (size_t i = 0; i < lvl2_pendulums.size(); ++i) {
+        const PendulumBounds& b = bounds[i];
+        if (!BoxesOverlap(b, hitR, minX, minY, minZ, maxX, maxY, maxZ)) continue;
+        const Pendulum& p = lvl2_pendulums[i];
+        const float closing = b.maxSpikeSpeed + bodySpeed;
+
+        // Conservative advancement: the gap can't close faster than
+        // 'closing', so nothing can happen before t + gap / closing
+        float t = t0;
+        for (;;) {
+            const float u = (span > 0.0f) ? (t - t0) / span : 1.0f;
+            float sx, sy, sz; PendulumSpikeAt(p, t, sx, sy, sz);
+            const float dx = x0 + (x1 - x0) * u - sx;
+            const float dy = y0 + (y1 - y0) * u + 1.0f - sy;
+            const float dz = z0 + (z1 - z0) * u - sz;
+            const float gap = sqrtf(dx * dx + dy * dy + dz * dz) - hitR;
+            if (gap < 0.0f) {
+                if (!hit || t < best) best = t;
+                hit = true;
+                break;
+            }
+            if (t >= t1 || (hit && t >= best) || closing <= 0.0f) break;
+            float step = gap / closing;
+            if (step < PENDULUM_MIN_STEP) step = PENDULUM_MIN_STEP;
+            t = (t + step < t1) ? t + step : t1;
+        }
+    }
+    if (hit && hitTime) *hitTime = best;
+    return hit;
+}
+
+// ---------------- LEVEL 1 PLACEMENT FUNCTIONS ----------------
+
+void PlaceBoatAtEdge() {
+    g_boat.x = LAND_SIZE / 2.0f;
+    g_boat.z = LAND_SIZE - 5.0f;
+    g_boat.y = GROUND_Y + 0.5f;
+    g_boat.yawDeg = 180.0f;
+    g_boat.scale = 1.0f;
+    g_boat.placed = true;
+}
+void placeTreasurePiles() {
+    DestroyIf<Renderable>(g_level1Entities, [](Entity, const Renderable& r) { return r.kind == RENDER_TREASURE; });
+    CreateEntity(g_level1Entities, Transform{ 150.0f, 0.0f, 150.0f, 45.0f, 0.05f }, Renderable{ RENDER_TREASURE });
+}
+
+bool InStreetZone(float x, float z) {
+    const float centerX = WORLD_SIZE * 0.5f;
+    const float centerZ = WORLD_SIZE * 0.5f;
+    const float halfX = (16.0f * 0.5f) + 12.0f + 6.0f;
+    const float halfZ = (6.0f * 2.0f) + 3.0f;
+    return (x >= (centerX - halfX) && x <= (centerX + halfX) && z >= (centerZ - halfZ) && z <= (centerZ + halfZ));
+}
+
+void PlacePirateMapInRoad() {
+    const float centerX = (WORLD_SIZE * 0.5f) - 12.0f;
+    const float centerZ = (WORLD_SIZE * 0.5f) + 12.0f;
+    DestroyPickups(g_level1Entities, PICKUP_MAP);
+    CreateEntity(g_level1Entities, Transform{ centerX, 20.8f, centerZ, 0.0f, 0.1f }, Spin{ 60.0f }, Pickup{ PICKUP_MAP, 2.0f }, Renderable{ RENDER_MAP });
+}
+
+void PlaceTreesRandom(int count) {
+    g_trees.clear();
+    InvalidateBroadPhase();
+    std::vector<TreeInstance> fixedTrees = {
+        {20.0f, 0.0f, 20.0f, 45.0f, 0.40f}, {280.0f, 0.0f, 20.0f, 90.0f, 0.40f},
+        {20.0f, 0.0f, 280.0f, 135.0f, 0.40f}, {280.0f, 0.0f, 280.0f, 180.0f, 0.40f},
+        {35.0f, 0.0f, 45.0f, 225.0f, 0.40f}, {65.0f, 0.0f, 30.0f, 270.0f, 0.40f},
+        {50.0f, 0.0f, 75.0f, 315.0f, 0.40f}, {235.0f, 0.0f, 45.0f, 0.0f, 0.40f},
+        {265.0f, 0.0f, 30.0f, 45.0f, 0.40f}, {250.0f, 0.0f, 75.0f, 90.0f, 0.40f},
+        {35.0f, 0.0f, 255.0f, 135.0f, 0.40f}, {65.0f, 0.0f, 270.0f, 180.0f, 0.40f},
+        {50.0f, 0.0f, 225.0f, 225.0f, 0.40f}, {235.0f, 0.0f, 255.0f, 270.0f, 0.40f},
+        {265.0f, 0.0f, 270.0f, 315.0f, 0.40f}, {250.0f, 0.0f, 225.0f, 0.0f, 0.40f},
+        {30.0f, 0.0f, 100.0f, 45.0f, 0.40f}, {40.0f, 0.0f, 150.0f, 90.0f, 0.40f},
+        {30.0f, 0.0f, 200.0f, 135.0f, 0.40f}, {270.0f, 0.0f, 100.0f, 180.0f, 0.40f},
+        {260.0f, 0.0f, 150.0f, 225.0f, 0.40f}, {270.0f, 0.0f, 200.0f, 270.0f, 0.40f},
+        {80.0f, 0.0f, 25.0f, 315.0f, 0.40f}, {120.0f, 0.0f, 35.0f, 0.0f, 0.40f},
+        {160.0f, 0.0f, 30.0f, 45.0f, 0.40f}, {200.0f, 0.0f, 25.0f, 90.0f, 0.40f},
+        {220.0f, 0.0f, 40.0f, 135.0f, 0.40f}, {80.0f, 0.0f, 275.0f, 180.0f, 0.40f},
+        {120.0f, 0.0f, 285.0f, 225.0f, 0.40f}, {160.0f, 0.0f, 280.0f, 270.0f, 0.40f},
+        {200.0f, 0.0f, 275.0f, 315.0f, 0.40f}, {220.0f, 0.0f, 290.0f, 0.0f, 0.40f},
+        {90.0f, 0.0f, 90.0f, 45.0f, 0.40f}, {210.0f, 0.0f, 90.0f, 90.0f, 0.40f},
+        {90.0f, 0.0f, 210.0f, 135.0f, 0.40f}, {210.0f, 0.0f, 210.0f, 180.0f, 0.40f},
+        {75.0f, 0.0f, 130.0f, 225.0f, 0.40f}, {225.0f, 0.0f, 130.0f, 270.0f, 0.40f},
+        {75.0f, 0.0f, 170.0f, 315.0f, 0.40f}, {225.0f, 0.0f, 170.0f, 0.0f, 0.40f},
+        {110.0f, 0.0f, 60.0f, 45.0f, 0.40f}, {190.0f, 0.0f, 60.0f, 90.0f, 0.40f},
+        {110.0f, 0.0f, 240.0f, 135.0f, 0.40f}, {190.0f, 0.0f, 240.0f, 180.0f, 0.40f},
+        {140.0f, 0.0f, 100.0f, 225.0f, 0.40f}, {160.0f, 0.0f, 200.0f, 270.0f, 0.40f},
+        {55.0f, 0.0f, 110.0f, 315.0f, 0.40f}, {245.0f, 0.0f, 110.0f, 0.0f, 0.40f},
+        {55.0f, 0.0f, 190.0f, 45.0f, 0.40f}, {245.0f, 0.0f, 190.0f, 90.0f, 0.40f}
+    };
+    for (size_t i = 0; i < fixedTrees.size() && i < (size_t)count; ++i) { g_trees.push_back(fixedTrees[i]); }
+}
+
+// ---------------- POISSON-DISK PLACEMENT ----------------
+// Blue-noise sampler used to scatter pickups. Spacing between samples is
+// enforced through a background grid with cells of spacing/sqrt(2), so each
+// sample owns at most one cell and a spacing test touches a 5x5 block.
+// Keep-out discs (obstacles, spawn) are bucketed into a DiscGrid.
+
+struct PlacementPoint { float x, z; };
+// Spacing grid for the Poisson-disk sampler; cell[i] is the index of the
+// point inside that cell or -1.
+struct PoissonGrid {
+    float minX, minZ, maxX, maxZ, spacing, cellSize;
+    int cols, rows;
+    std::vector<int> cells;
+    std::vector<PlacementPoint> points;
+};
+
+static void InitPoissonGrid(PoissonGrid& g, float minX, float minZ, float maxX, float maxZ, float spacing) {
+    g.minX = minX; g.minZ = minZ; g.maxX = maxX; g.maxZ = maxZ;
+    g.spacing = spacing; g.cellSize = spacing / sqrtf(2.0f);
+    g.cols = (int)ceilf((maxX - minX) / g.cellSize); if (g.cols < 1) g.cols = 1;
+    g.rows = (int)ceilf((maxZ - minZ) / g.cellSize); if (g.rows < 1) g.rows = 1;
+    g.cells.assign(g.cols * g.rows, -1);
+    g.points.clear();
+}
+
+static inline int PoissonCell(const PoissonGrid& g, float x, float z) {
+    int c = (int)((x - g.minX) / g.cellSize), r = (int)((z - g.minZ) / g.cellSize);
+    if (c >= g.cols) c = g.cols - 1;
+    if (r >= g.rows) r = g.rows - 1;
+    return r * g.cols + c;
+}
+
+// True if (x, z) is inside the domain and at least spacing from every point
+static bool PoissonFits(const PoissonGrid& g, float x, float z) {
+    if (x < g.minX || x > g.maxX || z < g.minZ || z > g.maxZ) return false;
+    const int cell = PoissonCell(g, x, z);
+    const int c = cell % g.cols, r = cell / g.cols;
+    const int c0 = c - 2 < 0 ? 0 : c - 2, c1 = c + 2 >= g.cols ? g.cols - 1 : c + 2;
+    const int r0 = r - 2 < 0 ? 0 : r - 2, r1 = r + 2 >= g.rows ? g.rows - 1 : r + 2;
+    const float spacing2 = g.spacing * g.spacing;
+    for (int rr = r0; rr <= r1; ++rr) {
+        for (int cc = c0; cc <= c1; ++cc) {
+            int s = g.cells[rr * g.cols + cc];
+            if (s < 0) continue;
+            float dx = x - g.points[s].x, dz = z - g.points[s].z;
+            if ((dx * dx + dz * dz) < spacing2) return false;
+        }
+    }
+    return true;
+}
+
+static void PoissonInsert(PoissonGrid& g, float x, float z) {
+    g.cells[PoissonCell(g, x, z)] = (int)g.points.size();
+    g.points.push_back(PlacementPoint{ x, z });
+}
+
+// Grows the grid's point set until it is maximal: no further point that
+// satisfies accept(x, z) fits anywhere. Growth is seeded from every empty
+// cell (in random order), so regions cut off from each other by keep-out
+// zones are still covered.
+template <typename Accept>
+static void PoissonFill(PoissonGrid& g, Accept accept) {
+    const int candidatesPerSample = 30;
+    std::vector<int> active;
+    auto tryInsert = [&](float x, float z) -> bool {
+        if (!PoissonFits(g, x, z) || !accept(x, z)) return false;
+        active.push_back((int)g.points.size());
+        PoissonInsert(g, x, z);
+        return true;
+    };
+
+    // Visit cells in random order so the first seeds aren't biased to a corner
+    std::vector<int> order(g.cols * g.rows);
+    for (int i = 0; i < (int)order.size(); ++i) order[i] = i;
+    for (int i = (int)order.size() - 1; i > 0; --i) { int j = (int)frand(0.0f, (float)i + 0.999f); int tmp = order[i]; order[i] = order[j]; order[j] = tmp; }
+
+    for (int cell : order) {
+        if (g.cells[cell] >= 0) continue;
+        const float cx = g.minX + (cell % g.cols) * g.cellSize, cz = g.minZ + (cell / g.cols) * g.cellSize;
+        for (int t = 0; t < 4 && g.cells[cell] < 0; ++t) tryInsert(frand(cx, cx + g.cellSize), frand(cz, cz + g.cellSize));
+
+        // Grow outwards from whatever is active (Bridson)
+        while (!active.empty()) {
+            int a = (int)frand(0.0f, (float)active.size() - 0.001f);
+            const PlacementPoint p = g.points[active[a]];
+            bool grown = false;
+            for (int t = 0; t < candidatesPerSample && !grown; ++t) {
+                float ang = frand(0.0f, 2.0f * PI);
+                float dist = g.spacing * sqrtf(frand(1.0f, 4.0f)); // uniform by area in [r, 2r]
+                grown = tryInsert(p.x + dist * cosf(ang), p.z + dist * sinf(ang));
+            }
+            if (!grown) { active[a] = active.back(); active.pop_back(); }
+        }
+    }
+}
+
+// Places up to count points at least spacing apart that satisfy accept.
+// Points are dart-thrown against the spacing grid while that is cheap; once
+// darts keep missing (the domain is filling up) the remaining space is
+// filled with a maximal Poisson-disk set and the rest are drawn from it
+// uniformly, so the result never violates spacing and never falls back to a
+// clamped position. Fewer than count points are returned only if no more fit.
+template <typename Accept>
+static void PoissonDiskSample(float minX, float minZ, float maxX, float maxZ, float spacing, int count, Accept accept, std::vector<PlacementPoint>& out) {
+    PoissonGrid g;
+    InitPoissonGrid(g, minX, minZ, maxX, maxZ, spacing);
+    const int maxMisses = 64;
+    int misses = 0;
+    while ((int)g.points.size() < count && misses < maxMisses) {
+        float x = frand(minX, maxX), z = frand(minZ, maxZ);
+        if (PoissonFits(g, x, z) && accept(x, z)) { PoissonInsert(g, x, z); misses = 0; }
+        else misses++;
+    }
+
+    if ((int)g.points.size() < count) {
+        const int placed = (int)g.points.size();
+        PoissonFill(g, accept);
+        // Any subset of a Poisson-disk set keeps its spacing, so draw the
+        // missing points uniformly from the newly grown ones
+        const int needed = count - placed;
+        const int available = (int)g.points.size() - placed;
+        const int take = needed < available ? needed : available;
+        for (int i = 0; i < take; ++i) {
+            int j = placed + i + (int)frand(0.0f, (float)(available - i) - 0.001f);
+            PlacementPoint tmp = g.points[placed + i]; g.points[placed + i] = g.points[j]; g.points[j] = tmp;
+        }
+        g.points.resize(placed + take);
+    }
+    out.swap(g.points);
+}
+
+void PlaceCoinsRandom(int count) {
+    DestroyPickups(g_level1Entities, PICKUP_COIN);
+    InvalidateBroadPhase();
+    const float minDistFromObjects = 2.0f;
+    const float minDistBetweenCoins = 3.0f;
+    const float edge = 2.0f;
+
+    // Keep-out: obstacle collision radii plus a margin, and the player spawn
+    std::vector<GridDisc> discs;
+    discs.reserve(g_trees.size() + g_rocks.size() + g_houses.size() + 1);
+    for (const auto& t : g_trees) discs.push_back(GridDisc{ t.x, t.z, TREE_RADIUS + minDistFromObjects, OBSTACLE_TREE });
+    for (const auto& r : g_rocks) discs.push_back(GridDisc{ r.x, r.z, ROCK_RADIUS + minDistFromObjects, OBSTACLE_ROCK });
+    for (const auto& h : g_houses) discs.push_back(GridDisc{ h.x, h.z, HOUSE_RADIUS + minDistFromObjects, OBSTACLE_HOUSE });
+    discs.push_back(GridDisc{ playerX, playerZ, minDistFromObjects, KEEPOUT_SPAWN });
+    DiscGrid keepOut;
+    BuildDiscGrid(keepOut, discs, 0.0f, 0.0f, LAND_SIZE, LAND_SIZE, 8.0f);
+
+    std::vector<PlacementPoint> points;
+    PoissonDiskSample(edge, edge, LAND_SIZE - edge, LAND_SIZE - edge, minDistBetweenCoins, count,
+        [&](float x, float z) { return IsOverLand(x, z) && !InStreetZone(x, z) && !DiscGridOverlaps(keepOut, x, z, 0.0f, OBSTACLE_ANY | KEEPOUT_SPAWN); },
+        points);
+
+    for (const auto& p : points) SpawnCoin(p.x, p.z);
+}
+
+void PlaceHousesStreet() {
+    g_houses.clear();
+    InvalidateBroadPhase();
+    const float centerX = WORLD_SIZE * 0.5f; const float centerZ = WORLD_SIZE * 0.5f;
+    const float roadWidth = 16.0f; const float houseOffsetX = 12.0f; const float houseSpacingZ = 6.0f;
+    const float rowLeftX = centerX - (roadWidth * 0.5f) - houseOffsetX;
+    const float rowRightX = centerX + (roadWidth * 0.5f) + houseOffsetX;
+    const float startZ = centerZ - (houseSpacingZ * 2.0f);
+    const float y = -0.2f;
+    const float yaw = 0.0f;
+    for (int i = 0; i < 5; ++i) {
+        float z = startZ + i * houseSpacingZ;
+        g_houses.push_back(HouseInstance{ rowLeftX, y, z, yaw, 0.01f });
+        g_houses.push_back(HouseInstance{ rowRightX, y, z, yaw, 0.01f });
+    }
+}
+
+void PlaceRocksRandom(int countPerModel) {
+    g_rocks.clear();
+    InvalidateBroadPhase();
+    std::vector<RockInstance> fixedRocks = {
+        {25.0f, 0.0f, 35.0f, 30.0f, 0.01f, 0}, {275.0f, 0.0f, 35.0f, 60.0f, 0.01f, 1},
+        {25.0f, 0.0f, 265.0f, 90.0f, 0.01f, 2}, {275.0f, 0.0f, 265.0f, 120.0f, 0.01f, 3},
+        {70.0f, 0.0f, 25.0f, 150.0f, 0.01f, 4}, {150.0f, 0.0f, 30.0f, 180.0f, 0.01f, 0},
+        {230.0f, 0.0f, 25.0f, 210.0f, 0.01f, 1}, {70.0f, 0.0f, 275.0f, 240.0f, 0.01f, 2},
+        {150.0f, 0.0f, 280.0f, 270.0f, 0.01f, 3}, {230.0f, 0.0f, 275.0f, 300.0f, 0.01f, 4},
+        {25.0f, 0.0f, 100.0f, 330.0f, 0.01f, 0}, {30.0f, 0.0f, 180.0f, 0.0f, 0.01f, 1},
+        {275.0f, 0.0f, 100.0f, 30.0f, 0.01f, 2}, {280.0f, 0.0f, 180.0f, 60.0f, 0.01f, 3},
+        {85.0f, 0.0f, 80.0f, 90.0f, 0.01f, 4}, {215.0f, 0.0f, 80.0f, 120.0f, 0.01f, 0},
+        {85.0f, 0.0f, 220.0f, 150.0f, 0.01f, 1}, {215.0f, 0.0f, 220.0f, 180.0f, 0.01f, 2},
+        {100.0f, 0.0f, 120.0f, 210.0f, 0.01f, 3}, {200.0f, 0.0f, 120.0f, 240.0f, 0.01f, 4},
+        {100.0f, 0.0f, 180.0f, 270.0f, 0.01f, 0}, {200.0f, 0.0f, 180.0f, 300.0f, 0.01f, 1},
+        {50.0f, 0.0f, 140.0f, 330.0f, 0.01f, 2}, {250.0f, 0.0f, 140.0f, 0.0f, 0.01f, 3},
+        {50.0f, 0.0f, 160.0f, 30.0f, 0.01f, 4}, {250.0f, 0.0f, 160.0f, 60.0f, 0.01f, 0},
+        {120.0f, 0.0f, 55.0f, 90.0f, 0.01f, 1}, {180.0f, 0.0f, 55.0f, 120.0f, 0.01f, 2},
+        {120.0f, 0.0f, 245.0f, 150.0f, 0.01f, 3}, {180.0f, 0.0f, 245.0f, 180.0f, 0.01f, 4}
+    };
+    int perModel[5] = { 0 };
+    for (const auto& rock : fixedRocks) {
+        if (perModel[rock.modelIndex]++ < countPerModel) g_rocks.push_back(rock);
+    }
+}
+
+// ---------------- LEVEL 2 PLACEMENT FUNCTION ----------------
+
+void InitLevel2() {
+    lvl2_platforms.clear();
+    lvl2_pendulums.clear();
+
+    // 1. STARTING PLATFORM (Center at 0, 0)
+    lvl2_platforms.push_back({ 0.0f, 0.0f, 15.0f, 15.0f, 0.0f });
+
+    // 2. THE SPIKE CORRIDOR (Straight path with swings)
+    lvl2_platforms.push_back({ 0.0f, 40.0f, 8.0f, 60.0f, 0.0f });
+
+    // Swings (Side-to-Side)
+    lvl2_pendulums.push_back({ 0.0f, 15.0f, 20.0f, 12.0f, 0.0f, 60.0f, 3.0f, true });
+    lvl2_pendulums.push_back({ 0.0f, 15.0f, 40.0f, 12.0f, 0.0f, 60.0f, 4.0f, true });
+    lvl2_pendulums.push_back({ 0.0f, 15.0f, 60.0f, 12.0f, 0.0f, 60.0f, 2.5f, true });
+
+    // 3. THE SPLIT (Safe platform)
+    lvl2_platforms.push_back({ 0.0f, 80.0f, 20.0f, 15.0f, 0.0f });
+
+    // 4. THE KEY PATH (Side Platform)
+    lvl2_platforms.push_back({ 25.0f, 80.0f, 25.0f, 8.0f, 0.0f }); // Bridge to right
+    lvl2_platforms.push_back({ 40.0f, 80.0f, 15.0f, 15.0f, 0.0f }); // Key Platform
+
+    // Key on its platform; the gems follow below
+    ClearEntities(g_level2Entities);
+    CreateEntity(g_level2Entities, Transform{ 40.0f, 2.0f, 80.0f, 0.0f, 1.0f }, Spin{ 90.0f }, Pickup{ PICKUP_KEY, 2.0f }, Renderable{ RENDER_KEY });
+
+    // 5. THE FINAL GAUNTLET (To Chest)
+    lvl2_platforms.push_back({ 0.0f, 110.0f, 8.0f, 40.0f, 0.0f });
+
+    // More Pendulums (Slightly slower for last two)
+    lvl2_pendulums.push_back({ 0.0f, 15.0f, 100.0f, 12.0f, 0.0f, 70.0f, 3.5f, true });
+    lvl2_pendulums.push_back({ 0.0f, 15.0f, 120.0f, 12.0f, 0.0f, 70.0f, 3.5f, true });
+
+    // 6. CHEST PLATFORM
+    lvl2_platforms.push_back({ 0.0f, 135.0f, 20.0f, 10.0f, 1.0f });
+    lvl2_chest.x = 0.0f; lvl2_chest.y = 2.0f; lvl2_chest.z = 135.0f;
+
+    // --- PLACE 10 GEMS (2 per platform on the first 5 platforms) ---
+    InvalidateBroadPhase();
+    const int platformsForGems = 5; // first 5 platforms
+    const float margin = 1.0f;
+    int placed = 0;
+    for (int i = 0; i < (int)lvl2_platforms.size() && i < platformsForGems; ++i) {
+        const auto& p = lvl2_platforms[i];
+        float hw = p.width * 0.5f - margin;
+        // Two positions per platform: left/right along X, centered on Z
+        float gx1 = p.x - hw * 0.5f;
+        float gz1 = p.z;
+        float gx2 = p.x + hw * 0.5f;
+        float gz2 = p.z;
+        CreateEntity(g_level2Entities, Transform{ gx1, p.y + 1.0f, gz1, 0.0f, 1.2f }, Spin{ 90.0f }, Pickup{ PICKUP_GEM, 2.0f }, Renderable{ RENDER_GEM }); placed++;
+        CreateEntity(g_level2Entities, Transform{ gx2, p.y + 1.0f, gz2, 0.0f, 1.2f }, Spin{ 90.0f }, Pickup{ PICKUP_GEM, 2.0f }, Renderable{ RENDER_GEM }); placed++;
+        if (placed >= 10) break;
+    }
+}
+
+// ---------------- LOGIC UPDATES ----------------
+
+// Reset player state for Level 2 transition/death
+void ResetPlayerLvl2() {
+    playerX = 0.0f;
+    playerZ = 0.0f;
+    playerY = 0.0f;
+    velX = 0; velZ = 0; velY = 0;
+    jumpCount = 0; grounded = true;
+}
+
+// --- RESTORED MOMENTUM PHYSICS UPDATE ---
+void UpdateMovement(float dt) {
+    if (isFadingOut) return;
+    const float startX = playerX, startY = playerY, startZ = playerZ;
+    bool respawned = false;
+
+    // 1. Calculate Input Direction
+    float inputX = 0.0f, inputZ = 0.0f;
+    const float yawRad = playerYaw * PI / 180.0f;
+    const float fx = sinf(yawRad);
+    const float fz = cosf(yawRad);
+    const float lx = -fz;
+    const float lz = fx;
+
+    // Accumulate input
+    if (keyW) { inputX -= fx; inputZ -= fz; }
+    if (keyS) { inputX += fx; inputZ += fz; }
+    if (keyA) { inputX += lx; inputZ += lz; }
+    if (keyD) { inputX -= lx; inputZ -= lz; }
+
+    // Normalize input
+    float inputLen = sqrt(inputX * inputX + inputZ * inputZ);
+    if (inputLen > 0.001f) {
+        inputX /= inputLen;
+        inputZ /= inputLen;
+
+        // Apply ACCELERATION
+        velX += inputX * accel * dt;
+        velZ += inputZ * accel * dt;
+    }
+    else {
+        // Apply FRICTION
+        float currentSpeed = sqrt(velX * velX + velZ * velZ);
+        if (currentSpeed > 0.001f) {
+            float frictionToUse = grounded ? frictionGround : frictionAir;
+            float drop = frictionToUse * dt;
+            float newSpeed = currentSpeed - drop;
+            if (newSpeed < 0) newSpeed = 0;
+
+            velX *= (newSpeed / currentSpeed);
+            velZ *= (newSpeed / currentSpeed);
+        }
+        else {
+            velX = 0;
+            velZ = 0;
+        }
+    }
+
+    // Cap velocity
+    float currentSpeed = sqrt(velX * velX + velZ * velZ);
+    if (currentSpeed > maxSpeed) {
+        velX *= (maxSpeed / currentSpeed);
+        velZ *= (maxSpeed / currentSpeed);
+    }
+
+    // 2. Calculate Move Amount
+    float moveX = velX * dt;
+    float moveZ = velZ * dt;
+
+    // 3. Collision Logic
+    bool hitObstacle = false;
+    CountAdd(CTR_COLLISION_QUERIES, 2);
+
+    // Check X axis
+    float testX = playerX + moveX;
+    bool hitWallX = (gameState == LEVEL_1) && (testX < 0.0f || testX > LAND_SIZE);
+    bool hitNPC_X = CollidesWithNPCSilent(testX, playerZ, 0.0f) || CollidesWithBoatSilent(testX, playerZ, 0.0f);
+
+    if (CollidesWithAnyObject(testX, playerZ, 0.0f) || hitNPC_X || hitWallX) {
+        velX = 0; // Stop momentum on collision
+        if (hitWallX) {
+            if (testX < 0.0f) playerX = 0.0f;
+            if (testX > LAND_SIZE) playerX = LAND_SIZE;
+        }
+        else if (!hitNPC_X) {
+            hitObstacle = true;
+        }
+    }
+    else { playerX = testX; }
+
+    // Check Z axis
+    float testZ = playerZ + moveZ;
+    bool hitWallZ = (gameState == LEVEL_1) && (testZ < 0.0f || testZ > LAND_SIZE);
+    bool hitNPC_Z = CollidesWithNPCSilent(playerX, testZ, 0.0f) || CollidesWithBoatSilent(playerX, testZ, 0.0f);
+
+    if (CollidesWithAnyObject(playerX, testZ, 0.0f) || hitNPC_Z || hitWallZ) {
+        velZ = 0; // Stop momentum on collision
+        if (hitWallZ) {
+            if (testZ < 0.0f) playerZ = 0.0f;
+            if (testZ > LAND_SIZE) playerZ = LAND_SIZE;
+        }
+        else if (!hitNPC_Z) {
+            hitObstacle = true;
+        }
+    }
+    else { playerZ = testZ; }
+
+    if (hitObstacle) {
+        int currentTime = Game_ElapsedMs();
+        if (currentTime - lastCollisionTime > COLLISION_SOUND_COOLDOWN) {
+            Game_PlaySound(SND_COLLISION);
+            Game_PlaySound(SND_OOF);
+            lastCollisionTime = currentTime;
+        }
+    }
+
+    // Vertical movement
+    velY -= gravity * dt;
+    if (velY < maxFallSpeed) velY = maxFallSpeed;
+
+    if (spaceTrigger && jumpCount < 2) {
+        velY = jumpImpulse; grounded = false; jumpCount++; spaceTrigger = false; Game_PlaySound(SND_JUMP);
+    }
+
+    playerY += velY * dt;
+
+    // Ground/Water/Platform Landing
+    const float floorY = FloorHeightAt(playerX, playerZ);
+    if (floorY != NO_GROUND) {
+        if (playerY < floorY) { playerY = floorY; velY = 0.0f; grounded = true; jumpCount = 0; }
+    }
+    else if (playerY < GROUND_Y) {
+        grounded = false; velY = (velY > -5.0f) ? velY : -5.0f;
+
+        // --- FIX FOR LEVEL 2 VOID DEATH ---
+        if (gameState == LEVEL_2 && playerY < -20.0f) {
+            HandlePlayerDeath(); // LOSE A HEART!
+            if (lives > 0) ResetPlayerLvl2(); // Only respawn if alive
+            respawned = true;
+        }
+    }
+
+    // Level 1 Platforms Landing
+    float ledgeY;
+    if (velY <= 0.0f && LedgeLandingAt(playerX, playerZ, playerY, &ledgeY)) {
+        playerY = ledgeY; velY = 0.0f; grounded = true; jumpCount = 0;
+    }
+
+    // Level 2 Collision (swept over the whole tick so fast swings can't skip the player)
+    if (gameState == LEVEL_2 && !respawned &&
+        PendulumEarliestHit(g_pendulumTime - dt, g_pendulumTime, startX, startY, startZ, playerX, playerY, playerZ, 0.0f, nullptr)) {
+        // --- FIX FOR LEVEL 2 LIVES ---
+        HandlePlayerDeath(); // LOSE A HEART!
+        if (lives > 0) ResetPlayerLvl2(); // Only respawn if alive
+    }
+}
+
+void StartNewRun() {
+    gameState = LEVEL_1; // Start Level 1
+    // Reset player to Level 1 start pos
+    playerX = 2.0f; playerZ = 2.0f; playerY = 0.0f;
+    // Reset game state for new run
+    score = 1000; // Start at 1000 on new game
+    coinsCollected = 0;
+    gameTimer = 0.0f;
+    lives = 5; // START WITH 5 HEARTS
+    showNPCDialogue = false; showBoatDialogue = false; showBoatDialogue2 = false; showBoatInsufficient = false;
+
+    // --- UPDATED: Ensure Level 1 music starts ---
+    Game_PlayMusic(SND_MUSIC1, MUSIC_CROSSFADE_MS); // Crossfades from level 2 if it was playing
+}
+
+void Interact() {
+    if (gameState != LEVEL_1) return;
+    if (showInteractPrompt) {
+        Game_PlaySound(SND_NPC_INTERACT); showNPCDialogue = true; dialogueTimer = 0.0f;
+    }
+    else if (showBoatPrompt) {
+        Game_PlaySound(SND_BOAT_INTERACT);
+        if (coinsCollected >= BOAT_COST) {
+            if (hasMap) {
+                coinsCollected -= BOAT_COST; paidForBoat = true; isFadingOut = true;
+                Game_StopMusic(FADE_MS);   // out with the picture
+                showBoatDialogue = true; boatDialogueTimer = 0.0f; Game_PlaySound(SND_COIN_PICKUP);
+            }
+            else {
+                showBoatDialogue2 = true; boatDialogueTimer = 0.0f;
+            }
+        }
+        else {
+            showBoatInsufficient = true; boatDialogueTimer = 0.0f;
+        }
+    }
+}
+
+void CheckGameLogic() {
+    // Coins and the map (Level 1), gems and the key (Level 2)
+    TakePickups(LevelEntities());
+
+    if (gameState == LEVEL_1) {
+        // NPC Interaction Check
+        showInteractPrompt = (g_npc.placed && sqrt(pow(playerX - g_npc.x, 2) + pow(playerZ - g_npc.z, 2)) < NPC_INTERACT_DISTANCE);
+
+        // Boat Interaction Check
+        showBoatPrompt = (g_boat.placed && sqrt(pow(playerX - g_boat.x, 2) + pow(playerZ - g_boat.z, 2)) < BOAT_INTERACT_DISTANCE);
+    }
+    else if (gameState == LEVEL_2) {
+        // Open Chest (Level 2 WIN)
+        float d = sqrt(pow(playerX - lvl2_chest.x, 2) + pow(playerZ - lvl2_chest.z, 2));
+        if (d < 3.0f && hasLvl2Key) {
+            gameState = WIN;
+            // --- UPDATED: Stop music on win ---
+            Game_StopMusic(MUSIC_STOP_FADE_MS);
+            if (!winSoundPlayed) { Game_PlaySound(SND_WIN); winSoundPlayed = true; }
+        }
+    }
+}
+
+
+// ---------------- CROWD AGENTS ----------------
+// N-agent version of UpdateMovement + the pickup half of CheckGameLogic.
+// Each step runs in two phases:
+//   1. parallel over batches of AGENT_BATCH agents: move and collide every
+//      agent against the static world (broad-phase: obstacle grid cell,
+//      narrow-phase: disc tests), then look up the pickups under it and
+//      record a claim in the batch's own list. Nothing shared is written.
+//   2. serial: walk the claim lists in batch order and hand each pickup to
+//      its first claimant, i.e. the lowest agent index, then destroy the
+//      pickups that went.
+// Phase 1 only reads shared state and phase 2 doesn't depend on which
+// thread ran what, so the outcome is identical for any thread count.
+
+std::vector<Agent> g_agents;
+
+static const int AGENT_BATCH = 256;
+static const float AGENT_PICKUP_DIST = 2.0f;
+
+struct PickupClaim { int item; int agent; };
+static std::vector<std::vector<PickupClaim>> g_batchClaims;
+
+// The current level's pickups agents may take (PickupRule::agents), as the
+// grid was built from them; claims index into this
+struct AgentPickup { float x, z; Entity entity; };
+static std::vector<AgentPickup> g_agentPickups;
+static std::vector<char> g_agentPickupTaken;
+static DiscGrid g_pickupGrid;
+static const EntityWorld* g_pickupGridWorld = nullptr;
+static unsigned int g_pickupGridVersion = 0;
+
+Agent MakeAgent(float x, float z) {
+    Agent a;
+    a.x = x; a.y = GROUND_Y; a.z = z;
+    a.velX = a.velY = a.velZ = 0.0f;
+    a.inputX = a.inputZ = 0.0f;
+    a.jumpTrigger = false; a.grounded = true; a.jumpCount = 0;
+    a.spawnX = x; a.spawnZ = z;
+    a.pickups = 0;
+    return a;
+}
+
+// Pickup discs carry the pickup reach, so a point query hits exactly one
+// cell and every item is seen at most once per agent. Rebuilt whenever
+// the store changes, e.g. after every step that took something.
+static void EnsurePickupGrid() {
+    EntityWorld& world = LevelEntities();
+    if (!g_pickupGridDirty && g_pickupGridWorld == &world && g_pickupGridVersion == world.version) return;
+    g_agentPickups.clear();
+    ForEach<Transform, Pickup>(world, [](Entity e, const Transform& t, const Pickup& p) {
+        if (PICKUP_RULES[p.kind].agents) g_agentPickups.push_back(AgentPickup{ t.x, t.z, e });
+    });
+
+    std::vector<GridDisc> discs;
+    discs.reserve(g_agentPickups.size());
+    float minX = 0.0f, minZ = 0.0f, maxX = 1.0f, maxZ = 1.0f;
+    for (size_t i = 0; i < g_agentPickups.size(); ++i) {
+        const AgentPickup& it = g_agentPickups[i];
+        discs.push_back(GridDisc{ it.x, it.z, AGENT_PICKUP_DIST, 1 });
+        if (i == 0 || it.x < minX) minX = it.x;
+        if (i == 0 || it.z < minZ) minZ = it.z;
+        if (i == 0 || it.x > maxX) maxX = it.x;
+        if (i == 0 || it.z > maxZ) maxZ = it.z;
+    }
+    BuildDiscGrid(g_pickupGrid, discs, minX, minZ, maxX + 1.0f, maxZ + 1.0f, 2.0f * AGENT_PICKUP_DIST);
+    g_agentPickupTaken.assign(g_agentPickups.size(), 0);
+    g_pickupGridWorld = &world;
+    g_pickupGridVersion = world.version;
+    g_pickupGridDirty = false;
+}
+
+static inline bool AgentBlocked(float x, float z) {
+    return CollidesWithAnyObject(x, z, 0.0f) || CollidesWithNPC(x, z, 0.0f) || CollidesWithBoat(x, z, 0.0f);
+}
+
+static void RespawnAgent(Agent& a) {
+    a.x = a.spawnX; a.z = a.spawnZ; a.y = GROUND_Y;
+    a.velX = a.velY = a.velZ = 0.0f;
+    a.grounded = true; a.jumpCount = 0;
+}
+
+// UpdateMovement for one agent, without sounds, lives or the fade check.
+// Falling out of the world or meeting a pendulum sends it back to its spawn.
+static void StepAgent(Agent& a, float dt) {
+    const float startX = a.x, startY = a.y, startZ = a.z;
+    float inputLen = sqrtf(a.inputX * a.inputX + a.inputZ * a.inputZ);
+    if (inputLen > 0.001f) {
+        a.velX += a.inputX / inputLen * accel * dt;
+        a.velZ += a.inputZ / inputLen * accel * dt;
+    }
+    else {
+        float currentSpeed = sqrtf(a.velX * a.velX + a.velZ * a.velZ);
+        if (currentSpeed > 0.001f) {
+            float newSpeed = currentSpeed - (a.grounded ? frictionGround : frictionAir) * dt;
+            if (newSpeed < 0) newSpeed = 0;
+            a.velX *= (newSpeed / currentSpeed);
+            a.velZ *= (newSpeed / currentSpeed);
+        }
+        else { a.velX = 0; a.velZ = 0; }
+    }
+    float currentSpeed = sqrtf(a.velX * a.velX + a.velZ * a.velZ);
+    if (currentSpeed > maxSpeed) {
+        a.velX *= (maxSpeed / currentSpeed);
+        a.velZ *= (maxSpeed / currentSpeed);
+    }
+
+    // Axis-separated, same as the player
+    float testX = a.x + a.velX * dt;
+    bool hitWallX = (gameState == LEVEL_1) && (testX < 0.0f || testX > LAND_SIZE);
+    if (hitWallX || AgentBlocked(testX, a.z)) {
+        a.velX = 0;
+        if (hitWallX) a.x = (testX < 0.0f) ? 0.0f : LAND_SIZE;
+    }
+    else { a.x = testX; }
+
+    float testZ = a.z + a.velZ * dt;
+    bool hitWallZ = (gameState == LEVEL_1) && (testZ < 0.0f || testZ > LAND_SIZE);
+    if (hitWallZ || AgentBlocked(a.x, testZ)) {
+        a.velZ = 0;
+        if (hitWallZ) a.z = (testZ < 0.0f) ? 0.0f : LAND_SIZE;
+    }
+    else { a.z = testZ; }
+
+    // Vertical movement
+    a.velY -= gravity * dt;
+    if (a.velY < maxFallSpeed) a.velY = maxFallSpeed;
+    if (a.jumpTrigger && a.jumpCount < 2) { a.velY = jumpImpulse; a.grounded = false; a.jumpCount++; }
+    a.jumpTrigger = false;
+    a.y += a.velY * dt;
+
+    const float floorY = FloorHeightAt(a.x, a.z);
+    if (floorY != NO_GROUND) {
+        if (a.y < floorY) { a.y = floorY; a.velY = 0.0f; a.grounded = true; a.jumpCount = 0; }
+    }
+    else if (a.y < GROUND_Y) {
+        a.grounded = false; a.velY = (a.velY > -5.0f) ? a.velY : -5.0f;
+        if (a.y < -20.0f) { RespawnAgent(a); return; }
+    }
+
+    float ledgeY;
+    if (a.velY <= 0.0f && LedgeLandingAt(a.x, a.z, a.y, &ledgeY)) { a.y = ledgeY; a.velY = 0.0f; a.grounded = true; a.jumpCount = 0; }
+
+    if (gameState == LEVEL_2 &&
+        PendulumEarliestHit(g_pendulumTime - dt, g_pendulumTime, startX, startY, startZ, a.x, a.y, a.z, 0.0f, nullptr)) {
+        RespawnAgent(a);
+    }
+}
+
+// Phase 1 for one batch of agents
+static void StepAgentBatch(float dt, int batch) {
+    std::vector<PickupClaim>& claims = g_batchClaims[batch];
+    claims.clear();
+    const int begin = batch * AGENT_BATCH;
+    const int end = (begin + AGENT_BATCH < (int)g_agents.size()) ? begin + AGENT_BATCH : (int)g_agents.size();
+    const DiscGrid& g = g_pickupGrid;
+    for (int i = begin; i < end; ++i) {
+        Agent& a = g_agents[i];
+        StepAgent(a, dt);
+
+        int c0, r0, c1, r1; DiscGridCellRange(g, a.x, a.z, 0.0f, c0, r0, c1, r1);
+        const int cell = r0 * g.cols + c0;
+        for (int k = g.cellStart[cell]; k < g.cellStart[cell + 1]; ++k) {
+            const int item = g.discIndex[k];
+            float dx = a.x - g_agentPickups[item].x, dz = a.z - g_agentPickups[item].z;
+            if ((dx * dx + dz * dz) < (AGENT_PICKUP_DIST * AGENT_PICKUP_DIST)) claims.push_back(PickupClaim{ item, i });
+        }
+    }
+    CountAdd(CTR_COLLISION_QUERIES, 2LL * (end - begin));
+}
+
+static void ResolvePickups(int batchCount) {
+    for (int b = 0; b < batchCount; ++b) {
+        for (const PickupClaim& c : g_batchClaims[b]) {
+            if (g_agentPickupTaken[c.item]) continue;
+            g_agentPickupTaken[c.item] = 1;
+            g_agents[c.agent].pickups++;
+            g_takenPickups.push_back(g_agentPickups[c.item].entity);
+        }
+    }
+    EntityWorld& world = LevelEntities();
+    for (const Entity& e : g_takenPickups) DestroyEntity(world, e);
+    CountAdd(CTR_PICKUPS, (long long)g_takenPickups.size());
+    g_takenPickups.clear();
+}
+
+void UpdateAgents(float dt) {
+    if (g_agents.empty()) return;
+
+    // Lazy rebuilds happen here, before any worker can race on them
+    if (gameState == LEVEL_1) ObstacleGrid();
+    if (gameState == LEVEL_2) PendulumBoundsList();
+    GroundGrid(gameState == LEVEL_2);
+    EnsurePickupGrid();
+
+    const int batchCount = ((int)g_agents.size() + AGENT_BATCH - 1) / AGENT_BATCH;
+    if ((int)g_batchClaims.size() < batchCount) g_batchClaims.resize(batchCount);
+
+    ParallelFor(batchCount, 1, [dt](int begin, int end) { for (int b = begin; b < end; ++b) StepAgentBatch(dt, b); });
+
+    ResolvePickups(batchCount);
+}
+
+// Rows per job for the per-frame animation passes
+static const int SPIN_JOB_GRAIN = 1024;
+static const int PENDULUM_JOB_GRAIN = 16;
+
+void UpdateWorld(float dt, int elapsedMs) {
+    PROFILE_ZONE("UpdateWorld");
+    // decrease score over time: -1 point/sec, clamp at 0
+    static float scoreAccum = 0.0f;
+    if (gameState == LEVEL_1 || gameState == LEVEL_2) {
+        scoreAccum += dt;
+        while (scoreAccum >= 1.0f) {
+            if (score > 0) score -= 1;
+            scoreAccum -= 1.0f;
+        }
+    }
+
+    // Transition Logic
+    if (isFadingOut) {
+        fadeAlpha += dt * FADE_SPEED;
+        if (fadeAlpha >= 1.0f) {
+            fadeAlpha = 1.0f; isFadingOut = false; gameState = LEVEL_2; isFadingIn = true;
+            ResetPlayerLvl2();
+
+            // --- UPDATED: Switch Music when Level Changes ---
+            Game_PlayMusic(SND_MUSIC2, FADE_MS);   // Level 1 music has faded out; in with the picture
+            // ------------------------------------------------
+        }
+    }
+    else if (isFadingIn) {
+        fadeAlpha -= dt * FADE_SPEED; if (fadeAlpha <= 0.0f) { fadeAlpha = 0.0f; isFadingIn = false; }
+    }
+
+    if (gameState == LEVEL_1 || gameState == LEVEL_2) {
+        // --- FIX: Update Timer in BOTH levels so rotation works ---
+        gameTimer += dt;
+
+        // --- SUN MOVEMENT UPDATE ---
+        sunAngle += sunSpeed * dt;
+        if (sunAngle > 360.0f) sunAngle -= 360.0f;
+        // ---------------------------
+
+        // The pendulum swing and the spin of coins, the map, gems and the
+        // key run as jobs; movement and pickups below need both
+        {
+            PROFILE_ZONE("Animate");
+            JobCounter swung;
+            auto swing = [](int begin, int end) {
+                for (int i = begin; i < end; ++i) { Pendulum& p = lvl2_pendulums[i]; p.currentAngle = p.maxAngle * sin(g_pendulumTime * p.speed); }
+            };
+            if (gameState == LEVEL_2) {
+                g_pendulumTime = elapsedMs / 1000.0f;
+                SubmitParallelFor((int)lvl2_pendulums.size(), PENDULUM_JOB_GRAIN, swing, swung);
+            }
+            ParallelForEach<Transform, Spin>(LevelEntities(), SPIN_JOB_GRAIN, [dt](Entity, Transform& t, const Spin& s) {
+                t.yawDeg += s.degPerSec * dt; if (t.yawDeg > 360.0f) t.yawDeg -= 360.0f;
+            });
+            WaitForJobs(swung);
+        }
+
+        if (gameState == LEVEL_1) {
+            // Dialogue Timers
+            if (showNPCDialogue) { dialogueTimer += dt; if (dialogueTimer >= DIALOGUE_DURATION) showNPCDialogue = false; }
+            if (showBoatDialogue || showBoatDialogue2 || showBoatInsufficient) { boatDialogueTimer += dt; if (boatDialogueTimer >= DIALOGUE_DURATION) { showBoatDialogue = false; showBoatDialogue2 = false; showBoatInsufficient = false; } }
+
+        }
+
+
+        { PROFILE_ZONE("Movement"); UpdateMovement(dt); CheckGameLogic(); }
+        { PROFILE_ZONE("Agents"); UpdateAgents(dt); }
+    }
+}
@@ -0,0 +1,250 @@
+// ---------------- GAME WORLD ----------------
+// Simulation state and rules: level layout, player physics, collision,
+// pickups and level transitions. Nothing in here may touch GL, GLUT,
+// Windows or MCI so the same code can run inside the game and inside the
+// headless benchmark (bench/CollisionBench.cpp). The host program provides
+// the Game_* hooks declared at the bottom of this file.
+
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+#include "Entities.h"
+#include <vector>
+
+#define PI 3.1415926535f
+
+// ===== GAME STATE ENUMERATION =====
+enum GameState { MENU, LEVEL_1, WIN, LOSE, LEVEL_2 };
+extern GameState gameState;
+
+static const float LAND_SIZE = 300.0f;
+static const float WORLD_SIZE = LAND_SIZE + 100.0f;
+static const float GROUND_Y = 0.0f;
+static const float WATER_Y = -2.0f;
+
+// --- SUN MOVEMENT VARIABLES ---
+extern float sunAngle;
+extern float sunSpeed;
+extern float sunRadius;
+
+// ---------------- LEVEL 1 OBJECTS ----------------
+extern bool hasMap;
+
+struct NPCInstance { float x, y, z; float yawDeg; float scale; bool placed; };
+extern NPCInstance g_npc;
+
+extern bool showInteractPrompt;
+extern bool showNPCDialogue;
+extern float dialogueTimer;
+static const float DIALOGUE_DURATION = 5.0f;
+static const float NPC_INTERACT_DISTANCE = 5.0f;
+
+struct BoatInstance { float x, y, z; float yawDeg; float scale; bool placed; };
+extern BoatInstance g_boat;
+
+extern bool showBoatPrompt;
+extern bool showBoatDialogue;
+extern bool showBoatDialogue2;
+extern bool showBoatInsufficient;
+extern float boatDialogueTimer;
+
+static const float BOAT_INTERACT_DISTANCE = 30.0f;
+
+extern bool paidForBoat;
+static const int BOAT_COST = 10;
+
+// Level 1 Environment Instances
+// Collision radii of the Level 1 obstacles (added to the query radius)
+static const float TREE_RADIUS = 1.5f;
+static const float ROCK_RADIUS = 2.0f;
+static const float HOUSE_RADIUS = 3.5f;
+struct TreeInstance { float x, y, z; float yawDeg; float scale; };
+extern std::vector<TreeInstance> g_trees;
+struct HouseInstance { float x, y, z; float yawDeg; float scale; };
+extern std::vector<HouseInstance> g_houses;
+struct RockInstance { float x, y, z; float yawDeg; float scale; int modelIndex; };
+extern std::vector<RockInstance> g_rocks;
+
+// Level 1 Platforms
+struct Platform { float x, y, z, size; };
+static constexpr int PLATFORM_COUNT = 9;
+extern Platform g_platforms[PLATFORM_COUNT];
+
+// ---------------- LEVEL 2 OBJECTS ----------------
+struct Lvl2Platform { float x, z, width, length, y; };
+extern std::vector<Lvl2Platform> lvl2_platforms;
+
+struct Pendulum {
+    float pivotX, pivotY, pivotZ;
+    float length;
+    float currentAngle;
+    float maxAngle;
+    float speed;
+    bool axisZ; // true = side-to-side, false = front-to-back
+};
+extern std::vector<Pendulum> lvl2_pendulums;
+
+struct Chest { float x, y, z; bool isOpen; };
+extern Chest lvl2_chest;
+
+// ---------------- LEVEL ENTITIES ----------------
+// Pickups and props (coins, the pirate map, treasure piles, gems, the
+// Level 2 key) are entities in one store per level (Entities.h) rather
+// than a vector or global per type. The spin, pickup and draw passes each
+// run one query over the current level's store, so a new kind of pickup is
+// a PickupKind with a row in the rules table (GameWorld.cpp), a RenderKind
+// with a row in the renderer's table, and no new loop. Collected pickups
+// are destroyed.
+struct Transform { float x, y, z; float yawDeg; float scale; };
+struct Spin { float degPerSec; };   // turns Transform::yawDeg
+enum PickupKind { PICKUP_COIN, PICKUP_GEM, PICKUP_MAP, PICKUP_KEY, PICKUP_KIND_COUNT };
+struct Pickup { PickupKind kind; float reach; };   // reach: XZ distance the player takes it from
+enum RenderKind { RENDER_COIN, RENDER_GEM, RENDER_MAP, RENDER_KEY, RENDER_TREASURE, RENDER_KIND_COUNT };
+struct Renderable { RenderKind kind; };
+DECLARE_COMPONENT(Transform, 0)
+DECLARE_COMPONENT(Spin, 1)
+DECLARE_COMPONENT(Pickup, 2)
+DECLARE_COMPONENT(Renderable, 3)
+
+extern EntityWorld g_level1Entities, g_level2Entities;
+// Level 2's store in LEVEL_2, Level 1's otherwise
+EntityWorld& LevelEntities();
+Entity SpawnCoin(float x, float z);
+// Pickups of that kind left in the store
+int CountPickups(EntityWorld& world, PickupKind kind);
+
+extern bool hasLvl2Key;
+extern int score;
+extern int coinsCollected;
+extern float gameTimer;
+extern int gemsCollected;
+extern int lives;
+
+// ---------------- TRANSITION STATE ----------------
+extern float fadeAlpha;
+extern bool isFadingOut;
+extern bool isFadingIn;
+
+// ---------------- PLAYER STATE ----------------
+extern float playerX;
+extern float playerZ;
+extern float playerY;
+extern float playerYaw;
+
+extern float velX, velZ;
+extern float velY;
+const float accel = 100.0f;
+const float maxSpeed = 24.0f;
+const float frictionGround = 100.0f;
+const float frictionAir = 75.0f;
+const float gravity = 15.0f;
+const float jumpImpulse = 7.0f;
+const float maxFallSpeed = -15.0f;
+
+extern bool keyW, keyA, keyS, keyD;
+extern bool spaceTrigger;
+extern bool grounded;
+extern int jumpCount;
+
+// ---------------- GROUND QUERIES ----------------
+// Grid over the current level's floors (island / Level 2 platforms) and
+// Level 1 jump platforms; see GameWorld.cpp.
+static const float NO_GROUND = -1.0e30f;
+// Top of the highest floor under (x, z), or NO_GROUND over water/void
+float FloorHeightAt(float x, float z);
+void FloorHeightsAt(const float* xs, const float* zs, float* heights, int count);
+// True if a falling body at height y over (x, z) lands on a jump platform
+bool LedgeLandingAt(float x, float z, float y, float* topY);
+
+// ---------------- COLLISION QUERIES ----------------
+bool IsOnLevel2Platform(float x, float z);
+bool IsOverLand(float x, float z);
+bool InStreetZone(float x, float z);
+bool CollidesWithTree(float x, float z, float radius);
+bool CollidesWithRock(float x, float z, float radius);
+bool CollidesWithHouse(float x, float z, float radius);
+bool CollidesWithBoat(float x, float z, float radius);
+bool CollidesWithNPC(float x, float z, float radius);
+bool CollidesWithAnyObject(float x, float z, float radius);
+bool CollidesWithPendulum(float x, float z, float y, float radius);
+// Swept pendulum test: a body moving in a straight line from (x0,y0,z0) at
+// time t0 to (x1,y1,z1) at t1 (seconds of game clock, i.e. elapsedMs/1000)
+// against every spike over the whole interval. Returns the earliest contact
+// time through hitTime (may be null). Pass the same point twice for a
+// stationary body.
+bool PendulumEarliestHit(float t0, float t1, float x0, float y0, float z0, float x1, float y1, float z1, float radius, float* hitTime);
+// Tree/rock/house and ground queries go through grids built on first use.
+// The Place* functions invalidate them; call this after editing obstacles
+// or platforms by hand. (Pickup changes are seen through EntityWorld::version.)
+void InvalidateBroadPhase();
+// Bumped by InvalidateBroadPhase, so the renderer knows when to rebake the
+// level's static geometry
+extern unsigned int g_layoutVersion;
+
+// ---------------- PLACEMENT ----------------
+void PlaceBoatAtEdge();
+void placeTreasurePiles();
+void PlacePirateMapInRoad();
+void PlaceTreesRandom(int count);
+// Blue-noise scatter: coins are at least 3 units apart and clear of
+// obstacles, the street and the spawn. Places fewer than count if full.
+void PlaceCoinsRandom(int count);
+void PlaceHousesStreet();
+// The fixed rock layout, up to countPerModel (6 at most) of each of the 5 models
+void PlaceRocksRandom(int countPerModel);
+void InitLevel2();
+
+// ---------------- LOGIC UPDATES ----------------
+void HandlePlayerDeath();
+void ResetPlayerLvl2();
+void UpdateMovement(float dt);
+void CheckGameLogic();
+// The menu's play button: Level 1 from the start, full lives and score
+void StartNewRun();
+// 'E' in Level 1: talk to the NPC or pay for the boat, whichever is in reach
+void Interact();
+// One simulation step: timers, transitions, animation, movement and pickups.
+// elapsedMs is the absolute game clock that drives the pendulum swing.
+// Animation and the crowd run as jobs (Jobs.h); movement, pickups and the
+// host hooks stay on the calling thread.
+void UpdateWorld(float dt, int elapsedMs);
+
+// ---------------- CROWD AGENTS ----------------
+// Bots / NPC pirates sharing the level with the player, for load testing.
+// They use the player's movement rules, collide with the static world and
+// pick up coins (Level 1) or gems (Level 2), but not with each other or the
+// player. Stepped by UpdateWorld after the player.
+struct Agent {
+    float x, y, z;
+    float velX, velY, velZ;
+    float inputX, inputZ;   // desired move direction, set by whoever drives the agent
+    bool jumpTrigger;
+    bool grounded;
+    int jumpCount;
+    float spawnX, spawnZ;   // where it goes back to after falling or a pendulum hit
+    int pickups;
+};
+extern std::vector<Agent> g_agents;
+Agent MakeAgent(float x, float z);
+// Steps every agent in parallel batches on the job system (Jobs.h; see
+// SetJobWorkerCount). A pickup reached by several agents in the same step
+// goes to the lowest index, so the result is the same for any number of
+// workers.
+void UpdateAgents(float dt);
+
+// ---------------- HOST HOOKS ----------------
+// Implemented by whoever links the world in (OpenGLMeshLoader.cpp plays
+// them through Audio.h, the benchmark stubs them out).
+enum SoundId {
+    SND_MUSIC1, SND_MUSIC2, SND_WIN, SND_LOSE,
+    SND_COIN_PICKUP, SND_MAP_PICKUP, SND_COLLISION, SND_GAMEOVER,
+    SND_NPC_INTERACT, SND_BOAT_INTERACT, SND_JUMP, SND_OOF,
+    SND_COUNT
+};
+void Game_PlaySound(SoundId id);
+// Music loops; a new track fades in over fadeMs while the old one fades out
+void Game_PlayMusic(SoundId id, int fadeMs);
+void Game_StopMusic(int fadeMs);
+int Game_ElapsedMs();
+
+#endif // GAME_WORLD_H
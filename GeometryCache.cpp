@@ -0,0 +1,207 @@
+// ---------------- GEOMETRY CACHE ----------------
+// See GeometryCache.h. The quadric tessellations follow the SGI GLU code
+// (quad.c) vertex for vertex, so textures land where they did before.
+
+#include "glew.h"
+#include "GeometryCache.h"
+#include "Telemetry.h"
+#include <math.h>
+#include <stddef.h>
+#include <map>
+
+static const int CTR_DRAW_CALLS = RegisterCounter("draw_calls", "Draw calls issued.");
+static const int CTR_TRIANGLES = RegisterCounter("triangles", "Triangles submitted in draw calls.");
+
+void AddMeshVertex(Mesh& m, float x, float y, float z, float nx, float ny, float nz, float u, float v) {
+    MeshVertex vert = { x, y, z, nx, ny, nz, u, v };
+    m.vertices.push_back(vert);
+}
+
+void AddMeshTriangle(Mesh& m, unsigned int a, unsigned int b, unsigned int c) {
+    m.indices.push_back(a); m.indices.push_back(b); m.indices.push_back(c);
+}
+
+void AddMeshQuad(Mesh& m, const float corners[4][3], const float uvs[4][2], float nx, float ny, float nz) {
+    const unsigned int first = (unsigned int)m.vertices.size();
+    for (int i = 0; i < 4; ++i) AddMeshVertex(m, corners[i][0], corners[i][1], corners[i][2], nx, ny, nz, uvs[i][0], uvs[i][1]);
+    AddMeshTriangle(m, first, first + 1, first + 2);
+    AddMeshTriangle(m, first, first + 2, first + 3);
+}
+
+void UploadMesh(Mesh& m) {
+    m.indexCount = (int)m.indices.size();
+    if (!GLEW_VERSION_1_5 || m.vertices.empty()) return;   // drawn from client memory
+    if (!m.vertexBuffer) glGenBuffers(1, &m.vertexBuffer);
+    if (!m.indexBuffer) glGenBuffers(1, &m.indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, m.vertices.size() * sizeof(MeshVertex), &m.vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m.indices.size() * sizeof(unsigned int), &m.indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    // The GPU copy is the one that gets drawn
+    std::vector<MeshVertex>().swap(m.vertices);
+    std::vector<unsigned int>().swap(m.indices);
+}
+
+void ReleaseMesh(Mesh& m) {
+    if (m.vertexBuffer) glDeleteBuffers(1, &m.vertexBuffer);
+    if (m.indexBuffer) glDeleteBuffers(1, &m.indexBuffer);
+    m.vertexBuffer = m.indexBuffer = 0;
+    m.vertices.clear(); m.indices.clear();
+    m.indexCount = 0;
+}
+
+void DrawMesh(const Mesh& m) {
+    DrawMeshRange(m, 0, m.indexCount);
+}
+
+void DrawMeshRange(const Mesh& m, int firstIndex, int indexCount) {
+    if (indexCount <= 0) return;
+    const char* base = 0;
+    const void* indices = (const void*)(firstIndex * sizeof(unsigned int));
+    if (m.vertexBuffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, m.vertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.indexBuffer);
+    }
+    else {
+        base = (const char*)&m.vertices[0];
+        indices = &m.indices[firstIndex];
+    }
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, x));
+    glNormalPointer(GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, nx));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, u));
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices);
+    CountAdd(CTR_DRAW_CALLS); CountAdd(CTR_TRIANGLES, indexCount / 3);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (m.vertexBuffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+// ---------------- QUADRICS ----------------
+
+// Triangles for a GLU-style quad strip per row of a (rows+1) x (cols+1)
+// vertex grid starting at first. GLU emits the row-r vertex before the
+// row-(r+1) one unless lowFirst is false.
+static void AddStripGrid(Mesh& m, unsigned int first, int rows, int cols, bool lowFirst) {
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            unsigned int lo0 = first + r * (cols + 1) + c, hi0 = lo0 + (cols + 1);
+            unsigned int a0 = lowFirst ? lo0 : hi0, a1 = lowFirst ? hi0 : lo0;
+            unsigned int b0 = a0 + 1, b1 = a1 + 1;
+            AddMeshTriangle(m, a0, a1, b0);
+            AddMeshTriangle(m, b0, a1, b1);
+        }
+    }
+}
+
+static void BuildSphere(Mesh& m, float radius, int slices, int stacks, bool inside) {
+    const float nsign = inside ? -1.0f : 1.0f;
+    const float drho = 3.1415926535f / stacks, dtheta = 2.0f * 3.1415926535f / slices;
+    for (int i = 0; i <= stacks; ++i) {
+        const float rho = i * drho, t = 1.0f - (float)i / stacks;
+        for (int j = 0; j <= slices; ++j) {
+            const float theta = (j == slices) ? 0.0f : j * dtheta;
+            const float x = -sinf(theta) * sinf(rho), y = cosf(theta) * sinf(rho), z = nsign * cosf(rho);
+            AddMeshVertex(m, x * radius, y * radius, z * radius, x * nsign, y * nsign, z * nsign, (float)j / slices, t);
+        }
+    }
+    AddStripGrid(m, 0, stacks, slices, true);
+}
+
+static void BuildCylinder(Mesh& m, float baseRadius, float topRadius, float height, int slices, int stacks) {
+    const float deltaRadius = baseRadius - topRadius;
+    const float length = sqrtf(deltaRadius * deltaRadius + height * height);
+    const float zNormal = deltaRadius / length, xyNormalRatio = height / length;
+    for (int j = 0; j <= stacks; ++j) {
+        const float z = j * height / stacks, r = baseRadius - deltaRadius * ((float)j / stacks);
+        for (int i = 0; i <= slices; ++i) {
+            const float angle = (i == slices) ? 0.0f : 2.0f * 3.1415926535f * i / slices;
+            const float s = sinf(angle), c = cosf(angle);
+            AddMeshVertex(m, r * s, r * c, z, xyNormalRatio * s, xyNormalRatio * c, zNormal, 1.0f - (float)i / slices, (float)j / stacks);
+        }
+    }
+    AddStripGrid(m, 0, stacks, slices, true);
+}
+
+static void BuildDisk(Mesh& m, float innerRadius, float outerRadius, int slices, int loops) {
+    // GLU walks loops from the outer edge in; a zero inner radius just
+    // leaves the innermost ring collapsed onto the centre
+    const float deltaRadius = outerRadius - innerRadius;
+    for (int j = 0; j <= loops; ++j) {
+        const float r = outerRadius - deltaRadius * ((float)j / loops);
+        for (int i = 0; i <= slices; ++i) {
+            const float angle = (i == slices) ? 0.0f : 2.0f * 3.1415926535f * i / slices;
+            const float s = sinf(angle), c = cosf(angle);
+            AddMeshVertex(m, r * s, r * c, 0.0f, 0.0f, 0.0f, 1.0f, r * s / outerRadius / 2.0f + 0.5f, r * c / outerRadius / 2.0f + 0.5f);
+        }
+    }
+    AddStripGrid(m, 0, loops, slices, true);
+}
+
+// ---------------- CACHE ----------------
+
+enum ShapeKind { SHAPE_SPHERE, SHAPE_CYLINDER, SHAPE_DISK };
+
+struct ShapeKey {
+    int kind;
+    float p0, p1, p2;
+    int n0, n1;
+    bool operator<(const ShapeKey& o) const {
+        if (kind != o.kind) return kind < o.kind;
+        if (p0 != o.p0) return p0 < o.p0;
+        if (p1 != o.p1) return p1 < o.p1;
+        if (p2 != o.p2) return p2 < o.p2;
+        if (n0 != o.n0) return n0 < o.n0;
+        return n1 < o.n1;
+    }
+};
+
+static std::map<ShapeKey, Mesh> g_shapeCache;
+
+// Mesh for key, or a fresh empty one (indexCount 0) to be built
+static Mesh& LookupShape(const ShapeKey& key, bool* isNew) {
+    std::map<ShapeKey, Mesh>::iterator it = g_shapeCache.find(key);
+    *isNew = (it == g_shapeCache.end());
+    if (*isNew) {
+        Mesh empty = { std::vector<MeshVertex>(), std::vector<unsigned int>(), 0, 0, 0 };
+        it = g_shapeCache.insert(std::make_pair(key, empty)).first;
+    }
+    return it->second;
+}
+
+const Mesh& SphereMesh(float radius, int slices, int stacks, bool inside) {
+    ShapeKey key = { SHAPE_SPHERE, radius, inside ? 1.0f : 0.0f, 0.0f, slices, stacks };
+    bool isNew;
+    Mesh& m = LookupShape(key, &isNew);
+    if (isNew) { BuildSphere(m, radius, slices, stacks, inside); UploadMesh(m); }
+    return m;
+}
+
+const Mesh& CylinderMesh(float baseRadius, float topRadius, float height, int slices, int stacks) {
+    ShapeKey key = { SHAPE_CYLINDER, baseRadius, topRadius, height, slices, stacks };
+    bool isNew;
+    Mesh& m = LookupShape(key, &isNew);
+    if (isNew) { BuildCylinder(m, baseRadius, topRadius, height, slices, stacks); UploadMesh(m); }
+    return m;
+}
+
+const Mesh& DiskMesh(float innerRadius, float outerRadius, int slices, int loops) {
+    ShapeKey key = { SHAPE_DISK, innerRadius, outerRadius, 0.0f, slices, loops };
+    bool isNew;
+    Mesh& m = LookupShape(key, &isNew);
+    if (isNew) { BuildDisk(m, innerRadius, outerRadius, slices, loops); UploadMesh(m); }
+    return m;
+}
+
+void ReleaseGeometryCache() {
+    for (std::map<ShapeKey, Mesh>::iterator it = g_shapeCache.begin(); it != g_shapeCache.end(); ++it) ReleaseMesh(it->second);
+    g_shapeCache.clear();
+}
@@ -0,0 +1,44 @@
+// ---------------- GEOMETRY CACHE ----------------
+// Procedural meshes tessellated once and kept in vertex buffers, so shapes
+// that used to be rebuilt through GLU quadrics or glBegin every frame cost
+// one draw call each. Spheres, cylinders and disks match the GLU quadrics
+// they replace (same axes, normals and texture coordinates) and are shared
+// by every caller asking for the same parameters.
+//
+// Everything here needs a current GL context and glewInit() done; without
+// GL 1.5 buffers the meshes are drawn from client memory instead.
+
+#ifndef GEOMETRY_CACHE_H
+#define GEOMETRY_CACHE_H
+
+#include <vector>
+
+struct MeshVertex { float x, y, z; float nx, ny, nz; float u, v; };
+
+struct Mesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<unsigned int> indices;   // triangle list
+    unsigned int vertexBuffer, indexBuffer;   // 0 until uploaded / without VBOs
+    int indexCount;
+};
+
+// Builds a mesh on the CPU; UploadMesh moves it to the GPU
+void AddMeshVertex(Mesh& m, float x, float y, float z, float nx, float ny, float nz, float u, float v);
+void AddMeshTriangle(Mesh& m, unsigned int a, unsigned int b, unsigned int c);
+// Four new vertices in GL_QUADS order, flat normal (nx, ny, nz)
+void AddMeshQuad(Mesh& m, const float corners[4][3], const float uvs[4][2], float nx, float ny, float nz);
+void UploadMesh(Mesh& m);
+void ReleaseMesh(Mesh& m);
+// Draws with the current matrix, texture, colour and material
+void DrawMesh(const Mesh& m);
+// Draws indices [firstIndex, firstIndex + indexCount) only
+void DrawMeshRange(const Mesh& m, int firstIndex, int indexCount);
+
+// Cached GLU shapes. inside = GLU_INSIDE orientation (sky domes).
+const Mesh& SphereMesh(float radius, int slices, int stacks, bool inside);
+const Mesh& CylinderMesh(float baseRadius, float topRadius, float height, int slices, int stacks);
+const Mesh& DiskMesh(float innerRadius, float outerRadius, int slices, int loops);
+// Frees every cached shape (next lookup rebuilds it)
+void ReleaseGeometryCache();
+
+#endif // GEOMETRY_CACHE_H
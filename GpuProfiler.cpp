@@ -0,0 +1,136 @@
+// ---------------- GPU PROFILER ----------------
+// See GpuProfiler.h.
+
+#include "glew.h"
+#include "GpuProfiler.h"
+
+static GpuZoneTime g_lastZones[MAX_GPU_ZONES];
+static int g_lastZoneCount = 0;
+static int g_droppedFrames = 0;
+
+#if PROFILER_ENABLED
+struct GpuZone {
+    const char* name;
+    int depth;
+    int endOrder;          // zones go into the ring in the order they ended
+    long long cpuBeginNs;  // when GpuZoneBegin was called
+};
+
+struct GpuFrame {
+    GpuZone zones[MAX_GPU_ZONES];
+    GLuint queries[MAX_GPU_ZONES][2];
+    int count, ended;
+    int lastEnded;         // zone of the last query issued
+    bool pending;          // queries issued and not read back yet
+    long long offsetNs;    // CPU clock - GPU clock, when the GPU clock can be read
+};
+
+static bool g_gpuProfilerReady = false;
+static bool g_gpuClockReadable = false;
+static int g_gpuLane = -1;
+static GpuFrame g_gpuFrames[GPU_PROFILE_FRAMES];
+static int g_gpuFrame = GPU_PROFILE_FRAMES - 1;   // the first GpuFrameBegin moves to 0
+static int g_openZones[MAX_GPU_ZONES], g_openCount = 0;
+static int g_untimedOpen = 0;                     // zones begun with the frame's set full
+
+bool InitGpuProfiler() {
+    g_gpuProfilerReady = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (!g_gpuProfilerReady) return false;
+    g_gpuClockReadable = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+    for (GpuFrame& f : g_gpuFrames) {
+        glGenQueries(2 * MAX_GPU_ZONES, &f.queries[0][0]);
+        f.count = f.ended = 0;
+        f.pending = false;
+    }
+    g_gpuLane = ProfileAddLane("GPU");
+    return true;
+}
+
+// Puts the frame's zones into the GPU ring on the CPU clock. Without a
+// readable GPU clock the frame's first zone is placed where the CPU issued
+// it, which is only as early as the GPU could have started.
+static void ResolveFrame(GpuFrame& f) {
+    GLuint64 gpu[MAX_GPU_ZONES][2];
+    for (int i = 0; i < f.count; ++i) {
+        glGetQueryObjectui64v(f.queries[i][0], GL_QUERY_RESULT, &gpu[i][0]);
+        glGetQueryObjectui64v(f.queries[i][1], GL_QUERY_RESULT, &gpu[i][1]);
+    }
+    const long long offset = g_gpuClockReadable ? f.offsetNs : f.zones[0].cpuBeginNs - (long long)gpu[0][0];
+    int byEnd[MAX_GPU_ZONES];
+    for (int i = 0; i < f.count; ++i) byEnd[f.zones[i].endOrder] = i;
+    for (int k = 0; k < f.count; ++k) {
+        const int i = byEnd[k];
+        ProfileAddEvent(g_gpuLane, f.zones[i].name, (long long)gpu[i][0] + offset, (long long)gpu[i][1] + offset, f.zones[i].depth);
+    }
+    for (int i = 0; i < f.count; ++i) {
+        g_lastZones[i].name = f.zones[i].name;
+        g_lastZones[i].depth = f.zones[i].depth;
+        g_lastZones[i].ms = (float)((gpu[i][1] - gpu[i][0]) / 1.0e6);
+    }
+    g_lastZoneCount = f.count;
+    f.pending = false;
+}
+
+void GpuFrameBegin() {
+    if (!g_gpuProfilerReady) return;
+    GpuFrame& current = g_gpuFrames[g_gpuFrame];
+    // A frame with a zone left open is not worth reading back
+    current.pending = current.count > 0 && g_openCount == 0 && g_untimedOpen == 0;
+    g_openCount = g_untimedOpen = 0;
+
+    // Oldest first; the GPU finishes frames in order, so the first one not
+    // done ends the search
+    for (int k = 1; k <= GPU_PROFILE_FRAMES; ++k) {
+        GpuFrame& f = g_gpuFrames[(g_gpuFrame + k) % GPU_PROFILE_FRAMES];
+        if (!f.pending) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(f.queries[f.lastEnded][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        ResolveFrame(f);
+    }
+
+    g_gpuFrame = (g_gpuFrame + 1) % GPU_PROFILE_FRAMES;
+    GpuFrame& next = g_gpuFrames[g_gpuFrame];
+    if (next.pending) { next.pending = false; g_droppedFrames++; }
+    next.count = next.ended = 0;
+    if (g_gpuClockReadable) {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        next.offsetNs = ProfileNow() - (long long)gpuNow;
+    }
+}
+
+void GpuZoneBegin(const char* name) {
+    if (!g_gpuProfilerReady) return;
+    GpuFrame& f = g_gpuFrames[g_gpuFrame];
+    if (f.count == MAX_GPU_ZONES) { g_untimedOpen++; return; }
+    GpuZone& z = f.zones[f.count];
+    z.name = name;
+    z.depth = g_openCount;
+    z.cpuBeginNs = ProfileNow();
+    glQueryCounter(f.queries[f.count][0], GL_TIMESTAMP);
+    g_openZones[g_openCount++] = f.count++;
+}
+
+void GpuZoneEnd() {
+    if (!g_gpuProfilerReady) return;
+    // Zones begun with the set full are the innermost open ones
+    if (g_untimedOpen > 0) { g_untimedOpen--; return; }
+    if (g_openCount == 0) return;
+    GpuFrame& f = g_gpuFrames[g_gpuFrame];
+    const int i = g_openZones[--g_openCount];
+    glQueryCounter(f.queries[i][1], GL_TIMESTAMP);
+    f.zones[i].endOrder = f.ended++;
+    f.lastEnded = i;
+}
+#else
+bool InitGpuProfiler() { return false; }
+#endif
+
+int GpuLastFrameZones(GpuZoneTime* out, int max) {
+    const int n = g_lastZoneCount < max ? g_lastZoneCount : max;
+    for (int i = 0; i < n; ++i) out[i] = g_lastZones[i];
+    return n;
+}
+
+int GpuDroppedFrames() { return g_droppedFrames; }
@@ -0,0 +1,56 @@
+// ---------------- GPU PROFILER ----------------
+// GPU side of Profiler.h: every pass between GpuZoneBegin and GpuZoneEnd
+// (or in a GPU_ZONE block) gets a timestamp query at each end, so zones
+// nest like the CPU ones, around the shadow cascades' own elapsed-time
+// queries too. Frames rotate through GPU_PROFILE_FRAMES sets of queries
+// and a set is only read once the driver says it is done, so the
+// profiler never waits on the GPU; a frame whose queries are still out
+// when its set comes round again is dropped.
+//
+// Finished zones go into a "GPU" ring of the CPU profiler, moved onto its
+// clock, so they line up under the passes that issued them in the trace.
+//
+// Needs GL 3.3 or ARB_timer_query; without it the zones do nothing. With
+// PROFILER_ENABLED=0 the per-frame calls are empty inlines and no query
+// is ever made.
+
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include "Profiler.h"
+
+static const int GPU_PROFILE_FRAMES = 3;
+static const int MAX_GPU_ZONES = 32;   // per frame, more are not timed
+
+bool InitGpuProfiler();
+#if PROFILER_ENABLED
+// Once per frame, before its first zone: reads back the finished frames
+void GpuFrameBegin();
+// name must be a literal, like PROFILE_ZONE's
+void GpuZoneBegin(const char* name);
+void GpuZoneEnd();
+#else
+inline void GpuFrameBegin() {}
+inline void GpuZoneBegin(const char*) {}
+inline void GpuZoneEnd() {}
+#endif
+
+// Zones of the newest frame read back, in the order they began
+struct GpuZoneTime { const char* name; int depth; float ms; };
+int GpuLastFrameZones(GpuZoneTime* out, int max);
+// Frames dropped because their queries had not come back in time
+int GpuDroppedFrames();
+
+#if PROFILER_ENABLED
+struct GpuScope {
+    explicit GpuScope(const char* name) { GpuZoneBegin(name); }
+    ~GpuScope() { GpuZoneEnd(); }
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+};
+#define GPU_ZONE(name) GpuScope PROFILE_CONCAT(gpuZone, __LINE__)(name)
+#else
+#define GPU_ZONE(name) ((void)0)
+#endif
+
+#endif // GPU_PROFILER_H
@@ -0,0 +1,134 @@
+// ---------------- INPUT JOURNAL ----------------
+// See InputJournal.h.
+
+#include "InputJournal.h"
+#include "GameWorld.h"
+#include <initializer_list>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static FILE* g_journal = nullptr;
+static unsigned long long g_journalTicks = 0;
+static bool g_journalHeld[4] = {};   // W A S D as last written
+
+static void WriteHeldKeys(const SimInput& in) {
+    char keys[5]; int n = 0;
+    if (in.keyW) keys[n++] = 'w';
+    if (in.keyA) keys[n++] = 'a';
+    if (in.keyS) keys[n++] = 's';
+    if (in.keyD) keys[n++] = 'd';
+    if (n == 0) keys[n++] = '-';
+    keys[n] = '\0';
+    fprintf(g_journal, "k %s\n", keys);
+}
+
+bool StartJournal(const char* path, unsigned seed) {
+    g_journal = fopen(path, "w");
+    if (!g_journal) return false;
+    setvbuf(g_journal, nullptr, _IOFBF, 1 << 16);
+    fprintf(g_journal, "pirates-run-journal 1\nseed %u\n", seed);
+    g_journalTicks = 0;
+    memset(g_journalHeld, 0, sizeof(g_journalHeld));
+    return true;
+}
+
+void JournalTickDone(const SimInput& in, float dt, int elapsedMs) {
+    if (!g_journal) return;
+    fprintf(g_journal, "t %d %a\n", elapsedMs, dt);
+    const bool held[4] = { in.keyW, in.keyA, in.keyS, in.keyD };
+    if (memcmp(held, g_journalHeld, sizeof(held)) != 0) { WriteHeldKeys(in); memcpy(g_journalHeld, held, sizeof(held)); }
+    if (in.jump) fputs("j\n", g_journal);
+    if (in.turned) fprintf(g_journal, "y %a\n", in.yaw);
+    if (in.interact) fputs("e\n", g_journal);
+    if (in.startRun) fputs("s\n", g_journal);
+    if (++g_journalTicks % JOURNAL_CHECK_TICKS == 0) fprintf(g_journal, "c %llu %016llx\n", g_journalTicks, HashWorldState());
+}
+
+void StopJournal() {
+    if (!g_journal) return;
+    if (g_journalTicks % JOURNAL_CHECK_TICKS != 0) fprintf(g_journal, "c %llu %016llx\n", g_journalTicks, HashWorldState());
+    fclose(g_journal);
+    g_journal = nullptr;
+}
+
+bool JournalRecording() { return g_journal != nullptr; }
+
+bool LoadJournal(const char* path, InputJournal& journal) {
+    FILE* f = fopen(path, "r");
+    if (!f) { printf("Could not open %s\n", path); return false; }
+    journal.seed = 0;
+    journal.ticks.clear();
+    journal.checks.clear();
+
+    char line[128];
+    int version = 0, lineNo = 0;
+    bool ok = fgets(line, sizeof(line), f) && sscanf(line, "pirates-run-journal %d", &version) == 1 && version == 1;
+    lineNo++;
+    bool seeded = false;
+    SimInput held = {};   // keys carry over from tick to tick, the rest does not
+    while (ok && fgets(line, sizeof(line), f)) {
+        lineNo++;
+        char* arg = line + 1;
+        while (*arg == ' ') arg++;
+        switch (line[0]) {
+        case 's':
+            if (strncmp(line, "seed ", 5) == 0) { journal.seed = (unsigned)strtoul(line + 5, nullptr, 10); seeded = true; }
+            else if (!journal.ticks.empty()) journal.ticks.back().input.startRun = true;
+            else ok = false;
+            break;
+        case 't': {
+            JournalTick tick;
+            char* end;
+            tick.elapsedMs = (int)strtol(arg, &end, 10);
+            tick.dt = (float)strtod(end, &end);
+            tick.input = held;
+            ok = end != arg;
+            journal.ticks.push_back(tick);
+            break;
+        }
+        case 'k':
+            if (journal.ticks.empty()) { ok = false; break; }
+            held.keyW = strchr(arg, 'w') != nullptr; held.keyA = strchr(arg, 'a') != nullptr;
+            held.keyS = strchr(arg, 's') != nullptr; held.keyD = strchr(arg, 'd') != nullptr;
+            journal.ticks.back().input.keyW = held.keyW; journal.ticks.back().input.keyA = held.keyA;
+            journal.ticks.back().input.keyS = held.keyS; journal.ticks.back().input.keyD = held.keyD;
+            break;
+        case 'j': if (journal.ticks.empty()) ok = false; else journal.ticks.back().input.jump = true; break;
+        case 'e': if (journal.ticks.empty()) ok = false; else journal.ticks.back().input.interact = true; break;
+        case 'y':
+            if (journal.ticks.empty()) { ok = false; break; }
+            journal.ticks.back().input.turned = true;
+            journal.ticks.back().input.yaw = (float)strtod(arg, nullptr);
+            break;
+        case 'c': {
+            JournalCheck check;
+            ok = sscanf(arg, "%llu %llx", &check.tick, &check.hash) == 2;
+            journal.checks.push_back(check);
+            break;
+        }
+        case '#': case '\n': case '\r': break;
+        default: ok = false; break;
+        }
+    }
+    fclose(f);
+    if (!ok || !seeded) { printf("%s: not a journal, or broken at line %d\n", path, lineNo); return false; }
+    return true;
+}
+
+unsigned long long HashWorldState() {
+    unsigned long long h = 1469598103934665603ULL;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* b = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) { h ^= b[i]; h *= 1099511628211ULL; }
+    };
+    const float floats[] = { playerX, playerY, playerZ, playerYaw, velX, velY, velZ, gameTimer, sunAngle, fadeAlpha };
+    const int ints[] = { (int)gameState, score, coinsCollected, gemsCollected, lives, jumpCount };
+    const unsigned char flags[] = { grounded, hasMap, hasLvl2Key, paidForBoat, isFadingOut, isFadingIn, lvl2_chest.isOpen };
+    mix(floats, sizeof(floats));
+    mix(ints, sizeof(ints));
+    mix(flags, sizeof(flags));
+    for (EntityWorld* world : { &g_level1Entities, &g_level2Entities })
+        ForEach<Transform, Pickup>(*world, [&](Entity, const Transform& t, const Pickup& p) { mix(&t.x, sizeof(float) * 3); mix(&p.kind, sizeof(p.kind)); });
+    return h;
+}
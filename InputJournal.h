@@ -0,0 +1,67 @@
+// ---------------- INPUT JOURNAL ----------------
+// Everything that decides how a run plays out, so that it can be played
+// again: the seed the levels were laid out with, then for every simulation
+// tick its dt, its game clock and the input it took (held keys, jump,
+// camera yaw, interact, the menu's play button). The GLUT callbacks only
+// ever reach the world through a SimInput taken at the start of a tick, so
+// those ticks are the whole story; replaying them through UpdateWorld on
+// the same build lands on the same state, bit for bit.
+//
+// The journal is text, one line per tick and one per input that changed:
+//
+//   pirates-run-journal 1
+//   seed 1718000000
+//   t 8 0x1.1111p-7        tick: game clock in ms, dt (hex float, exact)
+//   k wd                   held keys from this tick on ("-" for none)
+//   j                      jump pressed
+//   y 0x1.68p+7            camera yaw the player should face
+//   e                      interact
+//   s                      play button
+//   c 120 1f3a...          state hash after tick 120
+//
+// Recording adds a check line every JOURNAL_CHECK_TICKS so a replay can
+// say at which second a changed build first parts from the recorded run.
+//
+// No GL, GLUT or Windows, like GameWorld.h.
+
+#ifndef INPUT_JOURNAL_H
+#define INPUT_JOURNAL_H
+
+#include <vector>
+
+// What the callbacks hand the simulation, taken at the start of a tick
+struct SimInput {
+    bool keyW, keyA, keyS, keyD;
+    bool jump;              // space pressed since the last tick
+    bool turned; float yaw; // camera yaw the player should face
+    bool interact;          // 'E'
+    bool startRun;          // menu's play button
+};
+
+static const int JOURNAL_CHECK_TICKS = 120;
+
+struct JournalTick { int elapsedMs; float dt; SimInput input; };
+struct JournalCheck { unsigned long long tick; unsigned long long hash; };
+struct InputJournal {
+    unsigned seed;
+    std::vector<JournalTick> ticks;
+    std::vector<JournalCheck> checks;   // in tick order
+};
+
+// Recording, from the one thread that ticks the world. False if the file
+// could not be created.
+bool StartJournal(const char* path, unsigned seed);
+// After UpdateWorld, with what the tick was given
+void JournalTickDone(const SimInput& input, float dt, int elapsedMs);
+// Once the simulation has stopped; a last check line for the final state
+void StopJournal();
+bool JournalRecording();
+
+// False (and a message on stdout) if the file is missing or malformed
+bool LoadJournal(const char* path, InputJournal& journal);
+
+// FNV-1a over the player, the run's progress, the clocks and the pickups
+// left in both levels
+unsigned long long HashWorldState();
+
+#endif // INPUT_JOURNAL_H
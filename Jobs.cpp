@@ -0,0 +1,158 @@
+// ---------------- JOB SYSTEM ----------------
+// See Jobs.h.
+
+#include "Jobs.h"
+#include "Profiler.h"
+#include <condition_variable>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+
+// A small lock per deque rather than a lock-free one: a frame has hundreds
+// of jobs, not millions, and the lock is only contended while stealing.
+// The owner works at the back, thieves advance head; the storage is reset
+// whenever it drains, so a steady frame never allocates.
+struct WorkerQueue {
+    std::mutex mutex;
+    std::vector<Job> jobs;
+    size_t head = 0;
+};
+
+struct JobSystem {
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkerQueue[]> queues;
+    std::atomic<int> workerCount;   // 0 until the first submit
+    std::mutex startMutex;
+    std::atomic<int> queued;        // jobs in all deques
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool quit = false;
+    std::atomic<int> jobsRun, steals;
+
+    JobSystem() : workerCount(0), queued(0), jobsRun(0), steals(0) {}
+    ~JobSystem() { Stop(); }
+
+    void Stop() {
+        { std::lock_guard<std::mutex> lock(sleepMutex); quit = true; }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+        threads.clear();
+        quit = false;
+        workerCount = 0;
+    }
+};
+
+static JobSystem g_jobs;
+static int g_requestedWorkers = 0;
+static thread_local int t_worker = 0;   // the main thread, and any other non-worker, is 0
+
+void SetJobWorkerCount(int count) { g_requestedWorkers = count; }
+
+int JobWorkerCount() {
+    int wanted = g_requestedWorkers > 0 ? g_requestedWorkers : (int)std::thread::hardware_concurrency();
+    return wanted < 1 ? 1 : wanted;
+}
+
+static bool PopJob(WorkerQueue& q, Job& job) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.head == q.jobs.size()) return false;
+    job = q.jobs.back();
+    q.jobs.pop_back();
+    if (q.head == q.jobs.size()) { q.jobs.clear(); q.head = 0; }
+    return true;
+}
+
+static bool StealJob(WorkerQueue& q, Job& job) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.head == q.jobs.size()) return false;
+    job = q.jobs[q.head++];
+    if (q.head == q.jobs.size()) { q.jobs.clear(); q.head = 0; }
+    return true;
+}
+
+static void PushJob(const Job& job) {
+    WorkerQueue& q = g_jobs.queues[t_worker];
+    { std::lock_guard<std::mutex> lock(q.mutex); q.jobs.push_back(job); }
+    g_jobs.queued.fetch_add(1);
+    // Taking the lock orders this against a worker that just found nothing
+    // and is about to sleep
+    { std::lock_guard<std::mutex> lock(g_jobs.sleepMutex); }
+    g_jobs.wake.notify_one();
+}
+
+// The held jobs are queued under the counter's lock, so a waiter can't see
+// zero and free the counter while they are still being read
+static void FinishJob(JobCounter& counter) {
+    std::lock_guard<std::mutex> lock(counter.mutex);
+    if (--counter.pending > 0) return;
+    for (const Job& job : counter.held) PushJob(job);
+    counter.held.clear();
+}
+
+// Own deque first, then the others starting with the next worker
+static bool RunOneJob() {
+    const int self = t_worker;
+    Job job;
+    bool found = PopJob(g_jobs.queues[self], job);
+    const int workers = g_jobs.workerCount.load(std::memory_order_relaxed);
+    for (int i = 1; !found && i < workers; ++i)
+        if (StealJob(g_jobs.queues[(self + i) % workers], job)) { found = true; g_jobs.steals.fetch_add(1, std::memory_order_relaxed); }
+    if (!found) return false;
+    g_jobs.queued.fetch_sub(1);
+    {
+        PROFILE_ZONE("Job");
+        job.run(job.ctx, job.begin, job.end);
+    }
+    g_jobs.jobsRun.fetch_add(1, std::memory_order_relaxed);
+    FinishJob(*job.done);
+    return true;
+}
+
+static void WorkerMain(int self) {
+    t_worker = self;
+    char label[16];
+    sprintf(label, "worker %d", self);
+    ProfileThreadName(label);
+    for (;;) {
+        if (RunOneJob()) continue;
+        std::unique_lock<std::mutex> lock(g_jobs.sleepMutex);
+        g_jobs.wake.wait(lock, [] { return g_jobs.quit || g_jobs.queued.load() > 0; });
+        if (g_jobs.quit) return;
+    }
+}
+
+// The simulation and render threads both submit as worker 0, so the first
+// submit from either may start the workers
+static void EnsureWorkers() {
+    const int wanted = JobWorkerCount();
+    if (wanted == g_jobs.workerCount.load()) return;
+    std::lock_guard<std::mutex> lock(g_jobs.startMutex);
+    if (wanted == g_jobs.workerCount.load()) return;
+    g_jobs.Stop();
+    g_jobs.queues.reset(new WorkerQueue[wanted]);
+    g_jobs.workerCount = wanted;
+    for (int w = 1; w < wanted; ++w) g_jobs.threads.push_back(std::thread(WorkerMain, w));
+}
+
+void SubmitJob(const Job& job, JobCounter& done, JobCounter* after) {
+    if (t_worker == 0) EnsureWorkers();
+    done.pending.fetch_add(1);
+    if (after) {
+        std::lock_guard<std::mutex> lock(after->mutex);
+        if (after->pending.load() > 0) { after->held.push_back(job); return; }
+    }
+    PushJob(job);
+}
+
+void WaitForJobs(JobCounter& counter) {
+    while (counter.pending.load() > 0)
+        if (!RunOneJob()) std::this_thread::yield();
+    // The last FinishJob may still hold the lock
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+JobStats TakeJobStats() {
+    const int workers = g_jobs.workerCount.load();
+    JobStats s = { g_jobs.jobsRun.exchange(0), g_jobs.steals.exchange(0), workers > 0 ? workers : JobWorkerCount() };
+    return s;
+}
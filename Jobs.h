@@ -0,0 +1,87 @@
+// ---------------- JOB SYSTEM ----------------
+// Per-frame work split into jobs on a fixed set of worker threads, one per
+// core by default. Every worker (the main thread is worker 0) has its own
+// deque: it pushes and pops at the back, so what it just spawned runs next
+// while still in cache, and idle workers steal the oldest job from the
+// front of somebody else's. A thread waiting for jobs runs jobs meanwhile,
+// so waits can nest and the main thread is never just blocked.
+//
+// A JobCounter counts the unfinished jobs submitted against it. A job may
+// also be held back until another counter reaches zero, which is how a
+// stage says it needs the previous one:
+//
+//   JobCounter culled, sorted;
+//   SubmitParallelFor(cells, 16, cull, culled);
+//   SubmitParallelFor(1, 1, sort, sorted, &culled);   // after every cull job
+//   WaitForJobs(sorted);
+//
+// Any thread that is not a worker (the simulation thread, the render
+// thread) submits and waits as worker 0, sharing its deque.
+// Jobs must not call GL or GLUT: only the main thread has the context.
+// No GL, GLUT or Windows, like GameWorld.h.
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+struct JobCounter;
+
+// run(ctx, begin, end) over a range of items
+struct Job {
+    void (*run)(void* ctx, int begin, int end);
+    void* ctx;
+    int begin, end;
+    JobCounter* done;
+};
+
+struct JobCounter {
+    std::atomic<int> pending;
+    std::mutex mutex;
+    std::vector<Job> held;    // submitted with this counter as their 'after'
+    JobCounter() : pending(0) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+};
+
+// Workers including the main thread; 0 = one per core. Takes effect at the
+// next submit, so only call it between frames.
+void SetJobWorkerCount(int count);
+int JobWorkerCount();
+
+// Queues job on the calling thread's deque and counts it on done; with
+// after, only once after has no pending jobs left
+void SubmitJob(const Job& job, JobCounter& done, JobCounter* after = nullptr);
+// Runs queued jobs until counter has no pending jobs
+void WaitForJobs(JobCounter& counter);
+
+// Jobs run and jobs stolen from another worker's deque since the last call
+struct JobStats { int jobs; int steals; int workers; };
+JobStats TakeJobStats();
+
+template <typename F> void RunJobRange(void* ctx, int begin, int end) { (*static_cast<F*>(ctx))(begin, end); }
+
+// f(begin, end) over [0, count) in jobs of up to grain items. f is not
+// copied: it must outlive done.
+template <typename F>
+void SubmitParallelFor(int count, int grain, F& f, JobCounter& done, JobCounter* after = nullptr) {
+    if (grain < 1) grain = 1;
+    for (int begin = 0; begin < count; begin += grain) {
+        const Job job = { RunJobRange<F>, &f, begin, begin + grain < count ? begin + grain : count, &done };
+        SubmitJob(job, done, after);
+    }
+}
+
+// SubmitParallelFor and wait; a single chunk just runs on the caller
+template <typename F>
+void ParallelFor(int count, int grain, F f) {
+    if (count <= 0) return;
+    if (count <= grain || JobWorkerCount() == 1) { f(0, count); return; }
+    JobCounter done;
+    SubmitParallelFor(count, grain, f, done);
+    WaitForJobs(done);
+}
+
+#endif // JOBS_H
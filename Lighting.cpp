@@ -0,0 +1,115 @@
+// ---------------- CLUSTERED LIGHTS ----------------
+// See Lighting.h.
+
+#include "Lighting.h"
+#include <math.h>
+
+// Tile/slice box a light covers, inclusive
+struct ClusterRange { int x0, x1, y0, y1, s0, s1; };
+
+static int SliceFor(const LightClusters& c, float depth) {
+    int s = (int)floorf(logf(depth / c.nearZ) * c.sliceScale);
+    if (s < 0) s = 0;
+    if (s > c.slices - 1) s = c.slices - 1;
+    return s;
+}
+
+static int ClampTile(float v, int count) {
+    int t = (int)floorf(v * count);
+    if (t < 0) t = 0;
+    if (t > count - 1) t = count - 1;
+    return t;
+}
+
+// False if the light is entirely in front of the near or behind the far plane
+static bool LightClusterRange(const LightClusters& c, const float* vl, const float proj[16], ClusterRange& r) {
+    const float depth = -vl[2], radius = vl[3];
+    const float dMin = depth - radius, dMax = depth + radius;
+    if (dMax < c.nearZ || dMin > c.farZ) return false;
+    r.s0 = SliceFor(c, dMin > c.nearZ ? dMin : c.nearZ);
+    r.s1 = SliceFor(c, dMax < c.farZ ? dMax : c.farZ);
+
+    if (dMin <= c.nearZ) {
+        // Reaches the camera: could be anywhere on screen
+        r.x0 = 0; r.x1 = c.tilesX - 1; r.y0 = 0; r.y1 = c.tilesY - 1;
+        return true;
+    }
+    // Screen rectangle of the sphere's view-space box; every corner is in front
+    float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+    for (int i = 0; i < 8; ++i) {
+        const float x = vl[0] + ((i & 1) ? radius : -radius);
+        const float y = vl[1] + ((i & 2) ? radius : -radius);
+        const float d = depth + ((i & 4) ? radius : -radius);
+        const float sx = proj[0] * x / d * 0.5f + 0.5f, sy = proj[5] * y / d * 0.5f + 0.5f;
+        if (sx < minX) minX = sx;
+        if (sx > maxX) maxX = sx;
+        if (sy < minY) minY = sy;
+        if (sy > maxY) maxY = sy;
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= 1.0f || minY >= 1.0f) return false;
+    r.x0 = ClampTile(minX, c.tilesX); r.x1 = ClampTile(maxX, c.tilesX);
+    r.y0 = ClampTile(minY, c.tilesY); r.y1 = ClampTile(maxY, c.tilesY);
+    return true;
+}
+
+void BuildLightClusters(LightClusters& c, const std::vector<PointLight>& lights, const float view[16], const float proj[16],
+    int tilesX, int tilesY, int slices, float nearZ, float farZ) {
+    c.tilesX = tilesX; c.tilesY = tilesY; c.slices = slices;
+    c.nearZ = nearZ; c.farZ = farZ;
+    c.sliceScale = slices / logf(farZ / nearZ);
+    const int clusterCount = tilesX * tilesY * slices;
+    c.offsets.assign(clusterCount + 1, 0);
+    c.indices.clear();
+    c.viewLights.resize(lights.size() * 4);
+    c.maxPerCluster = 0;
+
+    std::vector<ClusterRange> ranges(lights.size());
+    std::vector<char> inView(lights.size(), 0);
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const PointLight& l = lights[i];
+        float* vl = &c.viewLights[i * 4];
+        for (int k = 0; k < 3; ++k) vl[k] = view[0 * 4 + k] * l.x + view[1 * 4 + k] * l.y + view[2 * 4 + k] * l.z + view[3 * 4 + k];
+        vl[3] = l.radius;
+        inView[i] = LightClusterRange(c, vl, proj, ranges[i]);
+    }
+
+    // Count, prefix-sum, fill
+    for (size_t i = 0; i < lights.size(); ++i) {
+        if (!inView[i]) continue;
+        const ClusterRange& r = ranges[i];
+        for (int s = r.s0; s <= r.s1; ++s)
+            for (int y = r.y0; y <= r.y1; ++y)
+                for (int x = r.x0; x <= r.x1; ++x) c.offsets[x + tilesX * (y + tilesY * s) + 1]++;
+    }
+    for (int i = 0; i < clusterCount; ++i) {
+        const int n = c.offsets[i + 1];
+        if (n > c.maxPerCluster) c.maxPerCluster = n;
+        c.offsets[i + 1] += c.offsets[i];
+    }
+    c.indices.resize(c.offsets[clusterCount]);
+    std::vector<int> cursor(c.offsets.begin(), c.offsets.end() - 1);
+    for (size_t i = 0; i < lights.size(); ++i) {
+        if (!inView[i]) continue;
+        const ClusterRange& r = ranges[i];
+        for (int s = r.s0; s <= r.s1; ++s)
+            for (int y = r.y0; y <= r.y1; ++y)
+                for (int x = r.x0; x <= r.x1; ++x) c.indices[cursor[x + tilesX * (y + tilesY * s)]++] = (int)i;
+    }
+}
+
+int ClusterAt(const LightClusters& c, float sx, float sy, float viewZ) {
+    const float depth = -viewZ;
+    if (depth < c.nearZ || depth > c.farZ) return -1;
+    return ClampTile(sx, c.tilesX) + c.tilesX * (ClampTile(sy, c.tilesY) + c.tilesY * SliceFor(c, depth));
+}
+
+float LightFalloff(const float* viewLight, float px, float py, float pz, float nx, float ny, float nz) {
+    const float lx = viewLight[0] - px, ly = viewLight[1] - py, lz = viewLight[2] - pz;
+    const float d2 = lx * lx + ly * ly + lz * lz, r = viewLight[3];
+    if (d2 >= r * r) return 0.0f;
+    const float d = sqrtf(d2);
+    float att = 1.0f - d / r;
+    att *= att;
+    const float ndotl = d > 0.0f ? (nx * lx + ny * ly + nz * lz) / d : 1.0f;
+    return ndotl > 0.0f ? att * ndotl : 0.0f;
+}
@@ -0,0 +1,41 @@
+// ---------------- CLUSTERED LIGHTS ----------------
+// Point lights (torches) binned into view-space clusters: the screen is cut
+// into tiles and each tile into slices along depth, spaced exponentially
+// between the near and far plane. Every cluster keeps the lights whose
+// sphere may touch it, so a pixel only looks at a handful of lights however
+// many there are in the level. GL-free: LightingShader.h does the
+// per-pixel pass in the game, bench/RenderBench.cpp shades on the CPU.
+
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include <vector>
+
+struct PointLight { float x, y, z; float radius; float r, g, b; };
+
+struct LightClusters {
+    int tilesX, tilesY, slices;
+    float nearZ, farZ;
+    float sliceScale;               // slices / log(far / near)
+    // CSR: the lights of cluster c are indices[offsets[c] .. offsets[c + 1])
+    // (cluster c = tileX + tilesX * (tileY + tilesY * slice))
+    std::vector<int> offsets;
+    std::vector<int> indices;
+    std::vector<float> viewLights;  // per light: view-space x, y, z, radius
+    int maxPerCluster;
+};
+
+// view and proj are column-major (as glGetFloatv returns them); proj must
+// be a symmetric perspective projection such as gluPerspective makes.
+void BuildLightClusters(LightClusters& c, const std::vector<PointLight>& lights, const float view[16], const float proj[16],
+    int tilesX, int tilesY, int slices, float nearZ, float farZ);
+
+// Cluster holding a view-space point seen at normalised screen position
+// (sx, sy) in [0,1); -1 if it is outside the near/far range
+int ClusterAt(const LightClusters& c, float sx, float sy, float viewZ);
+
+// Light reaching a view-space point with normal n from light (view space):
+// smooth falloff to zero at the radius, times N.L
+float LightFalloff(const float* viewLight, float px, float py, float pz, float nx, float ny, float nz);
+
+#endif // LIGHTING_H
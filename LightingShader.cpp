@@ -0,0 +1,186 @@
+// ---------------- CLUSTERED LIGHT PASS ----------------
+// See LightingShader.h.
+
+#include "glew.h"
+#include "LightingShader.h"
+#include <stdio.h>
+
+static const int INDEX_TEXTURE_WIDTH = 1024;
+
+static GLuint g_lightProgram = 0;
+static GLuint g_depthTex = 0, g_clusterTex = 0, g_indexTex = 0, g_lightTex = 0;
+static int g_depthWidth = 0, g_depthHeight = 0;
+static bool g_lightPassReady = false;
+
+// Lights per cluster the shader looks at; busier clusters drop the rest
+#define MAX_CLUSTER_LIGHTS 64
+#define STRINGIFY2(x) #x
+#define STRINGIFY(x) STRINGIFY2(x)
+
+static const char* LIGHT_PASS_FRAGMENT =
+    "#version 120\n"
+    "uniform sampler2D depthTex, clusterTex, indexTex, lightTex;\n"
+    "uniform vec2 viewSize;\n"
+    "uniform vec4 projParams;    // proj[0], proj[5], proj[10], proj[14]\n"
+    "uniform vec3 clusterDims;   // tilesX, tilesY, slices\n"
+    "uniform vec2 sliceParams;   // near, slices / log(far / near)\n"
+    "uniform vec2 lightTexSize;  // index texture width, light count\n"
+    "void main() {\n"
+    "    vec2 uv = gl_FragCoord.xy / viewSize;\n"
+    "    float depth = texture2D(depthTex, uv).r;\n"
+    "    if (depth >= 1.0) discard;\n"
+    "    float viewZ = -projParams.w / (depth * 2.0 - 1.0 + projParams.z);\n"
+    "    vec2 ndc = uv * 2.0 - 1.0;\n"
+    "    vec3 pos = vec3(ndc.x * -viewZ / projParams.x, ndc.y * -viewZ / projParams.y, viewZ);\n"
+    "    vec3 n = normalize(cross(dFdx(pos), dFdy(pos)));\n"
+    "    if (dot(n, pos) > 0.0) n = -n;\n"
+    "    float slice = clamp(floor(log(-viewZ / sliceParams.x) * sliceParams.y), 0.0, clusterDims.z - 1.0);\n"
+    "    vec2 tile = min(floor(uv * clusterDims.xy), clusterDims.xy - 1.0);\n"
+    "    vec4 cluster = texture2D(clusterTex, vec2((tile.x + tile.y * clusterDims.x + 0.5) / (clusterDims.x * clusterDims.y), (slice + 0.5) / clusterDims.z));\n"
+    "    float first = cluster.r, count = cluster.a;\n"
+    "    float indexRows = max(ceil((first + count) / lightTexSize.x), 1.0);\n"
+    "    vec3 sum = vec3(0.0);\n"
+    "    for (int i = 0; i < " STRINGIFY(MAX_CLUSTER_LIGHTS) "; ++i) {\n"
+    "        if (float(i) >= count) break;\n"
+    "        float k = first + float(i);\n"
+    "        float row = floor(k / lightTexSize.x);\n"
+    "        float light = texture2D(indexTex, vec2((k - row * lightTexSize.x + 0.5) / lightTexSize.x, (row + 0.5) / indexRows)).r;\n"
+    "        vec4 lp = texture2D(lightTex, vec2((light + 0.5) / lightTexSize.y, 0.25));\n"
+    "        vec3 lc = texture2D(lightTex, vec2((light + 0.5) / lightTexSize.y, 0.75)).rgb;\n"
+    "        vec3 l = lp.xyz - pos;\n"
+    "        float d = length(l);\n"
+    "        float att = clamp(1.0 - d / lp.w, 0.0, 1.0);\n"
+    "        sum += lc * (att * att * max(dot(n, l / max(d, 1e-4)), 0.0));\n"
+    "    }\n"
+    "    gl_FragColor = vec4(sum, 1.0);\n"
+    "}\n";
+
+static GLuint CompileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, 0);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024]; glGetShaderInfoLog(shader, sizeof(log), 0, log);
+        printf("Light pass shader failed to compile:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static void InitDataTexture(GLuint* tex) {
+    glGenTextures(1, tex);
+    glBindTexture(GL_TEXTURE_2D, *tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+bool InitLightingPass() {
+    if (!GLEW_VERSION_2_0 || !GLEW_ARB_texture_float) return false;
+    GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, LIGHT_PASS_FRAGMENT);
+    if (!fragment) return false;
+    g_lightProgram = glCreateProgram();
+    glAttachShader(g_lightProgram, fragment);
+    glLinkProgram(g_lightProgram);
+    glDeleteShader(fragment);
+    GLint ok = 0;
+    glGetProgramiv(g_lightProgram, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        printf("Light pass shader failed to link\n");
+        glDeleteProgram(g_lightProgram); g_lightProgram = 0;
+        return false;
+    }
+    InitDataTexture(&g_depthTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
+    InitDataTexture(&g_clusterTex);
+    InitDataTexture(&g_indexTex);
+    InitDataTexture(&g_lightTex);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glUseProgram(g_lightProgram);
+    glUniform1i(glGetUniformLocation(g_lightProgram, "depthTex"), 0);
+    glUniform1i(glGetUniformLocation(g_lightProgram, "clusterTex"), 1);
+    glUniform1i(glGetUniformLocation(g_lightProgram, "indexTex"), 2);
+    glUniform1i(glGetUniformLocation(g_lightProgram, "lightTex"), 3);
+    glUseProgram(0);
+    g_lightPassReady = true;
+    return true;
+}
+
+// Cluster, index and light tables as float textures on units 1-3
+static void UploadClusterData(const LightClusters& c, const std::vector<PointLight>& lights) {
+    const int tiles = c.tilesX * c.tilesY;
+    std::vector<float> clusterData(tiles * c.slices * 2);
+    for (int i = 0; i < tiles * c.slices; ++i) {
+        clusterData[i * 2] = (float)c.offsets[i];
+        clusterData[i * 2 + 1] = (float)(c.offsets[i + 1] - c.offsets[i]);
+    }
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, g_clusterTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE_ALPHA32F_ARB, tiles, c.slices, 0, GL_LUMINANCE_ALPHA, GL_FLOAT, &clusterData[0]);
+
+    const int indexCount = (int)c.indices.size();
+    const int indexRows = indexCount > 0 ? (indexCount + INDEX_TEXTURE_WIDTH - 1) / INDEX_TEXTURE_WIDTH : 1;
+    std::vector<float> indexData(INDEX_TEXTURE_WIDTH * indexRows, 0.0f);
+    for (int i = 0; i < indexCount; ++i) indexData[i] = (float)c.indices[i];
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, g_indexTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE32F_ARB, INDEX_TEXTURE_WIDTH, indexRows, 0, GL_LUMINANCE, GL_FLOAT, &indexData[0]);
+
+    // Row 0: view-space position and radius, row 1: colour
+    const int lightCount = (int)lights.size();
+    std::vector<float> lightData(lightCount * 8);
+    for (int i = 0; i < lightCount; ++i) {
+        for (int k = 0; k < 4; ++k) lightData[i * 4 + k] = c.viewLights[i * 4 + k];
+        float* color = &lightData[(lightCount + i) * 4];
+        color[0] = lights[i].r; color[1] = lights[i].g; color[2] = lights[i].b; color[3] = 0.0f;
+    }
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, g_lightTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, lightCount, 2, 0, GL_RGBA, GL_FLOAT, &lightData[0]);
+}
+
+void ApplyLightingPass(const LightClusters& clusters, const std::vector<PointLight>& lights, const float proj[16], int viewWidth, int viewHeight) {
+    if (!g_lightPassReady || lights.empty() || clusters.indices.empty()) return;
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT);
+
+    // Depth of the finished opaque scene
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, g_depthTex);
+    if (viewWidth != g_depthWidth || viewHeight != g_depthHeight) {
+        g_depthWidth = viewWidth; g_depthHeight = viewHeight;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, viewWidth, viewHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+    }
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, viewWidth, viewHeight);
+    UploadClusterData(clusters, lights);
+
+    glUseProgram(g_lightProgram);
+    glUniform2f(glGetUniformLocation(g_lightProgram, "viewSize"), (float)viewWidth, (float)viewHeight);
+    glUniform4f(glGetUniformLocation(g_lightProgram, "projParams"), proj[0], proj[5], proj[10], proj[14]);
+    glUniform3f(glGetUniformLocation(g_lightProgram, "clusterDims"), (float)clusters.tilesX, (float)clusters.tilesY, (float)clusters.slices);
+    glUniform2f(glGetUniformLocation(g_lightProgram, "sliceParams"), clusters.nearZ, clusters.sliceScale);
+    glUniform2f(glGetUniformLocation(g_lightProgram, "lightTexSize"), (float)INDEX_TEXTURE_WIDTH, (float)lights.size());
+
+    // dst * light + dst: torchlight scales whatever the scene put there
+    glDisable(GL_DEPTH_TEST); glDepthMask(GL_FALSE);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_BLEND); glBlendFunc(GL_DST_COLOR, GL_ONE);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+    glBegin(GL_QUADS);
+    glVertex2f(-1, -1); glVertex2f(1, -1); glVertex2f(1, 1); glVertex2f(-1, 1);
+    glEnd();
+    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    glUseProgram(0);
+
+    for (int unit = 3; unit >= 0; --unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glPopAttrib();
+}
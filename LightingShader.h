@@ -0,0 +1,21 @@
+// ---------------- CLUSTERED LIGHT PASS ----------------
+// Per-pixel point lights on top of the fixed-function scene. After the
+// opaque geometry is drawn, the depth buffer is copied to a texture and a
+// full-screen GLSL pass rebuilds each pixel's view-space position and
+// normal, looks up its cluster (Lighting.h) and multiplies the torch light
+// into the colour already there. The scene's draw code stays as it is.
+//
+// Needs GL 2.0 and ARB_texture_float; InitLightingPass reports false and
+// the game keeps fixed-function lighting only when they are missing.
+
+#ifndef LIGHTING_SHADER_H
+#define LIGHTING_SHADER_H
+
+#include "Lighting.h"
+
+bool InitLightingPass();
+// proj is the projection the scene was drawn with; lights as passed to
+// BuildLightClusters. Leaves GL state as it found it.
+void ApplyLightingPass(const LightClusters& clusters, const std::vector<PointLight>& lights, const float proj[16], int viewWidth, int viewHeight);
+
+#endif // LIGHTING_SHADER_H
@@ -82,6 +82,11 @@
 
 #include <math.h>			// Header file for the math library
 #include <gl\gl.h>			// Header file for the OpenGL32 library
+#include <chrono>
+#include "Tangents.h"		// Tangent frames for normal mapping
+#include "NormalMapShader.h"	// Shader path for normal mapped materials
+#include "Profiler.h"		// Frame profiler zones
+#include "Telemetry.h"		// Draw call counters
 
 // The chunk's id numbers
 #define MAIN3DS				0x4D4D
@@ -146,6 +151,13 @@ Model_3DS::Model_3DS()
 	// The model is visible by default
 	visible = true;
 
+	// No bounds until something is loaded
+	boundsMin.x = boundsMin.y = boundsMin.z = 0.0f;
+	boundsMax.x = boundsMax.y = boundsMax.z = 0.0f;
+	boundsCenter.x = boundsCenter.y = boundsCenter.z = 0.0f;
+	boundsRadius = 0.0f;
+	tangentMs = 0.0f;
+
 	// Set up the default position
 	pos.x = 0.0f;
 	pos.y = 0.0f;
@@ -227,6 +239,9 @@ void Model_3DS::Load(char* name)
 	// Calculate the vertex normals
 	CalculateNormals();
 
+	// Calculate the bounds for view culling
+	CalculateBounds();
+
 	// For future reference
 	modelname = name;
 
@@ -318,10 +333,48 @@ void Model_3DS::Load(char* name)
 			Materials[j].textured = true;
 		}
 	}
+
+	// Tangent frames for normal mapping, now that every object has texcoords
+	CalculateTangents();
+}
+
+void Model_3DS::SetNormalMap(char *name)
+{
+	if (numMaterials == 0)
+		return;
+
+	// Load it once and share the texture between the materials
+	Materials[0].normalMap.Load(name);
+	for (int j = 0; j < numMaterials; j++)
+	{
+		Materials[j].normalMap.texture[0] = Materials[0].normalMap.texture[0];
+		Materials[j].normalMapped = Materials[0].normalMap.texture[0] != 0;
+	}
+}
+
+void Model_3DS::FindNormalMap(int matindex, const char *base)
+{
+	const char *exts[] = { "png", "bmp", "tga" };
+	for (int e = 0; e < 3; e++)
+	{
+		char fullname[256];
+		sprintf(fullname, "%s%s_normal.%s", path, base, exts[e]);
+		FILE *f = fopen(fullname, "rb");
+		if (!f)
+			continue;
+		fclose(f);
+		Materials[matindex].normalMap.Load(fullname);
+		Materials[matindex].normalMapped = Materials[matindex].normalMap.texture[0] != 0;
+		return;
+	}
 }
 
+static const int CTR_DRAW_CALLS = RegisterCounter("draw_calls", "Draw calls issued.");
+static const int CTR_TRIANGLES = RegisterCounter("triangles", "Triangles submitted in draw calls.");
+
 void Model_3DS::Draw()
 {
+	PROFILE_ZONE("Model_3DS::Draw");
 	if (visible)
 	{
 		glPushMatrix();
@@ -356,8 +409,13 @@ void Model_3DS::Draw()
 			// Loop through the faces as sorted by material and draw them
 			for (int j = 0; j < Objects[i].numMatFaces; j++)
 			{
+				Material &mat = Materials[Objects[i].MatFaces[j].MatIndex];
+
+				// Normal mapped materials go through the shader when it can be used
+				const bool normalMapped = mat.normalMapped && lit && BeginNormalMapped(mat.normalMap.texture[0], Objects[i].Tangents);
+
 				// Use the material's texture
-				Materials[Objects[i].MatFaces[j].MatIndex].tex.Use();
+				mat.tex.Use();
 
 				glPushMatrix();
 
@@ -370,8 +428,12 @@ void Model_3DS::Draw()
 
 				// Draw the faces using an index to the vertex array
 				glDrawElements(GL_TRIANGLES, Objects[i].MatFaces[j].numSubFaces, GL_UNSIGNED_SHORT, Objects[i].MatFaces[j].subFaces);
+				CountAdd(CTR_DRAW_CALLS); CountAdd(CTR_TRIANGLES, Objects[i].MatFaces[j].numSubFaces / 3);
 
 				glPopMatrix();
+
+				if (normalMapped)
+					EndNormalMapped();
 			}
 
 			// Show the normals?
@@ -438,6 +500,70 @@ void Model_3DS::CalculateNormals()
 	}
 }
 
+void Model_3DS::CalculateTangents()
+{
+	const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < numObjects; i++)
+	{
+		// Needs one texture coordinate per vertex
+		if (Objects[i].numTexCoords != Objects[i].numVerts || Objects[i].numVerts == 0)
+			continue;
+
+		Objects[i].Tangents = new float[Objects[i].numVerts * 4];
+		ComputeTangents(Objects[i].Vertexes, Objects[i].Normals, Objects[i].TexCoords, Objects[i].numVerts,
+			Objects[i].Faces, Objects[i].numFaces, Objects[i].Tangents);
+	}
+
+	tangentMs = (float)std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Model_3DS::CalculateBounds()
+{
+	bool first = true;
+	boundsMin.x = boundsMin.y = boundsMin.z = 0.0f;
+	boundsMax.x = boundsMax.y = boundsMax.z = 0.0f;
+
+	// Box around every vertex of every object
+	for (int i = 0; i < numObjects; i++)
+	{
+		for (int g = 0; g < Objects[i].numVerts; g++)
+		{
+			float x = Objects[i].Vertexes[g * 3];
+			float y = Objects[i].Vertexes[g * 3 + 1];
+			float z = Objects[i].Vertexes[g * 3 + 2];
+
+			if (first || x < boundsMin.x) boundsMin.x = x;
+			if (first || y < boundsMin.y) boundsMin.y = y;
+			if (first || z < boundsMin.z) boundsMin.z = z;
+			if (first || x > boundsMax.x) boundsMax.x = x;
+			if (first || y > boundsMax.y) boundsMax.y = y;
+			if (first || z > boundsMax.z) boundsMax.z = z;
+			first = false;
+		}
+	}
+
+	// Sphere centred on the box, just big enough for the furthest vertex
+	boundsCenter.x = (boundsMin.x + boundsMax.x) * 0.5f;
+	boundsCenter.y = (boundsMin.y + boundsMax.y) * 0.5f;
+	boundsCenter.z = (boundsMin.z + boundsMax.z) * 0.5f;
+	float maxDist2 = 0.0f;
+
+	for (int i = 0; i < numObjects; i++)
+	{
+		for (int g = 0; g < Objects[i].numVerts; g++)
+		{
+			float dx = Objects[i].Vertexes[g * 3] - boundsCenter.x;
+			float dy = Objects[i].Vertexes[g * 3 + 1] - boundsCenter.y;
+			float dz = Objects[i].Vertexes[g * 3 + 2] - boundsCenter.z;
+			float d2 = dx * dx + dy * dy + dz * dz;
+			if (d2 > maxDist2)
+				maxDist2 = d2;
+		}
+	}
+	boundsRadius = (float)sqrt(maxDist2);
+}
+
 void Model_3DS::MainChunkProcessor(long length, long findex)
 {
 	ChunkHeader h;
@@ -510,7 +636,10 @@ void Model_3DS::EditChunkProcessor(long length, long findex)
 
 		// Material is set to untextured until we find otherwise
 		for (int d = 0; d < numMaterials; d++)
+		{
 			Materials[d].textured = false;
+			Materials[d].normalMapped = false;
+		}
 
 		fseek(bin3ds, findex, SEEK_SET);
 
@@ -542,7 +671,10 @@ void Model_3DS::EditChunkProcessor(long length, long findex)
 
 		// Set the textured variable to false until we find a texture
 		for (int k = 0; k < numObjects; k++)
+		{
 			Objects[k].textured = false;
+			Objects[k].Tangents = NULL;
+		}
 
 		// Zero the objects position and rotation
 		for (int m = 0; m < numObjects; m++)
@@ -888,7 +1020,7 @@ void Model_3DS::MapNameChunkProcessor(long length, long findex, int matindex)
 		char fullname[256];
 		sprintf(fullname, "%s%s.%s", path, base.c_str(), extTry);
 		FILE* f = fopen(fullname, "rb");
-		if (f) { fclose(f); Materials[matindex].tex.Load(fullname); Materials[matindex].textured = true; return true; }
+		if (f) { fclose(f); Materials[matindex].tex.Load(fullname); Materials[matindex].textured = true; FindNormalMap(matindex, base.c_str()); return true; }
 		return false;
 		};
 
@@ -66,6 +66,10 @@
 // m.Objects[0].pos.y = 0.0f;
 // m.Objects[0].pos.z = 0.0f;
 //
+// // Normal maps: Load picks up <texture>_normal.png/.bmp/.tga next to
+// // a material's texture, or give every material the same one
+// m.SetNormalMap("textures/wood_normal.png");
+//
 //////////////////////////////////////////////////////////////////////
 
 #ifndef MODEL_3DS_H
@@ -111,6 +115,8 @@ public:
 		GLTexture tex;	// The texture (this is the only outside reference in this class)
 		bool textured;	// whether or not it is textured
 		Color4i color;
+		GLTexture normalMap;	// Tangent-space normal map, drawn through NormalMapShader.h
+		bool normalMapped;		// whether or not it has one
 	};
 
 	// Every chunk in the 3ds file starts with this struct
@@ -132,6 +138,7 @@ public:
 		float *Vertexes;			// The array of vertices
 		float *Normals;				// The array of the normals for the vertices
 		float *TexCoords;			// The array of texture coordinates for the vertices
+		float *Tangents;			// Tangent frame per vertex, 4 floats (Tangents.h); NULL without texcoords
 		unsigned short *Faces;		// The array of face indices
 		int numFaces;				// The number of faces
 		int numMatFaces;			// The number of differnet material faces
@@ -157,7 +164,13 @@ public:
 	float scale;			// The size you want the model scaled to
 	bool lit;				// True: the model is lit
 	bool visible;			// True: the model gets rendered
+	Vector boundsMin;		// Bounding box of all the vertices (model space, set by Load)
+	Vector boundsMax;
+	Vector boundsCenter;	// Bounding sphere around the box centre
+	float boundsRadius;
+	float tangentMs;		// Time Load spent building the tangent frames
 	void Load(char *name);	// Loads a model
+	void SetNormalMap(char *name);	// Gives every material this normal map
 	void Draw();			// Draws the model
 	FILE *bin3ds;			// The binary 3ds file
 	Model_3DS();			// Constructor
@@ -198,6 +211,15 @@ private:
 	// Calculates the normals of the vertices by averaging
 	// the normals of the faces that use that vertex
 	void CalculateNormals();
+
+	// Calculates the bounding box and sphere used for culling
+	void CalculateBounds();
+
+	// Builds the per-vertex tangent frames the normal maps need
+	void CalculateTangents();
+
+	// Loads <base>_normal next to a material's texture, if there is one
+	void FindNormalMap(int matindex, const char *base);
 };
 
 #endif MODEL_3DS_H
\ No newline at end of file
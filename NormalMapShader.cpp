@@ -0,0 +1,131 @@
+// ---------------- NORMAL MAPPED MATERIALS ----------------
+// See NormalMapShader.h.
+
+#include "glew.h"
+#include "NormalMapShader.h"
+#include <stdio.h>
+
+bool normalMapping = true;
+
+// Clear of the attribute slots NVIDIA aliases to the built-ins
+static const GLuint TANGENT_ATTRIB = 6;
+static const int SHADED_LIGHTS = 3;   // GL_LIGHT0 (sun) and the two chest room torches
+
+static GLuint g_normalMapProgram = 0;
+static GLint g_lightEnabledLoc = -1, g_colorMaterialLoc = -1;
+static bool g_normalMapReady = false;
+
+static const char* NORMAL_MAP_VERTEX =
+    "#version 120\n"
+    "attribute vec4 tangent;\n"
+    "varying vec3 eyePos, eyeNormal, eyeTangent, eyeBitangent;\n"
+    "void main() {\n"
+    "    gl_Position = ftransform();\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    eyePos = vec3(gl_ModelViewMatrix * gl_Vertex);\n"
+    "    eyeNormal = normalize(gl_NormalMatrix * gl_Normal);\n"
+    "    eyeTangent = normalize(gl_NormalMatrix * tangent.xyz);\n"
+    "    eyeBitangent = tangent.w * cross(eyeNormal, eyeTangent);\n"
+    "}\n";
+
+// Same terms as fixed-function lighting without specular (the normal
+// mapped materials have none), then GL_MODULATE with the diffuse texture
+static const char* NORMAL_MAP_FRAGMENT =
+    "#version 120\n"
+    "uniform sampler2D diffuseMap, normalMap;\n"
+    "uniform float lightEnabled[3];\n"
+    "uniform bool colorMaterial;   // ambient and diffuse follow glColor\n"
+    "varying vec3 eyePos, eyeNormal, eyeTangent, eyeBitangent;\n"
+    "void main() {\n"
+    "    vec3 m = texture2D(normalMap, gl_TexCoord[0].st).xyz * 2.0 - 1.0;\n"
+    "    vec3 n = normalize(eyeTangent * m.x + eyeBitangent * m.y + eyeNormal * m.z);\n"
+    "    vec4 ambientMat = colorMaterial ? gl_Color : gl_FrontMaterial.ambient;\n"
+    "    vec4 diffuseMat = colorMaterial ? gl_Color : gl_FrontMaterial.diffuse;\n"
+    "    vec4 lit = gl_FrontMaterial.emission + gl_LightModel.ambient * ambientMat;\n"
+    "    for (int i = 0; i < 3; ++i) {\n"
+    "        vec4 lp = gl_LightSource[i].position;\n"
+    "        vec3 l = lp.xyz - eyePos * lp.w;\n"
+    "        float d = length(l);\n"
+    "        float att = lp.w == 0.0 ? 1.0 : 1.0 / (gl_LightSource[i].constantAttenuation + d * (gl_LightSource[i].linearAttenuation + d * gl_LightSource[i].quadraticAttenuation));\n"
+    "        lit += lightEnabled[i] * att * (gl_LightSource[i].ambient * ambientMat + max(dot(n, l / max(d, 1e-4)), 0.0) * gl_LightSource[i].diffuse * diffuseMat);\n"
+    "    }\n"
+    "    lit = clamp(lit, 0.0, 1.0);\n"
+    "    lit.a = diffuseMat.a;\n"
+    "    gl_FragColor = lit * texture2D(diffuseMap, gl_TexCoord[0].st);\n"
+    "}\n";
+
+static GLuint CompileShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, 0);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024]; glGetShaderInfoLog(shader, sizeof(log), 0, log);
+        printf("Normal map shader failed to compile:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool InitNormalMapShader() {
+    if (!GLEW_VERSION_2_0) return false;
+    GLuint vertex = CompileShader(GL_VERTEX_SHADER, NORMAL_MAP_VERTEX);
+    GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, NORMAL_MAP_FRAGMENT);
+    if (!vertex || !fragment) {
+        if (vertex) glDeleteShader(vertex);
+        if (fragment) glDeleteShader(fragment);
+        return false;
+    }
+    g_normalMapProgram = glCreateProgram();
+    glAttachShader(g_normalMapProgram, vertex);
+    glAttachShader(g_normalMapProgram, fragment);
+    glBindAttribLocation(g_normalMapProgram, TANGENT_ATTRIB, "tangent");
+    glLinkProgram(g_normalMapProgram);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    GLint ok = 0;
+    glGetProgramiv(g_normalMapProgram, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        printf("Normal map shader failed to link\n");
+        glDeleteProgram(g_normalMapProgram); g_normalMapProgram = 0;
+        return false;
+    }
+
+    glUseProgram(g_normalMapProgram);
+    glUniform1i(glGetUniformLocation(g_normalMapProgram, "diffuseMap"), 0);
+    glUniform1i(glGetUniformLocation(g_normalMapProgram, "normalMap"), 1);
+    g_lightEnabledLoc = glGetUniformLocation(g_normalMapProgram, "lightEnabled");
+    g_colorMaterialLoc = glGetUniformLocation(g_normalMapProgram, "colorMaterial");
+    glUseProgram(0);
+    g_normalMapReady = true;
+    return true;
+}
+
+bool BeginNormalMapped(unsigned int normalMap, const float* tangents) {
+    if (!normalMapping || !g_normalMapReady || !normalMap || !tangents || !glIsEnabled(GL_LIGHTING)) return false;
+    glUseProgram(g_normalMapProgram);
+
+    // The shader cannot see which lights are switched on
+    float enabled[SHADED_LIGHTS];
+    for (int i = 0; i < SHADED_LIGHTS; ++i) enabled[i] = glIsEnabled(GL_LIGHT0 + i) ? 1.0f : 0.0f;
+    glUniform1fv(g_lightEnabledLoc, SHADED_LIGHTS, enabled);
+    glUniform1i(g_colorMaterialLoc, glIsEnabled(GL_COLOR_MATERIAL) ? 1 : 0);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, normalMap);
+    glActiveTexture(GL_TEXTURE0);
+    glEnableVertexAttribArray(TANGENT_ATTRIB);
+    glVertexAttribPointer(TANGENT_ATTRIB, 4, GL_FLOAT, GL_FALSE, 0, tangents);
+    return true;
+}
+
+void EndNormalMapped() {
+    glDisableVertexAttribArray(TANGENT_ATTRIB);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glUseProgram(0);
+}
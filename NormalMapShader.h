@@ -0,0 +1,26 @@
+// ---------------- NORMAL MAPPED MATERIALS ----------------
+// Shader path for Model_3DS materials that have a normal map. It does what
+// fixed-function lighting does for the game's lights (GL_LIGHT0-2, global
+// ambient, colour material, texture modulate) but with the normal read
+// from the map and turned into eye space through the vertex tangent frame
+// (Tangents.h). Position goes through ftransform(), so depth matches the
+// fixed-function draws around it and the depth-based passes after it.
+//
+// Needs GL 2.0; InitNormalMapShader reports false without it and every
+// material keeps drawing fixed-function.
+
+#ifndef NORMAL_MAP_SHADER_H
+#define NORMAL_MAP_SHADER_H
+
+extern bool normalMapping;   // 'N' switches normal maps off to compare
+
+bool InitNormalMapShader();
+
+// Binds the shader, the normal map on texture unit 1 and the tangent array
+// for the next glDrawElements. Returns false, changing nothing, when normal
+// mapping is off or unavailable or lighting is disabled (shadow casters,
+// unlit draws); the caller then draws as before.
+bool BeginNormalMapped(unsigned int normalMap, const float* tangents);
+void EndNormalMapped();
+
+#endif // NORMAL_MAP_SHADER_H
@@ -1,117 +1,97 @@
 #include <vector>
+#include <algorithm>
 #include <ctime>
 #include "TextureBuilder.h"
 #include "Model_3DS.h"
 #include "GLTexture.h"
+#include "GameWorld.h"
+#include "Jobs.h"
+#include "Culling.h"
+#include "GeometryCache.h"
+#include "TextBatch.h"
+#include "LightingShader.h"
+#include "ShadowMaps.h"
+#include "NormalMapShader.h"
+#include "Capture.h"
+#include "Snapshot.h"
+#include "Audio.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "Telemetry.h"
+#include "InputJournal.h"
+#include "FramePacer.h"
 #include <glut.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <Windows.h>
-#include <mmsystem.h>
 #include <string>
-
-// Link the Windows Multimedia library for sound
-#pragma comment(lib, "winmm.lib")
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <direct.h>
 
 #define WIDTH 1280
 #define HEIGHT 720
-#define PI 3.1415926535f
-
-// ===== GAME STATE ENUMERATION =====
-enum GameState { MENU, LEVEL_1, WIN, LOSE, LEVEL_2 };
-GameState gameState = MENU; // Start in Menu
 
 // ---------------- SOUND CONFIGURATION ----------------
-static const wchar_t* ALIAS_MUSIC1 = L"music_lvl1";
-static const wchar_t* ALIAS_MUSIC2 = L"music_lvl2";
-
-static const wchar_t* ALIAS_WIN = L"s_win";
-static const wchar_t* ALIAS_LOSE = L"s_lose";
-
-static const wchar_t* ALIAS_COIN_PICKUP = L"s_coin";
-static const wchar_t* ALIAS_MAP_PICKUP = L"s_ma_pickup";
-static const wchar_t* ALIAS_COLLISION = L"s_collision";
-static const wchar_t* ALIAS_GAMEOVER = L"s_gameover";
-static const wchar_t* ALIAS_NPC_INTERACT = L"s_npc_interact";
-static const wchar_t* ALIAS_BOAT_INTERACT = L"s_boat_interact";
-static const wchar_t* ALIAS_JUMP = L"s_jump";
-static const wchar_t* ALIAS_OOF = L"s_oof";
-
-// --- SOUND PATHS ---
-static const wchar_t* PATH_OOF = L"SFX/oof.mp3";
-static const wchar_t* PATH_MUSIC1 = L"SFX/music_one.mp3";
-static const wchar_t* PATH_MUSIC2 = L"SFX/music_two.mp3";
-static const wchar_t* PATH_WIN = L"SFX/win.mp3";
-static const wchar_t* PATH_LOSE = L"SFX/lose.mp3";
-static const wchar_t* PATH_COIN_PICKUP = L"SFX/Coin-Gem Found.mp3";
-static const wchar_t* PATH_MAP_PICKUP = L"SFX/Map Found.mp3";
-static const wchar_t* PATH_NPC_INTERACT = L"SFX/Interact With Npc.mp3";
-static const wchar_t* PATH_BOAT_INTERACT = L"SFX/Boat-Interact.mp3";
-static const wchar_t* PATH_JUMP = L"SFX/Jump.mp3";
-static const wchar_t* PATH_COLLISION = L"SFX/hit-soundvideo-game-type-230510.mp3";
-static const wchar_t* PATH_GAMEOVER = L"SFX/game-over-38511.mp3";
-
-static bool showBoatInsufficient = false;
-static bool soundsInitialized = false;
-static bool gameOverSoundPlayed = false;
-static bool winSoundPlayed = false;
-static bool loseSoundPlayed = false;
+// Indexed by SoundId (GameWorld.h), which is also the clip or music track
+// id (Audio.h). Music is streamed; everything else is decoded once at
+// start-up, with the number of voices it may overlap with itself and its
+// priority when the mixer's pool is full (outcomes outrank pickups).
+struct SoundConfig { const wchar_t* path; bool streamed; int maxVoices; int priority; };
+static const SoundConfig SOUNDS[SND_COUNT] = {
+    { L"SFX/music_one.mp3", true, 1, 3 },                        // SND_MUSIC1
+    { L"SFX/music_two.mp3", true, 1, 3 },                        // SND_MUSIC2
+    { L"SFX/win.mp3", false, 1, 3 },                             // SND_WIN
+    { L"SFX/lose.mp3", false, 1, 3 },                            // SND_LOSE
+    { L"SFX/Coin-Gem Found.mp3", false, 4, 1 },                  // SND_COIN_PICKUP: back-to-back coins overlap
+    { L"SFX/Map Found.mp3", false, 1, 2 },                       // SND_MAP_PICKUP
+    { L"SFX/hit-soundvideo-game-type-230510.mp3", false, 2, 1 }, // SND_COLLISION
+    { L"SFX/game-over-38511.mp3", false, 1, 3 },                 // SND_GAMEOVER
+    { L"SFX/Interact With Npc.mp3", false, 1, 2 },               // SND_NPC_INTERACT
+    { L"SFX/Boat-Interact.mp3", false, 1, 2 },                   // SND_BOAT_INTERACT
+    { L"SFX/Jump.mp3", false, 2, 1 },                            // SND_JUMP: a double jump keeps the first one
+    { L"SFX/oof.mp3", false, 2, 1 }                              // SND_OOF
+};
 
-static int lastCollisionTime = 0;
-const int COLLISION_SOUND_COOLDOWN = 300;
+static bool soundsInitialized = false;
 
 // ---------------- SOUND HELPER FUNCTIONS ----------------
-static void MciOpen(const wchar_t* alias, const wchar_t* path) {
-    std::wstring cmd = L"open \""; cmd += path; cmd += L"\" type mpegvideo alias "; cmd += alias;
-    mciSendStringW(cmd.c_str(), nullptr, 0, nullptr);
-}
-static void MciClose(const wchar_t* alias) {
-    std::wstring cmd = L"close "; cmd += alias; mciSendStringW(cmd.c_str(), nullptr, 0, nullptr);
-}
-static void MciStop(const wchar_t* alias) {
-    std::wstring cmd = L"stop "; cmd += alias; mciSendStringW(cmd.c_str(), nullptr, 0, nullptr);
-}
-static void MciPlayLoop(const wchar_t* alias) {
-    std::wstring cmd = L"play "; cmd += alias; cmd += L" repeat"; mciSendStringW(cmd.c_str(), nullptr, 0, nullptr);
-}
-static void MciPlayOnce(const wchar_t* alias) {
-    std::wstring stopCmd = L"stop "; stopCmd += alias;
-    mciSendStringW(stopCmd.c_str(), nullptr, 0, nullptr);
-    std::wstring seekCmd = L"seek "; seekCmd += alias; seekCmd += L" to start";
-    mciSendStringW(seekCmd.c_str(), nullptr, 0, nullptr);
-    std::wstring playCmd = L"play "; playCmd += alias;
-    mciSendStringW(playCmd.c_str(), nullptr, 0, nullptr);
-}
-
+// Without a device the mixer still runs, into the null sink, so the game
+// behaves the same with or without sound
 static void Sound_Init() {
     if (soundsInitialized) return;
-    MciOpen(ALIAS_MUSIC1, PATH_MUSIC1);
-    MciOpen(ALIAS_MUSIC2, PATH_MUSIC2);
-    MciOpen(ALIAS_WIN, PATH_WIN);
-    MciOpen(ALIAS_LOSE, PATH_LOSE);
-
-    MciOpen(ALIAS_COIN_PICKUP, PATH_COIN_PICKUP);
-    MciOpen(ALIAS_MAP_PICKUP, PATH_MAP_PICKUP);
-    MciOpen(ALIAS_COLLISION, PATH_COLLISION);
-    MciOpen(ALIAS_GAMEOVER, PATH_GAMEOVER);
-    MciOpen(ALIAS_NPC_INTERACT, PATH_NPC_INTERACT);
-    MciOpen(ALIAS_BOAT_INTERACT, PATH_BOAT_INTERACT);
-    MciOpen(ALIAS_JUMP, PATH_JUMP);
-    MciOpen(ALIAS_OOF, PATH_OOF);
+    for (int id = 0; id < SND_COUNT; ++id) {
+        const SoundConfig& sound = SOUNDS[id];
+        if (sound.streamed) { SetMusicTrack(id, sound.path); continue; }
+        if (!LoadAudioClip(id, sound.path)) wprintf(L"Could not decode %ls\n", sound.path);
+        SetClipLimits(id, sound.maxVoices, sound.priority);
+    }
+    if (!StartAudio(AUDIO_DEVICE)) StartAudio(AUDIO_NULL);
     soundsInitialized = true;
 }
 static void Sound_Shutdown() {
-    MciClose(ALIAS_GAMEOVER); MciClose(ALIAS_COLLISION); MciClose(ALIAS_BOAT_INTERACT);
-    MciClose(ALIAS_NPC_INTERACT); MciClose(ALIAS_MAP_PICKUP); MciClose(ALIAS_COIN_PICKUP);
-    MciClose(ALIAS_JUMP);
-    MciClose(ALIAS_WIN);
-    MciClose(ALIAS_LOSE);
-    MciClose(ALIAS_MUSIC1);
-    MciClose(ALIAS_MUSIC2);
-    MciClose(ALIAS_OOF);
+    StopAudio();
 }
 
+// ---------------- GAME WORLD HOOKS ----------------
+// The hooks run on the simulation thread; Audio.h only queues a command
+// for the mixer or the music streamer, so they call it directly
+static const int CTR_AUDIO_TRIGGERS = RegisterCounter("audio_triggers", "Sound effects started by the game.");
+void Game_PlaySound(SoundId id) { PlayClip(id); CountAdd(CTR_AUDIO_TRIGGERS); }
+void Game_PlayMusic(SoundId id, int fadeMs) { PlayMusic(id, fadeMs); }
+void Game_StopMusic(int fadeMs) { StopMusic(fadeMs); }
+// The game clock is when the current tick started, so everything in one
+// tick sees the same time and a replay can set it from the journal.
+// Not GLUT_ELAPSED_TIME: GLUT may only be called from the main thread
+static const std::chrono::steady_clock::time_point g_startTime = std::chrono::steady_clock::now();
+static int g_tickMs = 0;
+static int WallClockMs() { return (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - g_startTime).count(); }
+int Game_ElapsedMs() { return g_tickMs; }
+
 
 // ---------------- GLOBAL VARIABLES ----------------
 GLuint tex;
@@ -129,135 +109,21 @@ GLTexture tex_win_bg;
 GLTexture tex_lose_bg;
 
 char title[] = "Pirate's Run - Multi-Level";
-static const float LAND_SIZE = 300.0f;
-static const float WORLD_SIZE = LAND_SIZE + 100.0f;
-static const float GROUND_Y = 0.0f;
-static const float WATER_Y = -2.0f;
-
-// --- SUN MOVEMENT VARIABLES ---
-float sunAngle = 0.0f;      // Rotation angle
-float sunSpeed = 0.3f;      // Speed of day/night cycle
-float sunRadius = 250.0f;   // Distance from center
-
-// ---------------- LEVEL 1 OBJECTS ----------------
-struct MapInstance { float x, y, z; float scale; float spinDeg; bool placed; };
-static MapInstance g_mapRoad = { 0.0f, 1.0f, 0.0f, 2.0f, 0.0f, false };
-static bool hasMap = false;
-
-struct NPCInstance { float x, y, z; float yawDeg; float scale; bool placed; };
-static NPCInstance g_npc = { 5.0f, 0.0f, 5.0f, 180.0f, 0.02f, true };
-struct TreasureInstance { float x, y, z; float yawDeg; float scale; };
-static std::vector<TreasureInstance> g_treasures;
-
-static bool showInteractPrompt = false;
-static bool showNPCDialogue = false;
-static float dialogueTimer = 0.0f;
-static const float DIALOGUE_DURATION = 5.0f;
-static const float NPC_INTERACT_DISTANCE = 5.0f;
-
-struct BoatInstance { float x, y, z; float yawDeg; float scale; bool placed; };
-static BoatInstance g_boat = { 0.0f, GROUND_Y, 0.0f, 0.0f, 1.0f, false };
-
-static bool showBoatPrompt = false;
-static bool showBoatDialogue = false;
-static bool showBoatDialogue2 = false;
-static float boatDialogueTimer = 0.0f;
-
-static const float BOAT_INTERACT_DISTANCE = 30.0f;
-
-static bool paidForBoat = false;
-static const int BOAT_COST = 10;
-
-// Level 1 Environment Instances
-struct TreeInstance { float x, y, z; float yawDeg; float scale; };
-static std::vector<TreeInstance> g_trees;
-struct HouseInstance { float x, y, z; float yawDeg; float scale; };
-static std::vector<HouseInstance> g_houses;
-struct RockInstance { float x, y, z; float yawDeg; float scale; int modelIndex; };
-static std::vector<RockInstance> g_rocks;
-struct CoinInstance { float x, y, z; float spinDeg; float scale; bool active; };
-static std::vector<CoinInstance> g_coins;
-struct GemInstance { float x, y, z; float spinDeg; float scale; bool active; };
-static std::vector<GemInstance> g_gems;
-
-
-// Level 1 Platforms
-struct Platform { float x, y, z, size; };
-static constexpr int PLATFORM_COUNT = 9;
-static Platform g_platforms[PLATFORM_COUNT] = {
-    { (WORLD_SIZE * 0.5f) - 8.0f, 2.0f, (WORLD_SIZE * 0.5f) - 6.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) + 6.0f, 4.0f, (WORLD_SIZE * 0.5f) - 3.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) - 5.0f, 6.4f, (WORLD_SIZE * 0.5f) + 4.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) + 8.0f, 8.8f, (WORLD_SIZE * 0.5f) + 2.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) - 10.0f, 10.2f, (WORLD_SIZE * 0.5f) - 1.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) + 10.0f, 12.6f, (WORLD_SIZE * 0.5f) - 7.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) - 7.0f, 14.0f, (WORLD_SIZE * 0.5f) + 8.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) + 2.0f, 16.4f, (WORLD_SIZE * 0.5f) + 10.0f, 2.5f },
-    { (WORLD_SIZE * 0.5f) - 12.0f, 18.8f, (WORLD_SIZE * 0.5f) + 12.0f, 2.5f },
-};
-
-// ---------------- LEVEL 2 OBJECTS ----------------
-struct Lvl2Platform { float x, z, width, length, y; };
-static std::vector<Lvl2Platform> lvl2_platforms;
-
-struct Pendulum {
-    float pivotX, pivotY, pivotZ;
-    float length;
-    float currentAngle;
-    float maxAngle;
-    float speed;
-    bool axisZ; // true = side-to-side, false = front-to-back
-};
-static std::vector<Pendulum> lvl2_pendulums;
-
-// Level 1 & 2 Game Objects
-struct GameObject { float x, y, z; bool active; float r, g, b; };
-GameObject lvl2_key = { 40.0f, 2.0f, 80.0f, true, 1, 1, 0 }; // Level 2 Key
-
-struct Chest { float x, y, z; bool isOpen; };
-Chest lvl2_chest = { 0.0f, 2.0f, 130.0f, false }; // Level 2 Chest
-
-bool hasLvl2Key = false;
-int score = 1000; // Start at 1000
-// --- COIN STARTING VALUE ---
-int coinsCollected = 0;
-float gameTimer = 0.0f;
-int gemsCollected = 0;
-// --- LIVES SYSTEM ---
-int lives = 5;
-
-// Helper to handle player death (lose a life)
-static void HandlePlayerDeath() {
-    lives -= 1;
-    if (lives < 0) lives = 0;
-    // Scoring penalty on death
-    score -= 15;
-    if (score < 0) score = 0;
-    // Play collision sound
-    MciPlayOnce(ALIAS_OOF);
-    MciPlayOnce(ALIAS_COLLISION);
-    if (lives == 0) {
-        gameState = LOSE;
-        // --- UPDATED: Stop Music on Game Over ---
-        MciStop(ALIAS_MUSIC1);
-        MciStop(ALIAS_MUSIC2);
-        if (!loseSoundPlayed) {
-            MciPlayOnce(ALIAS_LOSE); loseSoundPlayed = true;
-        }
-    }
-}
 
-// ---------------- TRANSITION STATE ----------------
-static float fadeAlpha = 0.0f;
-static bool isFadingOut = false;
-static bool isFadingIn = false;
+// --capture draws into an offscreen WIDTH x HEIGHT target (Capture.h)
+// instead of the window; every pass sizes itself through these
+static bool g_capturing = false;
+static const unsigned CAPTURE_SEED = 1;   // same level layout every capture run
+static unsigned g_layoutSeed = 0;         // srand seed of the level layout, for --record
+static int ViewWidth() { return g_capturing ? WIDTH : glutGet(GLUT_WINDOW_WIDTH); }
+static int ViewHeight() { return g_capturing ? HEIGHT : glutGet(GLUT_WINDOW_HEIGHT); }
 
-// ---------------- CAMERA & PLAYER STATE ----------------
-float playerX = 2.0f;
-float playerZ = 2.0f;
-float playerY = 0.0f;
-float playerYaw = 0.0f;
+// Everything the renderer reads from the simulation comes from g_frame,
+// the newest snapshot at the start of myDisplay (Snapshot.h)
+static SnapshotBuffer g_snapshots;
+static const FrameSnapshot* g_frame = nullptr;
 
+// ---------------- CAMERA STATE ----------------
 float camYaw = 0.0f;
 float camPitch = 15.0f;
 float camDistance = 15.0f;
@@ -267,21 +133,6 @@ int lastMouseX = -1;
 int lastMouseY = -1;
 bool isTopDown = false;
 
-float velX = 0.0f, velZ = 0.0f;
-float velY = 0.0f;
-const float accel = 100.0f;
-const float maxSpeed = 24.0f;
-const float frictionGround = 100.0f;
-const float frictionAir = 75.0f;
-const float gravity = 15.0f;
-const float jumpImpulse = 7.0f;
-const float maxFallSpeed = -15.0f;
-
-bool keyW = false, keyA = false, keyS = false, keyD = false;
-bool spaceTrigger = false;
-bool grounded = true;
-int jumpCount = 0;
-
 // ---------------- MODELS ----------------
 Model_3DS model_pirate;
 Model_3DS model_key;
@@ -296,172 +147,189 @@ Model_3DS model_torch;
 Model_3DS model_chest_3d;
 Model_3DS model_test;
 
-// ---------------- HELPER FUNCTIONS & COLLISION ----------------
-
-static float frand(float minV, float maxV) { return minV + (maxV - minV) * (rand() / (float)RAND_MAX); }
-
-static bool IsOnLevel2Platform(float x, float z) {
-    for (const auto& p : lvl2_platforms) {
-        float halfW = p.width / 2.0f;
-        float halfL = p.length / 2.0f;
-        if (x >= (p.x - halfW) && x <= (p.x + halfW) && z >= (p.z - halfL) && z <= (p.z + halfL)) return true;
+// Materials with a normal map draw through NormalMapShader.h; 'N' toggles
+static bool g_normalMapsAvailable = false;   // GL 2.0, see InitNormalMapShader
+
+// Normal mapped materials over every model, and what Load spent on tangents
+static void NormalMapStats(int& materials, float& tangentMs) {
+    const Model_3DS* models[] = { &model_pirate, &model_key, &model_rocks[0], &model_rocks[1], &model_rocks[2], &model_rocks[3], &model_rocks[4],
+        &model_houses, &model_tree, &model_map, &model_boat, &model_palet, &model_spike, &model_torch, &model_chest_3d, &model_test };
+    materials = 0; tangentMs = 0.0f;
+    for (const Model_3DS* m : models) {
+        tangentMs += m->tangentMs;
+        for (int i = 0; i < m->numMaterials; ++i) if (m->Materials[i].normalMapped) materials++;
     }
-    return false;
 }
 
-static inline bool IsOverLand(float x, float z) {
-    if (gameState == LEVEL_2) return IsOnLevel2Platform(x, z);
-    return x >= 0.0f && x <= LAND_SIZE && z >= 0.0f && z <= LAND_SIZE;
+// ---------------- VIEW CULLING ----------------
+Frustum g_viewFrustum;
+CullStats g_cullStats;
+bool showRenderStats = false;   // 'P' toggles the stats overlay
+bool showProfiler = false;      // 'F' toggles the profiler overlay, 'J' writes profile.json
+
+// Rocks, houses and trees never move after LoadAssets, so they live in a
+// cell grid (see Culling.h); everything else is tested one sphere at a time.
+enum StaticKind { STATIC_ROCK, STATIC_HOUSE, STATIC_TREE };
+struct StaticRef { int kind; int index; };
+static CullGrid g_staticCull;
+static std::vector<StaticRef> g_staticRefs;
+static std::vector<int> g_visibleStatic;    // reused every frame
+
+// Level 1 houses and the boat are drawn into a small software depth buffer
+// before anything else; rocks, trees, coins and props behind them are
+// skipped. 'O' switches it off to compare.
+static const int OCCLUSION_WIDTH = 160, OCCLUSION_HEIGHT = 90;
+static const float OCCLUDER_SHRINK = 0.6f;   // occluder box vs model bounds, keeps it inside the mesh
+static const int COIN_TRIANGLES = 80;        // DrawCustomCoin: 20-slice rim and two disks
+static const int GEM_TRIANGLES = 8;          // DrawGem: octahedron
+bool occlusionCulling = true;
+OcclusionStats g_occlusionStats;
+static OcclusionBuffer g_occlusion;
+static bool g_occlusionReady = false;        // buffer holds this frame's occluders
+static float g_viewClip[16];
+static float g_viewMatrix[16], g_projMatrix[16];   // as the camera left them, for the light pass
+static std::vector<OccluderBox> g_houseOccluders;
+
+// Model-space point through translate(x,y,z), rotate(yawDeg, Y),
+// rotate(pitchDeg, X), uniform scale
+static void ModelToWorld(float px, float py, float pz, float x, float y, float z, float yawDeg, float pitchDeg, float scale, float out[3]) {
+    const float p = pitchDeg * PI / 180.0f, yaw = yawDeg * PI / 180.0f;
+    float cy = py * cosf(p) - pz * sinf(p);
+    float cz = py * sinf(p) + pz * cosf(p);
+    float rx = px * cosf(yaw) + cz * sinf(yaw);
+    float rz = -px * sinf(yaw) + cz * cosf(yaw);
+    out[0] = x + rx * scale; out[1] = y + cy * scale; out[2] = z + rz * scale;
 }
 
-static inline bool CollidesWithTree(float x, float z, float radius) {
-    if (gameState != LEVEL_1) return false;
-    const float minDist2 = pow(radius + 1.5f, 2);
-    for (const auto& t : g_trees) if ((pow(x - t.x, 2) + pow(z - t.z, 2)) < minDist2) return true;
-    return false;
-}
-//static inline bool CollidesWithTree(float x, float z, float radius) {
-    //if (gameState != LEVEL_1) return false;
-    //const float minDist2 = pow(radius + 1.5f, 2);
-    //for (const auto& t : g_trees) if ((pow(x - t.x, 2) + pow(z - t.z, 2)) < minDist2) return true;
-    //return false;
-//}
-static inline bool CollidesWithRock(float x, float z, float radius) {
-    if (gameState != LEVEL_1) return false;
-    const float minDist2 = pow(radius + 2.0f, 2);
-    for (const auto& r : g_rocks) if ((pow(x - r.x, 2) + pow(z - r.z, 2)) < minDist2) return true;
-    return false;
-}
-static inline bool CollidesWithHouse(float x, float z, float radius) {
-    if (gameState != LEVEL_1) return false;
-    const float minDist2 = pow(radius + 3.5f, 2);
-    for (const auto& h : g_houses) if ((pow(x - h.x, 2) + pow(z - h.z, 2)) < minDist2) return true;
-    return false;
-}
-static inline bool CollidesWithBoat(float x, float z, float radius) {
-    if (gameState != LEVEL_1 || !g_boat.placed) return false;
-    return ((pow(x - g_boat.x, 2) + pow(z - g_boat.z, 2)) < pow(radius + 4.0f, 2));
-}
-static inline bool CollidesWithNPC(float x, float z, float radius) {
-    if (gameState != LEVEL_1 || !g_npc.placed) return false;
-    return ((pow(x - g_npc.x, 2) + pow(z - g_npc.z, 2)) < pow(radius + 1.0f, 2));
+// World sphere of a model drawn with the ModelToWorld transform
+static BoundSphere ModelSphere(const Model_3DS& m, float x, float y, float z, float yawDeg, float pitchDeg, float scale) {
+    float c[3];
+    ModelToWorld(m.boundsCenter.x, m.boundsCenter.y, m.boundsCenter.z, x, y, z, yawDeg, pitchDeg, scale, c);
+    BoundSphere s = { c[0], c[1], c[2], m.boundsRadius * scale };
+    return s;
 }
 
-static inline bool CollidesWithAnyObject(float x, float z, float radius) {
-    return CollidesWithTree(x, z, radius) || CollidesWithRock(x, z, radius) || CollidesWithHouse(x, z, radius);
-}
-static inline bool CollidesWithNPCSilent(float x, float z, float radius) {
-    return CollidesWithNPC(x, z, radius);
+// Model bounds shrunk by OCCLUDER_SHRINK around their centre, as an
+// oriented world box for the occlusion buffer
+static OccluderBox ModelOccluderBox(const Model_3DS& m, float x, float y, float z, float yawDeg, float pitchDeg, float scale) {
+    OccluderBox box;
+    const float lo[3] = { m.boundsMin.x, m.boundsMin.y, m.boundsMin.z }, hi[3] = { m.boundsMax.x, m.boundsMax.y, m.boundsMax.z };
+    float a[3], b[3];
+    for (int k = 0; k < 3; ++k) {
+        const float mid = (lo[k] + hi[k]) * 0.5f, half = (hi[k] - lo[k]) * 0.5f * OCCLUDER_SHRINK;
+        a[k] = mid - half; b[k] = mid + half;
+    }
+    for (int i = 0; i < 8; ++i)
+        ModelToWorld((i & 1) ? b[0] : a[0], (i & 2) ? b[1] : a[1], (i & 4) ? b[2] : a[2], x, y, z, yawDeg, pitchDeg, scale, box.corners[i]);
+    return box;
 }
-static inline bool CollidesWithBoatSilent(float x, float z, float radius) {
-    return CollidesWithBoat(x, z, radius);
+
+// Sphere around the model's origin that holds for any rotation, for
+// models that swing or spin every frame
+static BoundSphere LooseModelSphere(const Model_3DS& m, float x, float y, float z, float scale) {
+    const float c = sqrtf(m.boundsCenter.x * m.boundsCenter.x + m.boundsCenter.y * m.boundsCenter.y + m.boundsCenter.z * m.boundsCenter.z);
+    BoundSphere s = { x, y, z, (c + m.boundsRadius) * scale };
+    return s;
 }
 
-// Helper: Level 2 Pendulum Collision
-static bool CollidesWithPendulum(float x, float z, float y, float radius) {
-    if (gameState != LEVEL_2) return false;
-    for (const auto& p : lvl2_pendulums) {
-        float rad = p.currentAngle * PI / 180.0f;
-        float spikeX = p.pivotX;
-        float spikeY = p.pivotY - p.length * cos(rad);
-        float spikeZ = p.pivotZ;
+static bool CullSphere(const BoundSphere& s) {
+    if (SphereInFrustum(g_viewFrustum, s.x, s.y, s.z, s.radius)) { g_cullStats.visible++; return true; }
+    g_cullStats.culled++;
+    return false;
+}
 
-        if (p.axisZ) spikeX += p.length * sin(rad);
-        else spikeZ += p.length * sin(rad);
+// True if s is hidden behind this frame's occluders; triangles is what
+// drawing it would have cost
+static bool Occluded(const BoundSphere& s, int triangles) {
+    if (!g_occlusionReady) return false;
+    g_occlusionStats.tested++;
+    if (!SphereOccluded(g_occlusion, s.x, s.y, s.z, s.radius)) return false;
+    g_occlusionStats.occluded++;
+    g_occlusionStats.trianglesSkipped += triangles;
+    return true;
+}
 
-        float dist = sqrt(pow(x - spikeX, 2) + pow(y + 1.0f - spikeY, 2) + pow(z - spikeZ, 2));
+// Call right after the camera is set up; the modelview holds only the view
+static void UpdateViewFrustum() {
+    glGetFloatv(GL_PROJECTION_MATRIX, g_projMatrix);
+    glGetFloatv(GL_MODELVIEW_MATRIX, g_viewMatrix);
+    MultiplyMatrix4(g_projMatrix, g_viewMatrix, g_viewClip);
+    ExtractFrustum(g_viewClip, g_viewFrustum);
+    g_cullStats.visible = 0; g_cullStats.culled = 0;
+    g_occlusionStats = OcclusionStats{ 0, 0, 0, 0 };
+    g_occlusionReady = false;
+}
 
-        // Extended hitbox radius
-        if (dist < (3.5f + radius)) return true;
+static void BuildStaticCullGrid() {
+    std::vector<BoundSphere> spheres;
+    g_staticRefs.clear();
+    g_houseOccluders.clear();
+    for (int i = 0; i < (int)g_rocks.size(); ++i) {
+        const RockInstance& r = g_rocks[i];
+        spheres.push_back(ModelSphere(model_rocks[r.modelIndex], r.x, r.y, r.z, r.yawDeg, 0.0f, r.scale));
+        g_staticRefs.push_back(StaticRef{ STATIC_ROCK, i });
     }
-    return false;
+    for (int i = 0; i < (int)g_houses.size(); ++i) {
+        const HouseInstance& h = g_houses[i];
+        spheres.push_back(ModelSphere(model_houses, h.x, h.y, h.z, h.yawDeg, 90.0f, h.scale));
+        g_staticRefs.push_back(StaticRef{ STATIC_HOUSE, i });
+        g_houseOccluders.push_back(ModelOccluderBox(model_houses, h.x, h.y, h.z, h.yawDeg, 90.0f, h.scale));
+    }
+    for (int i = 0; i < (int)g_trees.size(); ++i) {
+        const TreeInstance& t = g_trees[i];
+        spheres.push_back(ModelSphere(model_tree, t.x, t.y, t.z, 0.0f, 0.0f, t.scale + 1));
+        g_staticRefs.push_back(StaticRef{ STATIC_TREE, i });
+    }
+    BuildCullGrid(g_staticCull, spheres, 50.0f);
 }
 
-// ---------------- LEVEL 1 PLACEMENT FUNCTIONS ----------------
-
-static void PlaceBoatAtEdge() {
-    g_boat.x = LAND_SIZE / 2.0f;
-    g_boat.z = LAND_SIZE - 5.0f;
-    g_boat.y = GROUND_Y + 0.5f;
-    g_boat.yawDeg = 180.0f;
-    g_boat.scale = 1.0f;
-    g_boat.placed = true;
-}
-static void placeTreasurePiles() {
-    g_treasures.clear();
-	g_treasures.push_back({ 150.0f, 0.0f, 150.0f, 45.0f, 0.05f });
-
-}
-
-static inline bool InStreetZone(float x, float z) {
-    const float centerX = WORLD_SIZE * 0.5f;
-    const float centerZ = WORLD_SIZE * 0.5f;
-    const float halfX = (16.0f * 0.5f) + 12.0f + 6.0f;
-    const float halfZ = (6.0f * 2.0f) + 3.0f;
-    return (x >= (centerX - halfX) && x <= (centerX + halfX) && z >= (centerZ - halfZ) && z <= (centerZ + halfZ));
-}
-
-static void PlacePirateMapInRoad() {
-    const float centerX = (WORLD_SIZE * 0.5f) - 12.0f;
-    const float centerZ = (WORLD_SIZE * 0.5f) + 12.0f;
-    g_mapRoad.x = centerX; g_mapRoad.z = centerZ; g_mapRoad.y = 20.8f;
-    g_mapRoad.scale = 0.1f; g_mapRoad.spinDeg = 0.0f; g_mapRoad.placed = true;
-}
-
-void PlaceTreesRandom(int count) {
-    g_trees.clear();
-    std::vector<TreeInstance> fixedTrees = {
-        {20.0f, 0.0f, 20.0f, 45.0f, 0.40f}, {280.0f, 0.0f, 20.0f, 90.0f, 0.40f},
-        {20.0f, 0.0f, 280.0f, 135.0f, 0.40f}, {280.0f, 0.0f, 280.0f, 180.0f, 0.40f},
-        {35.0f, 0.0f, 45.0f, 225.0f, 0.40f}, {65.0f, 0.0f, 30.0f, 270.0f, 0.40f},
-        {50.0f, 0.0f, 75.0f, 315.0f, 0.40f}, {235.0f, 0.0f, 45.0f, 0.0f, 0.40f},
-        {265.0f, 0.0f, 30.0f, 45.0f, 0.40f}, {250.0f, 0.0f, 75.0f, 90.0f, 0.40f},
-        {35.0f, 0.0f, 255.0f, 135.0f, 0.40f}, {65.0f, 0.0f, 270.0f, 180.0f, 0.40f},
-        {50.0f, 0.0f, 225.0f, 225.0f, 0.40f}, {235.0f, 0.0f, 255.0f, 270.0f, 0.40f},
-        {265.0f, 0.0f, 270.0f, 315.0f, 0.40f}, {250.0f, 0.0f, 225.0f, 0.0f, 0.40f},
-        {30.0f, 0.0f, 100.0f, 45.0f, 0.40f}, {40.0f, 0.0f, 150.0f, 90.0f, 0.40f},
-        {30.0f, 0.0f, 200.0f, 135.0f, 0.40f}, {270.0f, 0.0f, 100.0f, 180.0f, 0.40f},
-        {260.0f, 0.0f, 150.0f, 225.0f, 0.40f}, {270.0f, 0.0f, 200.0f, 270.0f, 0.40f},
-        {80.0f, 0.0f, 25.0f, 315.0f, 0.40f}, {120.0f, 0.0f, 35.0f, 0.0f, 0.40f},
-        {160.0f, 0.0f, 30.0f, 45.0f, 0.40f}, {200.0f, 0.0f, 25.0f, 90.0f, 0.40f},
-        {220.0f, 0.0f, 40.0f, 135.0f, 0.40f}, {80.0f, 0.0f, 275.0f, 180.0f, 0.40f},
-        {120.0f, 0.0f, 285.0f, 225.0f, 0.40f}, {160.0f, 0.0f, 280.0f, 270.0f, 0.40f},
-        {200.0f, 0.0f, 275.0f, 315.0f, 0.40f}, {220.0f, 0.0f, 290.0f, 0.0f, 0.40f},
-        {90.0f, 0.0f, 90.0f, 45.0f, 0.40f}, {210.0f, 0.0f, 90.0f, 90.0f, 0.40f},
-        {90.0f, 0.0f, 210.0f, 135.0f, 0.40f}, {210.0f, 0.0f, 210.0f, 180.0f, 0.40f},
-        {75.0f, 0.0f, 130.0f, 225.0f, 0.40f}, {225.0f, 0.0f, 130.0f, 270.0f, 0.40f},
-        {75.0f, 0.0f, 170.0f, 315.0f, 0.40f}, {225.0f, 0.0f, 170.0f, 0.0f, 0.40f},
-        {110.0f, 0.0f, 60.0f, 45.0f, 0.40f}, {190.0f, 0.0f, 60.0f, 90.0f, 0.40f},
-        {110.0f, 0.0f, 240.0f, 135.0f, 0.40f}, {190.0f, 0.0f, 240.0f, 180.0f, 0.40f},
-        {140.0f, 0.0f, 100.0f, 225.0f, 0.40f}, {160.0f, 0.0f, 200.0f, 270.0f, 0.40f},
-        {55.0f, 0.0f, 110.0f, 315.0f, 0.40f}, {245.0f, 0.0f, 110.0f, 0.0f, 0.40f},
-        {55.0f, 0.0f, 190.0f, 45.0f, 0.40f}, {245.0f, 0.0f, 190.0f, 90.0f, 0.40f}
+// Fills g_visibleStatic. The grid's cells are culled in jobs, each chunk
+// into its own list; a sort job that waits for all of them joins the lists
+// and orders the draws by model, then front to back, so each model is set
+// up once and near instances fill the depth buffer first.
+static const int CULL_CELLS_PER_JOB = 8;
+static std::vector<std::vector<int> > g_cullChunkVisible;
+static std::vector<CullStats> g_cullChunkStats;
+static std::vector<unsigned long long> g_staticDrawKeys;   // model << 56 | depth << 24 | instance
+
+static void CullAndSortStatic() {
+    PROFILE_ZONE("CullAndSortStatic");
+    const int cells = (int)g_staticCull.cells.size();
+    const int chunks = (cells + CULL_CELLS_PER_JOB - 1) / CULL_CELLS_PER_JOB;
+    if ((int)g_cullChunkVisible.size() < chunks) g_cullChunkVisible.resize(chunks);
+    g_cullChunkStats.assign(chunks, CullStats{ 0, 0 });
+
+    auto cull = [cells](int begin, int end) {
+        for (int c = begin; c < end; ++c) {
+            const int first = c * CULL_CELLS_PER_JOB;
+            g_cullChunkVisible[c].clear();
+            CullGridQueryCells(g_staticCull, g_viewFrustum, first, std::min(first + CULL_CELLS_PER_JOB, cells), g_cullChunkVisible[c], g_cullChunkStats[c]);
+        }
     };
-    for (size_t i = 0; i < fixedTrees.size() && i < (size_t)count; ++i) { g_trees.push_back(fixedTrees[i]); }
-}
-
-void PlaceCoinsRandom(int count) {
-    g_coins.clear();
-    const float minDistFromObjects = 2.0f;
-    const float minDistBetweenCoins = 3.0f;
-    for (int i = 0; i < count; ++i) {
-        const int maxTries = 200;
-        float x = 0.0f, z = 0.0f;
-        bool found = false;
-        for (int t = 0; t < maxTries; ++t) {
-            x = frand(2.0f, LAND_SIZE - 2.0f); z = frand(2.0f, LAND_SIZE - 2.0f);
-            if (!IsOverLand(x, z)) continue;
-            if (CollidesWithRock(x, z, minDistFromObjects) || CollidesWithTree(x, z, minDistFromObjects) || CollidesWithHouse(x, z, minDistFromObjects)) continue;
-            auto OverlapsAnyCoin = [&](float cx, float cz, float minD) {
-                for (const auto& c : g_coins) { float dx = cx - c.x, dz = cz - c.z; if ((dx * dx + dz * dz) < (minD * minD)) return true; } return false;
-                };
-            if (OverlapsAnyCoin(x, z, minDistBetweenCoins)) continue;
-            float dx = x - playerX, dz = z - playerZ; if ((dx * dx + dz * dz) < (minDistFromObjects * minDistFromObjects)) continue;
-            found = true; break;
+    auto sort = [chunks](int, int) {
+        g_staticDrawKeys.clear();
+        for (int c = 0; c < chunks; ++c) {
+            for (int i : g_cullChunkVisible[c]) {
+                const StaticRef& ref = g_staticRefs[i];
+                const BoundSphere& s = g_staticCull.spheres[i];
+                // Distance along the view direction; non-negative floats sort like their bits
+                float depth = -(g_viewMatrix[2] * s.x + g_viewMatrix[6] * s.y + g_viewMatrix[10] * s.z + g_viewMatrix[14]);
+                if (depth < 0.0f) depth = 0.0f;
+                unsigned int depthBits; memcpy(&depthBits, &depth, sizeof(depthBits));
+                const unsigned long long model = ref.kind * 8 + (ref.kind == STATIC_ROCK ? g_rocks[ref.index].modelIndex : 0);
+                g_staticDrawKeys.push_back(model << 56 | (unsigned long long)depthBits << 24 | (unsigned long long)i);
+            }
         }
-        if (!found) { if (x < 2.0f) x = 2.0f; else if (x > (LAND_SIZE - 2.0f)) x = LAND_SIZE - 2.0f; if (z < 2.0f) z = 2.0f; else if (z > (LAND_SIZE - 2.0f)) z = LAND_SIZE - 2.0f; }
-        g_coins.push_back(CoinInstance{ x, 1.0f, z, 0.0f, 0.01f, true });
-    }
+        std::sort(g_staticDrawKeys.begin(), g_staticDrawKeys.end());
+        g_visibleStatic.clear();
+        for (unsigned long long key : g_staticDrawKeys) g_visibleStatic.push_back((int)(key & 0xFFFFFF));
+    };
+
+    static JobCounter culled, sorted;   // static so the held sort job reuses its storage
+    SubmitParallelFor(chunks, 1, cull, culled);
+    SubmitParallelFor(1, 1, sort, sorted, &culled);
+    WaitForJobs(sorted);
+    for (const CullStats& c : g_cullChunkStats) { g_cullStats.visible += c.visible; g_cullStats.culled += c.culled; }
 }
 
 // ---------------- RENDERING PRIMITIVES ----------------
@@ -516,104 +384,6 @@ static void DrawGem() {
     glEnd();
 }
 
-static void PlaceHousesStreet() {
-    g_houses.clear();
-    const float centerX = WORLD_SIZE * 0.5f; const float centerZ = WORLD_SIZE * 0.5f;
-    const float roadWidth = 16.0f; const float houseOffsetX = 12.0f; const float houseSpacingZ = 6.0f;
-    const float rowLeftX = centerX - (roadWidth * 0.5f) - houseOffsetX;
-    const float rowRightX = centerX + (roadWidth * 0.5f) + houseOffsetX;
-    const float startZ = centerZ - (houseSpacingZ * 2.0f);
-    const float y = -0.2f;
-    auto yawForIndex = [](int i) -> float { return 0.0f; };
-    for (int i = 0; i < 5; ++i) {
-        float z = startZ + i * houseSpacingZ; float yaw = yawForIndex(i);
-        g_houses.push_back(HouseInstance{ rowLeftX, y, z, yaw, 0.01f });
-        g_houses.push_back(HouseInstance{ rowRightX, y, z, yaw, 0.01f });
-    }
-}
-
-void PlaceRocksRandom(int countPerModel) {
-    g_rocks.clear();
-    std::vector<RockInstance> fixedRocks = {
-        {25.0f, 0.0f, 35.0f, 30.0f, 0.01f, 0}, {275.0f, 0.0f, 35.0f, 60.0f, 0.01f, 1},
-        {25.0f, 0.0f, 265.0f, 90.0f, 0.01f, 2}, {275.0f, 0.0f, 265.0f, 120.0f, 0.01f, 3},
-        {70.0f, 0.0f, 25.0f, 150.0f, 0.01f, 4}, {150.0f, 0.0f, 30.0f, 180.0f, 0.01f, 0},
-        {230.0f, 0.0f, 25.0f, 210.0f, 0.01f, 1}, {70.0f, 0.0f, 275.0f, 240.0f, 0.01f, 2},
-        {150.0f, 0.0f, 280.0f, 270.0f, 0.01f, 3}, {230.0f, 0.0f, 275.0f, 300.0f, 0.01f, 4},
-        {25.0f, 0.0f, 100.0f, 330.0f, 0.01f, 0}, {30.0f, 0.0f, 180.0f, 0.0f, 0.01f, 1},
-        {275.0f, 0.0f, 100.0f, 30.0f, 0.01f, 2}, {280.0f, 0.0f, 180.0f, 60.0f, 0.01f, 3},
-        {85.0f, 0.0f, 80.0f, 90.0f, 0.01f, 4}, {215.0f, 0.0f, 80.0f, 120.0f, 0.01f, 0},
-        {85.0f, 0.0f, 220.0f, 150.0f, 0.01f, 1}, {215.0f, 0.0f, 220.0f, 180.0f, 0.01f, 2},
-        {100.0f, 0.0f, 120.0f, 210.0f, 0.01f, 3}, {200.0f, 0.0f, 120.0f, 240.0f, 0.01f, 4},
-        {100.0f, 0.0f, 180.0f, 270.0f, 0.01f, 0}, {200.0f, 0.0f, 180.0f, 300.0f, 0.01f, 1},
-        {50.0f, 0.0f, 140.0f, 330.0f, 0.01f, 2}, {250.0f, 0.0f, 140.0f, 0.0f, 0.01f, 3},
-        {50.0f, 0.0f, 160.0f, 30.0f, 0.01f, 4}, {250.0f, 0.0f, 160.0f, 60.0f, 0.01f, 0},
-        {120.0f, 0.0f, 55.0f, 90.0f, 0.01f, 1}, {180.0f, 0.0f, 55.0f, 120.0f, 0.01f, 2},
-        {120.0f, 0.0f, 245.0f, 150.0f, 0.01f, 3}, {180.0f, 0.0f, 245.0f, 180.0f, 0.01f, 4}
-    };
-    for (const auto& rock : fixedRocks) { g_rocks.push_back(rock); }
-}
-
-// ---------------- LEVEL 2 PLACEMENT FUNCTION ----------------
-
-void InitLevel2() {
-    lvl2_platforms.clear();
-    lvl2_pendulums.clear();
-
-    // 1. STARTING PLATFORM (Center at 0, 0)
-    lvl2_platforms.push_back({ 0.0f, 0.0f, 15.0f, 15.0f, 0.0f });
-
-    // 2. THE SPIKE CORRIDOR (Straight path with swings)
-    lvl2_platforms.push_back({ 0.0f, 40.0f, 8.0f, 60.0f, 0.0f });
-
-    // Swings (Side-to-Side)
-    lvl2_pendulums.push_back({ 0.0f, 15.0f, 20.0f, 12.0f, 0.0f, 60.0f, 3.0f, true });
-    lvl2_pendulums.push_back({ 0.0f, 15.0f, 40.0f, 12.0f, 0.0f, 60.0f, 4.0f, true });
-    lvl2_pendulums.push_back({ 0.0f, 15.0f, 60.0f, 12.0f, 0.0f, 60.0f, 2.5f, true });
-
-    // 3. THE SPLIT (Safe platform)
-    lvl2_platforms.push_back({ 0.0f, 80.0f, 20.0f, 15.0f, 0.0f });
-
-    // 4. THE KEY PATH (Side Platform)
-    lvl2_platforms.push_back({ 25.0f, 80.0f, 25.0f, 8.0f, 0.0f }); // Bridge to right
-    lvl2_platforms.push_back({ 40.0f, 80.0f, 15.0f, 15.0f, 0.0f }); // Key Platform
-
-    // Set Key Position
-    lvl2_key.x = 40.0f; lvl2_key.y = 2.0f; lvl2_key.z = 80.0f;
-
-    // 5. THE FINAL GAUNTLET (To Chest)
-    lvl2_platforms.push_back({ 0.0f, 110.0f, 8.0f, 40.0f, 0.0f });
-
-    // More Pendulums (Slightly slower for last two)
-    lvl2_pendulums.push_back({ 0.0f, 15.0f, 100.0f, 12.0f, 0.0f, 70.0f, 3.5f, true });
-    lvl2_pendulums.push_back({ 0.0f, 15.0f, 120.0f, 12.0f, 0.0f, 70.0f, 3.5f, true });
-
-    // 6. CHEST PLATFORM
-    lvl2_platforms.push_back({ 0.0f, 135.0f, 20.0f, 10.0f, 1.0f });
-    lvl2_chest.x = 0.0f; lvl2_chest.y = 2.0f; lvl2_chest.z = 135.0f;
-
-    // --- PLACE 10 GEMS (2 per platform on the first 5 platforms) ---
-    g_gems.clear();
-    const int platformsForGems = 5; // first 5 platforms
-    const float margin = 1.0f;
-    int placed = 0;
-    for (int i = 0; i < (int)lvl2_platforms.size() && i < platformsForGems; ++i) {
-        const auto& p = lvl2_platforms[i];
-        float hw = p.width * 0.5f - margin;
-        float hl = p.length * 0.5f - margin;
-        // Two positions per platform: left/right along X, centered on Z
-        float gx1 = p.x - hw * 0.5f;
-        float gz1 = p.z;
-        float gx2 = p.x + hw * 0.5f;
-        float gz2 = p.z;
-        g_gems.push_back(GemInstance{ gx1, p.y + 1.0f, gz1, 0.0f, 1.0f, true }); placed++;
-        g_gems.push_back(GemInstance{ gx2, p.y + 1.0f, gz2, 0.0f, 1.0f, true }); placed++;
-        if (placed >= 10) break;
-    }
-}
-
-// ---------------- RENDERING PRIMITIVES ----------------
-
 // Custom coin rendering function
 void DrawCustomCoin() {
     // Bind coin texture and ensure texturing is enabled
@@ -628,28 +398,128 @@ void DrawCustomCoin() {
     const float thickness = 0.15f;
     const int slices = 20;
 
-    // Use a single quadric with texture coordinates enabled
-    GLUquadricObj* quadric = gluNewQuadric();
-    gluQuadricDrawStyle(quadric, GLU_FILL);
-    gluQuadricNormals(quadric, GLU_SMOOTH);
-    gluQuadricTexture(quadric, GL_TRUE); // generate texture coords
+    // Tessellated once and shared by every coin (GeometryCache.h)
+    const Mesh& rim = CylinderMesh(radius, radius, thickness, slices, 1);
+    const Mesh& face = DiskMesh(0, radius, slices, 1);
 
     // Rim (cylinder)
-    gluCylinder(quadric, radius, radius, thickness, slices, 1);
+    DrawMesh(rim);
 
     // Front face (+Z)
     glPushMatrix();
     glTranslatef(0, 0, thickness);
-    gluDisk(quadric, 0, radius, slices, 1);
+    DrawMesh(face);
     glPopMatrix();
 
     // Back face (-Z)
     glPushMatrix();
     glRotatef(180, 1, 0, 0);
-    gluDisk(quadric, 0, radius, slices, 1);
+    DrawMesh(face);
+    glPopMatrix();
+}
+
+// Models at their world transforms, shared by the scene and the shadow
+// casters; material and colour are up to the caller
+static void DrawRock(const RockInstance& r) { glPushMatrix(); glTranslatef(r.x, r.y, r.z); glRotatef(r.yawDeg, 0, 1, 0); glScalef(r.scale, r.scale, r.scale); model_rocks[r.modelIndex].Draw(); glPopMatrix(); }
+static void DrawHouse(const HouseInstance& h) { glPushMatrix(); glTranslatef(h.x, h.y, h.z); glRotatef(h.yawDeg, 0, 1, 0); glRotatef(90.0f, 1, 0, 0); glScalef(h.scale, h.scale, h.scale); model_houses.Draw(); glPopMatrix(); }
+static void DrawTree(const TreeInstance& t) { glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(0, -90, 1, 0); glScalef(t.scale + 1, t.scale + 1, t.scale + 1); model_tree.Draw(); glPopMatrix(); }
+static void DrawBoat() { glPushMatrix(); glTranslatef(g_boat.x, g_boat.y + 10, g_boat.z + 120); glRotatef(g_boat.yawDeg, 0, 1, 0); glScalef(g_boat.scale, g_boat.scale, g_boat.scale); model_boat.Draw(); glPopMatrix(); }
+static void DrawNpc() { glPushMatrix(); glTranslatef(g_npc.x, g_npc.y, g_npc.z); glRotatef(g_npc.yawDeg, 0, 1, 0); glScalef(g_npc.scale, g_npc.scale, g_npc.scale); model_pirate.Draw(); glPopMatrix(); }
+static void DrawPalet(const Platform& p) {
+    glPushMatrix();
+    glTranslatef(p.x, p.y - 0.8f, p.z + 2.6f);
+    glRotatef(90.0f, 1, 0, 0);
+    float s = p.size * 0.2f; glScalef(s, s, s);
+    model_palet.Draw();
     glPopMatrix();
+}
+
+static void DrawPlayer() {
+    PROFILE_ZONE("DrawPlayer");
+    glPushMatrix();
+    glTranslatef(g_frame->playerX, g_frame->playerY, g_frame->playerZ);
+    glRotatef(g_frame->playerYaw + 180.0f, 0, 1, 0); // Rotate to match camera (Face forward)
+    glScalef(0.02f, 0.02f, 0.02f); // Scale down (matches NPC scale)
+    model_pirate.Draw();
+    glPopMatrix();
+}
 
-    gluDeleteQuadric(quadric);
+static void DrawPendulum(const Pendulum& p) {
+    glPushMatrix();
+    glTranslatef(p.pivotX, p.pivotY, p.pivotZ);
+    if (p.axisZ) glRotatef(p.currentAngle, 0, 0, 1);
+    else glRotatef(p.currentAngle, 1, 0, 0);
+    glScalef(0.2f, 0.2f, 0.2f);
+    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
+    model_spike.Draw();
+    glPopMatrix();
+}
+
+// Pickups and props: one row per RenderKind (GameWorld.h): how an entity with a Transform
+// draws, its bounds, and what it costs for the occlusion test. The scene
+// and the shadow casters both walk the level's store through this table.
+static void DrawCoin(const Transform& t) { glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(t.yawDeg, 0, 1, 0); glScalef(t.scale, t.scale, t.scale); DrawCustomCoin(); glPopMatrix(); }
+static void DrawMapPickup(const Transform& t) { glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(t.yawDeg, 0, 1, 0); glRotatef(45.0f, 1, 0, 0); glScalef(t.scale, t.scale, t.scale); model_map.Draw(); glPopMatrix(); }
+static void DrawGemPickup(const Transform& t) {
+    glPushMatrix();
+    glTranslatef(t.x, t.y + 0.3f * sinf(g_frame->gameTimer * 3.5f), t.z);
+    glRotatef(t.yawDeg, 0, 1, 0);
+    glScalef(t.scale, t.scale, t.scale);
+    DrawGem();
+    glPopMatrix();
+}
+static void DrawKeyPickup(const Transform& t) {
+    glPushMatrix();
+    // --- ADD HOVER EFFECT (Sine Wave on Y) ---
+    glTranslatef(t.x, t.y + 0.5f * sin(g_frame->gameTimer * 3.0f), t.z);
+    glRotatef(t.yawDeg, 0, 1, 0);
+    model_key.Draw();
+    glPopMatrix();
+}
+
+static BoundSphere CoinBounds(const Transform& t) { return BoundSphere{ t.x, t.y, t.z, 1.1f }; }
+static BoundSphere GemBounds(const Transform& t) { return BoundSphere{ t.x, t.y, t.z, 1.5f }; }
+static BoundSphere MapBounds(const Transform& t) { return LooseModelSphere(model_map, t.x, t.y, t.z, t.scale); }
+static BoundSphere KeyBounds(const Transform& t) { return LooseModelSphere(model_key, t.x, t.y, t.z, 1.0f); }
+
+struct EntityDrawer {
+    void (*draw)(const Transform&);            // null: not drawn
+    BoundSphere (*bounds)(const Transform&);
+    const Model_3DS* model;                    // triangle count for Occluded, else triangles
+    int triangles;
+    float color[3];
+};
+static const EntityDrawer ENTITY_DRAWERS[RENDER_KIND_COUNT] = {
+    { DrawCoin,      CoinBounds, nullptr,    COIN_TRIANGLES, { 1.0f, 1.0f, 1.0f } },    // RENDER_COIN
+    { DrawGemPickup, GemBounds,  nullptr,    GEM_TRIANGLES,  { 0.8f, 0.8f, 0.8f } },    // RENDER_GEM
+    { DrawMapPickup, MapBounds,  &model_map, 0,              { 1.0f, 1.0f, 1.0f } },    // RENDER_MAP
+    { DrawKeyPickup, KeyBounds,  &model_key, 0,              { 1.0f, 0.84f, 0.0f } },   // RENDER_KEY, unlit gold
+    { nullptr,       nullptr,    nullptr,    0,              { 1.0f, 1.0f, 1.0f } },    // RENDER_TREASURE, placeholder
+};
+
+// Every visible entity of the frame's snapshot; leaves lighting and texturing
+// on and the colour white
+static void DrawEntities() {
+    for (const SnapshotEntity& e : g_frame->entities) {
+        const EntityDrawer& d = ENTITY_DRAWERS[e.kind];
+        if (!d.draw) continue;
+        const BoundSphere bounds = d.bounds(e.transform);
+        if (!CullSphere(bounds) || Occluded(bounds, d.model ? d.model->totalFaces : d.triangles)) continue;
+        glColor3f(d.color[0], d.color[1], d.color[2]);
+        d.draw(e.transform);
+    }
+    glEnable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glColor3f(1.0f, 1.0f, 1.0f);
+}
+
+static void DrawChest() {
+    glPushMatrix();
+    glTranslatef(lvl2_chest.x, lvl2_chest.y, lvl2_chest.z);
+    glScalef(0.12f, 0.12f, 0.12f);
+    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);   // face the approach side
+    model_chest_3d.Draw();
+    glPopMatrix();
 }
 
 static void RenderFullScreenTexture(GLTexture& tex) {
@@ -669,18 +539,20 @@ static void RenderFullScreenTexture(GLTexture& tex) {
     glEnable(GL_DEPTH_TEST); glEnable(GL_LIGHTING);
 }
 
+// Text is queued into one batch (TextBatch.h) and drawn by FlushHUDText
+static GlyphAtlas g_hudFont;
+
 void RenderText(float x, float y, const char* string) {
-    glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D);
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
-    int w = glutGet(GLUT_WINDOW_WIDTH); int h = glutGet(GLUT_WINDOW_HEIGHT);
-    gluOrtho2D(0, w, 0, h);
-    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
-    glColor3f(1.0f, 1.0f, 1.0f); glRasterPos2f(x, y);
-    for (const char* c = string; *c != '\0'; c++) { glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c); }
-    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    QueueText(g_hudFont, x, y, string);
+    // Same state the per-character version always left behind
+    glColor3f(1.0f, 1.0f, 1.0f);
     glEnable(GL_TEXTURE_2D); glEnable(GL_LIGHTING);
 }
 
+static void FlushHUDText() {
+    FlushText(g_hudFont, ViewWidth(), ViewHeight());
+}
+
 // ---------------- SCENE INITIALIZATION & ASSET LOADING ----------------
 
 void myInit(void) {
@@ -705,6 +577,21 @@ void myInit(void) {
     setvbuf(stdout, NULL, _IONBF, 0);
 }
 
+// Everything random about a run; --replay lays out from the journal's seed
+// without loading a model
+static void LayOutLevels(unsigned seed) {
+    g_layoutSeed = seed;
+    srand(seed);
+    PlaceRocksRandom(6);
+    PlaceHousesStreet();
+    PlaceTreesRandom(50);
+    PlaceCoinsRandom(20);
+    PlacePirateMapInRoad();
+    PlaceBoatAtEdge();
+    placeTreasurePiles();
+    InitLevel2();
+}
+
 void LoadAssets() {
     // ---------------------------------------------------------
     // 1. LOAD PIRATE (Manual Texture Assignment)
@@ -790,6 +677,16 @@ void LoadAssets() {
     }
     // ---------------------------------------------------------
 
+    // Normal maps for the wood and stone props. Model_3DS picks up a
+    // <texture>_normal file next to a model's texture by itself, but these
+    // models use the shared ones in textures/.
+    model_houses.SetNormalMap("textures/wood_normal.png");
+    model_palet.SetNormalMap("textures/wood_normal.png");
+    model_boat.SetNormalMap("textures/wood_normal.png");
+    model_torch.SetNormalMap("textures/wood_normal.png");
+    model_chest_3d.SetNormalMap("textures/wood_normal.png");
+    for (int i = 0; i < 5; ++i) model_rocks[i].SetNormalMap("textures/stone_normal.png");
+
     // --- LOAD SUN MODEL FOR LIGHT SOURCE ---
 
 
@@ -809,239 +706,358 @@ void LoadAssets() {
     tex_win_bg.Load("textures/WIN.bmp");
     tex_lose_bg.Load("textures/LOSE.bmp");
 
-    srand((unsigned)time(nullptr));
-    PlaceRocksRandom(6);
-    PlaceHousesStreet();
-    PlaceTreesRandom(50);
-    PlaceCoinsRandom(20);
-    PlacePirateMapInRoad();
-    PlaceBoatAtEdge();
-    placeTreasurePiles();
-    InitLevel2();
+    LayOutLevels(g_capturing ? CAPTURE_SEED : (unsigned)time(nullptr));
+    BuildStaticCullGrid();
 }
 
-// ---------------- LOGIC UPDATES ----------------
-
-// Reset player state for Level 2 transition/death
-void ResetPlayerLvl2() {
-    playerX = 0.0f;
-    playerZ = 0.0f;
-    playerY = 0.0f;
-    velX = 0; velZ = 0; velY = 0;
-    jumpCount = 0; grounded = true;
-}
-
-// --- RESTORED MOMENTUM PHYSICS UPDATE ---
-void UpdateMovement(float dt) {
-    if (isFadingOut) return;
-
-    // 1. Calculate Input Direction
-    float inputX = 0.0f, inputZ = 0.0f;
-    const float yawRad = playerYaw * PI / 180.0f;
-    const float fx = sinf(yawRad);
-    const float fz = cosf(yawRad);
-    const float lx = -fz;
-    const float lz = fx;
-
-    // Accumulate input
-    if (keyW) { inputX -= fx; inputZ -= fz; }
-    if (keyS) { inputX += fx; inputZ += fz; }
-    if (keyA) { inputX += lx; inputZ += lz; }
-    if (keyD) { inputX -= lx; inputZ -= lz; }
-
-    // Normalize input
-    float inputLen = sqrt(inputX * inputX + inputZ * inputZ);
-    if (inputLen > 0.001f) {
-        inputX /= inputLen;
-        inputZ /= inputLen;
-
-        // Apply ACCELERATION
-        velX += inputX * accel * dt;
-        velZ += inputZ * accel * dt;
-    }
-    else {
-        // Apply FRICTION
-        float currentSpeed = sqrt(velX * velX + velZ * velZ);
-        if (currentSpeed > 0.001f) {
-            float frictionToUse = grounded ? frictionGround : frictionAir;
-            float drop = frictionToUse * dt;
-            float newSpeed = currentSpeed - drop;
-            if (newSpeed < 0) newSpeed = 0;
-
-            velX *= (newSpeed / currentSpeed);
-            velZ *= (newSpeed / currentSpeed);
-        }
-        else {
-            velX = 0;
-            velZ = 0;
+// ---------------- STATIC BATCHES ----------------
+// Geometry that only changes when a level is laid out, baked into vertex
+// buffers (GeometryCache.h) instead of going through glBegin every frame.
+// The Level 2 batches are rebaked whenever g_layoutVersion moves.
+static Mesh g_groundBatch, g_waterBatch, g_abyssBatch;
+static Mesh g_menuBackground, g_menuButton;
+static Mesh g_lvl2PlatformTops;    // textured top and bottom of each platform
+static Mesh g_lvl2PlatformSides;   // untextured sides of each platform
+static Mesh g_lvl2ChestWalls;
+static unsigned int g_lvl2BakedVersion = 0;
+static bool g_lvl2Baked = false;
+static const int PLATFORM_TOP_INDICES = 12, PLATFORM_SIDE_INDICES = 24;   // per platform, in lvl2_platforms order
+
+static const float CHEST_WALL_HEIGHT = 8.0f;
+static const float CHEST_WALL_THICK = 0.6f;
+
+// Platform that holds the chest: the walls and torches go on its edges
+struct ChestRoom { float px, pz, py, hw, hl; };
+static ChestRoom FindChestRoom() {
+    float cx = lvl2_chest.x;
+    float cz = lvl2_chest.z;
+    ChestRoom room = { cx, cz, GROUND_Y, 12.0f * 0.5f, 10.0f * 0.5f };   // fallback size 12 x 10
+    for (const auto& p : lvl2_platforms) {
+        float hw = p.width * 0.5f;
+        float hl = p.length * 0.5f;
+        if (fabsf(cx - p.x) <= hw + 0.1f && fabsf(cz - p.z) <= hl + 0.1f) {
+            room.px = p.x; room.pz = p.z; room.py = p.y; room.hw = hw; room.hl = hl; break;
         }
     }
+    return room;
+}
 
-    // Cap velocity
-    float currentSpeed = sqrt(velX * velX + velZ * velZ);
-    if (currentSpeed > maxSpeed) {
-        velX *= (maxSpeed / currentSpeed);
-        velZ *= (maxSpeed / currentSpeed);
-    }
+static void BakeQuad(Mesh& m, float x0, float y0, float z0, float x1, float y1, float z1, float x2, float y2, float z2, float x3, float y3, float z3,
+    float u0, float v0, float u1, float v1, float nx, float ny, float nz) {
+    const float corners[4][3] = { { x0, y0, z0 }, { x1, y1, z1 }, { x2, y2, z2 }, { x3, y3, z3 } };
+    const float uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+    AddMeshQuad(m, corners, uvs, nx, ny, nz);
+}
 
-    // 2. Calculate Move Amount
-    float moveX = velX * dt;
-    float moveZ = velZ * dt;
+// Textured axis-aligned box, every face tiled repeatX x repeatY
+static void BakeBox(Mesh& m, float xMin, float xMax, float zMin, float zMax, float yMin, float yMax, float repeatX, float repeatY) {
+    BakeQuad(m, xMin, yMin, zMin, xMax, yMin, zMin, xMax, yMax, zMin, xMin, yMax, zMin, 0, 0, repeatX, repeatY, 0, 0, -1);   // Front (-Z)
+    BakeQuad(m, xMax, yMin, zMax, xMin, yMin, zMax, xMin, yMax, zMax, xMax, yMax, zMax, 0, 0, repeatX, repeatY, 0, 0, 1);    // Back (+Z)
+    BakeQuad(m, xMin, yMin, zMax, xMin, yMin, zMin, xMin, yMax, zMin, xMin, yMax, zMax, 0, 0, repeatX, repeatY, -1, 0, 0);   // Left (-X)
+    BakeQuad(m, xMax, yMin, zMin, xMax, yMin, zMax, xMax, yMax, zMax, xMax, yMax, zMin, 0, 0, repeatX, repeatY, 1, 0, 0);    // Right (+X)
+    BakeQuad(m, xMin, yMax, zMin, xMax, yMax, zMin, xMax, yMax, zMax, xMin, yMax, zMax, 0, 0, repeatX, repeatY, 0, 1, 0);    // Top (+Y)
+    BakeQuad(m, xMin, yMin, zMax, xMax, yMin, zMax, xMax, yMin, zMin, xMin, yMin, zMin, 0, 0, repeatX, repeatY, 0, -1, 0);   // Bottom (-Y)
+}
 
-    // 3. Collision Logic
-    bool hitObstacle = false;
+// Island, water, abyss and menu quads never change
+static void BakeConstantBatches() {
+    const float tilingFactor = LAND_SIZE / 20.0f;
+    BakeQuad(g_groundBatch, 0.0f, GROUND_Y, 0.0f, LAND_SIZE, GROUND_Y, 0.0f, LAND_SIZE, GROUND_Y, LAND_SIZE, 0.0f, GROUND_Y, LAND_SIZE, 0, 0, tilingFactor, tilingFactor, 0, 1, 0);
+    UploadMesh(g_groundBatch);
+    BakeQuad(g_waterBatch, -100, WATER_Y, -100, WORLD_SIZE + 100, WATER_Y, -100, WORLD_SIZE + 100, WATER_Y, WORLD_SIZE + 100, -100, WATER_Y, WORLD_SIZE + 100, 0, 0, 0, 0, 0, 1, 0);
+    UploadMesh(g_waterBatch);
+    BakeQuad(g_abyssBatch, -100, WATER_Y - 10, -100, WORLD_SIZE, WATER_Y - 10, -100, WORLD_SIZE, WATER_Y - 10, WORLD_SIZE, -100, WATER_Y - 10, WORLD_SIZE, 0, 0, 0, 0, 0, 1, 0);
+    UploadMesh(g_abyssBatch);
+
+    BakeQuad(g_menuBackground, 0, 0, 0, WIDTH, 0, 0, WIDTH, HEIGHT, 0, 0, HEIGHT, 0, 0, 0, 1, 1, 0, 0, 1);
+    UploadMesh(g_menuBackground);
+    float btnW = 200, btnH = 100; float btnX = (WIDTH - btnW) / 2.0f; float btnY = 100.0f;
+    BakeQuad(g_menuButton, btnX, btnY, 0, btnX + btnW, btnY, 0, btnX + btnW, btnY + btnH, 0, btnX, btnY + btnH, 0, 0, 0, 1, 1, 0, 0, 1);
+    UploadMesh(g_menuButton);
+}
 
-    // Check X axis
-    float testX = playerX + moveX;
-    bool hitWallX = (gameState == LEVEL_1) && (testX < 0.0f || testX > LAND_SIZE);
-    bool hitNPC_X = CollidesWithNPCSilent(testX, playerZ, 0.0f) || CollidesWithBoatSilent(testX, playerZ, 0.0f);
+static void BakeLevel2Batches() {
+    ReleaseMesh(g_lvl2PlatformTops); ReleaseMesh(g_lvl2PlatformSides); ReleaseMesh(g_lvl2ChestWalls);
+    for (const auto& p : lvl2_platforms) {
+        float hw = p.width / 2.0f; float hl = p.length / 2.0f; float y = p.y;
+        float x0 = p.x - hw, x1 = p.x + hw, z0 = p.z - hl, z1 = p.z + hl;
+        BakeQuad(g_lvl2PlatformTops, x0, y, z0, x1, y, z0, x1, y, z1, x0, y, z1, 0, 0, 1, 1, 0, 1, 0);
+        // The bottom never had its own texture coordinates; it kept the top's last one
+        BakeQuad(g_lvl2PlatformTops, x0, y - 2, z0, x1, y - 2, z0, x1, y - 2, z1, x0, y - 2, z1, 0, 1, 0, 1, 0, -1, 0);
+        BakeQuad(g_lvl2PlatformSides, x0, y, z1, x1, y, z1, x1, y - 2, z1, x0, y - 2, z1, 0, 0, 0, 0, 0, 0, 1);
+        BakeQuad(g_lvl2PlatformSides, x0, y, z0, x1, y, z0, x1, y - 2, z0, x0, y - 2, z0, 0, 0, 0, 0, 0, 0, -1);
+        BakeQuad(g_lvl2PlatformSides, x0, y, z0, x0, y, z1, x0, y - 2, z1, x0, y - 2, z0, 0, 0, 0, 0, -1, 0, 0);
+        BakeQuad(g_lvl2PlatformSides, x1, y, z0, x1, y, z1, x1, y - 2, z1, x1, y - 2, z0, 0, 0, 0, 0, 1, 0, 0);
+    }
+    UploadMesh(g_lvl2PlatformTops);
+    UploadMesh(g_lvl2PlatformSides);
+
+    // Chest walls on the back and side edges; the approach side (-Z) stays open
+    const ChestRoom r = FindChestRoom();
+    const float thick = CHEST_WALL_THICK, top = r.py + CHEST_WALL_HEIGHT;
+    const float repeatX = 2.5f, repeatY = 4.0f;   // texture tiling along span / height
+    BakeBox(g_lvl2ChestWalls, r.px - r.hw, r.px + r.hw, r.pz + r.hl - thick, r.pz + r.hl + thick, r.py, top, repeatX, repeatY);           // Back
+    BakeBox(g_lvl2ChestWalls, r.px - r.hw - thick, r.px - r.hw + thick, r.pz - r.hl, r.pz + r.hl, r.py, top, repeatX, repeatY);           // Left
+    BakeBox(g_lvl2ChestWalls, r.px + r.hw - thick, r.px + r.hw + thick, r.pz - r.hl, r.pz + r.hl, r.py, top, repeatX, repeatY);           // Right
+    UploadMesh(g_lvl2ChestWalls);
+
+    g_lvl2BakedVersion = g_layoutVersion;
+    g_lvl2Baked = true;
+}
 
-    if (CollidesWithAnyObject(testX, playerZ, 0.0f) || hitNPC_X || hitWallX) {
-        velX = 0; // Stop momentum on collision
-        if (hitWallX) {
-            if (testX < 0.0f) playerX = 0.0f;
-            if (testX > LAND_SIZE) playerX = LAND_SIZE;
-        }
-        else if (!hitNPC_X) {
-            hitObstacle = true;
+// ---------------- TORCH LIGHTS ----------------
+// Torches along the Level 1 street and the Level 2 platform edges. They are
+// per-pixel point lights (Lighting.h): binned into screen clusters every
+// frame and added by a full-screen pass (LightingShader.h) once the opaque
+// scene is drawn. 'L' switches the pass off to compare.
+struct TorchInstance { float x, y, z; float yawDeg; };
+static const float TORCH_SCALE = 0.8f;          // same size as the chest room torches
+static const float TORCH_MOUNT_HEIGHT = 2.5f;   // above the ground or platform top
+static const float TORCH_SPACING = 10.0f;       // along a Level 2 platform edge
+static const float TORCH_RADIUS = 14.0f;
+static const int LIGHT_TILES_X = 16, LIGHT_TILES_Y = 9, LIGHT_SLICES = 24;
+static const float LIGHT_NEAR = 0.1f, LIGHT_FAR = 1000.0f;   // gluPerspective in myInit/myReshape
+bool torchLighting = true;
+static bool g_lightPassAvailable = false;       // GL 2.0 + float textures, see InitLightingPass
+static std::vector<TorchInstance> g_torches;
+static std::vector<PointLight> g_torchLights;   // base colour; flicker is applied per frame
+static std::vector<PointLight> g_frameLights;
+static LightClusters g_lightClusters;
+static int g_torchState = -1;                   // gameState the torches were placed for
+static unsigned int g_torchVersion = 0;
+static double g_lightClusterMs = 0.0;           // BuildLightClusters CPU time, smoothed
+
+static void PlaceTorches() {
+    g_torches.clear();
+    if (g_frame->gameState == LEVEL_1) {
+        // One per house, between it and the road, facing the road
+        for (const auto& h : g_houses) {
+            const float towardRoad = h.x < WORLD_SIZE * 0.5f ? 7.0f : -7.0f;
+            g_torches.push_back(TorchInstance{ h.x + towardRoad, GROUND_Y + TORCH_MOUNT_HEIGHT, h.z + 3.0f, towardRoad > 0.0f ? 90.0f : -90.0f });
         }
     }
-    else { playerX = testX; }
-
-    // Check Z axis
-    float testZ = playerZ + moveZ;
-    bool hitWallZ = (gameState == LEVEL_1) && (testZ < 0.0f || testZ > LAND_SIZE);
-    bool hitNPC_Z = CollidesWithNPCSilent(playerX, testZ, 0.0f) || CollidesWithBoatSilent(playerX, testZ, 0.0f);
-
-    if (CollidesWithAnyObject(playerX, testZ, 0.0f) || hitNPC_Z || hitWallZ) {
-        velZ = 0; // Stop momentum on collision
-        if (hitWallZ) {
-            if (testZ < 0.0f) playerZ = 0.0f;
-            if (testZ > LAND_SIZE) playerZ = LAND_SIZE;
-        }
-        else if (!hitNPC_Z) {
-            hitObstacle = true;
+    else if (g_frame->gameState == LEVEL_2) {
+        // Pairs along both side edges of every platform; the chest room has its own
+        const ChestRoom room = FindChestRoom();
+        for (const auto& p : lvl2_platforms) {
+            if (p.x == room.px && p.z == room.pz) continue;
+            const float hw = p.width * 0.5f - 0.5f, z0 = p.z - p.length * 0.5f;
+            const int pairs = (int)(p.length / TORCH_SPACING) + 1;
+            for (int i = 0; i < pairs; ++i) {
+                const float z = z0 + p.length * (i + 0.5f) / pairs;
+                g_torches.push_back(TorchInstance{ p.x - hw, p.y + TORCH_MOUNT_HEIGHT, z, 90.0f });
+                g_torches.push_back(TorchInstance{ p.x + hw, p.y + TORCH_MOUNT_HEIGHT, z, -90.0f });
+            }
         }
     }
-    else { playerZ = testZ; }
-
-    if (hitObstacle) {
-        int currentTime = glutGet(GLUT_ELAPSED_TIME);
-        if (currentTime - lastCollisionTime > COLLISION_SOUND_COOLDOWN) {
-            MciPlayOnce(ALIAS_COLLISION);
-            MciPlayOnce(ALIAS_OOF);
-            lastCollisionTime = currentTime;
-        }
+
+    // The light sits at the top of the model, where the flame is
+    g_torchLights.clear();
+    for (const auto& t : g_torches) {
+        float flame[3];
+        ModelToWorld(model_torch.boundsCenter.x, model_torch.boundsMax.y, model_torch.boundsCenter.z, t.x, t.y, t.z, t.yawDeg, 0.0f, TORCH_SCALE, flame);
+        g_torchLights.push_back(PointLight{ flame[0], flame[1], flame[2], TORCH_RADIUS, 1.0f, 0.6f, 0.25f });
     }
+    g_torchState = g_frame->gameState;
+    g_torchVersion = g_layoutVersion;
+}
 
-    // Vertical movement
-    velY -= gravity * dt;
-    if (velY < maxFallSpeed) velY = maxFallSpeed;
+static void DrawTorch(const TorchInstance& t) {
+    glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(t.yawDeg, 0, 1, 0); glScalef(TORCH_SCALE, TORCH_SCALE, TORCH_SCALE); model_torch.Draw(); glPopMatrix();
+}
 
-    if (spaceTrigger && jumpCount < 2) {
-        velY = jumpImpulse; grounded = false; jumpCount++; spaceTrigger = false; MciPlayOnce(ALIAS_JUMP);
+static void DrawTorches() {
+    PROFILE_ZONE("DrawTorches");
+    if (g_torchState != g_frame->gameState || g_torchVersion != g_layoutVersion) PlaceTorches();
+    glEnable(GL_TEXTURE_2D); glColor3f(1.0f, 1.0f, 1.0f);
+    for (const auto& t : g_torches) {
+        const BoundSphere bounds = ModelSphere(model_torch, t.x, t.y, t.z, t.yawDeg, 0.0f, TORCH_SCALE);
+        if (!CullSphere(bounds) || Occluded(bounds, model_torch.totalFaces)) continue;
+        DrawTorch(t);
     }
+}
 
-    playerY += velY * dt;
+// Torchlight over the finished opaque scene. The village only gets the
+// full strength at night; the dungeon always does.
+static void ApplyTorchLighting(float sunY) {
+    if (!torchLighting || !g_lightPassAvailable || g_torchLights.empty()) return;
+    PROFILE_ZONE("ApplyTorchLighting"); GPU_ZONE("ApplyTorchLighting");
+    const float strength = (g_frame->gameState == LEVEL_1 && sunY >= -10.0f) ? 0.25f : 1.0f;
+    g_frameLights = g_torchLights;
+    for (size_t i = 0; i < g_frameLights.size(); ++i) {
+        const float flicker = strength * (1.0f + 0.15f * sinf(g_frame->gameTimer * 7.0f + i * 1.7f) + 0.08f * sinf(g_frame->gameTimer * 10.3f + i * 0.9f));
+        PointLight& l = g_frameLights[i];
+        l.r *= flicker; l.g *= flicker; l.b *= flicker;
+    }
 
-    // Ground/Water/Platform Landing
-    if (playerY < GROUND_Y) {
-        if (IsOverLand(playerX, playerZ)) {
-            playerY = GROUND_Y; velY = 0.0f; grounded = true; jumpCount = 0;
-        }
-        else {
-            grounded = false; velY = (velY > -5.0f) ? velY : -5.0f;
+    const auto start = std::chrono::high_resolution_clock::now();
+    BuildLightClusters(g_lightClusters, g_frameLights, g_viewMatrix, g_projMatrix, LIGHT_TILES_X, LIGHT_TILES_Y, LIGHT_SLICES, LIGHT_NEAR, LIGHT_FAR);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    g_lightClusterMs = g_lightClusterMs * 0.95 + ms * 0.05;
 
-            // --- FIX FOR LEVEL 2 VOID DEATH ---
-            if (gameState == LEVEL_2 && playerY < -20.0f) {
-                HandlePlayerDeath(); // LOSE A HEART!
-                if (lives > 0) ResetPlayerLvl2(); // Only respawn if alive
-            }
-        }
-    }
+    ApplyLightingPass(g_lightClusters, g_frameLights, g_projMatrix, ViewWidth(), ViewHeight());
+}
 
-    // Level 1 Platforms Landing
-    if (gameState == LEVEL_1) {
-        for (int i = 0; i < PLATFORM_COUNT; ++i) {
-            const Platform& p = g_platforms[i]; const float s = p.size; const float topY = p.y;
-            if (playerX >= (p.x - s) && playerX <= (p.x + s) && playerZ >= (p.z - s) && playerZ <= (p.z + s)) {
-                if (playerY >= topY - 0.5f && playerY <= topY + 1.0f && velY <= 0.0f) {
-                    playerY = topY; velY = 0.0f; grounded = true; jumpCount = 0;
-                }
+// ---------------- SUN SHADOWS ----------------
+// Cascaded shadow maps from the sun (Shadows.h, ShadowMaps.h). Scenery that
+// never moves goes into each cascade's static layer, which is only redrawn
+// when the cascade's projection changes; the player, pickups and spikes are
+// drawn on top of a copy of it every frame. The sun direction is rounded to
+// SHADOW_SUN_STEP_DEG so the day cycle moves the static layers in steps
+// instead of invalidating them every frame. 'K' switches shadows off.
+static const int SHADOW_CASCADES = 4;
+static const int SHADOW_MAP_SIZE = 1024;
+static const float SHADOW_DISTANCE = 200.0f;     // view depth the last cascade reaches
+static const float SHADOW_SPLIT_LAMBDA = 0.75f;  // mostly logarithmic splits
+static const float SHADOW_SNAP = 0.125f;         // cascade centre step, fraction of its radius
+static const float SHADOW_SUN_STEP_DEG = 2.0f;
+static const float SHADOW_STRENGTH = 0.45f;
+bool sunShadows = true;
+static bool g_shadowsAvailable = false;          // GL 2.0 + framebuffer objects, see InitShadowMaps
+static ShadowCascade g_cascades[SHADOW_CASCADES];
+static ShadowCascade g_cachedCascades[SHADOW_CASCADES];   // what each static layer was drawn with
+static bool g_staticLayerValid[SHADOW_CASCADES];
+static bool g_shadowsDrawn = false;              // this frame's maps are ready for the pass
+static float g_shadowLightDir[3];
+static float g_shadowSceneMin[3], g_shadowSceneMax[3];
+static int g_shadowState = -1;                   // gameState the static layers were drawn for
+static unsigned int g_shadowVersion = 0;
+static std::vector<int> g_shadowStatic;          // reused for every cascade
+struct ShadowCascadeStats { int staticDrawn, staticCulled, movingDrawn, movingCulled; bool staticRedrawn; double cpuMs; };
+static ShadowCascadeStats g_shadowStats[SHADOW_CASCADES];
+
+// Box around everything that can cast a shadow in the current level
+static void UpdateShadowScene() {
+    if (g_frame->gameState == LEVEL_1) {
+        const float lo[3] = { -100.0f, WATER_Y - 10.0f, -100.0f }, hi[3] = { WORLD_SIZE + 100.0f, 80.0f, WORLD_SIZE + 250.0f };
+        for (int k = 0; k < 3; ++k) { g_shadowSceneMin[k] = lo[k]; g_shadowSceneMax[k] = hi[k]; }
+    }
+    else {
+        g_shadowSceneMin[0] = g_shadowSceneMin[1] = g_shadowSceneMin[2] = 1e30f;
+        g_shadowSceneMax[0] = g_shadowSceneMax[1] = g_shadowSceneMax[2] = -1e30f;
+        for (const auto& p : lvl2_platforms) {
+            const float lo[3] = { p.x - p.width * 0.5f, p.y - 2.0f, p.z - p.length * 0.5f }, hi[3] = { p.x + p.width * 0.5f, p.y + 30.0f, p.z + p.length * 0.5f };
+            for (int k = 0; k < 3; ++k) {
+                if (lo[k] < g_shadowSceneMin[k]) g_shadowSceneMin[k] = lo[k];
+                if (hi[k] > g_shadowSceneMax[k]) g_shadowSceneMax[k] = hi[k];
             }
         }
     }
-
-    // Level 2 Collision
-    if (gameState == LEVEL_2 && CollidesWithPendulum(playerX, playerZ, playerY, 0.0f)) {
-        // --- FIX FOR LEVEL 2 LIVES ---
-        HandlePlayerDeath(); // LOSE A HEART!
-        if (lives > 0) ResetPlayerLvl2(); // Only respawn if alive
-    }
+    for (int i = 0; i < SHADOW_CASCADES; ++i) g_staticLayerValid[i] = false;
+    g_shadowState = g_frame->gameState;
+    g_shadowVersion = g_layoutVersion;
 }
 
-void CheckGameLogic() {
-    float pickupDist = 2.0f;
+// Depth only: whatever the draws below enable is undone by EndShadowLayer
+static void DrawShadowCasters(const Frustum& f, bool moving, ShadowCascadeStats& stats) {
+    int& drawn = moving ? stats.movingDrawn : stats.staticDrawn;
+    int& culled = moving ? stats.movingCulled : stats.staticCulled;
+    auto casts = [&](const BoundSphere& s) {
+        if (SphereInFrustum(f, s.x, s.y, s.z, s.radius)) { drawn++; return true; }
+        culled++;
+        return false;
+    };
 
-    if (gameState == LEVEL_1) {
-        // Coin/Key/Map Pickups (Level 1)
-        for (auto& coin : g_coins) {
-            if (coin.active) {
-                float d = sqrt(pow(playerX - coin.x, 2) + pow(playerZ - coin.z, 2));
-                if (d < pickupDist) { coin.active = false; score += 1; coinsCollected++; MciPlayOnce(ALIAS_COIN_PICKUP); }
-            }
+    if (moving) {
+        for (const SnapshotEntity& e : g_frame->entities) {
+            const EntityDrawer& d = ENTITY_DRAWERS[e.kind];
+            if (d.draw && casts(d.bounds(e.transform))) d.draw(e.transform);
         }
-        if (g_mapRoad.placed) {
-            float d = sqrt(pow(playerX - g_mapRoad.x, 2) + pow(playerZ - g_mapRoad.z, 2));
-            if (d < pickupDist) { g_mapRoad.placed = false; hasMap = true; score += 10; MciPlayOnce(ALIAS_MAP_PICKUP); }
-        }
-
-        // NPC Interaction Check
-        showInteractPrompt = (g_npc.placed && sqrt(pow(playerX - g_npc.x, 2) + pow(playerZ - g_npc.z, 2)) < NPC_INTERACT_DISTANCE);
-
-        // Boat Interaction Check
-        showBoatPrompt = (g_boat.placed && sqrt(pow(playerX - g_boat.x, 2) + pow(playerZ - g_boat.z, 2)) < BOAT_INTERACT_DISTANCE);
-
-        // Win condition (Level 1)
-        int coinsRemaining = 0;
-        for (const auto& coin : g_coins) { if (coin.active) coinsRemaining++; }
+        if (g_frame->gameState == LEVEL_2)
+            for (const auto& p : g_frame->pendulums)
+                if (casts(LooseModelSphere(model_spike, p.pivotX, p.pivotY, p.pivotZ, 0.2f))) DrawPendulum(p);
+        // Drawn in first person too: the player still sees their own shadow
+        if (casts(ModelSphere(model_pirate, g_frame->playerX, g_frame->playerY, g_frame->playerZ, g_frame->playerYaw + 180.0f, 0.0f, 0.02f))) DrawPlayer();
+        return;
     }
-    else if (gameState == LEVEL_2) {
-        // --- GEM PICKUPS (Level 2) ---
-        for (auto& gem : g_gems) {
-            if (!gem.active) continue;
-            float d = sqrt(pow(playerX - gem.x, 2) + pow(playerZ - gem.z, 2));
-            if (d < pickupDist) {
-                gem.active = false;
-                gemsCollected++;     // increment gem counter
-                score += 10;          // optional: reward score for gems
-                MciPlayOnce(ALIAS_COIN_PICKUP);
-            }
-        }
 
-        // Pick up Key (Level 2)
-        if (lvl2_key.active) {
-            float d = sqrt(pow(playerX - lvl2_key.x, 2) + pow(playerZ - lvl2_key.z, 2));
-
-            // --- FIX: Reduced radius to 2.0f so it doesn't vanish before you reach it ---
-            if (d < 2.0f) {
-                lvl2_key.active = false;
-                hasLvl2Key = true;
-                MciPlayOnce(ALIAS_COIN_PICKUP);
-            }
+    if (g_frame->gameState == LEVEL_1) {
+        g_shadowStatic.clear();
+        CullStats gridStats = { 0, 0 };
+        CullGridQuery(g_staticCull, f, g_shadowStatic, gridStats);
+        drawn += gridStats.visible; culled += gridStats.culled;
+        for (int i : g_shadowStatic) {
+            const StaticRef& ref = g_staticRefs[i];
+            if (ref.kind == STATIC_ROCK) DrawRock(g_rocks[ref.index]);
+            else if (ref.kind == STATIC_HOUSE) DrawHouse(g_houses[ref.index]);
+            else DrawTree(g_trees[ref.index]);
         }
+        for (int i = 0; i < PLATFORM_COUNT; ++i) {
+            const Platform& p = g_platforms[i];
+            if (casts(ModelSphere(model_palet, p.x, p.y - 0.8f, p.z + 2.6f, 0.0f, 90.0f, p.size * 0.2f))) DrawPalet(p);
+        }
+        if (g_boat.placed && casts(ModelSphere(model_boat, g_boat.x, g_boat.y + 10, g_boat.z + 120, g_boat.yawDeg, 0.0f, g_boat.scale))) DrawBoat();
+        if (g_npc.placed && casts(ModelSphere(model_pirate, g_npc.x, g_npc.y, g_npc.z, g_npc.yawDeg, 0.0f, g_npc.scale))) DrawNpc();
+    }
+    else {
+        // Whole baked batches: a handful of quads per platform
+        DrawMesh(g_lvl2PlatformTops); DrawMesh(g_lvl2PlatformSides); DrawMesh(g_lvl2ChestWalls);
+        drawn += (int)lvl2_platforms.size() + 1;
+        if (casts(ModelSphere(model_chest_3d, lvl2_chest.x, lvl2_chest.y, lvl2_chest.z, 180.0f, 0.0f, 0.12f))) DrawChest();
+    }
+    for (const auto& t : g_torches)
+        if (casts(ModelSphere(model_torch, t.x, t.y, t.z, t.yawDeg, 0.0f, TORCH_SCALE))) DrawTorch(t);
+}
 
-        // Open Chest (Level 2 WIN)
-        float d = sqrt(pow(playerX - lvl2_chest.x, 2) + pow(playerZ - lvl2_chest.z, 2));
-        if (d < 3.0f && hasLvl2Key) {
-            gameState = WIN;
-            // --- UPDATED: Stop music on win ---
-            MciStop(ALIAS_MUSIC2);
-            if (!winSoundPlayed) { MciPlayOnce(ALIAS_WIN); winSoundPlayed = true; }
+// Call with the camera set up (after UpdateViewFrustum), before the scene
+static void RenderSunShadows(float sunX, float sunY, float mapCenter) {
+    g_shadowsDrawn = false;
+    if (!sunShadows || !g_shadowsAvailable || sunY <= 0.0f) return;
+    PROFILE_ZONE("RenderSunShadows"); GPU_ZONE("RenderSunShadows");
+
+    // Everything the casters depend on, brought up to date first
+    if (g_frame->gameState == LEVEL_1 && g_staticRefs.size() != g_rocks.size() + g_houses.size() + g_trees.size()) BuildStaticCullGrid();
+    if (g_frame->gameState == LEVEL_2 && (!g_lvl2Baked || g_lvl2BakedVersion != g_layoutVersion)) BakeLevel2Batches();
+    if (g_torchState != g_frame->gameState || g_torchVersion != g_layoutVersion) PlaceTorches();
+    if (g_shadowState != g_frame->gameState || g_shadowVersion != g_layoutVersion) UpdateShadowScene();
+
+    // The sun circles the map centre in the XY plane
+    const float step = SHADOW_SUN_STEP_DEG * PI / 180.0f;
+    const float angle = floorf(atan2f(sunY, sunX - mapCenter) / step + 0.5f) * step;
+    g_shadowLightDir[0] = cosf(angle); g_shadowLightDir[1] = sinf(angle); g_shadowLightDir[2] = 0.0f;
+
+    float splits[SHADOW_CASCADES + 1];
+    ComputeCascadeSplits(LIGHT_NEAR, SHADOW_DISTANCE, SHADOW_CASCADES, SHADOW_SPLIT_LAMBDA, splits);
+    const float aspect = (float)ViewWidth() / ViewHeight();
+    for (int i = 0; i < SHADOW_CASCADES; ++i) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        ShadowCascade& c = g_cascades[i];
+        ShadowCascadeStats& stats = g_shadowStats[i];
+        stats.movingDrawn = stats.movingCulled = 0;   // the static counts stay as the layer was last drawn
+        stats.staticRedrawn = false;
+        FitShadowCascade(c, g_viewMatrix, 45.0f, aspect, splits[i], splits[i + 1], g_shadowLightDir, g_shadowSceneMin, g_shadowSceneMax, SHADOW_SNAP);
+
+        BeginShadowCascade(i);
+        if (!g_staticLayerValid[i] || !SameCascadeProjection(c, g_cachedCascades[i])) {
+            stats.staticDrawn = stats.staticCulled = 0;
+            BeginShadowLayer(i, SHADOW_STATIC_LAYER, c);
+            DrawShadowCasters(c.casters, false, stats);
+            EndShadowLayer();
+            g_cachedCascades[i] = c;
+            g_staticLayerValid[i] = true;
+            stats.staticRedrawn = true;
         }
+        CopyStaticShadowLayer(i);
+        BeginShadowLayer(i, SHADOW_FRAME_LAYER, c);
+        DrawShadowCasters(c.casters, true, stats);
+        EndShadowLayer();
+        EndShadowCascade(i);
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        stats.cpuMs = stats.cpuMs * 0.95 + ms * 0.05;
     }
+    g_shadowsDrawn = true;
 }
 
+// Darkens what the sun cannot see, fading out as the sun sets
+static void ApplySunShadows(float sunY) {
+    if (!g_shadowsDrawn) return;
+    PROFILE_ZONE("ApplySunShadows"); GPU_ZONE("ApplySunShadows");
+    float strength = SHADOW_STRENGTH * sunY / (sunRadius * 0.25f);
+    if (strength > SHADOW_STRENGTH) strength = SHADOW_STRENGTH;
+    ApplyShadowPass(g_cascades, SHADOW_CASCADES, g_viewMatrix, g_projMatrix, g_shadowLightDir, strength,
+        ViewWidth(), ViewHeight());
+}
 
 // ---------------- RENDERING SCENES ----------------
 
@@ -1050,12 +1066,9 @@ static void RenderPaletsOnPlatforms() {
     glEnable(GL_TEXTURE_2D); glEnable(GL_LIGHTING); glColor3f(0.6f, 0.5f, 0.4f);
     for (int i = 0; i < PLATFORM_COUNT; ++i) {
         const Platform& p = g_platforms[i];
-        glPushMatrix();
-        glTranslatef(p.x, p.y - 0.8f, p.z + 2.6f);
-        glRotatef(90.0f, 1, 0, 0);
-        float s = p.size * 0.2f; glScalef(s, s, s);
-        model_palet.Draw();
-        glPopMatrix();
+        const BoundSphere bounds = ModelSphere(model_palet, p.x, p.y - 0.8f, p.z + 2.6f, 0.0f, 90.0f, p.size * 0.2f);
+        if (!CullSphere(bounds) || Occluded(bounds, model_palet.totalFaces)) continue;
+        DrawPalet(p);
     }
 }
 
@@ -1065,52 +1078,42 @@ void RenderGround() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-    const float tilingFactor = LAND_SIZE / 20.0f;
-    glBegin(GL_QUADS);
-    glTexCoord2f(0.0f, 0.0f); glVertex3f(0.0f, GROUND_Y, 0.0f);
-    glTexCoord2f(tilingFactor, 0.0f); glVertex3f(LAND_SIZE, GROUND_Y, 0.0f);
-    glTexCoord2f(tilingFactor, tilingFactor); glVertex3f(LAND_SIZE, GROUND_Y, LAND_SIZE);
-    glTexCoord2f(0.0f, tilingFactor); glVertex3f(0.0f, GROUND_Y, LAND_SIZE);
-    glEnd();
+    if (g_groundBatch.indexCount == 0) BakeConstantBatches();
+    DrawMesh(g_groundBatch);
 
     // Water: keep solid blue, untextured
     glDisable(GL_TEXTURE_2D); glColor3f(0.2f, 0.4f, 1.0f);
-    glBegin(GL_QUADS); glVertex3f(-100, WATER_Y, -100); glVertex3f(WORLD_SIZE + 100, WATER_Y, -100);
-    glVertex3f(WORLD_SIZE + 100, WATER_Y, WORLD_SIZE + 100); glVertex3f(-100, WATER_Y, WORLD_SIZE + 100); glEnd();
+    DrawMesh(g_waterBatch);
     glEnable(GL_LIGHTING);
 }
 
 void RenderLevel2() {
-    // Draw Platforms
-    glEnable(GL_TEXTURE_2D); groundTexture.Use(); glColor3f(0.8f, 0.8f, 0.8f);
-    for (const auto& p : lvl2_platforms) {
-        float hw = p.width / 2.0f; float hl = p.length / 2.0f; float y = p.y;
-        glBegin(GL_QUADS);
-        glTexCoord2f(0, 0); glVertex3f(p.x - hw, y, p.z - hl); glTexCoord2f(1, 0); glVertex3f(p.x + hw, y, p.z - hl);
-        glTexCoord2f(1, 1); glVertex3f(p.x + hw, y, p.z + hl); glTexCoord2f(0, 1); glVertex3f(p.x - hw, y, p.z + hl);
-        glVertex3f(p.x - hw, y - 2.0f, p.z - hl); glVertex3f(p.x + hw, y - 2.0f, p.z - hl);
-        glVertex3f(p.x + hw, y - 2.0f, p.z + hl); glVertex3f(p.x - hw, y - 2.0f, p.z + hl);
-        glEnd();
-
-        glDisable(GL_TEXTURE_2D); glColor3f(0.4f, 0.4f, 0.4f);
-        glBegin(GL_QUADS);
-        glVertex3f(p.x - hw, y, p.z + hl); glVertex3f(p.x + hw, y, p.z + hl); glVertex3f(p.x + hw, y - 2, p.z + hl); glVertex3f(p.x - hw, y - 2, p.z + hl);
-        glVertex3f(p.x - hw, y, p.z - hl); glVertex3f(p.x + hw, y, p.z - hl); glVertex3f(p.x + hw, y - 2, p.z - hl); glVertex3f(p.x - hw, y - 2, p.z - hl);
-        glVertex3f(p.x - hw, y, p.z - hl); glVertex3f(p.x - hw, y, p.z + hl); glVertex3f(p.x - hw, y - 2, p.z + hl); glVertex3f(p.x - hw, y - 2, p.z - hl);
-        glVertex3f(p.x + hw, y, p.z - hl); glVertex3f(p.x + hw, y, p.z + hl); glVertex3f(p.x + hw, y - 2, p.z + hl); glVertex3f(p.x + hw, y - 2, p.z - hl);
-        glEnd();
+    PROFILE_ZONE("RenderLevel2");
+    if (!g_lvl2Baked || g_lvl2BakedVersion != g_layoutVersion) BakeLevel2Batches();
+
+    // Draw Platforms: frustum-test each one, then draw runs of visible
+    // neighbours from the baked batches with one call per run
+    glEnable(GL_TEXTURE_2D); groundTexture.Use();
+    int runStart = 0, runLength = 0;
+    const int platformCount = (int)lvl2_platforms.size();
+    for (int i = 0; i <= platformCount; ++i) {
+        bool visible = false;
+        if (i < platformCount) {
+            const auto& p = lvl2_platforms[i];
+            float hw = p.width / 2.0f; float hl = p.length / 2.0f; float y = p.y;
+            const float boxMin[3] = { p.x - hw, y - 2.0f, p.z - hl }, boxMax[3] = { p.x + hw, y, p.z + hl };
+            visible = ClassifyBox(g_viewFrustum, boxMin, boxMax) != CULL_OUTSIDE;
+            if (visible) g_cullStats.visible++; else g_cullStats.culled++;
+        }
+        if (visible) { if (runLength++ == 0) runStart = i; continue; }
+        if (runLength == 0) continue;
         glEnable(GL_TEXTURE_2D); glColor3f(0.8f, 0.8f, 0.8f);
+        DrawMeshRange(g_lvl2PlatformTops, runStart * PLATFORM_TOP_INDICES, runLength * PLATFORM_TOP_INDICES);
+        glDisable(GL_TEXTURE_2D); glColor3f(0.4f, 0.4f, 0.4f);
+        DrawMeshRange(g_lvl2PlatformSides, runStart * PLATFORM_SIDE_INDICES, runLength * PLATFORM_SIDE_INDICES);
+        runLength = 0;
     }
-
-    for (const auto& gem : g_gems) {
-        if (!gem.active) continue;
-        glPushMatrix();
-        glTranslatef(gem.x, gem.y + 0.3f * sinf(gameTimer * 3.5f), gem.z);
-        glRotatef(gem.spinDeg, 0, 1, 0);
-        glScalef(1.2f, 1.2f, 1.2f);
-        DrawGem();
-        glPopMatrix();
-    }
+    glEnable(GL_TEXTURE_2D); glColor3f(0.8f, 0.8f, 0.8f);
 
     // --- RENDER SPIKE MODELS WITH METALLIC MATERIAL ---
     glDisable(GL_TEXTURE_2D); // Disable texture so material colors work
@@ -1118,11 +1121,8 @@ void RenderLevel2() {
     // Disable COLOR MATERIAL so the underlying model color doesn't override the Silver
     glDisable(GL_COLOR_MATERIAL);
 
-    for (const auto& p : lvl2_pendulums) {
-        glPushMatrix();
-        glTranslatef(p.pivotX, p.pivotY, p.pivotZ);
-        if (p.axisZ) glRotatef(p.currentAngle, 0, 0, 1);
-        else glRotatef(p.currentAngle, 1, 0, 0);
+    for (const auto& p : g_frame->pendulums) {
+        if (!CullSphere(LooseModelSphere(model_spike, p.pivotX, p.pivotY, p.pivotZ, 0.2f))) continue;
 
         // --- APPLY METALLIC SILVER MATERIAL ---
         GLfloat mat_ambient[] = { 0.25f, 0.25f, 0.25f, 1.0f };    // Dark Grey base
@@ -1136,36 +1136,16 @@ void RenderLevel2() {
         glMaterialf(GL_FRONT, GL_SHININESS, shine);
         // -------------------------------------
 
-        glScalef(0.2f, 0.2f, 0.2f);
-        glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-        model_spike.Draw();
-        glPopMatrix();
+        DrawPendulum(p);
     }
     // Re-enable generic white material for other objects
     glEnable(GL_COLOR_MATERIAL);
     GLfloat defaultMat[] = { 0.8f, 0.8f, 0.8f, 1.0f };
     glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, defaultMat);
 
-    // --- DRAW LEVEL 2 KEY ---
-    if (lvl2_key.active) {
-        glPushMatrix();
-        // --- ADD HOVER EFFECT (Sine Wave on Y) ---
-        float hoverY = lvl2_key.y + 0.5f * sin(gameTimer * 3.0f);
-        glTranslatef(lvl2_key.x, hoverY, lvl2_key.z);
-
-        // --- DRAW KEY MODEL (UNLIT YELLOW) ---
-        glRotatef(gameTimer * 90.0f, 0, 1, 0);
-
-
-        glScalef(1.0f, 1.0f, 1.0f);
-
-        glColor3f(1.0f, 0.84f, 0.0f); // Gold Color
-        model_key.Draw();
-
-        glEnable(GL_LIGHTING);
-        glEnable(GL_TEXTURE_2D);
-        glPopMatrix();
-    }
+    // --- DRAW GEMS AND THE KEY ---
+    glEnable(GL_TEXTURE_2D);
+    DrawEntities();
 
 
 
@@ -1174,25 +1154,14 @@ void RenderLevel2() {
     // Explicitly bind the chest texture
     glBindTexture(GL_TEXTURE_2D, tex_chest.texture[0]);
 
-    glPushMatrix();
-    glTranslatef(lvl2_chest.x, lvl2_chest.y, lvl2_chest.z);
-
-    // Scale adjustment - BIGGER (Was 0.05f -> now 0.25f)
-    glScalef(0.12f, 0.12f, 0.12f);
-
-    // --- ROTATION FIX ---
-    // Removed the X-Rotation that made it lie down.
-    // Added Y-Rotation 180 to face the camera (player).
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-
-    // Reset Material to white so texture colors show correctly
-    GLfloat white[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-    glMaterialfv(GL_FRONT, GL_AMBIENT, white);
-    glMaterialfv(GL_FRONT, GL_DIFFUSE, white);
-
-    model_chest_3d.Draw();
+    if (CullSphere(ModelSphere(model_chest_3d, lvl2_chest.x, lvl2_chest.y, lvl2_chest.z, 180.0f, 0.0f, 0.12f))) {
+        // Reset Material to white so texture colors show correctly
+        GLfloat white[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glMaterialfv(GL_FRONT, GL_AMBIENT, white);
+        glMaterialfv(GL_FRONT, GL_DIFFUSE, white);
 
-    glPopMatrix();
+        DrawChest();
+    }
 
     // Unbind chest texture
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -1200,28 +1169,11 @@ void RenderLevel2() {
     // --- DRAW CHEST WALLS (Ground Texture) ---
     // 3D walls placed at the edges of the chest platform; opening on the approach side (-Z)
     {
-        // Find the platform that contains the chest to place walls at its edges
-        float cx = lvl2_chest.x;
-        float cz = lvl2_chest.z;
-        float px = cx, pz = cz;    // platform center fallback
-        float py = GROUND_Y;       // top surface Y
-        float width = 12.0f;        // fallback width
-        float length = 10.0f;      // fallback length
-
-        for (const auto& p : lvl2_platforms) {
-            float hw = p.width * 0.5f;
-            float hl = p.length * 0.5f;
-            if (fabsf(cx - p.x) <= hw + 0.1f && fabsf(cz - p.z) <= hl + 0.1f) {
-                px = p.x; pz = p.z; py = p.y; width = p.width; length = p.length; break;
-            }
-        }
-
-        float hw = width * 0.5f;
-        float hl = length * 0.5f;
-        const float wallH = 8.0f;        // wall height
-        const float thick = 0.6f;        // wall thickness
-        const float repeatX = 2.5f;      // texture tiling along horizontal span
-        const float repeatY = 4.0f;      // texture tiling along height
+        // Walls are baked with the level (BakeLevel2Batches); the torches
+        // below hang on the same platform edges
+        const ChestRoom room = FindChestRoom();
+        const float px = room.px, pz = room.pz, py = room.py, hw = room.hw, hl = room.hl;
+        const float thick = CHEST_WALL_THICK;
 
         glEnable(GL_TEXTURE_2D);
         glDisable(GL_LIGHTING);          // match ground look (unlit textured)
@@ -1229,59 +1181,7 @@ void RenderLevel2() {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glColor3f(1.0f, 1.0f, 1.0f);
-
-        // Helper lambdas to draw a textured box (axis-aligned)
-        auto DrawBoxXAligned = [&](float xMin, float xMax, float zMin, float zMax, float yMin, float yMax) {
-            // Front (-Z)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMin, yMin, zMin);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMax, yMin, zMin);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMax, yMax, zMin);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMin, yMax, zMin);
-            glEnd();
-            // Back (+Z)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMax, yMin, zMax);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMin, yMin, zMax);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMin, yMax, zMax);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMax, yMax, zMax);
-            glEnd();
-            // Left (-X)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMin, yMin, zMax);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMin, yMin, zMin);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMin, yMax, zMin);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMin, yMax, zMax);
-            glEnd();
-            // Right (+X)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMax, yMin, zMin);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMax, yMin, zMax);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMax, yMax, zMax);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMax, yMax, zMin);
-            glEnd();
-            // Top (+Y)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMin, yMax, zMin);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMax, yMax, zMin);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMax, yMax, zMax);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMin, yMax, zMax);
-            glEnd();
-            // Bottom (-Y)
-            glBegin(GL_QUADS);
-            glTexCoord2f(0.0f, 0.0f);       glVertex3f(xMin, yMin, zMax);
-            glTexCoord2f(repeatX, 0.0f);       glVertex3f(xMax, yMin, zMax);
-            glTexCoord2f(repeatX, repeatY);    glVertex3f(xMax, yMin, zMin);
-            glTexCoord2f(0.0f, repeatY);    glVertex3f(xMin, yMin, zMin);
-            glEnd();
-            };
-
-        // Back wall (placed at +Z edge)
-        DrawBoxXAligned(px - hw, px + hw, pz + hl - thick, pz + hl + thick, py, py + wallH);
-        // Left wall (placed at -X edge)
-        DrawBoxXAligned(px - hw - thick, px - hw + thick, pz - hl, pz + hl, py, py + wallH);
-        // Right wall (placed at +X edge)
-        DrawBoxXAligned(px + hw - thick, px + hw + thick, pz - hl, pz + hl, py, py + wallH);
+        DrawMesh(g_lvl2ChestWalls);
 
         // Restore state for lit, textured models next
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -1320,13 +1220,13 @@ void RenderLevel2() {
             glEnable(GL_LIGHT2);
 
             float cycle = 0.6f; // faster, more noticeable pulsing
-            int phase = (int)(gameTimer / cycle) % 2; // 0 or 1
+            int phase = (int)(g_frame->gameTimer / cycle) % 2; // 0 or 1
             // Base colors
             GLfloat baseHigh[4] = { 1.0f, 0.95f, 0.75f, 1.0f }; // very warm bright
             GLfloat baseLow[4] = { 0.02f, 0.02f, 0.015f, 1.0f }; // near-off
 
             // Add noticeable flicker jitter using different waveforms
-            float t = gameTimer;
+            float t = g_frame->gameTimer;
             float jitterA = 0.35f * sinf(t * 7.0f) + 0.20f * sinf(t * 10.3f + 0.7f); // stronger flicker
             float jitterB = 0.35f * sinf(t * 7.6f + 1.4f) + 0.20f * sinf(t * 9.7f + 2.2f);
             // Clamp jitter so it doesn't go negative when combined with low values
@@ -1408,13 +1308,14 @@ void RenderLevel2() {
 
     // Draw Water (Abyss)
     glDisable(GL_TEXTURE_2D); glColor3f(0.1f, 0.0f, 0.2f);
-    glBegin(GL_QUADS); glVertex3f(-100, WATER_Y - 10, -100); glVertex3f(WORLD_SIZE, WATER_Y - 10, -100);
-    glVertex3f(WORLD_SIZE, WATER_Y - 10, WORLD_SIZE); glVertex3f(-100, WATER_Y - 10, WORLD_SIZE); glEnd();
+    if (g_abyssBatch.indexCount == 0) BakeConstantBatches();
+    DrawMesh(g_abyssBatch);
     glEnable(GL_LIGHTING);
 }
 
 // --- NEW FUNCTION: Draws a round sky sphere (Skydome) ---
 static void RenderSkydome(float radius) {
+    PROFILE_ZONE("RenderSkydome"); GPU_ZONE("RenderSkydome");
     glDisable(GL_LIGHTING); glEnable(GL_TEXTURE_2D);
     // Disable depth writing so sky is always "behind" everything
     glDepthMask(GL_FALSE);
@@ -1422,43 +1323,30 @@ static void RenderSkydome(float radius) {
     skyboxTexture.Use();
     glColor3f(1.0f, 1.0f, 1.0f);
 
-    GLUquadricObj* q = gluNewQuadric();
-    gluQuadricNormals(q, GLU_SMOOTH);
-    gluQuadricTexture(q, GL_TRUE); // Enable texture coords for the sphere
-
     glPushMatrix();
     glRotatef(90, 1, 0, 0); // Rotate to align texture correctly
-    // Invert normals to draw on the inside of the sphere
-    gluQuadricOrientation(q, GLU_INSIDE);
-    // Draw sphere with high slice/stack count for roundness
-    gluSphere(q, radius, 32, 32);
+    // Inside-facing sphere with high slice/stack count for roundness
+    DrawMesh(SphereMesh(radius, 32, 32, true));
     glPopMatrix();
 
-    gluDeleteQuadric(q);
-
     // Re-enable depth writing
     glDepthMask(GL_TRUE);
     glDisable(GL_TEXTURE_2D); glEnable(GL_LIGHTING);
 }
 
 void RenderMenu() {
+    PROFILE_ZONE("RenderMenu");
     glDisable(GL_LIGHTING); glDisable(GL_DEPTH_TEST);
     tex_menu_bg.Use(); glEnable(GL_TEXTURE_2D);
     glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, WIDTH, 0, HEIGHT);
     glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
     glColor3f(1, 1, 1);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0, 0); glVertex2f(0, 0); glTexCoord2f(1, 0); glVertex2f(WIDTH, 0);
-    glTexCoord2f(1, 1); glVertex2f(WIDTH, HEIGHT); glTexCoord2f(0, 1); glVertex2f(0, HEIGHT);
-    glEnd();
+    if (g_menuBackground.indexCount == 0) BakeConstantBatches();
+    DrawMesh(g_menuBackground);
 
     tex_play_btn.Use();
-    float btnW = 200, btnH = 100; float btnX = (WIDTH - btnW) / 2.0f; float btnY = 100.0f;
     glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glBegin(GL_QUADS);
-    glTexCoord2f(0, 0); glVertex2f(btnX, btnY); glTexCoord2f(1, 0); glVertex2f(btnX + btnW, btnY);
-    glTexCoord2f(1, 1); glVertex2f(btnX + btnW, btnY + btnH); glTexCoord2f(0, 1); glVertex2f(btnX, btnY + btnH);
-    glEnd();
+    DrawMesh(g_menuButton);
     glDisable(GL_BLEND);
 
     glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
@@ -1466,161 +1354,400 @@ void RenderMenu() {
 }
 
 void DrawLevelObjects() {
-    if (gameState == LEVEL_1) {
+    PROFILE_ZONE("DrawLevelObjects"); GPU_ZONE("DrawLevelObjects");
+    if (g_frame->gameState == LEVEL_1) {
+        // Rocks, houses and trees: whole grid cells first, then instances
+        if (g_staticRefs.size() != g_rocks.size() + g_houses.size() + g_trees.size()) BuildStaticCullGrid();
+        CullAndSortStatic();
+        const bool boatVisible = g_boat.placed && CullSphere(ModelSphere(model_boat, g_boat.x, g_boat.y + 10, g_boat.z + 120, g_boat.yawDeg, 0.0f, g_boat.scale));
+
+        // Occluders: the visible houses and the boat
+        if (occlusionCulling) {
+            BeginOcclusionFrame(g_occlusion, OCCLUSION_WIDTH, OCCLUSION_HEIGHT, g_viewClip);
+            for (int i : g_visibleStatic) {
+                if (g_staticRefs[i].kind != STATIC_HOUSE) continue;
+                RasterizeOccluderBox(g_occlusion, g_houseOccluders[g_staticRefs[i].index]);
+                g_occlusionStats.occluders++;
+            }
+            if (boatVisible) {
+                RasterizeOccluderBox(g_occlusion, ModelOccluderBox(model_boat, g_boat.x, g_boat.y + 10, g_boat.z + 120, g_boat.yawDeg, 0.0f, g_boat.scale));
+                g_occlusionStats.occluders++;
+            }
+            FinishOccluders(g_occlusion);
+            g_occlusionReady = true;
+        }
+
         RenderGround();
         RenderPaletsOnPlatforms();
         glColor3f(1.0f, 1.0f, 1.0f); glEnable(GL_TEXTURE_2D);
 
-        // Rocks
-        for (const auto& r : g_rocks) { glPushMatrix(); glTranslatef(r.x, r.y, r.z); glRotatef(r.yawDeg, 0, 1, 0); glScalef(r.scale, r.scale, r.scale); model_rocks[r.modelIndex].Draw(); glPopMatrix(); }
-        // Houses
-        for (const auto& h : g_houses) { glPushMatrix(); glTranslatef(h.x, h.y, h.z); glRotatef(h.yawDeg, 0, 1, 0); glRotatef(90.0f, 1, 0, 0); glScalef(h.scale, h.scale, h.scale); model_houses.Draw(); glPopMatrix(); }
-        // Trees
-        for (const auto& t : g_trees) { glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(0, -90, 1, 0); glScalef(t.scale + 1, t.scale + 1, t.scale + 1); model_tree.Draw(); glPopMatrix(); }
-        // Coins
-        for (const auto& coin : g_coins) {
-            if (coin.active) {
-                glPushMatrix(); glTranslatef(coin.x, coin.y, coin.z); glRotatef(coin.spinDeg, 0, 1, 0); glScalef(2.0f, 2.0f, 2.0f); DrawCustomCoin(); glPopMatrix();
-            }
+        for (int i : g_visibleStatic) {
+            const StaticRef& ref = g_staticRefs[i];
+            if (ref.kind == STATIC_ROCK && Occluded(g_staticCull.spheres[i], model_rocks[g_rocks[ref.index].modelIndex].totalFaces)) continue;
+            if (ref.kind == STATIC_TREE && Occluded(g_staticCull.spheres[i], model_tree.totalFaces)) continue;
+            if (ref.kind == STATIC_ROCK) DrawRock(g_rocks[ref.index]);
+            else if (ref.kind == STATIC_HOUSE) DrawHouse(g_houses[ref.index]);
+            else DrawTree(g_trees[ref.index]);
         }
-        //for(const auto& t:g_treasures) {
-            
-            //glPushMatrix(); glTranslatef(t.x, t.y, t.z); glRotatef(t.yawDeg, 0, 1, 0); glScalef(0.5f, 0.5f, 0.5f); model_test.Draw(); glPopMatrix();
-            
-		//}
-        // Map
-        if (g_mapRoad.placed) { glPushMatrix(); glTranslatef(g_mapRoad.x, g_mapRoad.y, g_mapRoad.z); glRotatef(g_mapRoad.spinDeg, 0, 1, 0); glRotatef(45.0f, 1, 0, 0); glScalef(g_mapRoad.scale, g_mapRoad.scale, g_mapRoad.scale); model_map.Draw(); glPopMatrix(); }
+        // Coins and the map
+        DrawEntities();
         // Boat
-        if (g_boat.placed) { glEnable(GL_TEXTURE_2D); glColor3f(0.6f, 0.5f, 0.4f); glPushMatrix(); glTranslatef(g_boat.x, g_boat.y + 10, g_boat.z + 120); glRotatef(g_boat.yawDeg, 0, 1, 0); glScalef(g_boat.scale, g_boat.scale, g_boat.scale); model_boat.Draw(); glPopMatrix(); }
+        if (boatVisible) { glEnable(GL_TEXTURE_2D); glColor3f(0.6f, 0.5f, 0.4f); DrawBoat(); }
         // NPC
-        if (g_npc.placed) { glEnable(GL_TEXTURE_2D); glColor3f(1.0f, 1.0f, 1.0f); glPushMatrix(); glTranslatef(g_npc.x, g_npc.y, g_npc.z); glRotatef(g_npc.yawDeg, 0, 1, 0); glScalef(g_npc.scale, g_npc.scale, g_npc.scale); model_pirate.Draw(); glPopMatrix(); }
+        const BoundSphere npcBounds = ModelSphere(model_pirate, g_npc.x, g_npc.y, g_npc.z, g_npc.yawDeg, 0.0f, g_npc.scale);
+        if (g_npc.placed && CullSphere(npcBounds) && !Occluded(npcBounds, model_pirate.totalFaces)) { glEnable(GL_TEXTURE_2D); glColor3f(1.0f, 1.0f, 1.0f); DrawNpc(); }
     }
-    else if (gameState == LEVEL_2) {
+    else if (g_frame->gameState == LEVEL_2) {
         RenderLevel2();
     }
+    DrawTorches();
 }
 
-void DrawHUD() {
-    // HUD background bar (NOW AT BOTTOM: 0 to 80 pixels high)
-    glDisable(GL_LIGHTING); glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
-    glColor4f(0.0f, 0.0f, 0.0f, 0.35f);
-    glBegin(GL_QUADS);
-    glVertex2f(0, 0); glVertex2f(WIDTH, 0); glVertex2f(WIDTH, 80); glVertex2f(0, 80);
-    glEnd();
-    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
-    glDisable(GL_BLEND); glEnable(GL_DEPTH_TEST); glEnable(GL_LIGHTING);
+// ---------------- HUD ----------------
+// Retained: each widget keeps the vertices it was last laid out with and
+// is only rebuilt when the value it shows changes (the timer at 0.1 s).
+// All widgets go out together in one draw through the glyph atlas. 'H'
+// rebuilds everything every frame, to compare on the stats overlay.
+enum HudWidgetId { HUD_BAR, HUD_SCORE, HUD_COINS, HUD_COUNTER, HUD_HEARTS, HUD_MESSAGES, HUD_STATS, HUD_PROFILER, HUD_WIDGET_COUNT };
+struct HudWidget { long long key; bool valid; std::vector<TextVertex> vertices; };
+static HudWidget g_hudWidgets[HUD_WIDGET_COUNT];
+static std::vector<TextVertex> g_hudVertices;   // every widget back to back
+static int g_hudViewW = 0, g_hudViewH = 0;
+bool hudRebuildAll = false;
+static double g_hudCpuMs = 0.0;   // DrawHUD CPU time, smoothed
+static int g_hudRebuilt = 0;      // widgets laid out again this frame
+
+// True (and the widget emptied) if it has to be laid out again for key
+static bool HudWidgetStale(HudWidget& w, long long key) {
+    if (w.valid && w.key == key && !hudRebuildAll) return false;
+    w.key = key; w.valid = true;
+    w.vertices.clear();
+    g_hudRebuilt++;
+    return true;
+}
 
-    // Score and coins (Moved Y coordinates down to fit in bottom bar)
-    char scoreText[64]; sprintf(scoreText, "Score: %d", score); RenderText(15, 60, scoreText);
-    char coinText[64]; sprintf(coinText, "Coins: %d", coinsCollected); RenderText(15, 35, coinText);
+// Flat shape given in HUD units (WIDTH x HEIGHT), text is in window pixels
+static void HudShape(std::vector<TextVertex>& out, const float points[][2], int count, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    const float sx = (float)g_hudViewW / WIDTH, sy = (float)g_hudViewH / HEIGHT;
+    float scaled[4][2];
+    for (int i = 0; i < count; ++i) { scaled[i][0] = points[i][0] * sx; scaled[i][1] = points[i][1] * sy; }
+    const unsigned char rgba[4] = { r, g, b, a };
+    LayoutSolid(g_hudFont, scaled, count, rgba, out);
+}
+
+static void HudText(std::vector<TextVertex>& out, float x, float y, const char* str) {
+    LayoutText(g_hudFont, x, y, str, out);
+}
+
+// Dialogue, prompts and objectives: which of them are up
+static long long HudMessageKey() {
+    long long key = g_frame->gameState;
+    int bit = 4;
+    const bool flags[] = { g_frame->coinsCollected >= BOAT_COST && g_frame->hasMap, g_frame->showInteractPrompt, g_frame->showNPCDialogue, g_frame->showBoatPrompt,
+        g_frame->showBoatDialogue, g_frame->showBoatDialogue2, g_frame->showBoatInsufficient, g_frame->hasLvl2Key };
+    for (bool f : flags) { if (f) key |= 1LL << bit; bit++; }
+    return key;
+}
+
+static void BuildHudMessages(std::vector<TextVertex>& out) {
+    if (g_frame->gameState == LEVEL_1) {
+        if (g_frame->coinsCollected >= BOAT_COST && g_frame->hasMap) HudText(out, 10, 100, "You can now go to Level 2! (Go to Boat)");
 
-    if (gameState == LEVEL_2) {
-        char gemText[64]; sprintf(gemText, "Gems: %d", gemsCollected);
-        RenderText(15, 10, gemText);
+        // Dialogue and Prompts
+        if (g_frame->showInteractPrompt && !g_frame->showNPCDialogue) HudText(out, WIDTH / 2 - 80, HEIGHT - 200, "Press E to talk");
+        if (g_frame->showBoatPrompt && !g_frame->showBoatDialogue && !g_frame->showBoatInsufficient && !g_frame->showBoatDialogue2) HudText(out, WIDTH / 2 - 120, HEIGHT - 200, "Press E to pay 10 gold");
+        // NPC Dialogue
+        if (g_frame->showNPCDialogue) {
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ahoy there, matey!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 10, "Find the treasure map in the village and collect");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 - 30, "at least 10 gold coins to pay for passage on me boat!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 - 70, "The map will guide ye to the ancient treasure...");
+        }
+        // Boat Dialogue (Has enough coins and map - Ready to transition)
+        if (g_frame->showBoatDialogue) {
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ahoy there, matey! Ready to set sail!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 10, "Welcome to Level 2! (Loading...)");
+        }
+        // Boat Dialogue (Has enough coins, no map)
+        if (g_frame->showBoatDialogue2) {
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 50, "Yer got the gold, matey!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 10, "but ye still need to find the map.");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 - 30, "can't set sail without it.");
+        }
+        // Boat Dialogue (Insufficient coins)
+        if (g_frame->showBoatInsufficient) {
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ye be short on coin, lad!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 + 10, "Bring me 10 gold coins afore we set sail!");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 - 30, "Collect more coin aroun' the village.");
+            HudText(out, WIDTH / 2 - 380, HEIGHT / 2 - 70, "Then we ll chart a course!");
+        }
     }
+    else if (g_frame->gameState == LEVEL_2) {
+        HudText(out, 10, 100, "LEVEL 2: SPIKE DUNGEON");
+        if (!g_frame->hasLvl2Key) HudText(out, 10, 85, "Objective: Find the Key on the side platform!");
+        else HudText(out, 10, 85, "Objective: Open the Chest!");
+    }
+}
 
+// ---------------- PROFILER OVERLAY ----------------
+// 'F': the last whole frame's zones on the main thread, the GPU passes of
+// the newest frame the driver has finished, and the simulation's last
+// tick, each as a tree with the calls of a zone under one parent added up.
+static const float PROFILER_X = WIDTH - 420.0f;
+static const float PROFILER_BOTTOM = 95.0f;   // above the HUD bar
+static std::atomic<int> g_simProfileLane(-1); // set by the simulation thread before its first tick
+static std::vector<ProfileEvent> g_profileEvents;
+static long long g_profileFrameNs = 0, g_profileLastFrameNs = 0;   // start of this frame and the last one
+
+struct ProfileRow { const char* name; int depth; int parent; double ms; int calls; };
+
+// Events oldest first by begin; rows get one line per name under each parent
+static void AggregateProfileEvents(const std::vector<ProfileEvent>& events, std::vector<ProfileRow>& rows) {
+    int open[32];
+    std::fill(open, open + 32, -1);   // a zone whose parent began before the window goes at the top
+    rows.clear();
+    for (const ProfileEvent& e : events) {
+        if (e.depth >= 32) continue;
+        const int parent = e.depth > 0 ? open[e.depth - 1] : -1;
+        int row = -1;
+        for (int r = 0; r < (int)rows.size() && row < 0; ++r)
+            if (rows[r].parent == parent && rows[r].depth == e.depth && strcmp(rows[r].name, e.name) == 0) row = r;
+        if (row < 0) { row = (int)rows.size(); rows.push_back(ProfileRow{ e.name, e.depth, parent, 0.0, 0 }); }
+        rows[row].ms += (e.endNs - e.beginNs) / 1.0e6;
+        rows[row].calls++;
+        open[e.depth] = row;
+    }
+}
 
-    // Lives display (hearts) at BOTTOM RIGHT
-    int heartCount = lives; if (heartCount < 0) heartCount = 0; if (heartCount > 5) heartCount = 5;
-    float hx = WIDTH - 200.0f; float hy = 40.0f;
+static void HudProfileRows(std::vector<TextVertex>& out, const std::vector<ProfileRow>& rows, int parent, float& y) {
+    char text[128];
+    for (int r = 0; r < (int)rows.size(); ++r) {
+        if (rows[r].parent != parent || y < PROFILER_BOTTOM) continue;
+        if (rows[r].calls > 1) sprintf(text, "%*s%s %.3f ms (%d)", 2 * rows[r].depth, "", rows[r].name, rows[r].ms, rows[r].calls);
+        else sprintf(text, "%*s%s %.3f ms", 2 * rows[r].depth, "", rows[r].name, rows[r].ms);
+        HudText(out, PROFILER_X, y, text);
+        y -= 15.0f;
+        HudProfileRows(out, rows, r, y);
+    }
+}
 
-    glDisable(GL_LIGHTING); glDisable(GL_DEPTH_TEST);
-    glDisable(GL_TEXTURE_2D);               // FIX: ensure pure color for hearts
-    glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+static bool ProfileEventBefore(const ProfileEvent& a, const ProfileEvent& b) {
+    return a.beginNs != b.beginNs ? a.beginNs < b.beginNs : a.depth < b.depth;
+}
 
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, WIDTH, 0, HEIGHT);
-    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+static void BuildProfilerOverlay(std::vector<TextVertex>& out) {
+    char text[128];
+    float y = showRenderStats ? HEIGHT - 160.0f - 15.0f * SHADOW_CASCADES : HEIGHT - 25.0f;   // under the stats
+    if (!PROFILER_ENABLED) { HudText(out, PROFILER_X, y, "Profiler: built with PROFILER_ENABLED=0"); return; }
+
+    // A tick is much shorter than a frame, so looking back two frames
+    // always finds a whole one
+    const long long since = g_profileLastFrameNs - (g_profileFrameNs - g_profileLastFrameNs);
+    g_profileEvents.clear();
+    ProfileCollect(since, g_profileEvents);
+    const int mainLane = ProfileCurrentLane(), simLane = g_simProfileLane.load();
+    std::vector<ProfileEvent> mainEvents, simEvents;
+    std::vector<ProfileRow> rows;
+    int jobs = 0; double jobMs = 0.0;
+    long long tickBegin = -1;
+    for (const ProfileEvent& e : g_profileEvents) {
+        const bool lastFrame = e.beginNs >= g_profileLastFrameNs && e.endNs <= g_profileFrameNs;
+        if (e.lane == mainLane && lastFrame) mainEvents.push_back(e);
+        if (e.lane == simLane && e.depth == 0) tickBegin = e.beginNs;   // end order: the last one wins
+        if (lastFrame && strcmp(e.name, "Job") == 0) { jobs++; jobMs += (e.endNs - e.beginNs) / 1.0e6; }
+    }
+    for (const ProfileEvent& e : g_profileEvents) if (e.lane == simLane && tickBegin >= 0 && e.beginNs >= tickBegin) simEvents.push_back(e);
+
+    sprintf(text, "Profiler, last frame %.3f ms (J writes profile.json)", (g_profileFrameNs - g_profileLastFrameNs) / 1.0e6);
+    HudText(out, PROFILER_X, y, text); y -= 20.0f;
+    std::sort(mainEvents.begin(), mainEvents.end(), ProfileEventBefore);
+    AggregateProfileEvents(mainEvents, rows);
+    HudProfileRows(out, rows, -1, y);
+
+    y -= 5.0f;
+    GpuZoneTime gpu[MAX_GPU_ZONES];
+    const int gpuZones = GpuLastFrameZones(gpu, MAX_GPU_ZONES);
+    if (gpuZones == 0) { HudText(out, PROFILER_X, y, "GPU: no timer queries (GL 3.3 / ARB_timer_query)"); y -= 15.0f; }
+    else {
+        sprintf(text, "GPU, %d frames dropped", GpuDroppedFrames());
+        HudText(out, PROFILER_X, y, text); y -= 15.0f;
+        for (int i = 0; i < gpuZones && y >= PROFILER_BOTTOM; ++i, y -= 15.0f) {
+            sprintf(text, "%*s%s %.3f ms", 2 * gpu[i].depth, "", gpu[i].name, gpu[i].ms);
+            HudText(out, PROFILER_X, y, text);
+        }
+    }
 
-    for (int i = 0; i < 5; ++i) {
-        float x = hx + i * 28.0f; float y = hy;
-        if (i < heartCount) glColor4f(1.0f, 0.0f, 0.0f, 0.9f);
-        else glColor4f(0.5f, 0.5f, 0.5f, 0.4f);
+    y -= 5.0f;
+    if (y >= PROFILER_BOTTOM) {
+        sprintf(text, "Jobs in the last frame: %d, %.3f ms", jobs, jobMs);
+        HudText(out, PROFILER_X, y, text); y -= 15.0f;
+    }
+    if (y >= PROFILER_BOTTOM) { HudText(out, PROFILER_X, y, "Simulation, last tick"); y -= 15.0f; }
+    std::sort(simEvents.begin(), simEvents.end(), ProfileEventBefore);
+    AggregateProfileEvents(simEvents, rows);
+    HudProfileRows(out, rows, -1, y);
+}
 
-        glBegin(GL_TRIANGLES);
-        glVertex2f(x + 8, y); glVertex2f(x, y - 12); glVertex2f(x + 16, y - 12);
-        glVertex2f(x + 8, y - 22); glVertex2f(x, y - 12); glVertex2f(x + 16, y - 12);
-        glEnd();
+void DrawHUD() {
+    if (!g_hudFont.texture) return;
+    PROFILE_ZONE("DrawHUD"); GPU_ZONE("DrawHUD");
+    const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    g_hudRebuilt = 0;
+
+    const int viewW = ViewWidth(), viewH = ViewHeight();
+    if (viewW != g_hudViewW || viewH != g_hudViewH) {
+        g_hudViewW = viewW; g_hudViewH = viewH;
+        for (auto& w : g_hudWidgets) w.valid = false;
     }
+    char text[128];
 
-    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
-    glDisable(GL_BLEND);
-    glEnable(GL_TEXTURE_2D);               // restore for subsequent rendering
-    glEnable(GL_DEPTH_TEST); glEnable(GL_LIGHTING);
+    // HUD background bar (NOW AT BOTTOM: 0 to 80 pixels high)
+    HudWidget& bar = g_hudWidgets[HUD_BAR];
+    if (HudWidgetStale(bar, 0)) {
+        const float quad[4][2] = { { 0, 0 }, { WIDTH, 0 }, { WIDTH, 80 }, { 0, 80 } };
+        HudShape(bar.vertices, quad, 4, 0, 0, 0, 89);
+    }
 
-    if (gameState == LEVEL_1) {
-        char timerText[64]; sprintf(timerText, "Time: %.1f", gameTimer); RenderText(15, 10, timerText);
-        if (coinsCollected >= BOAT_COST && hasMap) { glColor3f(0.0f, 1.0f, 0.0f); RenderText(10, 100, "You can now go to Level 2! (Go to Boat)"); glColor3f(1, 1, 1); }
+    // Score and coins (Moved Y coordinates down to fit in bottom bar)
+    HudWidget& scoreWidget = g_hudWidgets[HUD_SCORE];
+    if (HudWidgetStale(scoreWidget, g_frame->score)) { sprintf(text, "Score: %d", g_frame->score); HudText(scoreWidget.vertices, 15, 60, text); }
+    HudWidget& coinWidget = g_hudWidgets[HUD_COINS];
+    if (HudWidgetStale(coinWidget, g_frame->coinsCollected)) { sprintf(text, "Coins: %d", g_frame->coinsCollected); HudText(coinWidget.vertices, 15, 35, text); }
+
+    // Gems in Level 2, the timer (0.1 s steps) in Level 1
+    HudWidget& counter = g_hudWidgets[HUD_COUNTER];
+    const long long counterValue = (g_frame->gameState == LEVEL_2) ? g_frame->gemsCollected : (long long)(g_frame->gameTimer * 10.0f + 0.5f);
+    if (HudWidgetStale(counter, ((long long)g_frame->gameState << 40) | (counterValue & 0xFFFFFFFFFFLL))) {
+        if (g_frame->gameState == LEVEL_2) { sprintf(text, "Gems: %d", g_frame->gemsCollected); HudText(counter.vertices, 15, 10, text); }
+        else if (g_frame->gameState == LEVEL_1) { sprintf(text, "Time: %.1f", counterValue / 10.0f); HudText(counter.vertices, 15, 10, text); }
+    }
 
-        // Dialogue and Prompts
-        if (showInteractPrompt && !showNPCDialogue) { glColor3f(1.0f, 1.0f, 0.0f); RenderText(WIDTH / 2 - 80, HEIGHT - 200, "Press E to talk"); glColor3f(1, 1, 1); }
-        if (showBoatPrompt && !showBoatDialogue && !showBoatInsufficient && !showBoatDialogue2) { glColor3f(0.0f, 1.0f, 0.0f); RenderText(WIDTH / 2 - 120, HEIGHT - 200, "Press E to pay 10 gold"); glColor3f(1, 1, 1); }
-        // NPC Dialogue
-        if (showNPCDialogue) {
-            glColor4f(0.0f, 0.0f, 0.0f, 0.7f); // Background
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ahoy there, matey!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 10, "Find the treasure map in the village and collect");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 - 30, "at least 10 gold coins to pay for passage on me boat!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 - 70, "The map will guide ye to the ancient treasure...");
-        }
-        // Boat Dialogue (Has enough coins and map - Ready to transition)
-        if (showBoatDialogue) {
-            glColor4f(0.0f, 0.0f, 0.0f, 0.7f); // Background
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ahoy there, matey! Ready to set sail!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 10, "Welcome to Level 2! (Loading...)");
-        }
-        // Boat Dialogue (Has enough coins, no map)
-        if (showBoatDialogue2) {
-            glColor4f(0.0f, 0.0f, 0.0f, 0.7f); // Background
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 50, "Yer got the gold, matey!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 10, "but ye still need to find the map.");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 - 30, "can't set sail without it.");
+    // Lives display (hearts) at BOTTOM RIGHT
+    int heartCount = g_frame->lives; if (heartCount < 0) heartCount = 0; if (heartCount > 5) heartCount = 5;
+    HudWidget& hearts = g_hudWidgets[HUD_HEARTS];
+    if (HudWidgetStale(hearts, heartCount)) {
+        float hx = WIDTH - 200.0f; float hy = 40.0f;
+        for (int i = 0; i < 5; ++i) {
+            float x = hx + i * 28.0f; float y = hy;
+            const bool full = i < heartCount;
+            const float top[3][2] = { { x + 8, y }, { x, y - 12 }, { x + 16, y - 12 } };
+            const float bottom[3][2] = { { x + 8, y - 22 }, { x, y - 12 }, { x + 16, y - 12 } };
+            if (full) { HudShape(hearts.vertices, top, 3, 255, 0, 0, 230); HudShape(hearts.vertices, bottom, 3, 255, 0, 0, 230); }
+            else { HudShape(hearts.vertices, top, 3, 128, 128, 128, 102); HudShape(hearts.vertices, bottom, 3, 128, 128, 128, 102); }
         }
-        // Boat Dialogue (Insufficient coins)
-        if (showBoatInsufficient) {
-            glColor4f(0.0f, 0.0f, 0.0f, 0.7f); // Background
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 50, "Ye be short on coin, lad!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 + 10, "Bring me 10 gold coins afore we set sail!");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 - 30, "Collect more coin aroun' the village.");
-            RenderText(WIDTH / 2 - 380, HEIGHT / 2 - 70, "Then we ll chart a course!");
+    }
+
+    HudWidget& messages = g_hudWidgets[HUD_MESSAGES];
+    if (HudWidgetStale(messages, HudMessageKey())) BuildHudMessages(messages.vertices);
+
+    // Render stats overlay (P): changes every frame while shown
+    static long long statsFrame = 0;
+    const JobStats jobs = TakeJobStats();   // since the last HUD: simulation ticks and this frame's culling
+    static unsigned long long lastFrameTick = 0;
+    const int ticksSinceFrame = (int)(g_frame->tick - lastFrameTick);
+    lastFrameTick = g_frame->tick;
+    HudWidget& stats = g_hudWidgets[HUD_STATS];
+    if (HudWidgetStale(stats, showRenderStats ? ++statsFrame : -1) && showRenderStats) {
+        sprintf(text, "Objects drawn: %d  culled: %d", g_cullStats.visible, g_cullStats.culled);
+        HudText(stats.vertices, 10, HEIGHT - 25, text);
+        sprintf(text, "Occlusion %s: %d occluders, %d/%d hidden, %d triangles skipped", occlusionCulling ? "on" : "off",
+            g_occlusionStats.occluders, g_occlusionStats.occluded, g_occlusionStats.tested, g_occlusionStats.trianglesSkipped);
+        HudText(stats.vertices, 10, HEIGHT - 40, text);
+        sprintf(text, "HUD %s: %.3f ms CPU", hudRebuildAll ? "rebuilt every frame" : "retained", g_hudCpuMs);
+        HudText(stats.vertices, 10, HEIGHT - 55, text);
+        if (!g_lightPassAvailable) sprintf(text, "Torch lights: %d (no GL 2.0 / float textures)", (int)g_torchLights.size());
+        else if (!torchLighting) sprintf(text, "Torch lights off: %d", (int)g_torchLights.size());
+        else sprintf(text, "Torch lights: %d, %d cluster entries (max %d per cluster), %.3f ms binning", (int)g_torchLights.size(),
+            (int)g_lightClusters.indices.size(), g_lightClusters.maxPerCluster, g_lightClusterMs);
+        HudText(stats.vertices, 10, HEIGHT - 70, text);
+        if (!g_shadowsAvailable) { sprintf(text, "Sun shadows: no GL 2.0 / framebuffer objects"); HudText(stats.vertices, 10, HEIGHT - 85, text); }
+        else if (!sunShadows || !g_shadowsDrawn) { sprintf(text, "Sun shadows %s", sunShadows ? "idle (sun down)" : "off"); HudText(stats.vertices, 10, HEIGHT - 85, text); }
+        else for (int i = 0; i < SHADOW_CASCADES; ++i) {
+            const ShadowCascadeStats& c = g_shadowStats[i];
+            sprintf(text, "Cascade %d (to %.0f): static %d/%d %s, moving %d/%d, %.3f ms CPU, %.3f ms GPU", i, g_cascades[i].splitFar,
+                c.staticDrawn, c.staticDrawn + c.staticCulled, c.staticRedrawn ? "redrawn" : "cached", c.movingDrawn, c.movingDrawn + c.movingCulled,
+                c.cpuMs, ShadowCascadeGpuMs(i));
+            HudText(stats.vertices, 10, HEIGHT - 85 - 15.0f * i, text);
         }
+        int normalMapped = 0; float tangentMs = 0.0f;
+        NormalMapStats(normalMapped, tangentMs);
+        sprintf(text, "Normal maps %s: %d materials, tangent frames built in %.2f ms at load", !g_normalMapsAvailable ? "unavailable (no GL 2.0)" : normalMapping ? "on" : "off",
+            normalMapped, tangentMs);
+        HudText(stats.vertices, 10, HEIGHT - 85 - 15.0f * SHADOW_CASCADES, text);
+        sprintf(text, "Jobs: %d on %d workers, %d stolen", jobs.jobs, jobs.workers, jobs.steals);
+        HudText(stats.vertices, 10, HEIGHT - 100 - 15.0f * SHADOW_CASCADES, text);
+        sprintf(text, "Simulation: tick %llu, %.3f ms, %d ticks since the last frame", g_frame->tick, g_frame->simMs, ticksSinceFrame);
+        HudText(stats.vertices, 10, HEIGHT - 115 - 15.0f * SHADOW_CASCADES, text);
+        const AudioStats audio = GetAudioStats();
+        sprintf(text, "Audio: %d/%d voices, %d blocks, %.3f ms last mix, %d underruns, %d dropped, %d stolen, %d refused, %d music starved",
+            audio.voices, MAX_AUDIO_VOICES, audio.blocks, audio.mixMs, audio.underruns, audio.dropped, audio.stolen, audio.refused, audio.musicStarved);
+        HudText(stats.vertices, 10, HEIGHT - 130 - 15.0f * SHADOW_CASCADES, text);
+        const PacerStats pacer = GetPacerStats();
+        const TelemetrySummary shown = GetTelemetrySummary(g_frame->gameState);
+        char pacing[64];
+        if (pacer.vsyncPacing) sprintf(pacing, "vsync, swap interval %d", PacerSwapInterval());
+        else if (pacer.periodMs > 0.0f) sprintf(pacing, "%.1f Hz", 1000.0f / pacer.periodMs);
+        else sprintf(pacing, "uncapped");
+        sprintf(text, "Pacing %s: %.2f ms asleep, %.2f ms spinning a frame (margin %.2f ms); this state: %.2f ms jitter, %.0f%% CPU",
+            pacing, pacer.sleepMs, pacer.spinMs, pacer.spinMarginMs, shown.frameMsJitter, shown.cpuPercent);
+        HudText(stats.vertices, 10, HEIGHT - 145 - 15.0f * SHADOW_CASCADES, text);
     }
-    else if (gameState == LEVEL_2) {
-        RenderText(10, 100, "LEVEL 2: SPIKE DUNGEON");
-        if (!hasLvl2Key) { glColor3f(1, 0, 0); RenderText(10, 85, "Objective: Find the Key on the side platform!"); glColor3f(1, 1, 1); }
-        else { glColor3f(0, 1, 0); RenderText(10, 85, "Objective: Open the Chest!"); glColor3f(1, 1, 1); }
+
+    static long long profilerFrame = 0;
+    HudWidget& profiler = g_hudWidgets[HUD_PROFILER];
+    if (HudWidgetStale(profiler, showProfiler ? ++profilerFrame : -1) && showProfiler) BuildProfilerOverlay(profiler.vertices);
+
+    // Composite: only re-join the stream when a widget changed
+    if (g_hudRebuilt > 0) {
+        g_hudVertices.clear();
+        for (const auto& w : g_hudWidgets) g_hudVertices.insert(g_hudVertices.end(), w.vertices.begin(), w.vertices.end());
     }
+    if (!g_hudVertices.empty()) DrawTextVertices(g_hudFont, &g_hudVertices[0], (int)g_hudVertices.size(), viewW, viewH);
+
+    // Same state the immediate-mode HUD always left behind
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glEnable(GL_TEXTURE_2D); glEnable(GL_LIGHTING); glEnable(GL_DEPTH_TEST);
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    g_hudCpuMs = g_hudCpuMs * 0.95 + ms * 0.05;
 }
 
 
 void myDisplay(void) {
+    g_profileLastFrameNs = g_profileFrameNs;
+    g_profileFrameNs = ProfileNow();
+    GpuFrameBegin();
+    GpuZoneBegin("Frame");
+    PROFILE_ZONE("Frame");
+    g_frame = &AcquireSnapshot(g_snapshots);
+    if (g_profileLastFrameNs > 0) TelemetryFrame((g_profileFrameNs - g_profileLastFrameNs) / 1.0e6f, g_frame->gameState);
+    // Glyph atlas is captured from the back buffer, so before the clear
+    if (!g_hudFont.texture) BuildGlyphAtlas(g_hudFont, GLUT_BITMAP_HELVETICA_18);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    if (gameState == MENU) {
+    if (g_frame->gameState == MENU) {
         RenderMenu();
     }
-    else if (gameState == LEVEL_1 || gameState == LEVEL_2) {
+    else if (g_frame->gameState == LEVEL_1 || g_frame->gameState == LEVEL_2) {
         // Camera Setup
         glLoadIdentity();
         float eyeX, eyeY, eyeZ, centerX, centerY, centerZ;
         float rad = camYaw * PI / 180.0f;
         float pitchRad = camPitch * PI / 180.0f;
         if (isTopDown) {
-            eyeX = playerX + camDistance * sin(rad);
-            eyeY = playerY + 20.0f;
-            eyeZ = playerZ + camDistance * cos(rad);
+            eyeX = g_frame->playerX + camDistance * sin(rad);
+            eyeY = g_frame->playerY + 20.0f;
+            eyeZ = g_frame->playerZ + camDistance * cos(rad);
 
-            centerX = playerX;
-            centerY = playerY + 1.0f;
-            centerZ = playerZ;
+            centerX = g_frame->playerX;
+            centerY = g_frame->playerY + 1.0f;
+            centerZ = g_frame->playerZ;
         }
         else if (isFirstPerson) {
             
-            eyeX = playerX;
-            eyeY = playerY + 8.2f; 
-            eyeZ = playerZ;
+            eyeX = g_frame->playerX;
+            eyeY = g_frame->playerY + 8.2f; 
+            eyeZ = g_frame->playerZ;
 
             
             centerX = eyeX - 10.0f * sin(rad) * cos(pitchRad);
@@ -1629,15 +1756,16 @@ void myDisplay(void) {
         }
         else {
             // Third Person (Standard)
-            eyeX = playerX + camDistance * sin(rad);
-            eyeY = playerY + 5.0f;
-            eyeZ = playerZ + camDistance * cos(rad);
+            eyeX = g_frame->playerX + camDistance * sin(rad);
+            eyeY = g_frame->playerY + 5.0f;
+            eyeZ = g_frame->playerZ + camDistance * cos(rad);
 
-            centerX = playerX;
-            centerY = playerY + 1.0f;
-            centerZ = playerZ;
+            centerX = g_frame->playerX;
+            centerY = g_frame->playerY + 1.0f;
+            centerZ = g_frame->playerZ;
         }
         gluLookAt(eyeX, eyeY, eyeZ, centerX, centerY, centerZ, 0, 1, 0);
+        UpdateViewFrustum();
 
         // --- ROUND SKYDOME ---
         glPushMatrix();
@@ -1653,8 +1781,8 @@ void myDisplay(void) {
         // It rotates around the Z-axis (East-West motion) centered on the map.
         // Center of map is (LAND_SIZE/2, 0, LAND_SIZE/2).
         float mapCenter = LAND_SIZE / 2.0f;
-        float sunX = mapCenter + sunRadius * cos(sunAngle); // Moves East/West
-        float sunY = sunRadius * sin(sunAngle);             // Moves Up/Down
+        float sunX = mapCenter + sunRadius * cos(g_frame->sunAngle); // Moves East/West
+        float sunY = sunRadius * sin(g_frame->sunAngle);             // Moves Up/Down
         float sunZ = mapCenter;                             // Stays centered depth-wise
 
         // 2. Update the actual Light Source (GL_LIGHT0) position
@@ -1673,29 +1801,26 @@ void myDisplay(void) {
             glLightfv(GL_LIGHT0, GL_DIFFUSE, bright);
         }
 
-        // --- DRAW SUN AS A YELLOW SPHERE WITH TEXTURE ---
-        glPushMatrix();
-        glTranslatef(sunX, sunY, sunZ);
-        glDisable(GL_LIGHTING); // Disable lighting so it glows
-        glEnable(GL_TEXTURE_2D);
-        tex_sun.Use(); // Bind the sun texture
-
-        // Use pure white so the texture colors show clearly. 
-        // If texture is grayscale, use Yellow (1,1,0) to tint it.
-        glColor3f(1.0f, 1.0f, 1.0f);
+        RenderSunShadows(sunX, sunY, mapCenter);
 
-        // Create Sphere with texture coords
-        GLUquadricObj* qSun = gluNewQuadric();
-        gluQuadricTexture(qSun, GL_TRUE);
-        gluQuadricNormals(qSun, GLU_SMOOTH);
+        // --- DRAW SUN AS A YELLOW SPHERE WITH TEXTURE ---
+        if (CullSphere(BoundSphere{ sunX, sunY, sunZ, 40.0f })) {
+            glPushMatrix();
+            glTranslatef(sunX, sunY, sunZ);
+            glDisable(GL_LIGHTING); // Disable lighting so it glows
+            glEnable(GL_TEXTURE_2D);
+            tex_sun.Use(); // Bind the sun texture
 
-        // Draw Sphere (Radius 40.0f = Nice and Big)
-        gluSphere(qSun, 40.0f, 32, 32);
+            // Use pure white so the texture colors show clearly. 
+            // If texture is grayscale, use Yellow (1,1,0) to tint it.
+            glColor3f(1.0f, 1.0f, 1.0f);
 
-        gluDeleteQuadric(qSun);
+            // Draw Sphere (Radius 40.0f = Nice and Big)
+            DrawMesh(SphereMesh(40.0f, 32, 32, false));
 
-        glEnable(GL_LIGHTING);
-        glPopMatrix();
+            glEnable(GL_LIGHTING);
+            glPopMatrix();
+        }
         // ---------------------------------------------------
 
         // Scene Objects
@@ -1704,11 +1829,6 @@ void myDisplay(void) {
         // --- DRAW PLAYER (PIRATE) ---
         // Only draw in Third Person
         if (!isFirstPerson) {
-            glPushMatrix();
-            glTranslatef(playerX, playerY, playerZ);
-            glRotatef(playerYaw + 180.0f, 0, 1, 0); // Rotate to match camera (Face forward)
-            glScalef(0.02f, 0.02f, 0.02f); // Scale down (matches NPC scale)
-
             // --- FIX FOR MISSING PIRATE TEXTURE IN LEVEL 2 ---
             // Ensure texturing is ON and color is WHITE before drawing the player
             // This fixes it if Level 2 disabled textures for spikes.
@@ -1716,20 +1836,22 @@ void myDisplay(void) {
             glColor3f(1.0f, 1.0f, 1.0f);
             // -------------------------------------------------
 
-            model_pirate.Draw();
-            glPopMatrix();
+            DrawPlayer();
         }
 
+        ApplySunShadows(sunY);
+        ApplyTorchLighting(sunY);
+
         // HUD
         DrawHUD();
 
         // FADE SCREEN
-        if (fadeAlpha > 0.0f) {
+        if (g_frame->fadeAlpha > 0.0f) {
             glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D); glDisable(GL_DEPTH_TEST);
             glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, WIDTH, 0, HEIGHT);
             glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
-            glColor4f(0, 0, 0, fadeAlpha);
+            glColor4f(0, 0, 0, g_frame->fadeAlpha);
             glBegin(GL_QUADS); glVertex2f(0, 0); glVertex2f(WIDTH, 0); glVertex2f(WIDTH, HEIGHT); glVertex2f(0, HEIGHT); glEnd();
             glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
             glDisable(GL_BLEND); glEnable(GL_DEPTH_TEST); glEnable(GL_LIGHTING);
@@ -1738,93 +1860,156 @@ void myDisplay(void) {
     }
     else {
         // WIN/LOSE Screen
-        if (gameState == WIN) {
+        if (g_frame->gameState == WIN) {
             RenderFullScreenTexture(tex_win_bg);
         }
-        else if (gameState == LOSE) {
+        else if (g_frame->gameState == LOSE) {
             RenderFullScreenTexture(tex_lose_bg);
         }
         glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, WIDTH, 0, HEIGHT);
         glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
         glDisable(GL_LIGHTING); glDisable(GL_DEPTH_TEST); glColor3f(1, 1, 1);
-        if (gameState == WIN) {
+        if (g_frame->gameState == WIN) {
             RenderText(WIDTH / 2 - 150, HEIGHT / 2, "You claimed the treasure!");
         }
         else {
             RenderText(WIDTH / 2 - 150, HEIGHT / 2, "Out of lives. Better luck next time!");
         }
-        char finalScore[64]; sprintf(finalScore, "Final Score: %d", score); RenderText(WIDTH / 2 - 100, HEIGHT / 2 - 40, finalScore);
+        char finalScore[64]; sprintf(finalScore, "Final Score: %d", g_frame->score); RenderText(WIDTH / 2 - 100, HEIGHT / 2 - 40, finalScore);
         RenderText(WIDTH / 2 - 120, HEIGHT / 2 - 80, "Press ESC to exit");
+        FlushHUDText();
         glEnable(GL_DEPTH_TEST); glEnable(GL_LIGHTING);
         glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
     }
-    glutSwapBuffers();
+    GpuZoneEnd();
+    if (!g_capturing) { PROFILE_ZONE("SwapBuffers"); glutSwapBuffers(); }
+}
+
+
+// ---------------- SIMULATION THREAD ----------------
+// UpdateWorld runs on its own thread at SIM_TICK_HZ and publishes a
+// snapshot after every tick, while the main thread, which owns the GL
+// context and the GLUT callbacks, renders the newest one. A frame then
+// costs about max(simulation, rendering) instead of their sum. Input gets
+// to the simulation through g_simInput, taken at the start of each tick;
+// sounds go straight into the mixer's queue (Audio.h). --capture steps the world on
+// the main thread instead, one tick per frame. With --record every tick's
+// input goes into a journal too (InputJournal.h).
+static std::mutex g_simInputMutex;
+static SimInput g_simInput = {};
+static std::thread g_simThread;
+static std::atomic<bool> g_simQuit(false);
+static unsigned long long g_simTicks = 0;
+static const double SIM_TICK_HZ = 120.0;
+
+static SimInput TakeSimInput() {
+    std::lock_guard<std::mutex> lock(g_simInputMutex);
+    const SimInput in = g_simInput;
+    g_simInput.jump = g_simInput.turned = g_simInput.interact = g_simInput.startRun = false;
+    return in;
+}
+
+static void ApplySimInput(const SimInput& in) {
+    keyW = in.keyW; keyA = in.keyA; keyS = in.keyS; keyD = in.keyD;
+    if (in.jump) spaceTrigger = true;
+    if (in.turned) playerYaw = in.yaw;
+    if (in.startRun && gameState == MENU) StartNewRun();
+    if (in.interact && !isFadingOut) Interact();
+}
+
+static void PublishFrame(float simMs) {
+    FillSnapshot(SnapshotToWrite(g_snapshots), g_simTicks, simMs);
+    PublishSnapshot(g_snapshots);
+}
+
+static void SimulationMain() {
+    ProfileThreadName("simulation");
+    g_simProfileLane = ProfileCurrentLane();
+    typedef std::chrono::steady_clock SimClock;
+    const SimClock::duration tick = std::chrono::duration_cast<SimClock::duration>(std::chrono::duration<double>(1.0 / SIM_TICK_HZ));
+    SimClock::time_point last = SimClock::now(), next = last;
+    while (!g_simQuit.load()) {
+        {
+            PROFILE_ZONE("Tick");
+            const SimInput in = TakeSimInput();
+            ApplySimInput(in);
+            const SimClock::time_point now = SimClock::now();
+            float dt = std::chrono::duration<float>(now - last).count(); if (dt > 0.05f) dt = 0.05f; last = now;
+            g_tickMs = WallClockMs();
+            UpdateWorld(dt, g_tickMs);
+            g_simTicks++;
+            JournalTickDone(in, dt, g_tickMs);
+            PublishFrame(std::chrono::duration<float, std::milli>(SimClock::now() - now).count());
+        }
+
+        // Behind schedule (a long tick, a debugger) means start again from now, not catch up
+        next += tick;
+        if (next < SimClock::now()) next = SimClock::now();
+        std::this_thread::sleep_until(next);
+    }
 }
 
+static void StopSimulation() {
+    if (!g_simThread.joinable()) return;
+    g_simQuit = true;
+    g_simThread.join();
+}
+
+static void StartSimulation() {
+    PublishFrame(0.0f);   // something to draw, and for the callbacks to read, before the first tick
+    g_frame = &AcquireSnapshot(g_snapshots);
+    g_simThread = std::thread(SimulationMain);
+    atexit(StopSimulation);   // GLUT leaves through exit() when the window closes
+}
 
 // ---------------- INPUT & ANIMATION ----------------
+// Callbacks run on the main thread: view toggles apply directly, anything
+// the simulation owns goes through g_simInput.
 
 void myKeyboard(unsigned char button, int x, int y) {
-    if (isFadingOut) return;
+    PacerWake();
+    if (g_frame->isFadingOut) return;
+    if (button == 27) { StopSimulation(); Sound_Shutdown(); exit(0); }
+    std::lock_guard<std::mutex> lock(g_simInputMutex);
     switch (button) {
-    case 'w': case 'W': keyW = true; break; case 's': case 'S': keyS = true; break;
-    case 'a': case 'A': keyA = true; break; case 'd': case 'D': keyD = true; break;
-    case ' ': spaceTrigger = true; break; case 'v': case 'V': isFirstPerson = !isFirstPerson; break;
+    case 'w': case 'W': g_simInput.keyW = true; break; case 's': case 'S': g_simInput.keyS = true; break;
+    case 'a': case 'A': g_simInput.keyA = true; break; case 'd': case 'D': g_simInput.keyD = true; break;
+    case ' ': g_simInput.jump = true; break; case 'v': case 'V': isFirstPerson = !isFirstPerson; break;
+    case 'p': case 'P': showRenderStats = !showRenderStats; break;
+    case 'f': case 'F': showProfiler = !showProfiler; break;
+    case 'j': case 'J':
+        if (WriteChromeTrace("profile.json")) printf("Wrote profile.json\n");
+        else printf("Could not write profile.json\n");
+        break;
+    case 'o': case 'O': occlusionCulling = !occlusionCulling; break;
+    case 'h': case 'H': hudRebuildAll = !hudRebuildAll; break;
+    case 'l': case 'L': torchLighting = !torchLighting; break;
+    case 'k': case 'K': sunShadows = !sunShadows; break;
+    case 'n': case 'N': normalMapping = !normalMapping; break;
     case 't':case 'T':
 		isTopDown = !isTopDown;
 		if (isTopDown) isFirstPerson = false;
         break;
-    case 'e': case 'E':
-        if (gameState == LEVEL_1) {
-            if (showInteractPrompt) {
-                MciPlayOnce(ALIAS_NPC_INTERACT); showNPCDialogue = true; dialogueTimer = 0.0f;
-            }
-            else if (showBoatPrompt) {
-                MciPlayOnce(ALIAS_BOAT_INTERACT);
-                if (coinsCollected >= BOAT_COST) {
-                    if (hasMap) {
-                        coinsCollected -= BOAT_COST; paidForBoat = true; isFadingOut = true;
-                        showBoatDialogue = true; boatDialogueTimer = 0.0f; MciPlayOnce(ALIAS_COIN_PICKUP);
-                    }
-                    else {
-                        showBoatDialogue2 = true; boatDialogueTimer = 0.0f;
-                    }
-                }
-                else {
-                    showBoatInsufficient = true; boatDialogueTimer = 0.0f;
-                }
-            }
-        }
-        break;
-    case 27: Sound_Shutdown(); exit(0); break;
+    case 'e': case 'E': g_simInput.interact = true; break;
     }
 }
 
 void myKeyboardUp(unsigned char button, int x, int y) {
+    std::lock_guard<std::mutex> lock(g_simInputMutex);
     switch (button) {
-    case 'w': case 'W': keyW = false; break; case 's': case 'S': keyS = false; break;
-    case 'a': case 'A': keyA = false; break; case 'd': case 'D': keyD = false; break;
+    case 'w': case 'W': g_simInput.keyW = false; break; case 's': case 'S': g_simInput.keyS = false; break;
+    case 'a': case 'A': g_simInput.keyA = false; break; case 'd': case 'D': g_simInput.keyD = false; break;
     }
 }
 void myMouse(int button, int state, int x, int y) {
-    if (gameState == MENU) {
+    PacerWake();
+    if (g_frame->gameState == MENU) {
         if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
             float btnW = 200, btnH = 100; float btnX = (WIDTH - btnW) / 2.0f; float btnY = 100.0f;
             int glY = HEIGHT - y;
             if (x >= btnX && x <= (btnX + btnW) && glY >= btnY && glY <= (btnY + btnH)) {
-                gameState = LEVEL_1; // Start Level 1
-                // Reset player to Level 1 start pos
-                playerX = 2.0f; playerZ = 2.0f; playerY = 0.0f;
-                // Reset game state for new run
-                score = 1000; // Start at 1000 on new game
-                coinsCollected = 0; // START WITH 10 COINS AS REQUESTED
-                gameTimer = 0.0f;
-                lives = 5; // START WITH 5 HEARTS
-                showNPCDialogue = false; showBoatDialogue = false; showBoatDialogue2 = false; showBoatInsufficient = false;
-
-                // --- UPDATED: Ensure Level 1 music starts ---
-                MciStop(ALIAS_MUSIC2); // Stop level 2 if it was playing
-                MciPlayLoop(ALIAS_MUSIC1);
+                std::lock_guard<std::mutex> lock(g_simInputMutex);
+                g_simInput.startRun = true;
             }
         }
     }
@@ -1857,7 +2042,8 @@ void myMotion(int x, int y) {
     if (camPitch > 89.0f) camPitch = 89.0f;    // Look down limit
     if (camPitch < -89.0f) camPitch = -89.0f; // Look up limit (was -10)
 
-    playerYaw = camYaw;
+    std::lock_guard<std::mutex> lock(g_simInputMutex);
+    g_simInput.turned = true; g_simInput.yaw = camYaw;
 }
 
 void myReshape(int w, int h) {
@@ -1868,75 +2054,292 @@ void myReshape(int w, int h) {
     glMatrixMode(GL_MODELVIEW);
 }
 
+// ---------------- FRAME PACING ----------------
+// The idle callback asks the pacer (FramePacer.h) whether the next frame is
+// due instead of drawing again straight away. Options:
+//   --fps N        target frame rate (default: the display's refresh rate,
+//                  60 if Windows does not say; 0 draws as fast as possible)
+//   --vsync 0|1    wait for the display in the swap (default 1, where the
+//                  driver has WGL_EXT_swap_control)
+//   --idle-fps N   rate of the menu, win and lose screens (default 10; 0
+//                  draws them like the levels)
+// The telemetry (Telemetry.h) and the stats overlay give the CPU use and
+// the frame time jitter per game state.
+static const float DEFAULT_FPS = 60.0f, DEFAULT_IDLE_FPS = 10.0f;
+static float g_fpsOption = -1.0f;   // -1: the refresh rate
+static float g_idleFpsOption = DEFAULT_IDLE_FPS;
+static bool g_vsyncOption = true;
+
+static void ParsePacingArgs(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--fps") == 0) g_fpsOption = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--vsync") == 0) g_vsyncOption = atoi(argv[++i]) != 0;
+        else if (strcmp(argv[i], "--idle-fps") == 0) g_idleFpsOption = (float)atof(argv[++i]);
+    }
+}
+
+// After the window exists: its context is the one the swap interval applies to
+static void InitFramePacing() {
+    PacerOptions options;
+    DEVMODEA mode = {};
+    mode.dmSize = sizeof(mode);
+    options.refreshHz = EnumDisplaySettingsA(nullptr, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1 ? (float)mode.dmDisplayFrequency : 0.0f;
+    options.targetHz = g_fpsOption >= 0.0f ? g_fpsOption : options.refreshHz > 0.0f ? options.refreshHz : DEFAULT_FPS;
+    options.lowPowerHz = g_idleFpsOption;
+
+    typedef BOOL (WINAPI* SwapIntervalProc)(int interval);
+    const SwapIntervalProc setSwapInterval = (SwapIntervalProc)wglGetProcAddress("wglSwapIntervalEXT");
+    options.vsync = g_vsyncOption && setSwapInterval;
+    SetPacerOptions(options);
+    if (setSwapInterval) setSwapInterval(PacerSwapInterval());
+}
+
+// Nothing moves on these screens, so they are drawn at the idle rate
+static bool StaticScreen() {
+    return g_frame->gameState == MENU || g_frame->gameState == WIN || g_frame->gameState == LOSE;
+}
+
 void Anim() {
-    static int lastT = -1; int t = glutGet(GLUT_ELAPSED_TIME);
-    if (lastT == -1) lastT = t; float dt = (t - lastT) / 1000.0f; if (dt > 0.05f) dt = 0.05f; lastT = t;
-    // decrease score over time: -1 point/sec, clamp at 0
-    static float scoreAccum = 0.0f;
-    if (gameState == LEVEL_1 || gameState == LEVEL_2) {
-        scoreAccum += dt;
-        while (scoreAccum >= 1.0f) {
-            if (score > 0) score -= 1;
-            scoreAccum -= 1.0f;
-        }
+    if (PacerFrameDue(StaticScreen())) glutPostRedisplay();
+}
+
+// ---------------- HEADLESS CAPTURE ----------------
+// OpenGLMeshLoader --capture [--frames N] [--images N] [--out file.csv] [--trace file.json]
+// renders LEVEL_1 and LEVEL_2 for N frames each (default 600) at a fixed
+// 60 Hz step, with the player walked along a scripted path, into the
+// offscreen target instead of the window, which is never shown. Prints a
+// timing summary, writes every frame's times to the csv (default
+// capture.csv), with --images, every Nth frame to capture/ and, with
+// --trace, the profiler's zones (the last PROFILE_RING_EVENTS of each
+// thread) as a Chrome trace. The window
+// only provides the GL context, so with Mesa's software opengl32.dll next
+// to the exe it runs on machines without a GPU or a display.
+struct CaptureOptions { int frames; int imageEvery; const char* csvPath; const char* tracePath; };
+static CaptureOptions g_captureOptions = { 600, 0, "capture.csv", nullptr };
+static const float CAPTURE_DT = 1.0f / 60.0f;
+
+// Takes --capture and its options out of argv; false if it is not there
+static bool ParseCaptureArgs(int argc, char** argv) {
+    bool capture = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--capture") == 0) capture = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) g_captureOptions.frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--images") == 0 && i + 1 < argc) g_captureOptions.imageEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) g_captureOptions.csvPath = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) g_captureOptions.tracePath = argv[++i];
     }
+    if (g_captureOptions.frames < 1) g_captureOptions.frames = 1;
+    return capture;
+}
 
-    // Transition Logic
-    if (isFadingOut) {
-        fadeAlpha += dt * 0.8f;
-        if (fadeAlpha >= 1.0f) {
-            fadeAlpha = 1.0f; isFadingOut = false; gameState = LEVEL_2; isFadingIn = true;
-            ResetPlayerLvl2();
-
-            // --- UPDATED: Switch Music when Level Changes ---
-            MciStop(ALIAS_MUSIC1);      // Stop Level 1 Music
-            MciPlayLoop(ALIAS_MUSIC2);  // Start Level 2 Music
-            // ------------------------------------------------
-        }
+// Puts the player (and the third person camera behind them) where the path
+// is t seconds into the level
+static void PlaceCapturePlayer(float t) {
+    if (gameState == LEVEL_1) {
+        // Round the village on a 100-unit circle at top speed, like bench/RenderBench.cpp
+        const float a = t * maxSpeed / 100.0f;
+        playerX = LAND_SIZE / 2.0f + 100.0f * cosf(a);
+        playerZ = LAND_SIZE / 2.0f + 100.0f * sinf(a);
+        playerY = GROUND_Y;
+        camYaw = 180.0f - a * 180.0f / PI;
     }
-    else if (isFadingIn) {
-        fadeAlpha -= dt * 0.8f; if (fadeAlpha <= 0.0f) { fadeAlpha = 0.0f; isFadingIn = false; }
+    else {
+        // Up the spike corridor to the chest platform and back
+        const float length = 120.0f, d = fmodf(t * maxSpeed * 0.5f, 2.0f * length);
+        playerX = 0.0f;
+        playerZ = d < length ? d : 2.0f * length - d;
+        playerY = 0.0f;
+        camYaw = d < length ? 180.0f : 0.0f;
     }
+    playerYaw = camYaw;
+    velX = velY = velZ = 0.0f;
+}
 
-    if (gameState == LEVEL_1 || gameState == LEVEL_2) {
-        // --- FIX: Update Timer in BOTH levels so rotation works ---
-        gameTimer += dt;
-
-        // --- SUN MOVEMENT UPDATE ---
-        sunAngle += sunSpeed * dt;
-        if (sunAngle > 360.0f) sunAngle -= 360.0f;
-        // ---------------------------
-
-        if (gameState == LEVEL_1) {
-            if (g_mapRoad.placed) { g_mapRoad.spinDeg += 60.0f * dt; if (g_mapRoad.spinDeg > 360.0f) g_mapRoad.spinDeg -= 360.0f; }
-            for (auto& coin : g_coins) { coin.spinDeg += 120.0f * dt; if (coin.spinDeg > 360.0f) coin.spinDeg -= 360.0f; }
-            // Dialogue Timers
-            if (showNPCDialogue) { dialogueTimer += dt; if (dialogueTimer >= DIALOGUE_DURATION) showNPCDialogue = false; }
-            if (showBoatDialogue || showBoatDialogue2 || showBoatInsufficient) { boatDialogueTimer += dt; if (boatDialogueTimer >= DIALOGUE_DURATION) { showBoatDialogue = false; showBoatDialogue2 = false; showBoatInsufficient = false; } }
+static void StartCaptureLevel(GameState level) {
+    gameState = level;
+    score = 1000; lives = 5; coinsCollected = 0; gameTimer = 0.0f;
+    fadeAlpha = 0.0f; isFadingOut = isFadingIn = false;
+    showNPCDialogue = showBoatDialogue = showBoatDialogue2 = showBoatInsufficient = false;
+    isFirstPerson = isTopDown = false;
+    camPitch = 15.0f;
+    sunAngle = 0.6f;   // mid-morning, so the sun shadows are part of the frame
+    if (level == LEVEL_2) ResetPlayerLvl2();
+}
 
+static int RunCapture() {
+    if (!InitCaptureTarget(WIDTH, HEIGHT)) {
+        printf("--capture needs framebuffer objects (GL 3.0 or ARB_framebuffer_object)\n");
+        return 1;
+    }
+    myReshape(WIDTH, HEIGHT);
+    if (g_captureOptions.imageEvery > 0) _mkdir("capture");
+
+    const GameState levels[] = { LEVEL_1, LEVEL_2 };
+    std::vector<CaptureSegment> segments;
+    for (GameState level : levels) {
+        CaptureSegment segment;
+        segment.name = level == LEVEL_1 ? "level1" : "level2";
+        StartCaptureLevel(level);
+        for (int f = 0; f < g_captureOptions.frames; ++f) {
+            const float t = f * CAPTURE_DT;
+            g_tickMs = (int)(t * 1000.0f);
+            UpdateWorld(CAPTURE_DT, g_tickMs);
+            g_simTicks++;
+            // A spike or the chest may end the run; the path carries on regardless
+            gameState = level; lives = 5; isFadingOut = false;
+            PlaceCapturePlayer(t);
+            PublishFrame(0.0f);
+
+            BeginCaptureFrame();
+            myDisplay();
+            segment.frames.push_back(EndCaptureFrame());
+            if (g_captureOptions.imageEvery > 0 && f % g_captureOptions.imageEvery == 0) {
+                char path[64]; sprintf(path, "capture/%s_%04d.tga", segment.name, f);
+                WriteCaptureImage(path);
+            }
         }
-        else if (gameState == LEVEL_2) {
-            for (auto& p : lvl2_pendulums) { p.currentAngle = p.maxAngle * sin(t / 1000.0f * p.speed); }
-            // Spin gems in level 2
-            for (auto& gem : g_gems) { gem.spinDeg += 90.0f * dt; if (gem.spinDeg > 360.0f) gem.spinDeg -= 360.0f; }
+        segments.push_back(segment);
+    }
+
+    PrintCaptureSummary(segments);
+    if (!WriteCaptureTimings(g_captureOptions.csvPath, segments)) {
+        printf("Could not write %s\n", g_captureOptions.csvPath);
+        return 1;
+    }
+    if (g_captureOptions.tracePath) {
+        glFinish(); GpuFrameBegin();   // read back the GPU zones still in flight
+        if (!WriteChromeTrace(g_captureOptions.tracePath)) {
+            printf("Could not write %s\n", g_captureOptions.tracePath);
+            return 1;
         }
+    }
+    return 0;
+}
 
+// ---------------- INPUT REPLAY ----------------
+// OpenGLMeshLoader --record file.journal plays as usual and writes the
+// layout seed and every tick's input to the journal (InputJournal.h).
+// OpenGLMeshLoader --replay file.journal lays the levels out from its seed
+// and runs its ticks through UpdateWorld back to back, with no window, GL
+// or sound. Prints the tick times and whether the world matched the
+// recording at every check line; exits 2 if it did not, so a script can
+// tell a physics change from a pure speed-up.
+static const char* g_recordPath = nullptr;
+static const char* g_replayPath = nullptr;
+
+static void ParseJournalArgs(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--record") == 0) g_recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0) g_replayPath = argv[++i];
+    }
+}
+
+static void StartRecording() {
+    if (!StartJournal(g_recordPath, g_layoutSeed)) { printf("Could not write %s\n", g_recordPath); return; }
+    atexit(StopJournal);   // before StartSimulation's, so it runs after the last tick
+}
 
-        UpdateMovement(dt); CheckGameLogic();
+static int RunReplay() {
+    InputJournal journal;
+    if (!LoadJournal(g_replayPath, journal)) return 1;
+    if (journal.ticks.empty()) { printf("%s has no ticks\n", g_replayPath); return 1; }
+    LayOutLevels(journal.seed);
+
+    typedef std::chrono::steady_clock ReplayClock;
+    std::vector<float> tickMs;
+    tickMs.reserve(journal.ticks.size());
+    size_t check = 0, matched = 0;
+    long long firstMismatch = -1;
+    double playSeconds = 0.0;
+    const ReplayClock::time_point start = ReplayClock::now();
+    for (const JournalTick& tick : journal.ticks) {
+        const ReplayClock::time_point begin = ReplayClock::now();
+        ApplySimInput(tick.input);
+        g_tickMs = tick.elapsedMs;
+        UpdateWorld(tick.dt, g_tickMs);
+        tickMs.push_back(std::chrono::duration<float, std::milli>(ReplayClock::now() - begin).count());
+        g_simTicks++;
+        playSeconds += tick.dt;
+        if (check < journal.checks.size() && journal.checks[check].tick == g_simTicks) {
+            if (HashWorldState() == journal.checks[check].hash) matched++;
+            else if (firstMismatch < 0) firstMismatch = (long long)g_simTicks;
+            check++;
+        }
+    }
+    const double wallSeconds = std::chrono::duration<double>(ReplayClock::now() - start).count();
+
+    double sum = 0.0;
+    for (float ms : tickMs) sum += ms;
+    std::vector<float> sorted(tickMs);
+    std::sort(sorted.begin(), sorted.end());
+    auto pct = [&](float p) { return sorted[(size_t)(p * (sorted.size() - 1))]; };
+    printf("Replayed %zu ticks (%.1f s of play, seed %u) in %.2f s: %.0f ticks/s, %.0fx real time\n",
+        tickMs.size(), playSeconds, journal.seed, wallSeconds, tickMs.size() / wallSeconds, playSeconds / wallSeconds);
+    printf("Tick ms: mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+        sum / tickMs.size(), pct(0.50f), pct(0.95f), pct(0.99f), sorted.back());
+    if (journal.checks.empty()) printf("State: no check lines to compare, final hash %016llx\n", HashWorldState());
+    else if (firstMismatch < 0) printf("State: matches the recording at all %zu checks, final hash %016llx\n", matched, HashWorldState());
+    else {
+        const JournalTick& at = journal.ticks[(size_t)firstMismatch - 1];
+        printf("State: differs from the recording from tick %lld (%.1f s in), %zu of %zu checks match\n",
+            firstMismatch, (at.elapsedMs - journal.ticks[0].elapsedMs) / 1000.0, matched, journal.checks.size());
     }
-    glutPostRedisplay();
+    return firstMismatch < 0 ? 0 : 2;
+}
+
+// ---------------- TELEMETRY EXPORT ----------------
+// Counters (Telemetry.h) always run; these options export them:
+//   --telemetry file.csv       a row per game state every period, appended
+//   --telemetry-json file.json the session so far, rewritten every period
+//   --metrics-port N           OpenMetrics on http://127.0.0.1:N/metrics
+//   --telemetry-period ms      default 1000
+static TelemetryOptions g_telemetryOptions = { 1000, nullptr, nullptr, 0 };
+
+// True if any export was asked for
+static bool ParseTelemetryArgs(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (strcmp(argv[i], "--telemetry") == 0) g_telemetryOptions.csvPath = argv[++i];
+        else if (strcmp(argv[i], "--telemetry-json") == 0) g_telemetryOptions.jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--metrics-port") == 0) g_telemetryOptions.metricsPort = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--telemetry-period") == 0) g_telemetryOptions.periodMs = atoi(argv[++i]);
+    }
+    return g_telemetryOptions.csvPath || g_telemetryOptions.jsonPath || g_telemetryOptions.metricsPort > 0;
+}
+
+static void StartTelemetryExport() {
+    SetTelemetryStateName(MENU, "menu"); SetTelemetryStateName(LEVEL_1, "level_1"); SetTelemetryStateName(LEVEL_2, "level_2");
+    SetTelemetryStateName(WIN, "win"); SetTelemetryStateName(LOSE, "lose");
+    if (!StartTelemetry(g_telemetryOptions)) printf("Telemetry: could not open every sink\n");
+    atexit(StopTelemetry);
 }
 
 void main(int argc, char** argv) {
     glutInit(&argc, argv); glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
+    ParseJournalArgs(argc, argv);
+    ParsePacingArgs(argc, argv);
+    if (g_replayPath) exit(RunReplay());   // the simulation needs no window, GL or sound
+    g_capturing = ParseCaptureArgs(argc, argv);
     glutInitWindowSize(WIDTH, HEIGHT); glutInitWindowPosition(100, 150); glutCreateWindow(title);
+    if (g_capturing) glutHideWindow();   // only the context is needed; the loop that would map it never runs
+    glewInit();   // GL 1.5 vertex buffers for GeometryCache
+    ProfileThreadName("main");
+    InitGpuProfiler();
     glutDisplayFunc(myDisplay); glutKeyboardFunc(myKeyboard); glutKeyboardUpFunc(myKeyboardUp);
     glutMouseFunc(myMouse); glutMotionFunc(myMotion); glutReshapeFunc(myReshape); glutIdleFunc(Anim);
-    myInit(); LoadAssets(); Sound_Init();
+    myInit(); LoadAssets();
+    g_lightPassAvailable = InitLightingPass();
+    g_shadowsAvailable = InitShadowMaps(SHADOW_CASCADES, SHADOW_MAP_SIZE);
+    g_normalMapsAvailable = InitNormalMapShader();
+    if (ParseTelemetryArgs(argc, argv)) StartTelemetryExport();
+    if (g_capturing) exit(RunCapture());   // silent: audio never starts, triggers just fill its queue
+    Sound_Init();
 
     // --- UPDATED: Start with Level 1 Music ---
-    MciPlayLoop(ALIAS_MUSIC1);
+    PlayMusic(SND_MUSIC1, 0);
 
+    if (g_recordPath) StartRecording();
+    InitFramePacing();
+    StartSimulation();
     glutMainLoop();
     Sound_Shutdown();
 }
\ No newline at end of file
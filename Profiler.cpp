@@ -0,0 +1,207 @@
+// ---------------- FRAME PROFILER ----------------
+// See Profiler.h.
+
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+
+static const int MAX_PROFILE_LANES = 48;
+
+// A seqlock per slot: the stamp is odd while event n is being written and
+// 2n + 2 once it is, so a reader can tell a finished event from one being
+// overwritten under it. Every field is a relaxed atomic, which on x86 is a
+// plain store.
+struct ProfileSlot {
+    std::atomic<unsigned> stamp;
+    std::atomic<const char*> name;
+    std::atomic<long long> begin, end;
+    std::atomic<int> depth;
+};
+
+struct ProfileLane {
+    ProfileSlot slots[PROFILE_RING_EVENTS];
+    std::atomic<unsigned> written;   // events so far
+    char label[32];                  // under g_laneMutex
+    ProfileLane() : written(0) {
+        for (ProfileSlot& s : slots) s.stamp.store(0, std::memory_order_relaxed);
+        label[0] = 0;
+    }
+};
+
+// Lanes are never freed, so a thread's zones outlive it for the trace; the
+// lane of a thread that has exited is handed to the next new one (job
+// workers come and go with the worker count)
+static ProfileLane* g_lanes[MAX_PROFILE_LANES];
+static std::atomic<int> g_laneCount(0);
+static std::mutex g_laneMutex;
+static std::vector<int> g_freeLanes;   // under g_laneMutex
+
+struct LaneOwner {
+    int lane = -1;   // -2 once every lane was taken
+    ~LaneOwner() {
+        if (lane < 0) return;
+        std::lock_guard<std::mutex> lock(g_laneMutex);
+        g_freeLanes.push_back(lane);
+    }
+};
+static thread_local LaneOwner t_lane;
+#if PROFILER_ENABLED
+static thread_local int t_depth = 0;
+#endif
+static const std::chrono::steady_clock::time_point g_profileStart = std::chrono::steady_clock::now();
+
+long long ProfileNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_profileStart).count();
+}
+
+static int AddLane(const char* label) {
+    std::lock_guard<std::mutex> lock(g_laneMutex);
+    const int lane = g_laneCount.load(std::memory_order_relaxed);
+    if (lane == MAX_PROFILE_LANES) return -1;
+    g_lanes[lane] = new ProfileLane();
+    if (label) snprintf(g_lanes[lane]->label, sizeof(g_lanes[lane]->label), "%s", label);
+    else snprintf(g_lanes[lane]->label, sizeof(g_lanes[lane]->label), "thread %d", lane);
+    g_laneCount.store(lane + 1, std::memory_order_release);
+    return lane;
+}
+
+int ProfileAddLane(const char* label) { return AddLane(label); }
+
+#if PROFILER_ENABLED
+static int CurrentLane() {
+    if (t_lane.lane != -1) return t_lane.lane;
+    {
+        std::lock_guard<std::mutex> lock(g_laneMutex);
+        if (!g_freeLanes.empty()) {
+            t_lane.lane = g_freeLanes.back();
+            g_freeLanes.pop_back();
+            snprintf(g_lanes[t_lane.lane]->label, sizeof(g_lanes[t_lane.lane]->label), "thread %d", t_lane.lane);
+            return t_lane.lane;
+        }
+    }
+    const int lane = AddLane(nullptr);
+    t_lane.lane = lane < 0 ? -2 : lane;
+    return lane;
+}
+#endif
+
+int ProfileCurrentLane() { return t_lane.lane < 0 ? -1 : t_lane.lane; }
+
+void ProfileThreadName(const char* label) {
+#if PROFILER_ENABLED
+    const int lane = CurrentLane();
+    if (lane < 0) return;
+    std::lock_guard<std::mutex> lock(g_laneMutex);
+    snprintf(g_lanes[lane]->label, sizeof(g_lanes[lane]->label), "%s", label);
+#else
+    (void)label;   // no zones will come, so no ring either
+#endif
+}
+
+int ProfileLaneCount() { return g_laneCount.load(std::memory_order_acquire); }
+
+void ProfileLaneLabel(int lane, char* out, int size) {
+    std::lock_guard<std::mutex> lock(g_laneMutex);
+    snprintf(out, size, "%s", lane >= 0 && lane < g_laneCount.load() ? g_lanes[lane]->label : "");
+}
+
+void ProfileAddEvent(int lane, const char* name, long long beginNs, long long endNs, int depth) {
+    if (lane < 0) return;
+    ProfileLane& l = *g_lanes[lane];
+    const unsigned n = l.written.load(std::memory_order_relaxed);
+    ProfileSlot& s = l.slots[n & (PROFILE_RING_EVENTS - 1)];
+    s.stamp.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.name.store(name, std::memory_order_relaxed);
+    s.begin.store(beginNs, std::memory_order_relaxed);
+    s.end.store(endNs, std::memory_order_relaxed);
+    s.depth.store(depth, std::memory_order_relaxed);
+    s.stamp.store(2 * n + 2, std::memory_order_release);
+    l.written.store(n + 1, std::memory_order_release);
+}
+
+#if PROFILER_ENABLED
+ProfileScope::ProfileScope(const char* zoneName) : name(zoneName), lane(CurrentLane()) {
+    ++t_depth;
+    begin = ProfileNow();
+}
+
+ProfileScope::~ProfileScope() {
+    const long long end = ProfileNow();
+    --t_depth;
+    ProfileAddEvent(lane, name, begin, end, t_depth);
+}
+#endif
+
+static bool ReadSlot(const ProfileLane& l, unsigned n, ProfileEvent& e) {
+    const ProfileSlot& s = l.slots[n & (PROFILE_RING_EVENTS - 1)];
+    const unsigned stamp = s.stamp.load(std::memory_order_acquire);
+    if (stamp != 2 * n + 2) return false;
+    e.name = s.name.load(std::memory_order_relaxed);
+    e.beginNs = s.begin.load(std::memory_order_relaxed);
+    e.endNs = s.end.load(std::memory_order_relaxed);
+    e.depth = s.depth.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return s.stamp.load(std::memory_order_relaxed) == stamp;
+}
+
+// A lane's events are in the order they ended, so walking back from the
+// newest can stop at the first one that ended before sinceNs
+void ProfileCollect(long long sinceNs, std::vector<ProfileEvent>& out) {
+    const int lanes = ProfileLaneCount();
+    for (int lane = 0; lane < lanes; ++lane) {
+        const ProfileLane& l = *g_lanes[lane];
+        const unsigned written = l.written.load(std::memory_order_acquire);
+        const unsigned oldest = written > PROFILE_RING_EVENTS ? written - PROFILE_RING_EVENTS : 0;
+        const size_t first = out.size();
+        for (unsigned n = written; n-- > oldest;) {
+            ProfileEvent e;
+            if (!ReadSlot(l, n, e)) continue;
+            if (e.endNs < sinceNs) break;
+            if (e.beginNs < sinceNs) continue;
+            e.lane = lane;
+            out.push_back(e);
+        }
+        std::reverse(out.begin() + first, out.end());
+    }
+}
+
+static void WriteJsonString(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+// Complete ("X") events in microseconds, and a name for every lane
+bool WriteChromeTrace(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    std::vector<ProfileEvent> events;
+    ProfileCollect(0, events);
+    fprintf(f, "{\"traceEvents\":[\n");
+    const int lanes = ProfileLaneCount();
+    for (int lane = 0; lane < lanes; ++lane) {
+        char label[32];
+        ProfileLaneLabel(lane, label, sizeof(label));
+        fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", lane);
+        WriteJsonString(f, label);
+        fprintf(f, "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}%s\n",
+            lane, lane, events.empty() && lane == lanes - 1 ? "" : ",");
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        const ProfileEvent& e = events[i];
+        fprintf(f, "{\"name\":");
+        WriteJsonString(f, e.name);
+        fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n", e.lane, e.beginNs / 1000.0,
+            (e.endNs - e.beginNs) / 1000.0, i + 1 < events.size() ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    return fclose(f) == 0;
+}
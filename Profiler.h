@@ -0,0 +1,76 @@
+// ---------------- FRAME PROFILER ----------------
+// Nested CPU zones, recorded per thread:
+//
+//   void RenderLevel2() {
+//       PROFILE_ZONE("RenderLevel2");
+//       ...
+//   }
+//
+// A zone is timed from the macro to the end of its block and written, when
+// it closes, into its thread's ring of the last PROFILE_RING_EVENTS zones:
+// two clock reads and a few relaxed stores, no lock and no allocation.
+// Threads register themselves on their first zone. Anything may read the
+// rings at any time (the overlay, the trace export); a zone overwritten
+// while it is being read is skipped rather than torn.
+//
+// GPU passes are timed separately (GpuProfiler.h) and added to a ring of
+// their own with ProfileAddEvent.
+//
+// Build with PROFILER_ENABLED=0 and PROFILE_ZONE compiles to nothing.
+//
+// No GL, GLUT or Windows, like GameWorld.h.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#include <vector>
+
+static const int PROFILE_RING_EVENTS = 16384;   // per thread, a power of two
+
+// Nanoseconds on a steady clock shared by every thread
+long long ProfileNow();
+
+// Labels the calling thread's ring in the overlay and the trace ("main",
+// "simulation"); the text is copied. Nothing without PROFILER_ENABLED.
+void ProfileThreadName(const char* label);
+
+// A ring that is not a thread, e.g. the GPU; its events are added with
+// ProfileAddEvent by one thread at a time. -1 when all rings are taken.
+int ProfileAddLane(const char* label);
+// name must be a literal or otherwise outlive the profiler
+void ProfileAddEvent(int lane, const char* name, long long beginNs, long long endNs, int depth);
+
+// Zones of every ring that begin at or after sinceNs, oldest first per ring
+struct ProfileEvent { const char* name; long long beginNs, endNs; int depth; int lane; };
+void ProfileCollect(long long sinceNs, std::vector<ProfileEvent>& out);
+// Ring of the calling thread, -1 before its first zone
+int ProfileCurrentLane();
+int ProfileLaneCount();
+void ProfileLaneLabel(int lane, char* out, int size);
+
+// Everything still in the rings, as Chrome trace-event JSON (load it in
+// chrome://tracing or ui.perfetto.dev)
+bool WriteChromeTrace(const char* path);
+
+#if PROFILER_ENABLED
+struct ProfileScope {
+    const char* name;
+    long long begin;
+    int lane;
+    explicit ProfileScope(const char* zoneName);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_ZONE(name) ProfileScope PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+#endif // PROFILER_H
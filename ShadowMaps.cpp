@@ -0,0 +1,283 @@
+// ---------------- SHADOW MAPS ----------------
+// See ShadowMaps.h.
+
+#include "glew.h"
+#include "ShadowMaps.h"
+#include <stdio.h>
+
+static int g_cascadeCount = 0, g_mapSize = 0;
+static GLuint g_layerTex[MAX_SHADOW_CASCADES][2], g_layerFbo[MAX_SHADOW_CASCADES][2];
+static GLuint g_shadowProgram = 0;
+static GLuint g_sceneDepthTex = 0;
+static int g_sceneDepthWidth = 0, g_sceneDepthHeight = 0;
+static bool g_shadowMapsReady = false;
+// What the scene draws into (the window, or the --capture target), bound
+// again after every shadow layer
+static GLint g_sceneFramebuffer = 0;
+
+// Two timer queries per cascade, alternating frames, so reading one never
+// waits on the frame still in flight
+static bool g_timersAvailable = false;
+static GLuint g_timerQuery[MAX_SHADOW_CASCADES][2];
+static bool g_timerPending[MAX_SHADOW_CASCADES][2];
+static int g_timerSlot[MAX_SHADOW_CASCADES];
+static float g_gpuMs[MAX_SHADOW_CASCADES];
+
+static const char* SHADOW_PASS_FRAGMENT =
+    "#version 120\n"
+    "uniform sampler2D depthTex;\n"
+    "uniform sampler2DShadow shadow0, shadow1, shadow2, shadow3;\n"
+    "uniform vec2 viewSize;\n"
+    "uniform vec4 projParams;      // proj[0], proj[5], proj[10], proj[14]\n"
+    "uniform mat4 shadowMatrix[4]; // view space to shadow map texture space\n"
+    "uniform vec4 splitFar;        // 0 for unused cascades\n"
+    "uniform vec4 normalOffset;    // per cascade, world units\n"
+    "uniform vec3 lightDirView;\n"
+    "uniform float strength;\n"
+    "uniform float texel;\n"
+    "float Lit(sampler2DShadow map, mat4 m, vec3 pos) {\n"
+    "    vec3 c = (m * vec4(pos, 1.0)).xyz;\n"
+    "    if (any(lessThan(c, vec3(0.0))) || any(greaterThan(c, vec3(1.0)))) return 1.0;\n"
+    "    float h = 0.5 * texel;\n"
+    "    return 0.25 * (shadow2D(map, c + vec3(-h, -h, 0.0)).r + shadow2D(map, c + vec3(h, -h, 0.0)).r\n"
+    "                 + shadow2D(map, c + vec3(-h, h, 0.0)).r + shadow2D(map, c + vec3(h, h, 0.0)).r);\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 uv = gl_FragCoord.xy / viewSize;\n"
+    "    float depth = texture2D(depthTex, uv).r;\n"
+    "    if (depth >= 1.0) discard;\n"
+    "    float viewZ = -projParams.w / (depth * 2.0 - 1.0 + projParams.z);\n"
+    "    vec2 ndc = uv * 2.0 - 1.0;\n"
+    "    vec3 pos = vec3(ndc.x * -viewZ / projParams.x, ndc.y * -viewZ / projParams.y, viewZ);\n"
+    "    vec3 n = normalize(cross(dFdx(pos), dFdy(pos)));\n"
+    "    if (dot(n, pos) > 0.0) n = -n;\n"
+    "    float facing = dot(n, lightDirView);\n"
+    "    if (facing <= 0.0) discard;   // turned away from the sun: already unlit\n"
+    "    float d = -viewZ, lit = 1.0;\n"
+    "    if (d < splitFar.x) lit = Lit(shadow0, shadowMatrix[0], pos + n * normalOffset.x);\n"
+    "    else if (d < splitFar.y) lit = Lit(shadow1, shadowMatrix[1], pos + n * normalOffset.y);\n"
+    "    else if (d < splitFar.z) lit = Lit(shadow2, shadowMatrix[2], pos + n * normalOffset.z);\n"
+    "    else if (d < splitFar.w) lit = Lit(shadow3, shadowMatrix[3], pos + n * normalOffset.w);\n"
+    "    float shade = 1.0 - strength * (1.0 - lit) * clamp(facing * 4.0, 0.0, 1.0);\n"
+    "    gl_FragColor = vec4(shade, shade, shade, 1.0);\n"
+    "}\n";
+
+static GLuint BuildShadowProgram() {
+    GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(shader, 1, &SHADOW_PASS_FRAGMENT, 0);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024]; glGetShaderInfoLog(shader, sizeof(log), 0, log);
+        printf("Shadow pass shader failed to compile:\n%s\n", log);
+        glDeleteShader(shader);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDeleteShader(shader);
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        printf("Shadow pass shader failed to link\n");
+        glDeleteProgram(program);
+        return 0;
+    }
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "depthTex"), 0);
+    const char* names[MAX_SHADOW_CASCADES] = { "shadow0", "shadow1", "shadow2", "shadow3" };
+    for (int i = 0; i < MAX_SHADOW_CASCADES; ++i) glUniform1i(glGetUniformLocation(program, names[i]), 1 + i);
+    glUseProgram(0);
+    return program;
+}
+
+// Depth texture sampled with hardware comparison (and 2x2 filtering where
+// the driver does it)
+static GLuint CreateShadowTexture(int size) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+}
+
+bool InitShadowMaps(int cascadeCount, int mapSize) {
+    if (!GLEW_VERSION_2_0 || !(GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object)) return false;
+    if (cascadeCount < 1 || cascadeCount > MAX_SHADOW_CASCADES) return false;
+    g_shadowProgram = BuildShadowProgram();
+    if (!g_shadowProgram) return false;
+
+    g_cascadeCount = cascadeCount; g_mapSize = mapSize;
+    for (int i = 0; i < cascadeCount; ++i) {
+        for (int layer = 0; layer < 2; ++layer) {
+            g_layerTex[i][layer] = CreateShadowTexture(mapSize);
+            glGenFramebuffers(1, &g_layerFbo[i][layer]);
+            glBindFramebuffer(GL_FRAMEBUFFER, g_layerFbo[i][layer]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, g_layerTex[i][layer], 0);
+            glDrawBuffer(GL_NONE); glReadBuffer(GL_NONE);
+            const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            if (status != GL_FRAMEBUFFER_COMPLETE) {
+                printf("Shadow map framebuffer incomplete (0x%x)\n", status);
+                return false;
+            }
+        }
+    }
+
+    g_timersAvailable = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    for (int i = 0; i < cascadeCount; ++i) {
+        if (g_timersAvailable) glGenQueries(2, g_timerQuery[i]);
+        g_timerPending[i][0] = g_timerPending[i][1] = false;
+        g_timerSlot[i] = 0;
+        g_gpuMs[i] = -1.0f;
+    }
+
+    glGenTextures(1, &g_sceneDepthTex);
+    glBindTexture(GL_TEXTURE_2D, g_sceneDepthTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    g_shadowMapsReady = true;
+    return true;
+}
+
+void BeginShadowCascade(int cascade) {
+    if (!g_shadowMapsReady || !g_timersAvailable) return;
+    const int slot = g_timerSlot[cascade], other = 1 - slot;
+    if (g_timerPending[cascade][other]) {
+        GLint available = 0;
+        glGetQueryObjectiv(g_timerQuery[cascade][other], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(g_timerQuery[cascade][other], GL_QUERY_RESULT, &ns);
+            g_gpuMs[cascade] = (float)(ns / 1.0e6);
+            g_timerPending[cascade][other] = false;
+        }
+    }
+    glBeginQuery(GL_TIME_ELAPSED, g_timerQuery[cascade][slot]);
+}
+
+void EndShadowCascade(int cascade) {
+    if (!g_shadowMapsReady || !g_timersAvailable) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    g_timerPending[cascade][g_timerSlot[cascade]] = true;
+    g_timerSlot[cascade] = 1 - g_timerSlot[cascade];
+}
+
+float ShadowCascadeGpuMs(int cascade) {
+    return g_timersAvailable ? g_gpuMs[cascade] : -1.0f;
+}
+
+void BeginShadowLayer(int cascade, ShadowLayer layer, const ShadowCascade& c) {
+    glPushAttrib(GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_POLYGON_BIT | GL_LIGHTING_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &g_sceneFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_layerFbo[cascade][layer]);
+    glViewport(0, 0, g_mapSize, g_mapSize);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glEnable(GL_DEPTH_TEST); glDepthMask(GL_TRUE);
+    if (layer == SHADOW_STATIC_LAYER) glClear(GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D); glDisable(GL_BLEND); glDisable(GL_CULL_FACE);
+    glEnable(GL_POLYGON_OFFSET_FILL); glPolygonOffset(1.5f, 4.0f);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadMatrixf(c.lightClip);
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+}
+
+void EndShadowLayer() {
+    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_sceneFramebuffer);
+    glPopAttrib();
+}
+
+void CopyStaticShadowLayer(int cascade) {
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &g_sceneFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_layerFbo[cascade][SHADOW_STATIC_LAYER]);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_layerFbo[cascade][SHADOW_FRAME_LAYER]);
+    glBlitFramebuffer(0, 0, g_mapSize, g_mapSize, 0, 0, g_mapSize, g_mapSize, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_sceneFramebuffer);
+}
+
+// Inverse of a rigid column-major transform
+static void InvertRigid(const float m[16], float out[16]) {
+    for (int r = 0; r < 3; ++r) {
+        for (int k = 0; k < 3; ++k) out[k * 4 + r] = m[r * 4 + k];
+        out[r * 4 + 3] = 0.0f;
+        out[12 + r] = -(m[r * 4 + 0] * m[12] + m[r * 4 + 1] * m[13] + m[r * 4 + 2] * m[14]);
+    }
+    out[15] = 1.0f;
+}
+
+void ApplyShadowPass(const ShadowCascade cascades[], int count, const float view[16], const float proj[16], const float lightDir[3],
+    float strength, int viewWidth, int viewHeight) {
+    if (!g_shadowMapsReady || count > g_cascadeCount) return;
+
+    // Scene view space -> world -> cascade clip -> [0,1] texture space
+    static const float bias[16] = { 0.5f, 0, 0, 0, 0, 0.5f, 0, 0, 0, 0, 0.5f, 0, 0.5f, 0.5f, 0.5f, 1.0f };
+    float invView[16], toClip[16], matrices[MAX_SHADOW_CASCADES][16];
+    float splitFar[MAX_SHADOW_CASCADES] = { 0.0f }, normalOffset[MAX_SHADOW_CASCADES] = { 0.0f };
+    InvertRigid(view, invView);
+    for (int i = 0; i < MAX_SHADOW_CASCADES; ++i) {
+        const ShadowCascade& c = cascades[i < count ? i : 0];
+        MultiplyMatrix4(c.lightClip, invView, toClip);
+        MultiplyMatrix4(bias, toClip, matrices[i]);
+        if (i < count) {
+            splitFar[i] = c.splitFar;
+            normalOffset[i] = 1.5f * 2.0f * c.radius / g_mapSize;   // 1.5 texels
+        }
+    }
+    float lightView[3];
+    for (int r = 0; r < 3; ++r) lightView[r] = view[0 * 4 + r] * lightDir[0] + view[1 * 4 + r] * lightDir[1] + view[2 * 4 + r] * lightDir[2];
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, g_sceneDepthTex);
+    if (viewWidth != g_sceneDepthWidth || viewHeight != g_sceneDepthHeight) {
+        g_sceneDepthWidth = viewWidth; g_sceneDepthHeight = viewHeight;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, viewWidth, viewHeight, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+    }
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, viewWidth, viewHeight);
+    for (int i = 0; i < count; ++i) {
+        glActiveTexture(GL_TEXTURE1 + i);
+        glBindTexture(GL_TEXTURE_2D, g_layerTex[i][SHADOW_FRAME_LAYER]);
+    }
+
+    glUseProgram(g_shadowProgram);
+    glUniform2f(glGetUniformLocation(g_shadowProgram, "viewSize"), (float)viewWidth, (float)viewHeight);
+    glUniform4f(glGetUniformLocation(g_shadowProgram, "projParams"), proj[0], proj[5], proj[10], proj[14]);
+    glUniformMatrix4fv(glGetUniformLocation(g_shadowProgram, "shadowMatrix"), MAX_SHADOW_CASCADES, GL_FALSE, &matrices[0][0]);
+    glUniform4fv(glGetUniformLocation(g_shadowProgram, "splitFar"), 1, splitFar);
+    glUniform4fv(glGetUniformLocation(g_shadowProgram, "normalOffset"), 1, normalOffset);
+    glUniform3fv(glGetUniformLocation(g_shadowProgram, "lightDirView"), 1, lightView);
+    glUniform1f(glGetUniformLocation(g_shadowProgram, "strength"), strength);
+    glUniform1f(glGetUniformLocation(g_shadowProgram, "texel"), 1.0f / g_mapSize);
+
+    // dst * shade
+    glDisable(GL_DEPTH_TEST); glDepthMask(GL_FALSE);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_BLEND); glBlendFunc(GL_ZERO, GL_SRC_COLOR);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+    glBegin(GL_QUADS);
+    glVertex2f(-1, -1); glVertex2f(1, -1); glVertex2f(1, 1); glVertex2f(-1, 1);
+    glEnd();
+    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    glUseProgram(0);
+
+    for (int unit = count; unit >= 0; --unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glPopAttrib();
+}
@@ -0,0 +1,43 @@
+// ---------------- SHADOW MAPS ----------------
+// GL side of the cascades in Shadows.h. Every cascade owns two depth maps:
+// a static layer holding the casters that never move, redrawn only when
+// the cascade's projection changes, and the frame layer the scene is
+// shaded with, which starts each frame as a blit of the static layer and
+// gets the moving casters drawn on top. Once the opaque scene is drawn, a
+// full-screen pass over the depth buffer (like LightingShader.h) darkens
+// every pixel the sun cannot see.
+//
+// Needs GL 2.0 and framebuffer objects with blit (GL 3.0 or
+// ARB_framebuffer_object); InitShadowMaps reports false without them.
+
+#ifndef SHADOW_MAPS_H
+#define SHADOW_MAPS_H
+
+#include "Shadows.h"
+
+enum ShadowLayer { SHADOW_STATIC_LAYER, SHADOW_FRAME_LAYER };
+
+bool InitShadowMaps(int cascadeCount, int mapSize);
+
+// Brackets all the work on one cascade in a frame, for the GPU timer
+void BeginShadowCascade(int cascade);
+void EndShadowCascade(int cascade);
+// GPU time of the cascade in the last frame the driver has reported, in
+// ms; -1 without ARB_timer_query
+float ShadowCascadeGpuMs(int cascade);
+
+// Renders into the layer with the cascade's projection loaded, the
+// modelview at identity (so casters draw with their world transforms),
+// colour writes off and polygon offset on. The static layer is cleared.
+void BeginShadowLayer(int cascade, ShadowLayer layer, const ShadowCascade& c);
+void EndShadowLayer();
+// Frame layer = static layer
+void CopyStaticShadowLayer(int cascade);
+
+// view/proj: what the scene was drawn with; lightDir: unit vector toward
+// the sun; strength: how much of the colour a fully shadowed, sun-facing
+// pixel loses. Leaves GL state as it found it.
+void ApplyShadowPass(const ShadowCascade cascades[], int count, const float view[16], const float proj[16], const float lightDir[3],
+    float strength, int viewWidth, int viewHeight);
+
+#endif // SHADOW_MAPS_H
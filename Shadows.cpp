@@ -0,0 +1,99 @@
+// ---------------- CASCADED SHADOWS ----------------
+// See Shadows.h.
+
+#include "Shadows.h"
+#include <math.h>
+#include <string.h>
+
+void ComputeCascadeSplits(float nearZ, float farZ, int count, float lambda, float splits[]) {
+    for (int i = 0; i <= count; ++i) {
+        const float t = (float)i / count;
+        const float logSplit = nearZ * powf(farZ / nearZ, t);
+        const float uniformSplit = nearZ + (farZ - nearZ) * t;
+        splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+    }
+    splits[0] = nearZ; splits[count] = farZ;
+}
+
+static float Dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+static void Normalize3(float v[3]) {
+    const float len = sqrtf(Dot3(v, v));
+    if (len > 0.0f) { v[0] /= len; v[1] /= len; v[2] /= len; }
+}
+
+// View-space point back to world: the view is rigid, so its inverse is the
+// transposed rotation applied after undoing the translation
+static void ViewToWorld(const float view[16], const float v[3], float out[3]) {
+    for (int k = 0; k < 3; ++k) {
+        out[k] = 0.0f;
+        for (int r = 0; r < 3; ++r) out[k] += view[k * 4 + r] * (v[r] - view[12 + r]);
+    }
+}
+
+void FitShadowCascade(ShadowCascade& c, const float view[16], float fovYDeg, float aspect, float splitNear, float splitFar,
+    const float lightDir[3], const float sceneMin[3], const float sceneMax[3], float snapFraction) {
+    c.splitNear = splitNear; c.splitFar = splitFar;
+
+    // Bounding sphere of the slice: centred on its 8 corners, radius rounded
+    // up to a whole unit so it never changes with the camera's orientation
+    const float tanY = tanf(fovYDeg * 3.14159265f / 360.0f), tanX = tanY * aspect;
+    float corners[8][3], center[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 8; ++i) {
+        const float d = (i & 4) ? splitFar : splitNear;
+        const float v[3] = { ((i & 1) ? d : -d) * tanX, ((i & 2) ? d : -d) * tanY, -d };
+        ViewToWorld(view, v, corners[i]);
+        for (int k = 0; k < 3; ++k) center[k] += corners[i][k] * 0.125f;
+    }
+    float radius = 0.0f;
+    for (int i = 0; i < 8; ++i) {
+        const float d[3] = { corners[i][0] - center[0], corners[i][1] - center[1], corners[i][2] - center[2] };
+        const float dist = sqrtf(Dot3(d, d));
+        if (dist > radius) radius = dist;
+    }
+    radius = ceilf(radius);
+    const float step = radius * snapFraction;
+    radius += step;   // the snapped centre is off by at most half a step per axis
+
+    // Light basis: x and y across the map, z toward the sun
+    const float* l = lightDir;
+    float up[3] = { 0.0f, 1.0f, 0.0f };
+    if (fabsf(l[1]) > 0.99f) { up[1] = 0.0f; up[2] = 1.0f; }
+    float s[3] = { up[1] * l[2] - up[2] * l[1], up[2] * l[0] - up[0] * l[2], up[0] * l[1] - up[1] * l[0] };
+    Normalize3(s);
+    const float u[3] = { l[1] * s[2] - l[2] * s[1], l[2] * s[0] - l[0] * s[2], l[0] * s[1] - l[1] * s[0] };
+
+    float lc[3] = { Dot3(s, center), Dot3(u, center), Dot3(l, center) };
+    for (int k = 0; k < 3; ++k) lc[k] = floorf(lc[k] / step + 0.5f) * step;
+
+    // Depth runs from the sphere's far side back to the scene's sunward edge
+    float zMax = lc[2] + radius;
+    for (int i = 0; i < 8; ++i) {
+        const float p[3] = { (i & 1) ? sceneMax[0] : sceneMin[0], (i & 2) ? sceneMax[1] : sceneMin[1], (i & 4) ? sceneMax[2] : sceneMin[2] };
+        const float z = Dot3(l, p);
+        if (z > zMax) zMax = z;
+    }
+    const float zMin = lc[2] - radius;
+    c.radius = radius;
+
+    float lightView[16] = {
+        s[0], u[0], l[0], 0.0f,
+        s[1], u[1], l[1], 0.0f,
+        s[2], u[2], l[2], 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    // glOrtho(lc.x - r, lc.x + r, lc.y - r, lc.y + r, -zMax, -zMin)
+    const float nearD = -zMax, farD = -zMin;
+    float ortho[16] = {
+        1.0f / radius, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f / radius, 0.0f, 0.0f,
+        0.0f, 0.0f, -2.0f / (farD - nearD), 0.0f,
+        -lc[0] / radius, -lc[1] / radius, -(farD + nearD) / (farD - nearD), 1.0f
+    };
+    MultiplyMatrix4(ortho, lightView, c.lightClip);
+    ExtractFrustum(c.lightClip, c.casters);
+}
+
+bool SameCascadeProjection(const ShadowCascade& a, const ShadowCascade& b) {
+    return memcmp(a.lightClip, b.lightClip, sizeof(a.lightClip)) == 0;
+}
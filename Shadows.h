@@ -0,0 +1,40 @@
+// ---------------- CASCADED SHADOWS ----------------
+// Cascade fitting for the sun's shadow maps. The camera frustum is cut into
+// slices along depth and each slice gets an orthographic projection from
+// the sun around the slice's bounding sphere. The sphere's size does not
+// depend on where the camera looks, and its centre is snapped to coarse
+// steps in light space, so a cascade's projection stays bit-identical until
+// the camera has moved a whole step or the sun direction changes. That is
+// what lets ShadowMaps.h keep the static casters of a cascade cached.
+// Plain math like Culling.h: column-major float[16], no GL.
+
+#ifndef SHADOWS_H
+#define SHADOWS_H
+
+#include "Culling.h"
+
+#define MAX_SHADOW_CASCADES 4
+
+struct ShadowCascade {
+    float splitNear, splitFar;   // view depth range this cascade shades
+    float radius;                // half width of the projection, world units
+    float lightClip[16];         // ortho * light view: world to cascade clip space
+    Frustum casters;             // everything that can land in the map
+};
+
+// Split depths from nearZ to farZ, blending logarithmic and uniform spacing
+// by lambda (1 = fully logarithmic); splits gets count + 1 entries
+void ComputeCascadeSplits(float nearZ, float farZ, int count, float lambda, float splits[]);
+
+// view: the camera transform (rigid, as gluLookAt leaves it); lightDir: unit
+// vector toward the sun. sceneMin/Max bound every caster, so the projection
+// reaches back to anything between the slice and the sun. snapFraction is
+// the centre step as a fraction of the radius.
+void FitShadowCascade(ShadowCascade& c, const float view[16], float fovYDeg, float aspect, float splitNear, float splitFar,
+    const float lightDir[3], const float sceneMin[3], const float sceneMax[3], float snapFraction);
+
+// True if both cascades render to the same texels, i.e. a cached map of
+// one is valid for the other
+bool SameCascadeProjection(const ShadowCascade& a, const ShadowCascade& b);
+
+#endif // SHADOWS_H
@@ -0,0 +1,39 @@
+// ---------------- FRAME SNAPSHOTS ----------------
+// See Snapshot.h.
+
+#include "Snapshot.h"
+
+static const int SNAPSHOT_FRESH = 4;
+
+void FillSnapshot(FrameSnapshot& s, unsigned long long tick, float simMs) {
+    s.tick = tick;
+    s.simMs = simMs;
+    s.gameState = gameState;
+    s.playerX = playerX; s.playerY = playerY; s.playerZ = playerZ; s.playerYaw = playerYaw;
+    s.gameTimer = gameTimer; s.sunAngle = sunAngle; s.fadeAlpha = fadeAlpha;
+    s.isFadingOut = isFadingOut;
+    s.score = score; s.coinsCollected = coinsCollected; s.gemsCollected = gemsCollected; s.lives = lives;
+    s.hasMap = hasMap; s.hasLvl2Key = hasLvl2Key;
+    s.showInteractPrompt = showInteractPrompt; s.showBoatPrompt = showBoatPrompt;
+    s.showNPCDialogue = showNPCDialogue; s.showBoatDialogue = showBoatDialogue;
+    s.showBoatDialogue2 = showBoatDialogue2; s.showBoatInsufficient = showBoatInsufficient;
+    s.pendulums = lvl2_pendulums;
+    s.entities.clear();
+    ForEach<Transform, Renderable>(LevelEntities(), [&s](Entity, const Transform& t, const Renderable& r) {
+        s.entities.push_back(SnapshotEntity{ t, r.kind });
+    });
+}
+
+FrameSnapshot& SnapshotToWrite(SnapshotBuffer& b) {
+    return b.slots[b.writing];
+}
+
+void PublishSnapshot(SnapshotBuffer& b) {
+    b.writing = b.newest.exchange(b.writing | SNAPSHOT_FRESH, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+}
+
+const FrameSnapshot& AcquireSnapshot(SnapshotBuffer& b) {
+    if (b.newest.load(std::memory_order_relaxed) & SNAPSHOT_FRESH)
+        b.reading = b.newest.exchange(b.reading, std::memory_order_acq_rel) & ~SNAPSHOT_FRESH;
+    return b.slots[b.reading];
+}
@@ -0,0 +1,61 @@
+// ---------------- FRAME SNAPSHOTS ----------------
+// What the renderer needs from the simulation for one frame, copied out of
+// GameWorld at the end of every tick. The simulation runs on its own thread
+// (OpenGLMeshLoader.cpp) and the renderer draws only from the newest
+// snapshot, never from the live globals, so the two can overlap.
+//
+// Three snapshots rotate: the simulation fills one, the renderer holds
+// one, and the third is the newest finished one. Publishing and acquiring
+// are a single atomic exchange each; neither side ever waits for the
+// other. A renderer slower than the simulation skips snapshots, a faster
+// one draws the same snapshot again.
+//
+// Level layout (trees, rocks, houses, platforms, the NPC, boat and chest)
+// is not copied: it is only written while a level is laid out, before the
+// simulation thread starts.
+//
+// No GL, GLUT or Windows, like GameWorld.h.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "GameWorld.h"
+#include <atomic>
+#include <vector>
+
+struct SnapshotEntity { Transform transform; RenderKind kind; };
+
+struct FrameSnapshot {
+    unsigned long long tick;    // UpdateWorld calls so far
+    float simMs;                // CPU time of the tick that produced it
+    GameState gameState;
+    float playerX, playerY, playerZ, playerYaw;
+    float gameTimer, sunAngle, fadeAlpha;
+    bool isFadingOut;
+    int score, coinsCollected, gemsCollected, lives;
+    bool hasMap, hasLvl2Key;
+    bool showInteractPrompt, showBoatPrompt;
+    bool showNPCDialogue, showBoatDialogue, showBoatDialogue2, showBoatInsufficient;
+    std::vector<Pendulum> pendulums;          // lvl2_pendulums with this tick's angles
+    std::vector<SnapshotEntity> entities;     // the level's Renderables
+};
+
+// Copies the current world into s, reusing its storage
+void FillSnapshot(FrameSnapshot& s, unsigned long long tick, float simMs);
+
+struct SnapshotBuffer {
+    FrameSnapshot slots[3];
+    std::atomic<int> newest;    // slot index, plus SNAPSHOT_FRESH until acquired
+    int writing = 1, reading = 2;
+    SnapshotBuffer() : newest(0) {}
+};
+
+// The slot the simulation may fill next
+FrameSnapshot& SnapshotToWrite(SnapshotBuffer& b);
+// Makes the slot from SnapshotToWrite the newest
+void PublishSnapshot(SnapshotBuffer& b);
+// The newest published snapshot; stays valid and unchanged until the next
+// call. Only one thread may acquire.
+const FrameSnapshot& AcquireSnapshot(SnapshotBuffer& b);
+
+#endif // SNAPSHOT_H
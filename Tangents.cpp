@@ -0,0 +1,163 @@
+// ---------------- TANGENT FRAMES ----------------
+// See Tangents.h.
+
+#include "Tangents.h"
+#include <math.h>
+#include <vector>
+#include <xmmintrin.h>
+
+// One vertex of the final pass; the SSE loop below does the same four at a time
+static void FinishTangent(const float n[3], float tx, float ty, float tz, float bx, float by, float bz, float out[4]) {
+    const float d = n[0] * tx + n[1] * ty + n[2] * tz;
+    tx -= n[0] * d; ty -= n[1] * d; tz -= n[2] * d;
+    float len2 = tx * tx + ty * ty + tz * tz;
+    if (len2 < 1e-20f) {
+        // No UV gradient: any direction in the normal plane
+        if (fabsf(n[2]) > 0.9f) { tx = 0.0f; ty = n[2]; tz = -n[1]; }
+        else { tx = n[1]; ty = -n[0]; tz = 0.0f; }
+        len2 = tx * tx + ty * ty + tz * tz;
+    }
+    const float len = sqrtf(len2);
+    out[0] = tx / len; out[1] = ty / len; out[2] = tz / len;
+    const float cx = n[1] * out[2] - n[2] * out[1], cy = n[2] * out[0] - n[0] * out[2], cz = n[0] * out[1] - n[1] * out[0];
+    out[3] = (cx * bx + cy * by + cz * bz < 0.0f) ? -1.0f : 1.0f;
+}
+
+// x, y and z of 4 packed xyz vertices
+static inline void LoadXYZ4(const float* p, __m128& x, __m128& y, __m128& z) {
+    const __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);   // x0y0z0x1 y1z1x2y2 z2x3y3z3
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+// Four xyz vectors, one per lane
+struct Vec3x4 { __m128 x, y, z; };
+
+static inline Vec3x4 Sub(const Vec3x4& a, const Vec3x4& b) { return Vec3x4{ _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) }; }
+static inline Vec3x4 Scale(const Vec3x4& v, __m128 s) { return Vec3x4{ _mm_mul_ps(v.x, s), _mm_mul_ps(v.y, s), _mm_mul_ps(v.z, s) }; }
+static inline __m128 Dot(const Vec3x4& a, const Vec3x4& b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+// v minus its component along the unit normal n (not normalized)
+static inline Vec3x4 Reject(const Vec3x4& n, const Vec3x4& v) { return Sub(v, Scale(n, Dot(n, v))); }
+
+static inline Vec3x4 Gather3(const float* base, const int v[4]) {
+    const float* a = base + v[0] * 3; const float* b = base + v[1] * 3; const float* c = base + v[2] * 3; const float* d = base + v[3] * 3;
+    return Vec3x4{ _mm_setr_ps(a[0], b[0], c[0], d[0]), _mm_setr_ps(a[1], b[1], c[1], d[1]), _mm_setr_ps(a[2], b[2], c[2], d[2]) };
+}
+
+// acos of a cosine in [-1, 1], Abramowitz & Stegun 4.4.45: within 7e-5
+// rad of acosf, plenty for a weight
+static inline __m128 AcosApprox(__m128 x) {
+    const __m128 ax = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+    __m128 poly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0187293f), ax), _mm_set1_ps(0.0742610f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, ax), _mm_set1_ps(-0.2121144f));
+    poly = _mm_add_ps(_mm_mul_ps(poly, ax), _mm_set1_ps(1.5707288f));
+    const __m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), ax)), poly);
+    return Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(3.14159265f), r), r);
+}
+
+void ComputeTangents(const float* positions, const float* normals, const float* texCoords, int vertexCount,
+    const unsigned short* indices, int indexCount, float* tangents) {
+    if (vertexCount <= 0) return;
+    // Accumulators, one array per component so the last pass loads them directly
+    std::vector<float> acc(vertexCount * 6, 0.0f);
+    float* tx = &acc[0]; float* ty = tx + vertexCount; float* tz = ty + vertexCount;
+    float* bx = tz + vertexCount; float* by = bx + vertexCount; float* bz = by + vertexCount;
+
+    // Four triangles at a time. A corner adds the triangle's gradients,
+    // projected into its normal plane, weighted by its angle there; the
+    // adds go out in triangle order, as one triangle at a time would.
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f);
+    const __m128 tinyArea = _mm_set1_ps(1e-20f), tinyLen2 = _mm_set1_ps(1e-24f);
+    const int triangleCount = indexCount / 3;
+    for (int f = 0; f < triangleCount; f += 4) {
+        const int lanes = triangleCount - f < 4 ? triangleCount - f : 4;
+        int v[3][4];
+        for (int c = 0; c < 3; ++c)
+            for (int l = 0; l < 4; ++l) v[c][l] = indices[(f + (l < lanes ? l : 0)) * 3 + c];   // spare lanes repeat the first
+        const Vec3x4 p[3] = { Gather3(positions, v[0]), Gather3(positions, v[1]), Gather3(positions, v[2]) };
+        __m128 s[3], t[3];
+        for (int c = 0; c < 3; ++c) {
+            const float* a = texCoords + v[c][0] * 2; const float* b = texCoords + v[c][1] * 2;
+            const float* d = texCoords + v[c][2] * 2; const float* e = texCoords + v[c][3] * 2;
+            s[c] = _mm_setr_ps(a[0], b[0], d[0], e[0]); t[c] = _mm_setr_ps(a[1], b[1], d[1], e[1]);
+        }
+        const Vec3x4 e1 = Sub(p[1], p[0]), e2 = Sub(p[2], p[0]);
+        const __m128 s1 = _mm_sub_ps(s[1], s[0]), t1 = _mm_sub_ps(t[1], t[0]), s2 = _mm_sub_ps(s[2], s[0]), t2 = _mm_sub_ps(t[2], t[0]);
+        const __m128 area = _mm_sub_ps(_mm_mul_ps(s1, t2), _mm_mul_ps(s2, t1));
+        const int live = _mm_movemask_ps(_mm_cmpge_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), area), tinyArea)) & ((1 << lanes) - 1);
+        if (!live) continue;
+
+        // Gradient directions, normalized and signed by the UV winding
+        const __m128 sign = Select(_mm_cmpgt_ps(area, zero), one, minusOne);
+        Vec3x4 os = Sub(Scale(e1, t2), Scale(e2, t1)), ot = Sub(Scale(e2, s1), Scale(e1, s2));
+        os = Scale(os, _mm_div_ps(sign, _mm_sqrt_ps(_mm_max_ps(Dot(os, os), tinyLen2))));
+        ot = Scale(ot, _mm_div_ps(sign, _mm_sqrt_ps(_mm_max_ps(Dot(ot, ot), tinyLen2))));
+
+        float add[3][6][4];   // corner, tangent xyz and bitangent xyz, lane
+        for (int c = 0; c < 3; ++c) {
+            const Vec3x4 n = Gather3(normals, v[c]);
+            const Vec3x4 a = Reject(n, Sub(p[(c + 1) % 3], p[c])), b = Reject(n, Sub(p[(c + 2) % 3], p[c]));
+            const __m128 a2 = Dot(a, a), b2 = Dot(b, b);
+            const __m128 spans = _mm_and_ps(_mm_cmpge_ps(a2, tinyLen2), _mm_cmpge_ps(b2, tinyLen2));
+            __m128 cosAngle = _mm_div_ps(Dot(a, b), _mm_sqrt_ps(_mm_max_ps(_mm_mul_ps(a2, b2), tinyLen2)));
+            cosAngle = _mm_min_ps(_mm_max_ps(cosAngle, minusOne), one);
+            const __m128 angle = _mm_and_ps(spans, AcosApprox(cosAngle));
+
+            const Vec3x4 ts = Reject(n, os), tt = Reject(n, ot);
+            const __m128 ts2 = Dot(ts, ts), tt2 = Dot(tt, tt);
+            const __m128 ws = _mm_and_ps(_mm_cmpge_ps(ts2, tinyLen2), _mm_div_ps(angle, _mm_sqrt_ps(_mm_max_ps(ts2, tinyLen2))));
+            const __m128 wt = _mm_and_ps(_mm_cmpge_ps(tt2, tinyLen2), _mm_div_ps(angle, _mm_sqrt_ps(_mm_max_ps(tt2, tinyLen2))));
+            _mm_storeu_ps(add[c][0], _mm_mul_ps(ts.x, ws)); _mm_storeu_ps(add[c][1], _mm_mul_ps(ts.y, ws)); _mm_storeu_ps(add[c][2], _mm_mul_ps(ts.z, ws));
+            _mm_storeu_ps(add[c][3], _mm_mul_ps(tt.x, wt)); _mm_storeu_ps(add[c][4], _mm_mul_ps(tt.y, wt)); _mm_storeu_ps(add[c][5], _mm_mul_ps(tt.z, wt));
+        }
+        for (int l = 0; l < lanes; ++l) {
+            if (!(live & (1 << l))) continue;
+            for (int c = 0; c < 3; ++c) {
+                const int vi = v[c][l];
+                tx[vi] += add[c][0][l]; ty[vi] += add[c][1][l]; tz[vi] += add[c][2][l];
+                bx[vi] += add[c][3][l]; by[vi] += add[c][4][l]; bz[vi] += add[c][5][l];
+            }
+        }
+    }
+
+    // Orthogonalize, normalize and sign, four vertices per iteration
+    const __m128 tiny = _mm_set1_ps(1e-20f), nearAxis = _mm_set1_ps(0.9f);
+    int i = 0;
+    for (; i + 4 <= vertexCount; i += 4) {
+        __m128 nx, ny, nz;
+        LoadXYZ4(normals + i * 3, nx, ny, nz);
+        __m128 x = _mm_loadu_ps(tx + i), y = _mm_loadu_ps(ty + i), z = _mm_loadu_ps(tz + i);
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_mul_ps(nz, z));
+        x = _mm_sub_ps(x, _mm_mul_ps(nx, d)); y = _mm_sub_ps(y, _mm_mul_ps(ny, d)); z = _mm_sub_ps(z, _mm_mul_ps(nz, d));
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+
+        const __m128 degenerate = _mm_cmplt_ps(len2, tiny);
+        if (_mm_movemask_ps(degenerate)) {
+            const __m128 alongZ = _mm_cmpgt_ps(_mm_max_ps(nz, _mm_sub_ps(zero, nz)), nearAxis);
+            x = Select(degenerate, Select(alongZ, zero, ny), x);
+            y = Select(degenerate, Select(alongZ, nz, _mm_sub_ps(zero, nx)), y);
+            z = Select(degenerate, Select(alongZ, _mm_sub_ps(zero, ny), zero), z);
+            len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        }
+        const __m128 len = _mm_sqrt_ps(len2);
+        x = _mm_div_ps(x, len); y = _mm_div_ps(y, len); z = _mm_div_ps(z, len);
+
+        const __m128 cx = _mm_sub_ps(_mm_mul_ps(ny, z), _mm_mul_ps(nz, y));
+        const __m128 cy = _mm_sub_ps(_mm_mul_ps(nz, x), _mm_mul_ps(nx, z));
+        const __m128 cz = _mm_sub_ps(_mm_mul_ps(nx, y), _mm_mul_ps(ny, x));
+        const __m128 h = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, _mm_loadu_ps(bx + i)), _mm_mul_ps(cy, _mm_loadu_ps(by + i))), _mm_mul_ps(cz, _mm_loadu_ps(bz + i)));
+        __m128 w = Select(_mm_cmplt_ps(h, zero), minusOne, one);
+
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(tangents + i * 4, x);
+        _mm_storeu_ps(tangents + i * 4 + 4, y);
+        _mm_storeu_ps(tangents + i * 4 + 8, z);
+        _mm_storeu_ps(tangents + i * 4 + 12, w);
+    }
+    for (; i < vertexCount; ++i) FinishTangent(normals + i * 3, tx[i], ty[i], tz[i], bx[i], by[i], bz[i], tangents + i * 4);
+}
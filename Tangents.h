@@ -0,0 +1,24 @@
+// ---------------- TANGENT FRAMES ----------------
+// Per-vertex tangent frames for normal mapping, built the way MikkTSpace
+// builds them: every triangle's UV gradient is normalized and signed by the
+// triangle's UV winding, projected into each corner's normal plane and
+// weighted by the corner angle; the sum is orthogonalized against the
+// vertex normal. Tangents come out as x, y, z, w with w = +-1, so the
+// shader rebuilds bitangent = w * cross(normal, tangent), as MikkTSpace
+// shaders do. Unlike MikkTSpace no vertices are split: a vertex shared
+// across a UV mirror seam keeps the handedness most of its corners agree
+// on. Both passes run four at a time with SSE, triangles then vertices;
+// the corner angle comes from a polynomial acos, within 7e-5 rad.
+// bench/TangentBench.cpp times it against the scalar loop on the game's
+// models. Plain math like Culling.h, no GL.
+
+#ifndef TANGENTS_H
+#define TANGENTS_H
+
+// positions, normals: 3 floats per vertex; texCoords: 2; indices: triangle
+// list. tangents receives 4 floats per vertex. Vertices no triangle gives a
+// UV gradient get any unit vector perpendicular to their normal.
+void ComputeTangents(const float* positions, const float* normals, const float* texCoords, int vertexCount,
+    const unsigned short* indices, int indexCount, float* tangents);
+
+#endif // TANGENTS_H
@@ -0,0 +1,466 @@
+// ---------------- TELEMETRY ----------------
+// See Telemetry.h.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SOCKET;
+static const SOCKET INVALID_SOCKET = -1;
+static int closesocket(SOCKET s) { return close(s); }
+#endif
+
+#include "Telemetry.h"
+#include <chrono>
+#include <condition_variable>
+#include <math.h>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock TelemetryClock;
+
+// ---- Registry ----
+static const char* g_counterNames[MAX_COUNTERS];
+static const char* g_counterHelp[MAX_COUNTERS];
+static std::atomic<int> g_counterCount(0);
+static std::mutex g_registryMutex;   // constant-initialised, so usable from static initialisers
+
+int RegisterCounter(const char* name, const char* help) {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    const int count = g_counterCount.load();
+    for (int id = 0; id < count; ++id) if (strcmp(g_counterNames[id], name) == 0) return id;
+    if (count == MAX_COUNTERS) return -1;
+    g_counterNames[count] = name;
+    g_counterHelp[count] = help;
+    g_counterCount.store(count + 1);
+    return count;
+}
+
+int TelemetryCounterCount() { return g_counterCount.load(); }
+const char* TelemetryCounterName(int counter) { return g_counterNames[counter]; }
+
+static const char* g_stateNames[MAX_TELEMETRY_STATES];
+
+void SetTelemetryStateName(int state, const char* name) {
+    if (state >= 0 && state < MAX_TELEMETRY_STATES) g_stateNames[state] = name;
+}
+
+// ---- Per-thread blocks ----
+// Like the profiler's rings, a block outlives its thread (its counts are
+// part of the totals) and goes to the next new thread. Past
+// MAX_COUNTER_BLOCKS threads share the last one and may lose counts.
+static const int MAX_COUNTER_BLOCKS = 64;
+static CounterBlock* g_blocks[MAX_COUNTER_BLOCKS];
+static std::atomic<int> g_blockCount(0);
+static std::mutex g_blockMutex;
+static std::vector<CounterBlock*> g_freeBlocks;   // under g_blockMutex
+thread_local CounterBlock* t_counterBlock = nullptr;
+
+struct BlockOwner {
+    CounterBlock* block = nullptr;
+    ~BlockOwner() {
+        if (!block) return;
+        std::lock_guard<std::mutex> lock(g_blockMutex);
+        g_freeBlocks.push_back(block);
+    }
+};
+static thread_local BlockOwner t_blockOwner;
+
+CounterBlock* ThreadCounterBlock() {
+    std::lock_guard<std::mutex> lock(g_blockMutex);
+    CounterBlock* block;
+    if (!g_freeBlocks.empty()) { block = g_freeBlocks.back(); g_freeBlocks.pop_back(); t_blockOwner.block = block; }
+    else if (g_blockCount.load() < MAX_COUNTER_BLOCKS) {
+        block = new CounterBlock();
+        for (auto& v : block->values) v.store(0, std::memory_order_relaxed);
+        g_blocks[g_blockCount.load()] = block;
+        g_blockCount.fetch_add(1, std::memory_order_release);
+        t_blockOwner.block = block;
+    }
+    else block = g_blocks[MAX_COUNTER_BLOCKS - 1];
+    t_counterBlock = block;
+    return block;
+}
+
+// ---- Frames ----
+// Written by the drawing thread alone
+static std::atomic<long long> g_frameBuckets[FRAME_BUCKETS];
+static std::atomic<long long> g_frameUs(0);
+static std::atomic<long long> g_frameUsSquared(0);   // for the jitter
+
+// User plus kernel time of every thread in the process
+static double ProcessCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+    auto seconds = [](const FILETIME& t) { return (((unsigned long long)t.dwHighDateTime << 32) | t.dwLowDateTime) / 1.0e7; };
+    return seconds(kernel) + seconds(user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e6;
+#endif
+}
+
+// ---- Aggregation ----
+struct StateTotals {
+    double seconds;
+    double cpuSeconds;
+    double frameMs, frameMsSquared;
+    long long counters[MAX_COUNTERS];
+    long long buckets[FRAME_BUCKETS];
+};
+
+struct Aggregator {
+    std::mutex mutex;                     // everything below
+    int shownState = -1;
+    TelemetryClock::time_point last = TelemetryClock::now(), start = TelemetryClock::now();
+    long long lastCounters[MAX_COUNTERS] = {};
+    long long lastBuckets[FRAME_BUCKETS] = {};
+    long long lastFrameUs = 0, lastFrameUsSquared = 0;
+    double lastCpuSeconds = 0.0;   // so the loading before the first state counts nowhere
+    StateTotals session[MAX_TELEMETRY_STATES] = {};
+    StateTotals period[MAX_TELEMETRY_STATES] = {};
+};
+static Aggregator g_agg;
+
+// Puts everything counted since the last call into the state showing
+static void Aggregate(TelemetryClock::time_point now) {
+    long long counters[MAX_COUNTERS] = {};
+    const int blocks = g_blockCount.load(std::memory_order_acquire);
+    for (int b = 0; b < blocks; ++b)
+        for (int c = 0; c < MAX_COUNTERS; ++c) counters[c] += g_blocks[b]->values[c].load(std::memory_order_relaxed);
+    const double seconds = std::chrono::duration<double>(now - g_agg.last).count();
+    const long long frameUs = g_frameUs.load(std::memory_order_relaxed);
+    const long long frameUsSquared = g_frameUsSquared.load(std::memory_order_relaxed);
+    const double cpuSeconds = ProcessCpuSeconds();
+    const int s = g_agg.shownState;
+    StateTotals* totals[2] = { s >= 0 ? &g_agg.session[s] : nullptr, s >= 0 ? &g_agg.period[s] : nullptr };
+    for (StateTotals* t : totals) {
+        if (!t) continue;
+        t->seconds += seconds;
+        t->cpuSeconds += cpuSeconds - g_agg.lastCpuSeconds;
+        t->frameMs += (frameUs - g_agg.lastFrameUs) / 1000.0;
+        t->frameMsSquared += (frameUsSquared - g_agg.lastFrameUsSquared) / 1.0e6;
+        for (int c = 0; c < MAX_COUNTERS; ++c) t->counters[c] += counters[c] - g_agg.lastCounters[c];
+        for (int b = 0; b < FRAME_BUCKETS; ++b) t->buckets[b] += g_frameBuckets[b].load(std::memory_order_relaxed) - g_agg.lastBuckets[b];
+    }
+    for (int c = 0; c < MAX_COUNTERS; ++c) g_agg.lastCounters[c] = counters[c];
+    for (int b = 0; b < FRAME_BUCKETS; ++b) g_agg.lastBuckets[b] = g_frameBuckets[b].load(std::memory_order_relaxed);
+    g_agg.lastFrameUs = frameUs;
+    g_agg.lastFrameUsSquared = frameUsSquared;
+    g_agg.lastCpuSeconds = cpuSeconds;
+    g_agg.last = now;
+}
+
+void TelemetryFrame(float frameMs, int state) {
+    int bucket = (int)(frameMs / FRAME_BUCKET_MS);
+    if (bucket < 0) bucket = 0;
+    if (bucket >= FRAME_BUCKETS) bucket = FRAME_BUCKETS - 1;
+    g_frameBuckets[bucket].store(g_frameBuckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    const long long us = (long long)(frameMs * 1000.0f);
+    g_frameUs.store(g_frameUs.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+    g_frameUsSquared.store(g_frameUsSquared.load(std::memory_order_relaxed) + us * us, std::memory_order_relaxed);
+
+    // The frame that just ended still belongs to the old state
+    static int shown = -1;
+    if (state == shown) return;
+    shown = state;
+    std::lock_guard<std::mutex> lock(g_agg.mutex);
+    Aggregate(TelemetryClock::now());
+    g_agg.shownState = (state >= 0 && state < MAX_TELEMETRY_STATES) ? state : -1;
+}
+
+// Frame time at fraction p of the frames, interpolated inside its bucket
+static float FramePercentile(const long long buckets[], long long frames, double p) {
+    if (frames == 0) return 0.0f;
+    const double target = p * frames;
+    long long below = 0;
+    for (int b = 0; b < FRAME_BUCKETS; ++b) {
+        if (buckets[b] > 0 && below + buckets[b] >= target) return (float)((b + (target - below) / buckets[b]) * FRAME_BUCKET_MS);
+        below += buckets[b];
+    }
+    return FRAME_BUCKETS * FRAME_BUCKET_MS;
+}
+
+static TelemetrySummary Summarize(const StateTotals& t) {
+    TelemetrySummary s = {};
+    s.seconds = t.seconds;
+    for (int b = 0; b < FRAME_BUCKETS; ++b) s.frames += t.buckets[b];
+    s.fpsMean = t.frameMs > 0.0 ? (float)(s.frames * 1000.0 / t.frameMs) : 0.0f;
+    s.cpuPercent = t.seconds > 0.0 ? (float)(100.0 * t.cpuSeconds / t.seconds) : 0.0f;
+    if (s.frames > 0) {
+        const double mean = t.frameMs / s.frames, variance = t.frameMsSquared / s.frames - mean * mean;
+        s.frameMsJitter = variance > 0.0 ? (float)sqrt(variance) : 0.0f;
+    }
+    s.frameMsP50 = FramePercentile(t.buckets, s.frames, 0.50);
+    s.frameMsP95 = FramePercentile(t.buckets, s.frames, 0.95);
+    s.frameMsP99 = FramePercentile(t.buckets, s.frames, 0.99);
+    for (int c = 0; c < MAX_COUNTERS; ++c) s.counters[c] = t.counters[c];
+    return s;
+}
+
+TelemetrySummary GetTelemetrySummary(int state) {
+    std::lock_guard<std::mutex> lock(g_agg.mutex);
+    Aggregate(TelemetryClock::now());
+    return Summarize(g_agg.session[state]);
+}
+
+static const char* StateName(int state) {
+    return g_stateNames[state] ? g_stateNames[state] : "unnamed";
+}
+
+// ---- Sinks ----
+static void WriteCsvHeader(FILE* f) {
+    fprintf(f, "seconds,state,state_seconds,frames,fps_mean,frame_ms_p50,frame_ms_p95,frame_ms_p99,frame_ms_jitter,cpu_percent");
+    for (int c = 0; c < TelemetryCounterCount(); ++c) fprintf(f, ",%s", g_counterNames[c]);
+    fprintf(f, "\n");
+}
+
+// Every state that showed during the period, then the period starts over
+static void WriteCsvPeriod(FILE* f, double sinceStart) {
+    for (int state = 0; state < MAX_TELEMETRY_STATES; ++state) {
+        StateTotals& t = g_agg.period[state];
+        if (t.seconds <= 0.0) continue;
+        const TelemetrySummary s = Summarize(t);
+        fprintf(f, "%.3f,%s,%.3f,%lld,%.2f,%.3f,%.3f,%.3f,%.3f,%.1f", sinceStart, StateName(state), s.seconds, s.frames, s.fpsMean,
+            s.frameMsP50, s.frameMsP95, s.frameMsP99, s.frameMsJitter, s.cpuPercent);
+        for (int c = 0; c < TelemetryCounterCount(); ++c) fprintf(f, ",%lld", s.counters[c]);
+        fprintf(f, "\n");
+        t = StateTotals();
+    }
+    fflush(f);
+}
+
+static bool WriteJsonSummary(const char* path, double sinceStart) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\n  \"session_seconds\": %.3f,\n  \"states\": {", sinceStart);
+    bool first = true;
+    for (int state = 0; state < MAX_TELEMETRY_STATES; ++state) {
+        if (g_agg.session[state].seconds <= 0.0) continue;
+        const TelemetrySummary s = Summarize(g_agg.session[state]);
+        fprintf(f, "%s\n    \"%s\": {\n      \"seconds\": %.3f, \"frames\": %lld, \"fps_mean\": %.2f, \"cpu_percent\": %.1f,\n", first ? "" : ",",
+            StateName(state), s.seconds, s.frames, s.fpsMean, s.cpuPercent);
+        fprintf(f, "      \"frame_ms\": { \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"jitter\": %.3f },\n", s.frameMsP50, s.frameMsP95, s.frameMsP99,
+            s.frameMsJitter);
+        fprintf(f, "      \"fps\": { \"p50\": %.2f, \"p5\": %.2f, \"p1\": %.2f },\n      \"counters\": {", s.frameMsP50 > 0 ? 1000.0f / s.frameMsP50 : 0.0f,
+            s.frameMsP95 > 0 ? 1000.0f / s.frameMsP95 : 0.0f, s.frameMsP99 > 0 ? 1000.0f / s.frameMsP99 : 0.0f);
+        for (int c = 0; c < TelemetryCounterCount(); ++c) fprintf(f, "%s \"%s\": %lld", c ? "," : "", g_counterNames[c], s.counters[c]);
+        fprintf(f, " }\n    }");
+        first = false;
+    }
+    fprintf(f, "\n  }\n}\n");
+    return fclose(f) == 0;
+}
+
+// OpenMetrics text: a counter family per registered counter, the state
+// time and a frame time histogram, every series labelled with the state
+static const float METRIC_FRAME_BOUNDS_MS[] = { 4.0f, 8.5f, 12.0f, 17.0f, 20.0f, 25.0f, 33.5f, 50.0f, 67.0f };
+
+static std::string FormatMetrics() {
+    std::string out;
+    char line[256];
+    int states[MAX_TELEMETRY_STATES], stateCount = 0;
+    for (int state = 0; state < MAX_TELEMETRY_STATES; ++state) if (g_agg.session[state].seconds > 0.0) states[stateCount++] = state;
+
+    out += "# TYPE pirates_state_seconds counter\n# UNIT pirates_state_seconds seconds\n# HELP pirates_state_seconds Time each game state was showing.\n";
+    for (int i = 0; i < stateCount; ++i) {
+        sprintf(line, "pirates_state_seconds_total{state=\"%s\"} %.3f\n", StateName(states[i]), g_agg.session[states[i]].seconds);
+        out += line;
+    }
+    out += "# TYPE pirates_cpu_seconds counter\n# UNIT pirates_cpu_seconds seconds\n# HELP pirates_cpu_seconds Process CPU time (all threads) while each state was showing.\n";
+    for (int i = 0; i < stateCount; ++i) {
+        sprintf(line, "pirates_cpu_seconds_total{state=\"%s\"} %.3f\n", StateName(states[i]), g_agg.session[states[i]].cpuSeconds);
+        out += line;
+    }
+    out += "# TYPE pirates_frame_jitter_seconds gauge\n# UNIT pirates_frame_jitter_seconds seconds\n# HELP pirates_frame_jitter_seconds Standard deviation of the frame time.\n";
+    for (int i = 0; i < stateCount; ++i) {
+        sprintf(line, "pirates_frame_jitter_seconds{state=\"%s\"} %.6f\n", StateName(states[i]), Summarize(g_agg.session[states[i]]).frameMsJitter / 1000.0f);
+        out += line;
+    }
+    for (int c = 0; c < TelemetryCounterCount(); ++c) {
+        sprintf(line, "# TYPE pirates_%s counter\n# HELP pirates_%s %s\n", g_counterNames[c], g_counterNames[c], g_counterHelp[c]);
+        out += line;
+        for (int i = 0; i < stateCount; ++i) {
+            sprintf(line, "pirates_%s_total{state=\"%s\"} %lld\n", g_counterNames[c], StateName(states[i]), g_agg.session[states[i]].counters[c]);
+            out += line;
+        }
+    }
+    out += "# TYPE pirates_frame_seconds histogram\n# UNIT pirates_frame_seconds seconds\n# HELP pirates_frame_seconds Time from one frame to the next.\n";
+    for (int i = 0; i < stateCount; ++i) {
+        const StateTotals& t = g_agg.session[states[i]];
+        const char* name = StateName(states[i]);
+        long long cumulative = 0;
+        int b = 0;
+        for (float bound : METRIC_FRAME_BOUNDS_MS) {
+            for (; b < (int)(bound / FRAME_BUCKET_MS); ++b) cumulative += t.buckets[b];
+            sprintf(line, "pirates_frame_seconds_bucket{state=\"%s\",le=\"%g\"} %lld\n", name, bound / 1000.0f, cumulative);
+            out += line;
+        }
+        for (; b < FRAME_BUCKETS; ++b) cumulative += t.buckets[b];
+        sprintf(line, "pirates_frame_seconds_bucket{state=\"%s\",le=\"+Inf\"} %lld\npirates_frame_seconds_count{state=\"%s\"} %lld\n"
+            "pirates_frame_seconds_sum{state=\"%s\"} %.6f\n", name, cumulative, name, cumulative, name, t.frameMs / 1000.0);
+        out += line;
+    }
+    out += "# EOF\n";
+    return out;
+}
+
+// ---- Thread ----
+struct TelemetryThread {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit = false;                   // under mutex
+    TelemetryOptions options = {};
+    FILE* csv = nullptr;
+    SOCKET listener = INVALID_SOCKET;
+};
+static TelemetryThread g_telemetry;
+
+// Any request gets the metrics; scrapers ask for /metrics
+static void ServeScrape(SOCKET client) {
+    char request[1024];
+#ifdef _WIN32
+    DWORD timeout = 200;
+#else
+    timeval timeout = { 0, 200000 };
+#endif
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    int got = 0;
+    while (got < (int)sizeof(request) - 1) {
+        const int n = recv(client, request + got, (int)sizeof(request) - 1 - got, 0);
+        if (n <= 0) break;
+        got += n; request[got] = 0;
+        if (strstr(request, "\r\n\r\n")) break;
+    }
+    std::string body;
+    {
+        std::lock_guard<std::mutex> lock(g_agg.mutex);
+        Aggregate(TelemetryClock::now());
+        body = FormatMetrics();
+    }
+    char header[256];
+    sprintf(header, "HTTP/1.0 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+        "Content-Length: %d\r\nConnection: close\r\n\r\n", (int)body.size());
+    const std::string response = header + body;
+    for (size_t sent = 0; sent < response.size();) {
+        const int n = send(client, response.data() + sent, (int)(response.size() - sent), 0);
+        if (n <= 0) break;
+        sent += n;
+    }
+    closesocket(client);
+}
+
+static void EndPeriod() {
+    std::lock_guard<std::mutex> lock(g_agg.mutex);
+    const TelemetryClock::time_point now = TelemetryClock::now();
+    Aggregate(now);
+    const double sinceStart = std::chrono::duration<double>(now - g_agg.start).count();
+    if (g_telemetry.csv) WriteCsvPeriod(g_telemetry.csv, sinceStart);
+    if (g_telemetry.options.jsonPath) WriteJsonSummary(g_telemetry.options.jsonPath, sinceStart);
+}
+
+// Sleeps until the period ends, or in select() on the listener so a
+// scrape is answered at once; quitting is seen within SCRAPE_POLL_MS
+static const int SCRAPE_POLL_MS = 100;
+
+static void TelemetryMain() {
+    const TelemetryClock::duration period = std::chrono::milliseconds(g_telemetry.options.periodMs);
+    TelemetryClock::time_point next = TelemetryClock::now() + period;
+    for (;;) {
+        if (g_telemetry.listener == INVALID_SOCKET) {
+            std::unique_lock<std::mutex> lock(g_telemetry.mutex);
+            g_telemetry.wake.wait_until(lock, next, [] { return g_telemetry.quit; });
+            if (g_telemetry.quit) return;
+        }
+        else {
+            {
+                std::lock_guard<std::mutex> lock(g_telemetry.mutex);
+                if (g_telemetry.quit) return;
+            }
+            long long waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(next - TelemetryClock::now()).count();
+            if (waitMs > SCRAPE_POLL_MS) waitMs = SCRAPE_POLL_MS;
+            if (waitMs < 0) waitMs = 0;
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(g_telemetry.listener, &readable);
+            timeval timeout = { 0, (long)(waitMs * 1000) };
+            if (select((int)g_telemetry.listener + 1, &readable, nullptr, nullptr, &timeout) > 0) {
+                const SOCKET client = accept(g_telemetry.listener, nullptr, nullptr);
+                if (client != INVALID_SOCKET) ServeScrape(client);
+            }
+        }
+        if (TelemetryClock::now() >= next) {
+            EndPeriod();
+            next += period;
+            if (next < TelemetryClock::now()) next = TelemetryClock::now() + period;
+        }
+    }
+}
+
+static SOCKET OpenListener(int port) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return INVALID_SOCKET;
+#endif
+    const SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID_SOCKET) return INVALID_SOCKET;
+    const int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // never reachable from off the kiosk
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(s, (const sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 4) != 0) { closesocket(s); return INVALID_SOCKET; }
+    return s;
+}
+
+bool StartTelemetry(const TelemetryOptions& options) {
+    if (g_telemetry.thread.joinable()) return true;
+    bool ok = true;
+    g_telemetry.options = options;
+    if (g_telemetry.options.periodMs < 10) g_telemetry.options.periodMs = 10;
+    g_telemetry.quit = false;
+    if (options.csvPath) {
+        g_telemetry.csv = fopen(options.csvPath, "a");   // sessions append
+        if (!g_telemetry.csv) ok = false;
+        else if (fseek(g_telemetry.csv, 0, SEEK_END) == 0 && ftell(g_telemetry.csv) == 0) WriteCsvHeader(g_telemetry.csv);
+    }
+    if (options.metricsPort > 0) {
+        g_telemetry.listener = OpenListener(options.metricsPort);
+        if (g_telemetry.listener == INVALID_SOCKET) ok = false;
+    }
+    g_telemetry.thread = std::thread(TelemetryMain);
+    return ok;
+}
+
+void StopTelemetry() {
+    if (!g_telemetry.thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(g_telemetry.mutex);
+        g_telemetry.quit = true;
+    }
+    g_telemetry.wake.notify_all();
+    g_telemetry.thread.join();
+    EndPeriod();
+    if (g_telemetry.csv) { fclose(g_telemetry.csv); g_telemetry.csv = nullptr; }
+    if (g_telemetry.listener != INVALID_SOCKET) {
+        closesocket(g_telemetry.listener);
+        g_telemetry.listener = INVALID_SOCKET;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
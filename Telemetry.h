@@ -0,0 +1,96 @@
+// ---------------- TELEMETRY ----------------
+// Per-session counters for capacity planning, split by game state:
+//
+//   static const int CTR_DRAW_CALLS = RegisterCounter("draw_calls", "Draw calls issued");
+//   ...
+//   CountAdd(CTR_DRAW_CALLS);
+//
+// Counters are registered at static initialisation; registering a name
+// again gives the same counter, so each file that counts it can. Every
+// thread adds into a block of its own with a plain load and store (no
+// locked instruction, no shared cache line), so a count costs about a
+// nanosecond; the hot loops (collision tests, agents) still add once per
+// batch rather than per item. Build with TELEMETRY_COUNTERS=0 and CountAdd
+// compiles to nothing, to measure what the counts cost (CollisionBench).
+// TelemetryFrame records the drawing thread's frame times into a
+// histogram, for the percentiles, and says which state is showing.
+// Each period also takes the process's CPU time, so a state's CPU use
+// (100% is one core busy) sits next to its frame times and their jitter.
+//
+// StartTelemetry runs an aggregation thread that sums the blocks every
+// period and puts what was added since into the state that was showing
+// (a state change aggregates straight away, so nothing crosses over). It
+// can append a CSV row per state and period, rewrite a JSON summary of the
+// session, and answer OpenMetrics scrapes on 127.0.0.1. Between periods it
+// only sleeps, so an unscraped session pays for the counts alone.
+//
+// No GL or GLUT; the sockets are Winsock on Windows, BSD sockets elsewhere.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+
+#ifndef TELEMETRY_COUNTERS
+#define TELEMETRY_COUNTERS 1
+#endif
+
+static const int MAX_COUNTERS = 32;
+static const int MAX_TELEMETRY_STATES = 8;
+static const int FRAME_BUCKETS = 200;            // 0.5 ms each, the last one open
+static const float FRAME_BUCKET_MS = 0.5f;
+
+// name: [a-z_]; help: one line for the metrics endpoint. The same name
+// returns the same counter; -1 past MAX_COUNTERS.
+int RegisterCounter(const char* name, const char* help);
+
+// One thread's counts; see CountAdd
+struct CounterBlock { std::atomic<long long> values[MAX_COUNTERS]; };
+CounterBlock* ThreadCounterBlock();
+extern thread_local CounterBlock* t_counterBlock;
+
+// Only the calling thread writes its block, so no read-modify-write is
+// needed; the aggregator reads it with relaxed loads
+#if TELEMETRY_COUNTERS
+inline void CountAdd(int counter, long long n = 1) {
+    if (counter < 0) return;
+    CounterBlock* block = t_counterBlock ? t_counterBlock : ThreadCounterBlock();
+    std::atomic<long long>& v = block->values[counter];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+#else
+inline void CountAdd(int, long long = 1) {}
+#endif
+
+// Names the states for the exports ("menu", "level_1"); before StartTelemetry
+void SetTelemetryStateName(int state, const char* name);
+// Once per frame, from the thread that draws: how long since the last
+// frame began, and the state this frame shows
+void TelemetryFrame(float frameMs, int state);
+
+struct TelemetryOptions {
+    int periodMs;           // aggregation period
+    const char* csvPath;    // a row per state and period, or null
+    const char* jsonPath;   // session summary, rewritten every period, or null
+    int metricsPort;        // OpenMetrics on http://127.0.0.1:port/metrics, or 0
+};
+// False if a file or the port could not be opened (the rest still runs)
+bool StartTelemetry(const TelemetryOptions& options);
+// Aggregates once more and writes the final JSON
+void StopTelemetry();
+
+// Session totals of one state, aggregated now
+struct TelemetrySummary {
+    double seconds;         // wall time the state was showing
+    long long frames;
+    float fpsMean;
+    float frameMsP50, frameMsP95, frameMsP99;
+    float frameMsJitter;    // standard deviation
+    float cpuPercent;       // process CPU time over wall time; 100 is one core
+    long long counters[MAX_COUNTERS];
+};
+TelemetrySummary GetTelemetrySummary(int state);
+int TelemetryCounterCount();
+const char* TelemetryCounterName(int counter);
+
+#endif // TELEMETRY_H
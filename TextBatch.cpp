@@ -0,0 +1,131 @@
+// ---------------- TEXT ----------------
+// See TextBatch.h.
+
+#include "glew.h"
+#include "TextBatch.h"
+#include "Telemetry.h"
+#include <glut.h>
+
+// Cell layout, sized for GLUT_BITMAP_HELVETICA_18: 18 px ascent plus
+// room for descenders below the baseline
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_PAD = 2;
+static const int ATLAS_CELL_HEIGHT = 26;
+static const int ATLAS_BASELINE = 7;
+
+static std::vector<TextVertex> g_textQueue;
+
+static const int CTR_DRAW_CALLS = RegisterCounter("draw_calls", "Draw calls issued.");
+static const int CTR_TRIANGLES = RegisterCounter("triangles", "Triangles submitted in draw calls.");
+static const int CTR_TEXTURE_BINDS = RegisterCounter("texture_binds", "Textures bound for drawing.");
+
+static int NextPowerOfTwo(int v) {
+    int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+bool BuildGlyphAtlas(GlyphAtlas& atlas, void* font) {
+    int maxAdvance = 0;
+    for (int i = 0; i < TEXT_GLYPH_COUNT; ++i) {
+        int w = glutBitmapWidth(font, TEXT_FIRST_GLYPH + i);
+        if (w > maxAdvance) maxAdvance = w;
+    }
+    const int cellW = maxAdvance + 2 * ATLAS_PAD, cellH = ATLAS_CELL_HEIGHT;
+    const int cells = TEXT_GLYPH_COUNT + 1;   // the last one is the solid cell
+    const int rows = (cells + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    const int usedW = ATLAS_COLUMNS * cellW, usedH = rows * cellH;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (viewport[2] < usedW || viewport[3] < usedH) return false;
+
+    // Draw every glyph white on black in its cell at the bottom-left of the back buffer
+    glPushAttrib(GL_ALL_ATTRIB_BITS);
+    glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D); glDisable(GL_DEPTH_TEST); glDisable(GL_BLEND); glDisable(GL_FOG);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, viewport[2], 0, viewport[3]);
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+    glClearColor(0, 0, 0, 0); glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    for (int i = 0; i < TEXT_GLYPH_COUNT; ++i) {
+        const int col = i % ATLAS_COLUMNS, row = i / ATLAS_COLUMNS;
+        glRasterPos2f((float)(col * cellW + ATLAS_PAD), (float)(row * cellH + ATLAS_BASELINE));
+        glutBitmapCharacter(font, TEXT_FIRST_GLYPH + i);
+    }
+
+    // Coverage becomes the texture's alpha
+    const int texW = NextPowerOfTwo(usedW), texH = NextPowerOfTwo(usedH);
+    std::vector<unsigned char> pixels(texW * texH, 0);
+    // From whatever is being drawn to: the back buffer, or the --capture target
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, texW);
+    glReadPixels(viewport[0], viewport[1], usedW, usedH, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+
+    const int solidCol = TEXT_GLYPH_COUNT % ATLAS_COLUMNS, solidRow = TEXT_GLYPH_COUNT / ATLAS_COLUMNS;
+    for (int y = solidRow * cellH; y < (solidRow + 1) * cellH; ++y)
+        for (int x = solidCol * cellW; x < (solidCol + 1) * cellW; ++x) pixels[y * texW + x] = 255;
+
+    if (!atlas.texture) glGenTextures(1, &atlas.texture);
+    glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, texW, texH, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    atlas.cellWidth = (float)cellW; atlas.cellHeight = (float)cellH;
+    atlas.originX = (float)ATLAS_PAD; atlas.originY = (float)ATLAS_BASELINE;
+    atlas.solidU = (solidCol + 0.5f) * cellW / texW; atlas.solidV = (solidRow + 0.5f) * cellH / texH;
+    for (int i = 0; i < TEXT_GLYPH_COUNT; ++i) {
+        const int col = i % ATLAS_COLUMNS, row = i / ATLAS_COLUMNS;
+        GlyphInfo& g = atlas.glyphs[i];
+        g.advance = (float)glutBitmapWidth(font, TEXT_FIRST_GLYPH + i);
+        g.u0 = (float)(col * cellW) / texW; g.u1 = (float)((col + 1) * cellW) / texW;
+        g.v0 = (float)(row * cellH) / texH; g.v1 = (float)((row + 1) * cellH) / texH;
+    }
+    return true;
+}
+
+void QueueText(const GlyphAtlas& atlas, float x, float y, const char* str) {
+    if (!atlas.texture) return;   // atlas not built yet: nothing to draw with
+    LayoutText(atlas, x, y, str, g_textQueue);
+}
+
+void FlushText(const GlyphAtlas& atlas, int viewWidth, int viewHeight) {
+    if (g_textQueue.empty()) return;
+    DrawTextVertices(atlas, &g_textQueue[0], (int)g_textQueue.size(), viewWidth, viewHeight);
+    g_textQueue.clear();
+}
+
+void DrawTextVertices(const GlyphAtlas& atlas, const TextVertex* vertices, int count, int viewWidth, int viewHeight) {
+    if (count == 0 || !atlas.texture) return;
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING); glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D); glBindTexture(GL_TEXTURE_2D, atlas.texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable(GL_BLEND); glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity(); gluOrtho2D(0, viewWidth, 0, viewHeight);
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), &vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &vertices[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), &vertices[0].r);
+    glDrawArrays(GL_QUADS, 0, count);
+    CountAdd(CTR_DRAW_CALLS); CountAdd(CTR_TRIANGLES, count / 2); CountAdd(CTR_TEXTURE_BINDS);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    glPopMatrix(); glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
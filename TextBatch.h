@@ -0,0 +1,47 @@
+// ---------------- TEXT ----------------
+// HUD and dialogue text. The GLUT bitmap font is drawn once into a glyph
+// atlas texture; strings queued during a frame become textured quads that
+// go out in a single draw call on FlushText. The atlas also has a solid
+// texel, so flat-coloured HUD shapes can share the same draw. Layout
+// (TextLayout.cpp) needs no GL; bench/TextLayoutCheck.cpp checks it headless.
+
+#ifndef TEXT_BATCH_H
+#define TEXT_BATCH_H
+
+#include <vector>
+
+static const int TEXT_FIRST_GLYPH = 32;    // ' '
+static const int TEXT_GLYPH_COUNT = 95;    // up to '~'
+
+struct GlyphInfo { float advance; float u0, v0, u1, v1; };
+
+struct GlyphAtlas {
+    GlyphInfo glyphs[TEXT_GLYPH_COUNT];
+    float cellWidth, cellHeight;   // quad size in pixels
+    float originX, originY;        // pen position inside a cell (left padding, baseline)
+    float solidU, solidV;          // a fully opaque texel
+    unsigned int texture;          // 0 until BuildGlyphAtlas succeeds
+};
+
+struct TextVertex { float x, y, u, v; unsigned char r, g, b, a; };
+
+// Appends one quad (4 vertices, GL_QUADS order) per visible character of
+// str with the pen starting at (x, y) on the baseline. Characters outside
+// the atlas are drawn as '?'. Returns the number of quads added.
+int LayoutText(const GlyphAtlas& atlas, float x, float y, const char* str, std::vector<TextVertex>& out);
+// Flat-coloured triangle (count 3) or quad (count 4) as one GL_QUADS quad
+void LayoutSolid(const GlyphAtlas& atlas, const float points[][2], int count, const unsigned char rgba[4], std::vector<TextVertex>& out);
+
+// Renders font (a GLUT bitmap font) into the back buffer, reads it back
+// into the atlas texture and clears it again. Call with the window current
+// and before the frame is drawn. Fails if the window is too small.
+bool BuildGlyphAtlas(GlyphAtlas& atlas, void* font);
+// Queues str for the next FlushText; (x, y) in window pixels from the
+// bottom-left as with glRasterPos in an ortho projection.
+void QueueText(const GlyphAtlas& atlas, float x, float y, const char* str);
+// Draws everything queued since the last flush in one call
+void FlushText(const GlyphAtlas& atlas, int viewWidth, int viewHeight);
+// Draws prepared vertices (GL_QUADS) in one call, ortho over the view
+void DrawTextVertices(const GlyphAtlas& atlas, const TextVertex* vertices, int count, int viewWidth, int viewHeight);
+
+#endif // TEXT_BATCH_H
@@ -0,0 +1,39 @@
+// ---------------- TEXT LAYOUT ----------------
+// See TextBatch.h. The GL-free part, kept apart so bench/TextLayoutCheck.cpp
+// can link it without GL or GLUT.
+
+#include "TextBatch.h"
+
+static const GlyphInfo& GlyphFor(const GlyphAtlas& atlas, char c) {
+    int i = (unsigned char)c - TEXT_FIRST_GLYPH;
+    if (i < 0 || i >= TEXT_GLYPH_COUNT) i = '?' - TEXT_FIRST_GLYPH;
+    return atlas.glyphs[i];
+}
+
+int LayoutText(const GlyphAtlas& atlas, float x, float y, const char* str, std::vector<TextVertex>& out) {
+    int quads = 0;
+    float penX = x;
+    for (const char* c = str; *c != '\0'; c++) {
+        const GlyphInfo& g = GlyphFor(atlas, *c);
+        if (*c != ' ') {
+            const float x0 = penX - atlas.originX, y0 = y - atlas.originY;
+            const float x1 = x0 + atlas.cellWidth, y1 = y0 + atlas.cellHeight;
+            TextVertex quad[4] = {
+                { x0, y0, g.u0, g.v0, 255, 255, 255, 255 }, { x1, y0, g.u1, g.v0, 255, 255, 255, 255 },
+                { x1, y1, g.u1, g.v1, 255, 255, 255, 255 }, { x0, y1, g.u0, g.v1, 255, 255, 255, 255 }
+            };
+            out.insert(out.end(), quad, quad + 4);
+            quads++;
+        }
+        penX += g.advance;
+    }
+    return quads;
+}
+
+void LayoutSolid(const GlyphAtlas& atlas, const float points[][2], int count, const unsigned char rgba[4], std::vector<TextVertex>& out) {
+    for (int i = 0; i < 4; ++i) {
+        const float* p = points[i < count ? i : count - 1];   // a triangle repeats its last corner
+        TextVertex v = { p[0], p[1], atlas.solidU, atlas.solidV, rgba[0], rgba[1], rgba[2], rgba[3] };
+        out.push_back(v);
+    }
+}
@@ -0,0 +1,225 @@
+// ---------------- AUDIO BENCHMARK ----------------
+// Headless benchmark for the mixer in Audio.cpp, on synthetic clips (one
+// tone per clip, half a second to two seconds long) so it needs neither
+// the SFX folder nor a decoder. No GL, GLUT or Windows.
+//
+// It reports:
+//   - ns per PlayClip call, the cost the simulation pays per sound
+//   - ms and ns per frame to mix one AUDIO_BLOCK_FRAMES block at 1 up to
+//     MAX_AUDIO_VOICES playing voices, against the block's real-time budget
+//   - the voice pool under pressure: a burst of one capped clip, then a
+//     full pool of low-priority loops met by higher and lower priorities
+//   - a few seconds of the game's sound pattern (music loop, a pickup or
+//     jump every few frames from a 120 Hz thread) through the paced .wav
+//     sink: blocks mixed, dropped commands and the slowest trigger
+//   - streamed music: two minute-long 48 kHz tracks (written next to the
+//     output, deleted after) played, crossfaded and stopped through the
+//     sink, with each track's level per 100 ms read back from the output,
+//     the rings' fixed memory and any blocks where a ring ran dry
+//
+// Build:
+//   Visual Studio: AudioBench project in OpenGLMeshLoader.sln
+//   Linux/macOS:   g++ -O2 -std=c++14 -pthread bench/AudioBench.cpp Audio.cpp -o AudioBench
+//
+// Usage: AudioBench [seconds] [out.wav]
+//   seconds    length of the sink run (default 3)
+//   out.wav    where the sink writes (default AudioBench.wav)
+
+#include "../Audio.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point a, Clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+// Mono tones at 22050 Hz, so loading also goes through the resampler
+static void MakeClips() {
+    const int rate = 22050;
+    for (int id = 0; id < MAX_AUDIO_CLIPS; ++id) {
+        const int frames = rate / 2 + id * rate / 20;
+        std::vector<short> tone(frames);
+        const double hz = 220.0 + 40.0 * id;
+        for (int i = 0; i < frames; ++i) tone[i] = (short)(3000.0 * sin(6.283185307 * hz * i / rate));
+        SetAudioClip(id, tone.data(), frames, 1, rate);
+    }
+}
+
+static void BenchTriggers() {
+    const int batches = 2000, perBatch = 128;   // under the queue's 256 slots
+    std::vector<short> out(AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS);
+    double seconds = 0.0;
+    for (int b = 0; b < batches; ++b) {
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < perBatch; ++i) PlayClip(i % MAX_AUDIO_CLIPS);
+        seconds += Seconds(start, Clock::now());
+        MixAudio(out.data(), 1);   // drains the queue
+    }
+    printf("PlayClip: %.1f ns per call (%d calls)\n\n", seconds * 1e9 / (batches * perBatch), batches * perBatch);
+}
+
+static void BenchMix() {
+    const double budgetMs = 1000.0 * AUDIO_BLOCK_FRAMES / AUDIO_RATE;
+    printf("Mixing %d-frame blocks (%.1f ms of sound each)\n", AUDIO_BLOCK_FRAMES, budgetMs);
+    printf("%8s %12s %12s %12s\n", "voices", "ms/block", "ns/frame", "% budget");
+    std::vector<short> out(AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS);
+    const int blocks = 2000;
+    for (int voices = 1; voices <= MAX_AUDIO_VOICES && voices <= MAX_AUDIO_CLIPS; voices *= 2) {
+        for (int id = 0; id < MAX_AUDIO_CLIPS; ++id) StopClip(id);
+        for (int id = 0; id < voices; ++id) LoopClip(id);
+        MixAudio(out.data(), AUDIO_BLOCK_FRAMES);
+        const Clock::time_point start = Clock::now();
+        for (int b = 0; b < blocks; ++b) MixAudio(out.data(), AUDIO_BLOCK_FRAMES);
+        const double ms = Seconds(start, Clock::now()) * 1000.0 / blocks;
+        printf("%8d %12.4f %12.2f %12.2f\n", GetAudioStats().voices, ms, ms * 1e6 / AUDIO_BLOCK_FRAMES, 100.0 * ms / budgetMs);
+    }
+    for (int id = 0; id < MAX_AUDIO_CLIPS; ++id) StopClip(id);
+    MixAudio(out.data(), 1);
+    printf("\n");
+}
+
+static void ExpectVoices(const char* what, int voices, int expected) {
+    printf("  %-44s %3d voices (expected %d)%s\n", what, voices, expected, voices == expected ? "" : "  MISMATCH");
+}
+
+static void BenchPool() {
+    std::vector<short> out(AUDIO_BLOCK_FRAMES * AUDIO_CHANNELS);
+    printf("Voice pool (%d voices)\n", MAX_AUDIO_VOICES);
+    for (int id = 0; id < MAX_AUDIO_CLIPS; ++id) SetClipLimits(id, 1, 0);
+    SetClipLimits(0, 4, 1);
+    for (int i = 0; i < 50; ++i) PlayClip(0);
+    MixAudio(out.data(), AUDIO_BLOCK_FRAMES);
+    ExpectVoices("50 triggers of a clip capped at 4", GetAudioStats().voices, 4);
+    StopClip(0);
+
+    // Fill the pool with priority 0 loops, then ask for more
+    SetClipLimits(1, MAX_AUDIO_VOICES, 0);
+    SetClipLimits(2, 1, 2);
+    SetClipLimits(3, 1, -1);
+    for (int i = 0; i < MAX_AUDIO_VOICES; ++i) LoopClip(1);
+    MixAudio(out.data(), AUDIO_BLOCK_FRAMES);
+    ExpectVoices("pool filled with priority 0 loops", GetAudioStats().voices, MAX_AUDIO_VOICES);
+    const AudioStats before = GetAudioStats();
+    PlayClip(2);
+    PlayClip(3);
+    MixAudio(out.data(), AUDIO_BLOCK_FRAMES);
+    const AudioStats after = GetAudioStats();
+    printf("  priority 2 trigger: %d stolen; priority -1 trigger: %d refused\n", after.stolen - before.stolen, after.refused - before.refused);
+    StopClip(1); StopClip(2);
+    MixAudio(out.data(), 1);
+    for (int id = 0; id < MAX_AUDIO_CLIPS; ++id) SetClipLimits(id, 1, 0);
+    printf("\n");
+}
+
+// The simulation's pattern: music on a loop, short clips retriggered
+// every few ticks, from a thread that is not the mixer
+static void BenchSink(double seconds, const char* path) {
+    if (!StartAudio(AUDIO_WAV, path)) { printf("Could not open %s\n", path); return; }
+    const AudioStats before = GetAudioStats();
+    LoopClip(0);
+    double worstNs = 0.0;
+    int triggers = 0;
+    const Clock::time_point end = Clock::now() + std::chrono::microseconds((long long)(seconds * 1e6));
+    for (int tick = 0; Clock::now() < end; ++tick) {
+        if (tick % 5 == 0) {
+            const Clock::time_point start = Clock::now();
+            PlayClip(1 + tick % (MAX_AUDIO_CLIPS - 1));
+            const double ns = Seconds(start, Clock::now()) * 1e9;
+            if (ns > worstNs) worstNs = ns;
+            ++triggers;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(1000000 / 120));
+    }
+    StopAudio();
+    const AudioStats after = GetAudioStats();
+    printf("Sink run, %.1f s into %s:\n", seconds, path);
+    printf("  %d blocks mixed (%.1f s of sound), last mix %.3f ms\n", after.blocks - before.blocks,
+        (double)(after.blocks - before.blocks) * AUDIO_BLOCK_FRAMES / AUDIO_RATE, after.mixMs);
+    printf("  %d triggers, slowest %.0f ns, %d dropped\n", triggers, worstNs, after.dropped - before.dropped);
+}
+
+static void WriteWav(const char* path, const std::vector<short>& stereo, int rate) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return;
+    const unsigned data = (unsigned)(stereo.size() * 2);
+    const unsigned fields[] = { 36 + data, 16, 1 | (2 << 16), (unsigned)rate, (unsigned)rate * 4, 4 | (16 << 16), data };
+    fwrite("RIFF", 1, 4, f); fwrite(&fields[0], 4, 1, f); fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fields[1], 4, 5, f); fwrite("data", 1, 4, f); fwrite(&fields[6], 4, 1, f);   // little-endian hosts
+    fwrite(stereo.data(), 2, stereo.size(), f);
+    fclose(f);
+}
+
+// Level of one frequency in a window (Goertzel), on the left channel
+static double ToneLevel(const short* stereo, int frames, double hz) {
+    const double k = 2.0 * cos(6.283185307 * hz / AUDIO_RATE);
+    double s1 = 0.0, s2 = 0.0;
+    for (int i = 0; i < frames; ++i) {
+        const double s0 = stereo[i * 2] + k * s1 - s2;
+        s2 = s1; s1 = s0;
+    }
+    return sqrt(s1 * s1 + s2 * s2 - k * s1 * s2) * 2.0 / frames;
+}
+
+static void BenchMusic(const char* path) {
+    const int rate = 48000, seconds = 60;
+    const double hzA = 330.0, hzB = 550.0;
+    std::vector<short> track((size_t)rate * seconds * 2);
+    for (int pass = 0; pass < 2; ++pass) {
+        const double hz = pass == 0 ? hzA : hzB;
+        for (int i = 0; i < rate * seconds; ++i) track[i * 2] = track[i * 2 + 1] = (short)(8000.0 * sin(6.283185307 * hz * i / rate));
+        WriteWav(pass == 0 ? "AudioBenchMusicA.wav" : "AudioBenchMusicB.wav", track, rate);
+    }
+    SetMusicTrack(0, L"AudioBenchMusicA.wav");
+    SetMusicTrack(1, L"AudioBenchMusicB.wav");
+
+    if (!StartAudio(AUDIO_WAV, path)) { printf("Could not open %s\n", path); return; }
+    const AudioStats before = GetAudioStats();
+    PlayMusic(0, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    PlayMusic(1, 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    StopMusic(500);
+    std::this_thread::sleep_for(std::chrono::milliseconds(700));
+    StopAudio();
+    const AudioStats after = GetAudioStats();
+    remove("AudioBenchMusicA.wav");
+    remove("AudioBenchMusicB.wav");
+
+    printf("Streamed music: A at 0 s, crossfade to B over 1 s at 1 s, 0.5 s fade out at 2.5 s\n");
+    printf("  %d KB of rings for two %d s tracks (%d KB each as PCM), %d blocks starved\n",
+        (int)(2 * sizeof(short) * MUSIC_RING_FRAMES * AUDIO_CHANNELS / 1024), seconds, (int)(track.size() * 2 / 1024), after.musicStarved - before.musicStarved);
+    FILE* f = fopen(path, "rb");
+    if (!f) return;
+    fseek(f, 44, SEEK_SET);
+    std::vector<short> out;
+    short buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 2, 4096, f)) > 0) out.insert(out.end(), buffer, buffer + got);
+    fclose(f);
+    const int window = AUDIO_RATE / 10;
+    printf("  %6s %8s %8s\n", "t (s)", "A", "B");
+    for (int w = 0; (size_t)(w + 1) * window * 2 <= out.size(); w += 2)
+        printf("  %6.1f %8.0f %8.0f\n", w * 0.1, ToneLevel(&out[(size_t)w * window * 2], window, hzA), ToneLevel(&out[(size_t)w * window * 2], window, hzB));
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+    const char* path = argc > 2 ? argv[2] : "AudioBench.wav";
+    const Clock::time_point start = Clock::now();
+    MakeClips();
+    printf("%d clips resampled to %d Hz stereo in %.2f ms\n\n", MAX_AUDIO_CLIPS, AUDIO_RATE, Seconds(start, Clock::now()) * 1000.0);
+    BenchTriggers();
+    BenchMix();
+    BenchPool();
+    BenchMusic(path);
+    BenchSink(seconds, path);
+    return 0;
+}
@@ -0,0 +1,467 @@
+// ---------------- COLLISION & PHYSICS BENCHMARK ----------------
+// Headless microbenchmark for the simulation in GameWorld.cpp. It links the
+// real world code (no copies), stubs out the sound/clock hooks and never
+// touches GL, GLUT, Windows or MCI, so it runs on any build box.
+//
+// Worlds are populated at 1x, 10x, 100x and 1000x of the shipped tree, rock
+// and coin counts and the following are reported per scale:
+//   - ns per CollidesWithTree / Rock / House / AnyObject query
+//   - PlaceCoinsRandom time and coins placed for the scaled coin count
+//   - simulation ticks per second (UpdateWorld at 60 Hz with the player running)
+//   - heap allocations per tick
+// followed by:
+//   - PlaceCoinsRandom for 1k-16k coins over the open island and the
+//     shipped layout: time, coins placed of those asked for, closest pair
+//   - Level 2 ground-height queries (grid, batched, and the old linear scan
+//     for reference) with the shipped platforms plus 0/1k/10k extra ones
+//   - Level 2 pendulums: instant vs swept query cost, and how many hits
+//     per-frame sampling misses at the 20 Hz worst-case tick
+//   - the entity store (Entities.h) at 1k-100k entities: ns per entity for
+//     the spin pass (serial and as jobs on every core), the pickup scan,
+//     the render gather and destroy+create, next to the per-type vector
+//     loops it replaced
+//   - crowd throughput (UpdateAgents) for 1k-50k agents at 1..N job
+//     workers, with a hash of the final state that must match for every
+//     worker count
+//
+// To see what the telemetry counters cost, build it a second time with
+// -DTELEMETRY_COUNTERS=0 (CountAdd compiled to nothing) and compare the
+// ticks/s and agent-steps/s columns; the first line says which build ran.
+//
+// Build:
+//   Visual Studio: CollisionBench project in OpenGLMeshLoader.sln
+//   Linux/macOS:   g++ -O2 -std=c++14 -pthread bench/CollisionBench.cpp GameWorld.cpp Entities.cpp Jobs.cpp Profiler.cpp Telemetry.cpp -o CollisionBench
+//
+// Usage: CollisionBench [maxScale] [maxPlacementScale] [maxThreads]
+//   maxScale           largest world scale to run (default 1000)
+//   maxPlacementScale  largest scale PlaceCoinsRandom is timed at (default 1000)
+//   maxThreads         largest job worker count for the crowd table (default: cores, at least 8)
+
+#include "../GameWorld.h"
+#include "../Telemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+// ---------------- ALLOCATION COUNTING ----------------
+static std::atomic<long long> g_allocCount(0);
+
+void* operator new(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ---------------- HOST HOOKS (headless) ----------------
+static int g_simMs = 0;
+void Game_PlaySound(SoundId) {}
+void Game_PlayMusic(SoundId, int) {}
+void Game_StopMusic(int) {}
+int Game_ElapsedMs() { return g_simMs; }
+
+// ---------------- HELPERS ----------------
+typedef std::chrono::high_resolution_clock Clock;
+
+static double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static float RandRange(float minV, float maxV) { return minV + (maxV - minV) * (rand() / (float)RAND_MAX); }
+
+static volatile int g_sink = 0;
+
+// Runs query(x, z) over a fixed set of random points until at least
+// minSeconds have elapsed and returns the average ns per call.
+template <typename Query>
+static double TimeQueries(Query query, double minSeconds) {
+    static const int POINTS = 4096;
+    static float px[POINTS], pz[POINTS];
+    for (int i = 0; i < POINTS; ++i) { px[i] = RandRange(0.0f, LAND_SIZE); pz[i] = RandRange(0.0f, LAND_SIZE); }
+
+    long long calls = 0;
+    int hits = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    do {
+        for (int i = 0; i < POINTS; ++i) hits += query(px[i], pz[i]) ? 1 : 0;
+        calls += POINTS;
+        elapsed = SecondsSince(start);
+    } while (elapsed < minSeconds);
+    g_sink += hits;
+    return elapsed * 1e9 / (double)calls;
+}
+
+// Level 1 with the shipped layout, then scale-1 extra copies of every tree,
+// rock and coin scattered over the island.
+static void PopulateWorld(int scale) {
+    srand(1234u);
+    gameState = LEVEL_1;
+    ClearEntities(g_level1Entities);
+    PlaceRocksRandom(6);
+    PlaceHousesStreet();
+    PlaceTreesRandom(50);
+    PlacePirateMapInRoad();
+    PlaceBoatAtEdge();
+
+    const size_t baseTrees = g_trees.size(), baseRocks = g_rocks.size();
+    for (int s = 1; s < scale; ++s) {
+        for (size_t i = 0; i < baseTrees; ++i)
+            g_trees.push_back(TreeInstance{ RandRange(0.0f, LAND_SIZE), 0.0f, RandRange(0.0f, LAND_SIZE), 0.0f, 0.40f });
+        for (size_t i = 0; i < baseRocks; ++i)
+            g_rocks.push_back(RockInstance{ RandRange(0.0f, LAND_SIZE), 0.0f, RandRange(0.0f, LAND_SIZE), 0.0f, 0.01f, (int)(i % 5) });
+    }
+
+    // Coins are scattered directly so tick timings don't depend on the placer
+    for (int i = 0; i < 20 * scale; ++i) {
+        const float x = RandRange(2.0f, LAND_SIZE - 2.0f);
+        SpawnCoin(x, RandRange(2.0f, LAND_SIZE - 2.0f));
+    }
+
+    playerX = 2.0f; playerZ = 2.0f; playerY = 0.0f; playerYaw = 0.0f;
+    velX = velZ = velY = 0.0f; grounded = true; jumpCount = 0;
+    isFadingOut = false; isFadingIn = false; fadeAlpha = 0.0f;
+    score = 1000; lives = 5; coinsCollected = 0; gameTimer = 0.0f;
+    g_agents.clear();
+    InvalidateBroadPhase();
+}
+
+struct TickResult { double ticksPerSecond; double allocsPerTick; };
+
+// Runs the 60 Hz simulation with the player sprinting in a slow circle and
+// jumping every second so movement, collision and pickups all get exercised.
+static TickResult TimeTicks(int ticks) {
+    const float dt = 1.0f / 60.0f;
+    keyW = true;
+    long long allocsBefore = g_allocCount.load();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < ticks; ++i) {
+        playerYaw += 0.5f;
+        if (i % 60 == 0) spaceTrigger = true;
+        g_simMs += 16;
+        UpdateWorld(dt, g_simMs);
+    }
+    double elapsed = SecondsSince(start);
+    long long allocs = g_allocCount.load() - allocsBefore;
+    keyW = false;
+    TickResult r;
+    r.ticksPerSecond = ticks / elapsed;
+    r.allocsPerTick = (double)allocs / ticks;
+    return r;
+}
+
+// Spawns count agents on a jittered lattice over the island
+static void SpawnAgents(int count) {
+    g_agents.clear();
+    g_agents.reserve(count);
+    const int side = (int)ceilf(sqrtf((float)count));
+    for (int i = 0; i < count; ++i) {
+        float x = (i % side + 0.5f) * LAND_SIZE / side;
+        float z = (i / side + 0.5f) * LAND_SIZE / side;
+        g_agents.push_back(MakeAgent(x, z));
+    }
+}
+
+// FNV-1a over the agent array and the coins left
+static unsigned long long HashCrowd() {
+    unsigned long long h = 1469598103934665603ULL;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* b = (const unsigned char*)data;
+        for (size_t i = 0; i < size; ++i) { h ^= b[i]; h *= 1099511628211ULL; }
+    };
+    for (const Agent& a : g_agents) { mix(&a.x, sizeof(float) * 3); mix(&a.pickups, sizeof(int)); }
+    ForEach<Transform, Pickup>(g_level1Entities, [&](Entity, const Transform& t, const Pickup&) { mix(&t.x, sizeof(float)); mix(&t.z, sizeof(float)); });
+    return h;
+}
+
+// Every agent wanders with its own heading and jumps now and then; inputs
+// depend only on the tick and the agent index.
+static double TimeCrowd(int ticks) {
+    const float dt = 1.0f / 60.0f;
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < ticks; ++t) {
+        for (int i = 0; i < (int)g_agents.size(); ++i) {
+            float heading = (float)(i % 360) + t * 0.5f * ((i & 1) ? 1.0f : -1.0f);
+            g_agents[i].inputX = sinf(heading * PI / 180.0f);
+            g_agents[i].inputZ = cosf(heading * PI / 180.0f);
+            if ((t + i) % 90 == 0) g_agents[i].jumpTrigger = true;
+        }
+        UpdateAgents(dt);
+    }
+    return (double)ticks * g_agents.size() / SecondsSince(start);
+}
+
+// The pre-grid IsOnLevel2Platform, extended to return the height
+static float LinearFloorHeight(float x, float z) {
+    float best = NO_GROUND;
+    for (const auto& p : lvl2_platforms) {
+        float halfW = p.width / 2.0f, halfL = p.length / 2.0f;
+        if (x >= (p.x - halfW) && x <= (p.x + halfW) && z >= (p.z - halfL) && z <= (p.z + halfL) && p.y > best) best = p.y;
+    }
+    return best;
+}
+
+// PlaceCoinsRandom over the island with nothing in the way (no trees,
+// rocks or houses; the street and the spawn still keep coins out) and with
+// the shipped 1x obstacles, for more and more coins: ms (best of 3),
+// coins placed out of those asked for, and the closest two coins, which
+// must stay at least 3 apart. The scale table grows the obstacles with the
+// coins, so it fills the island; this shows how the placer itself scales.
+static void BenchPlacement() {
+    printf("\n%-12s %10s %10s %10s %10s\n", "placement", "asked", "placed", "ms", "min gap");
+    const int counts[] = { 1000, 2000, 4000, 8000, 16000 };
+    for (int open = 1; open >= 0; --open) {
+        PopulateWorld(1);
+        if (open) { g_trees.clear(); g_rocks.clear(); g_houses.clear(); InvalidateBroadPhase(); }
+        for (int count : counts) {
+            double best = 1e30;
+            for (int run = 0; run < 3; ++run) {
+                srand(777u);
+                Clock::time_point start = Clock::now();
+                PlaceCoinsRandom(count);
+                const double ms = SecondsSince(start) * 1000.0;
+                if (ms < best) best = ms;
+            }
+            std::vector<float> xz;
+            ForEach<Transform, Pickup>(g_level1Entities, [&](Entity, const Transform& t, const Pickup& p) {
+                if (p.kind == PICKUP_COIN) { xz.push_back(t.x); xz.push_back(t.z); }
+            });
+            float minGap2 = 1e30f;
+            for (size_t i = 0; i < xz.size(); i += 2)
+                for (size_t j = i + 2; j < xz.size(); j += 2) {
+                    const float dx = xz[i] - xz[j], dz = xz[i + 1] - xz[j + 1];
+                    if (dx * dx + dz * dz < minGap2) minGap2 = dx * dx + dz * dz;
+                }
+            printf("%-12s %10d %10d %10.2f %10.2f\n", open ? "open island" : "shipped 1x", count, (int)xz.size() / 2, best, sqrtf(minGap2));
+        }
+    }
+}
+
+// Level 2 with the shipped platforms plus extra random ones across a wider field
+static void BenchGround(double minSeconds) {
+    printf("\n%10s | %10s %10s %10s | %s\n", "platforms", "grid ns", "batch ns", "linear ns", "mismatches");
+    const int extras[] = { 0, 1000, 10000 };
+    for (int extra : extras) {
+        srand(99u);
+        InitLevel2();
+        gameState = LEVEL_2;
+        for (int i = 0; i < extra; ++i)
+            lvl2_platforms.push_back(Lvl2Platform{ RandRange(-500.0f, 500.0f), RandRange(-500.0f, 500.0f), RandRange(4.0f, 20.0f), RandRange(4.0f, 20.0f), RandRange(0.0f, 10.0f) });
+        InvalidateBroadPhase();
+
+        static const int POINTS = 4096;
+        static float xs[POINTS], zs[POINTS], heights[POINTS];
+        const float range = extra ? 500.0f : 60.0f;
+        for (int i = 0; i < POINTS; ++i) { xs[i] = RandRange(-range, range); zs[i] = RandRange(-range, range + 140.0f); }
+
+        int mismatches = 0;
+        FloorHeightsAt(xs, zs, heights, POINTS);
+        for (int i = 0; i < POINTS; ++i) mismatches += (heights[i] != LinearFloorHeight(xs[i], zs[i])) ? 1 : 0;
+
+        int i = 0;
+        double gridNs = TimeQueries([&](float, float) { i = (i + 1) % POINTS; return FloorHeightAt(xs[i], zs[i]) != NO_GROUND; }, minSeconds);
+        double linearNs = TimeQueries([&](float, float) { i = (i + 1) % POINTS; return LinearFloorHeight(xs[i], zs[i]) != NO_GROUND; }, minSeconds);
+        long long calls = 0;
+        Clock::time_point start = Clock::now();
+        do { FloorHeightsAt(xs, zs, heights, POINTS); calls += POINTS; } while (SecondsSince(start) < minSeconds);
+        double batchNs = SecondsSince(start) * 1e9 / (double)calls;
+        g_sink += (int)heights[0];
+
+        printf("%10d | %10.1f %10.1f %10.1f | %d\n", (int)lvl2_platforms.size(), gridNs, batchNs, linearNs, mismatches);
+    }
+    gameState = LEVEL_1;
+}
+
+// Level 2 corridor: random stationary bodies over random 50 ms windows
+static void BenchPendulums(double minSeconds) {
+    srand(4321u);
+    InitLevel2();
+    gameState = LEVEL_2;
+    const float dt = 0.05f;
+    static const int SAMPLES = 4096;
+    static float px[SAMPLES], py[SAMPLES], pz[SAMPLES], pt[SAMPLES];
+    for (int i = 0; i < SAMPLES; ++i) {
+        px[i] = RandRange(-8.0f, 8.0f); py[i] = RandRange(0.0f, 3.0f);
+        pz[i] = RandRange(10.0f, 130.0f); pt[i] = RandRange(0.0f, 60.0f);
+    }
+
+    // Misses: swept query hits somewhere in the window, the end-of-tick sample doesn't
+    int sweptHits = 0, sampledHits = 0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        for (auto& p : lvl2_pendulums) p.currentAngle = p.maxAngle * sinf(pt[i] * p.speed);
+        bool sampled = CollidesWithPendulum(px[i], pz[i], py[i], 0.0f);
+        bool swept = PendulumEarliestHit(pt[i] - dt, pt[i], px[i], py[i], pz[i], px[i], py[i], pz[i], 0.0f, nullptr);
+        sampledHits += sampled ? 1 : 0;
+        sweptHits += swept ? 1 : 0;
+    }
+
+    int i = 0;
+    double instantNs = TimeQueries([&](float, float) { i = (i + 1) % SAMPLES; return CollidesWithPendulum(px[i], pz[i], py[i], 0.0f); }, minSeconds);
+    double sweptNs = TimeQueries([&](float, float) {
+        i = (i + 1) % SAMPLES;
+        return PendulumEarliestHit(pt[i] - dt, pt[i], px[i], py[i], pz[i], px[i], py[i], pz[i], 0.0f, nullptr);
+    }, minSeconds);
+
+    printf("\npendulums %d | instant ns %.1f | swept ns %.1f | hits sampled %d, swept %d (%.0f%% missed by sampling)\n",
+        (int)lvl2_pendulums.size(), instantNs, sweptNs, sampledHits, sweptHits,
+        sweptHits ? 100.0 * (sweptHits - sampledHits) / sweptHits : 0.0);
+    gameState = LEVEL_1;
+}
+
+// Runs pass() until at least minSeconds have elapsed and returns ns per
+// item, for a pass that visits items entities.
+template <typename Pass>
+static double NsPerItem(int items, Pass pass, double minSeconds) {
+    long long visited = 0;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    do { pass(); visited += items; elapsed = SecondsSince(start); } while (elapsed < minSeconds);
+    return elapsed * 1e9 / (double)visited;
+}
+
+// CoinInstance as it was before the entity store, for the reference loops
+struct VectorCoin { float x, y, z; float spinDeg; float scale; bool active; };
+
+// Entity store (Entities.h) at 1k-100k entities, a quarter each of four
+// archetypes: spinning pickups, spinning props, still pickups, still props.
+static void BenchEntities(double minSeconds) {
+    printf("\n%9s | %10s %10s %10s %10s %10s | %12s %12s\n", "entities", "spin ns", "jobs spin", "scan ns", "gather ns", "churn ns", "vector spin", "vector scan");
+    const int counts[] = { 1000, 10000, 100000 };
+    for (int count : counts) {
+        srand(777u);
+        EntityWorld world;
+        std::vector<Entity> handles;
+        std::vector<VectorCoin> coins;
+        auto spawn = [&](int i) {
+            const float x = RandRange(0.0f, LAND_SIZE);
+            const Transform t = { x, 1.0f, RandRange(0.0f, LAND_SIZE), 0.0f, 1.0f };
+            switch (i % 4) {
+            case 0: return CreateEntity(world, t, Spin{ 120.0f }, Pickup{ PICKUP_COIN, 2.0f }, Renderable{ RENDER_COIN });
+            case 1: return CreateEntity(world, t, Spin{ 60.0f }, Renderable{ RENDER_MAP });
+            case 2: return CreateEntity(world, t, Pickup{ PICKUP_KEY, 2.0f }, Renderable{ RENDER_KEY });
+            default: return CreateEntity(world, t, Renderable{ RENDER_TREASURE });
+            }
+        };
+        for (int i = 0; i < count; ++i) {
+            handles.push_back(spawn(i));
+            const Transform& t = *GetComponent<Transform>(world, handles.back());
+            coins.push_back(VectorCoin{ t.x, t.y, t.z, 0.0f, 0.01f, true });
+        }
+
+        // The passes UpdateWorld, CheckGameLogic and the renderer run
+        const float dt = 1.0f / 60.0f, px = LAND_SIZE * 0.5f, pz = LAND_SIZE * 0.5f;
+        int hits = 0, kinds[RENDER_KIND_COUNT] = { 0 };
+        double spinNs = NsPerItem(count / 2, [&]() {
+            ForEach<Transform, Spin>(world, [dt](Entity, Transform& t, const Spin& s) {
+                t.yawDeg += s.degPerSec * dt; if (t.yawDeg > 360.0f) t.yawDeg -= 360.0f;
+            });
+        }, minSeconds);
+        double jobsSpinNs = NsPerItem(count / 2, [&]() {
+            ParallelForEach<Transform, Spin>(world, 1024, [dt](Entity, Transform& t, const Spin& s) {
+                t.yawDeg += s.degPerSec * dt; if (t.yawDeg > 360.0f) t.yawDeg -= 360.0f;
+            });
+        }, minSeconds);
+        double scanNs = NsPerItem(count / 2, [&]() {
+            ForEach<Transform, Pickup>(world, [&](Entity, const Transform& t, const Pickup& p) {
+                const float dx = px - t.x, dz = pz - t.z;
+                hits += (dx * dx + dz * dz < p.reach * p.reach) ? 1 : 0;
+            });
+        }, minSeconds);
+        double gatherNs = NsPerItem(count, [&]() {
+            ForEach<Transform, Renderable>(world, [&](Entity, const Transform& t, const Renderable& r) { kinds[r.kind] += t.x > px ? 1 : 0; });
+        }, minSeconds);
+
+        // Destroy and recreate 1% of the entities per pass
+        const int churn = count / 100;
+        int next = 0;
+        double churnNs = NsPerItem(churn, [&]() {
+            for (int k = 0; k < churn; ++k) {
+                const int i = (next = (next * 1103515245 + 12345) & 0x7FFFFFFF) % count;
+                DestroyEntity(world, handles[i]);
+                handles[i] = spawn(i);
+            }
+        }, minSeconds);
+
+        // The same spin and scan over one vector per type, as the game had them
+        double vectorSpinNs = NsPerItem(count, [&]() {
+            for (auto& coin : coins) { coin.spinDeg += 120.0f * dt; if (coin.spinDeg > 360.0f) coin.spinDeg -= 360.0f; }
+        }, minSeconds);
+        double vectorScanNs = NsPerItem(count, [&]() {
+            for (auto& coin : coins) {
+                if (!coin.active) continue;
+                float d = sqrt(pow(px - coin.x, 2) + pow(pz - coin.z, 2));
+                hits += (d < 2.0f) ? 1 : 0;
+            }
+        }, minSeconds);
+        g_sink += hits + kinds[RENDER_COIN];
+
+        printf("%9d | %10.2f %10.2f %10.2f %10.2f %10.1f | %12.2f %12.2f\n", EntityCount(world), spinNs, jobsSpinNs, scanNs, gatherNs, churnNs, vectorSpinNs, vectorScanNs);
+    }
+}
+
+int main(int argc, char** argv) {
+    int maxScale = (argc > 1) ? atoi(argv[1]) : 1000;
+    int maxPlacementScale = (argc > 2) ? atoi(argv[2]) : 1000;
+    int cores = (int)std::thread::hardware_concurrency();
+    int maxThreads = (argc > 3) ? atoi(argv[3]) : (cores > 8 ? cores : 8);
+    const int scales[] = { 1, 10, 100, 1000 };
+    const double minSeconds = 0.2;
+
+    printf("Telemetry counters %s\n\n", TELEMETRY_COUNTERS ? "compiled in" : "compiled out (TELEMETRY_COUNTERS=0)");
+    printf("%6s %8s %8s %8s | %10s %10s %10s %10s | %10s %8s | %12s %12s\n",
+        "scale", "trees", "rocks", "coins",
+        "tree ns", "rock ns", "house ns", "any ns",
+        "place ms", "placed", "ticks/s", "allocs/tick");
+
+    for (int scale : scales) {
+        if (scale > maxScale) break;
+        PopulateWorld(scale);
+
+        double treeNs = TimeQueries([](float x, float z) { return CollidesWithTree(x, z, 0.0f); }, minSeconds);
+        double rockNs = TimeQueries([](float x, float z) { return CollidesWithRock(x, z, 0.0f); }, minSeconds);
+        double houseNs = TimeQueries([](float x, float z) { return CollidesWithHouse(x, z, 0.0f); }, minSeconds);
+        double anyNs = TimeQueries([](float x, float z) { return CollidesWithAnyObject(x, z, 0.0f); }, minSeconds);
+
+        TickResult ticks = TimeTicks(scale >= 1000 ? 600 : 3000);
+
+        char placeText[32] = "skipped", placedText[32] = "-";
+        if (scale <= maxPlacementScale) {
+            Clock::time_point start = Clock::now();
+            PlaceCoinsRandom(20 * scale);
+            sprintf(placeText, "%.3f", SecondsSince(start) * 1000.0);
+            sprintf(placedText, "%d", CountPickups(g_level1Entities, PICKUP_COIN));
+        }
+
+        printf("%6d %8d %8d %8d | %10.1f %10.1f %10.1f %10.1f | %10s %8s | %12.0f %12.2f\n",
+            scale, (int)g_trees.size(), (int)g_rocks.size(), 20 * scale,
+            treeNs, rockNs, houseNs, anyNs,
+            placeText, placedText, ticks.ticksPerSecond, ticks.allocsPerTick);
+    }
+
+    BenchPlacement();
+    BenchGround(minSeconds);
+    BenchPendulums(minSeconds);
+    BenchEntities(minSeconds);
+
+    printf("\n%8s %8s | %14s %8s | %16s\n", "agents", "workers", "agent-steps/s", "speedup", "state hash");
+    const int crowds[] = { 1000, 10000, 50000 };
+    for (int count : crowds) {
+        double base = 0.0;
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            PopulateWorld(10);
+            SpawnAgents(count);
+            SetJobWorkerCount(threads);
+            double rate = TimeCrowd(120);
+            if (threads == 1) base = rate;
+            printf("%8d %8d | %14.0f %8.2f | %016llx\n", count, threads, rate, rate / base, HashCrowd());
+        }
+    }
+    SetJobWorkerCount(1);
+    return g_sink == -1;
+}
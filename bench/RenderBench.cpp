@@ -0,0 +1,366 @@
+// ---------------- RENDER BENCHMARK ----------------
+// Headless benchmark for the clustered torch lights in Lighting.cpp and the
+// sun shadow cascades in Shadows.cpp, and the HUD layout. A small
+// software renderer ray-casts a view-space G-buffer (ground plane and a far
+// wall, as seen from the player's eye height) and shades every pixel on the
+// CPU twice: against every light, and against only the lights of its
+// cluster. No GL, GLUT or Windows, so it runs on any build box.
+//
+// For 16 up to maxLights torches scattered over the ground it reports:
+//   - BuildLightClusters time and cluster entries written
+//   - shading ns per pixel, brute force vs clustered, and the speed-up
+//   - lights tested per pixel, on average, by the clustered path
+//   - clusters over the shader's 64-light loop limit (those would drop lights)
+//   - the largest difference between the two images, which must stay ~0
+//
+// Then it walks the player camera through the village for a minute of
+// 60 Hz frames under the moving sun, with the game's cascade settings, and
+// reports per cascade how often the cached static layer could be kept
+// (same projection as the frame before) and the fitting time.
+//
+// Last, it lays out the HUD's widgets (TextLayout.cpp) for a minute of
+// Level 1, retained and rebuilt every frame, with and without the stats
+// overlay, and reports CPU us per frame and widgets laid out per frame.
+//
+// Build:
+//   Visual Studio: RenderBench project in OpenGLMeshLoader.sln
+//   Linux/macOS:   g++ -O2 -std=c++14 bench/RenderBench.cpp Lighting.cpp Shadows.cpp Culling.cpp TextLayout.cpp -o RenderBench
+//
+// Usage: RenderBench [maxLights] [width] [height]
+//   maxLights  largest torch count (default 1024)
+//   width      G-buffer size (default 320 x 180)
+
+#include "../Lighting.h"
+#include "../Shadows.h"
+#include "../TextBatch.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Same frustum and grid the game uses (gluPerspective(45, 16:9, 0.1, 1000))
+static const float FOV_Y_DEG = 45.0f, ASPECT = 16.0f / 9.0f, NEAR_Z = 0.1f, FAR_Z = 1000.0f;
+static const int TILES_X = 16, TILES_Y = 9, SLICES = 24;
+static const int SHADER_LIGHT_LIMIT = 64;   // MAX_CLUSTER_LIGHTS in LightingShader.cpp
+static const float TORCH_RADIUS = 14.0f;
+// SUN SHADOWS constants in OpenGLMeshLoader.cpp, sunSpeed/sunRadius in GameWorld.cpp
+static const int CASCADES = 4;
+static const float SHADOW_DISTANCE = 200.0f, SHADOW_SPLIT_LAMBDA = 0.75f, SHADOW_SNAP = 0.125f, SHADOW_SUN_STEP_DEG = 2.0f;
+static const float SUN_SPEED = 0.3f;
+
+// ---------------- HELPERS ----------------
+typedef std::chrono::high_resolution_clock Clock;
+
+static double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static unsigned int g_rng = 12345u;
+static float Random01() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return (g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// Column-major gluLookAt / gluPerspective
+static void LookAt(const float eye[3], const float center[3], float m[16]) {
+    float f[3] = { center[0] - eye[0], center[1] - eye[1], center[2] - eye[2] };
+    float fl = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    for (int k = 0; k < 3; ++k) f[k] /= fl;
+    float s[3] = { -f[2], 0.0f, f[0] };   // f x up(0,1,0)
+    float sl = sqrtf(s[0] * s[0] + s[2] * s[2]);
+    s[0] /= sl; s[2] /= sl;
+    const float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+    const float rows[3][3] = { { s[0], s[1], s[2] }, { u[0], u[1], u[2] }, { -f[0], -f[1], -f[2] } };
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) m[c * 4 + r] = rows[r][c];
+        m[12 + r] = -(rows[r][0] * eye[0] + rows[r][1] * eye[1] + rows[r][2] * eye[2]);
+        m[r * 4 + 3] = 0.0f;
+    }
+    m[15] = 1.0f;
+}
+
+static void Perspective(float m[16]) {
+    const float f = 1.0f / tanf(FOV_Y_DEG * 3.14159265f / 360.0f);
+    for (int i = 0; i < 16; ++i) m[i] = 0.0f;
+    m[0] = f / ASPECT; m[5] = f;
+    m[10] = (FAR_Z + NEAR_Z) / (NEAR_Z - FAR_Z); m[11] = -1.0f;
+    m[14] = 2.0f * FAR_Z * NEAR_Z / (NEAR_Z - FAR_Z);
+}
+
+// ---------------- G-BUFFER ----------------
+// View-space position and normal per covered pixel; sky pixels are left out
+struct GPixel { float sx, sy; float px, py, pz; float nx, ny, nz; int index; };
+
+static const float WALL_Z = -150.0f;
+
+static void BuildGBuffer(int width, int height, const float view[16], const float eye[3], std::vector<GPixel>& out) {
+    const float tanY = tanf(FOV_Y_DEG * 3.14159265f / 360.0f), tanX = tanY * ASPECT;
+    out.clear();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float sx = (x + 0.5f) / width, sy = (y + 0.5f) / height;
+            const float vd[3] = { (sx * 2.0f - 1.0f) * tanX, (sy * 2.0f - 1.0f) * tanY, -1.0f };
+            // World direction: transpose of the view rotation
+            float wd[3];
+            for (int k = 0; k < 3; ++k) wd[k] = view[k * 4 + 0] * vd[0] + view[k * 4 + 1] * vd[1] + view[k * 4 + 2] * vd[2];
+            float t = 1e30f, wn[3] = { 0.0f, 0.0f, 0.0f };
+            if (wd[1] < 0.0f) { t = -eye[1] / wd[1]; wn[1] = 1.0f; }
+            if (wd[2] < 0.0f) {
+                const float tw = (WALL_Z - eye[2]) / wd[2];
+                if (tw < t) { t = tw; wn[1] = 0.0f; wn[2] = 1.0f; }
+            }
+            if (t > FAR_Z) continue;   // vd has z = -1, so t is the view depth
+            GPixel p;
+            p.sx = sx; p.sy = sy; p.index = y * width + x;
+            p.px = vd[0] * t; p.py = vd[1] * t; p.pz = -t;
+            p.nx = view[0] * wn[0] + view[4] * wn[1] + view[8] * wn[2];
+            p.ny = view[1] * wn[0] + view[5] * wn[1] + view[9] * wn[2];
+            p.nz = view[2] * wn[0] + view[6] * wn[1] + view[10] * wn[2];
+            out.push_back(p);
+        }
+    }
+}
+
+// ---------------- SHADING ----------------
+static void ShadeBrute(const std::vector<GPixel>& pixels, const LightClusters& c, const std::vector<PointLight>& lights, std::vector<float>& rgb) {
+    for (const GPixel& p : pixels) {
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        for (size_t i = 0; i < lights.size(); ++i) {
+            const float f = LightFalloff(&c.viewLights[i * 4], p.px, p.py, p.pz, p.nx, p.ny, p.nz);
+            r += lights[i].r * f; g += lights[i].g * f; b += lights[i].b * f;
+        }
+        float* o = &rgb[p.index * 3];
+        o[0] = r; o[1] = g; o[2] = b;
+    }
+}
+
+static long long ShadeClustered(const std::vector<GPixel>& pixels, const LightClusters& c, const std::vector<PointLight>& lights, std::vector<float>& rgb) {
+    long long tested = 0;
+    for (const GPixel& p : pixels) {
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        const int cluster = ClusterAt(c, p.sx, p.sy, p.pz);
+        if (cluster >= 0) {
+            const int first = c.offsets[cluster], last = c.offsets[cluster + 1];
+            tested += last - first;
+            for (int k = first; k < last; ++k) {
+                const int i = c.indices[k];
+                const float f = LightFalloff(&c.viewLights[i * 4], p.px, p.py, p.pz, p.nx, p.ny, p.nz);
+                r += lights[i].r * f; g += lights[i].g * f; b += lights[i].b * f;
+            }
+        }
+        float* o = &rgb[p.index * 3];
+        o[0] = r; o[1] = g; o[2] = b;
+    }
+    return tested;
+}
+
+// ---------------- SHADOW CASCADES ----------------
+// Third-person camera behind a player running a loop around the village at
+// full speed, the sun crossing the sky as in the game
+static void BenchShadowCascades() {
+    const float mapCenter = 150.0f;   // LAND_SIZE / 2
+    const float sceneMin[3] = { -100.0f, -12.0f, -100.0f }, sceneMax[3] = { 500.0f, 80.0f, 650.0f };
+    float splits[CASCADES + 1];
+    ComputeCascadeSplits(NEAR_Z, SHADOW_DISTANCE, CASCADES, SHADOW_SPLIT_LAMBDA, splits);
+
+    const int frames = 60 * 60;
+    const float dt = 1.0f / 60.0f, step = SHADOW_SUN_STEP_DEG * 3.14159265f / 180.0f;
+    ShadowCascade previous[CASCADES], current;
+    int kept[CASCADES] = { 0 };
+    double fitSeconds = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        const float t = f * dt;
+        // Sun from just after sunrise to just before sunset, over and over
+        const float sunAngle = 0.1f + fmodf(SUN_SPEED * t, 2.9f);
+        const float lightAngle = floorf(sunAngle / step + 0.5f) * step;
+        const float lightDir[3] = { cosf(lightAngle), sinf(lightAngle), 0.0f };
+        // Player on a 100-unit circle at top speed (maxSpeed, 24 units/s), camera
+        // 15 behind and 5 up
+        const float a = t * 0.24f;
+        const float px = mapCenter + 100.0f * cosf(a), pz = mapCenter + 100.0f * sinf(a);
+        const float dx = -sinf(a), dz = cosf(a);
+        const float eye[3] = { px - 15.0f * dx, 5.0f, pz - 15.0f * dz }, center[3] = { px, 1.0f, pz };
+        float view[16];
+        LookAt(eye, center, view);
+
+        for (int i = 0; i < CASCADES; ++i) {
+            Clock::time_point start = Clock::now();
+            FitShadowCascade(current, view, FOV_Y_DEG, ASPECT, splits[i], splits[i + 1], lightDir, sceneMin, sceneMax, SHADOW_SNAP);
+            fitSeconds += SecondsSince(start);
+            if (f > 0 && SameCascadeProjection(current, previous[i])) kept[i]++;
+            previous[i] = current;
+        }
+    }
+
+    printf("\nShadow cascades, %d frames at 60 Hz, sun step %.0f deg:\n", frames, SHADOW_SUN_STEP_DEG);
+    printf("%8s %10s %10s %10s %12s\n", "cascade", "to depth", "radius", "redraws/s", "static kept");
+    for (int i = 0; i < CASCADES; ++i) {
+        const int redraws = frames - kept[i];
+        printf("%8d %10.1f %10.1f %10.2f %11.1f%%\n", i, splits[i + 1], previous[i].radius, redraws / (frames * dt), 100.0 * kept[i] / (frames - 1));
+    }
+    printf("FitShadowCascade: %.2f us per cascade\n", fitSeconds * 1e6 / (frames * CASCADES));
+}
+
+// ---------------- HUD ----------------
+// DrawHUD's widgets (OpenGLMeshLoader.cpp) laid out through TextLayout.cpp
+// against a synthetic atlas, a minute of 60 Hz frames of Level 1: the
+// timer steps every 0.1 s, a coin is picked up every second, the NPC's
+// dialogue is up for the second half. Retained lays a widget out again
+// only when its key changes and re-joins the stream only then; rebuilt
+// ('H' in the game) does every widget every frame. The draw both end in
+// is the same single call and is not part of this.
+enum { HUD_BAR, HUD_SCORE, HUD_COINS, HUD_COUNTER, HUD_HEARTS, HUD_MESSAGES, HUD_STATS, HUD_WIDGETS };
+static const float HUD_W = 1280.0f, HUD_H = 720.0f;   // WIDTH x HEIGHT
+
+struct HudBenchWidget { long long key; bool valid; std::vector<TextVertex> vertices; };
+
+static bool HudStale(HudBenchWidget& w, long long key, bool rebuildAll, int& rebuilt) {
+    if (w.valid && w.key == key && !rebuildAll) return false;
+    w.key = key; w.valid = true;
+    w.vertices.clear();
+    rebuilt++;
+    return true;
+}
+
+static GlyphAtlas HudBenchAtlas() {
+    GlyphAtlas atlas = {};
+    for (int i = 0; i < TEXT_GLYPH_COUNT; ++i) {   // about GLUT_BITMAP_HELVETICA_18
+        atlas.glyphs[i].advance = 6.0f + (i * 7) % 8;
+        atlas.glyphs[i].u0 = (i % 16) / 16.0f; atlas.glyphs[i].u1 = (i % 16 + 1) / 16.0f;
+        atlas.glyphs[i].v0 = (i / 16) / 8.0f; atlas.glyphs[i].v1 = (i / 16 + 1) / 8.0f;
+    }
+    atlas.cellWidth = 22.0f; atlas.cellHeight = 26.0f; atlas.originX = 2.0f; atlas.originY = 7.0f;
+    atlas.solidU = 0.97f; atlas.solidV = 0.97f;
+    return atlas;
+}
+
+// One DrawHUD's worth of layout; returns the widgets laid out again
+static int LayOutHud(const GlyphAtlas& atlas, HudBenchWidget* widgets, std::vector<TextVertex>& stream, int frame, bool stats, bool rebuildAll) {
+    int rebuilt = 0;
+    char text[128];
+    const int coins = frame / 60, score = 1000 + 50 * coins;
+    const long long timer = (long long)(frame / 60.0f * 10.0f + 0.5f);
+    const bool dialogue = frame >= 1800;
+    if (HudStale(widgets[HUD_BAR], 0, rebuildAll, rebuilt)) {
+        const float quad[4][2] = { { 0, 0 }, { HUD_W, 0 }, { HUD_W, 80 }, { 0, 80 } };
+        const unsigned char rgba[4] = { 0, 0, 0, 89 };
+        LayoutSolid(atlas, quad, 4, rgba, widgets[HUD_BAR].vertices);
+    }
+    if (HudStale(widgets[HUD_SCORE], score, rebuildAll, rebuilt)) { sprintf(text, "Score: %d", score); LayoutText(atlas, 15, 60, text, widgets[HUD_SCORE].vertices); }
+    if (HudStale(widgets[HUD_COINS], coins, rebuildAll, rebuilt)) { sprintf(text, "Coins: %d", coins); LayoutText(atlas, 15, 35, text, widgets[HUD_COINS].vertices); }
+    if (HudStale(widgets[HUD_COUNTER], timer, rebuildAll, rebuilt)) { sprintf(text, "Time: %.1f", timer / 10.0f); LayoutText(atlas, 15, 10, text, widgets[HUD_COUNTER].vertices); }
+    if (HudStale(widgets[HUD_HEARTS], 3, rebuildAll, rebuilt)) {
+        for (int i = 0; i < 5; ++i) {
+            const float x = HUD_W - 200.0f + i * 28.0f, y = 40.0f;
+            const float top[3][2] = { { x + 8, y }, { x, y - 12 }, { x + 16, y - 12 } };
+            const float bottom[3][2] = { { x + 8, y - 22 }, { x, y - 12 }, { x + 16, y - 12 } };
+            const unsigned char full[4] = { 255, 0, 0, 230 }, empty[4] = { 128, 128, 128, 102 };
+            LayoutSolid(atlas, top, 3, i < 3 ? full : empty, widgets[HUD_HEARTS].vertices);
+            LayoutSolid(atlas, bottom, 3, i < 3 ? full : empty, widgets[HUD_HEARTS].vertices);
+        }
+    }
+    if (HudStale(widgets[HUD_MESSAGES], dialogue, rebuildAll, rebuilt)) {
+        std::vector<TextVertex>& out = widgets[HUD_MESSAGES].vertices;
+        if (!dialogue) LayoutText(atlas, HUD_W / 2 - 80, HUD_H - 200, "Press E to talk", out);
+        else {
+            LayoutText(atlas, HUD_W / 2 - 380, HUD_H / 2 + 50, "Ahoy there, matey!", out);
+            LayoutText(atlas, HUD_W / 2 - 380, HUD_H / 2 + 10, "Find the treasure map in the village and collect", out);
+            LayoutText(atlas, HUD_W / 2 - 380, HUD_H / 2 - 30, "at least 10 gold coins to pay for passage on me boat!", out);
+            LayoutText(atlas, HUD_W / 2 - 380, HUD_H / 2 - 70, "The map will guide ye to the ancient treasure...", out);
+        }
+    }
+    // The stats overlay changes every frame while shown: its 14 lines, at their usual length
+    if (HudStale(widgets[HUD_STATS], stats ? frame : -1, rebuildAll, rebuilt) && stats) {
+        for (int line = 0; line < 14; ++line) {
+            sprintf(text, "Cascade %d (to %.0f): static %d/%d cached, moving %d/%d, %.3f ms CPU, %.3f ms GPU", line, 12.5f * line,
+                frame % 97, 120, frame % 13, 40, 0.01f * line, 0.002f * frame);
+            LayoutText(atlas, 10, HUD_H - 25 - 15.0f * line, text, widgets[HUD_STATS].vertices);
+        }
+    }
+    if (rebuilt > 0) {
+        stream.clear();
+        for (int i = 0; i < HUD_WIDGETS; ++i) stream.insert(stream.end(), widgets[i].vertices.begin(), widgets[i].vertices.end());
+    }
+    return rebuilt;
+}
+
+static void BenchHud() {
+    const GlyphAtlas atlas = HudBenchAtlas();
+    const int frames = 60 * 60;
+    printf("\nHUD layout, %d frames of Level 1 at 60 Hz:\n", frames);
+    printf("%-14s %-9s %12s %14s %12s\n", "stats overlay", "widgets", "us / frame", "laid out / fr", "vertices");
+    for (int stats = 0; stats < 2; ++stats) {
+        for (int rebuildAll = 0; rebuildAll < 2; ++rebuildAll) {
+            HudBenchWidget widgets[HUD_WIDGETS] = {};
+            std::vector<TextVertex> stream;
+            long long rebuilt = 0;
+            double best = 1e30;
+            for (int run = 0; run < 5; ++run) {   // fastest of 5, each from a cold HUD
+                for (HudBenchWidget& w : widgets) w.valid = false;
+                rebuilt = 0;
+                Clock::time_point start = Clock::now();
+                for (int f = 0; f < frames; ++f) rebuilt += LayOutHud(atlas, widgets, stream, f, stats != 0, rebuildAll != 0);
+                const double s = SecondsSince(start);
+                if (s < best) best = s;
+            }
+            printf("%-14s %-9s %12.2f %14.2f %12d\n", stats ? "on" : "off", rebuildAll ? "rebuilt" : "retained", best * 1e6 / frames,
+                (double)rebuilt / frames, (int)stream.size());
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const int maxLights = argc > 1 ? atoi(argv[1]) : 1024;
+    const int width = argc > 2 ? atoi(argv[2]) : 320;
+    const int height = argc > 3 ? atoi(argv[3]) : 180;
+
+    const float eye[3] = { 0.0f, 8.2f, 10.0f }, center[3] = { 0.0f, 5.0f, -20.0f };
+    float view[16], proj[16];
+    LookAt(eye, center, view);
+    Perspective(proj);
+    std::vector<GPixel> pixels;
+    BuildGBuffer(width, height, view, eye, pixels);
+    printf("G-buffer %dx%d, %d covered pixels, %dx%dx%d clusters\n\n", width, height, (int)pixels.size(), TILES_X, TILES_Y, SLICES);
+
+    printf("%7s %10s %9s %12s %12s %8s %11s %9s %10s\n", "lights", "build ms", "entries", "brute ns/px", "clust ns/px", "speedup", "tested/px", "over cap", "max diff");
+    std::vector<float> brute(width * height * 3, 0.0f), clustered(width * height * 3, 0.0f);
+    for (int count = 16; count <= maxLights; count *= 2) {
+        // Torches over the ground in front of the camera, same spread at every count
+        g_rng = 12345u;
+        std::vector<PointLight> lights;
+        for (int i = 0; i < count; ++i) {
+            PointLight l = { -80.0f + 160.0f * Random01(), 1.0f + 3.0f * Random01(), WALL_Z + 160.0f * Random01(), TORCH_RADIUS, 1.0f, 0.6f, 0.25f };
+            lights.push_back(l);
+        }
+
+        LightClusters c;
+        const int buildRuns = 20;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < buildRuns; ++i) BuildLightClusters(c, lights, view, proj, TILES_X, TILES_Y, SLICES, NEAR_Z, FAR_Z);
+        const double buildMs = SecondsSince(start) * 1000.0 / buildRuns;
+
+        start = Clock::now();
+        ShadeBrute(pixels, c, lights, brute);
+        const double bruteNs = SecondsSince(start) * 1e9 / pixels.size();
+        start = Clock::now();
+        const long long tested = ShadeClustered(pixels, c, lights, clustered);
+        const double clusteredNs = SecondsSince(start) * 1e9 / pixels.size();
+
+        int overCap = 0;
+        for (int i = 0; i < TILES_X * TILES_Y * SLICES; ++i)
+            if (c.offsets[i + 1] - c.offsets[i] > SHADER_LIGHT_LIMIT) overCap++;
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < brute.size(); ++i) {
+            const float d = fabsf(brute[i] - clustered[i]);
+            if (d > maxDiff) maxDiff = d;
+        }
+        printf("%7d %10.3f %9d %12.1f %12.1f %7.1fx %11.2f %9d %10.2g\n", count, buildMs, (int)c.indices.size(), bruteNs, clusteredNs,
+            bruteNs / clusteredNs, (double)tested / pixels.size(), overCap, maxDiff);
+    }
+
+    BenchShadowCascades();
+    BenchHud();
+    return 0;
+}
@@ -0,0 +1,311 @@
+// ---------------- TANGENT BENCHMARK ----------------
+// Headless benchmark for the tangent frames in Tangents.cpp, the part of
+// Model_3DS::CalculateTangents that takes the time at load. Each of the
+// game's textured .3ds models is read (vertices, texture coordinates,
+// faces and the loader's smoothed normals, as Model_3DS builds them) and
+// then given tangents twice:
+//   - before: the one-triangle-at-a-time corner loop with acosf that
+//     ComputeTangents used to run, kept here as the reference
+//   - after:  ComputeTangents, four triangles per SSE batch
+// and it reports per model the vertices and triangles that get tangents,
+// ms for both (best of several runs), the speed-up, and how far apart
+// the two results are: the largest angle between the tangents and the
+// vertices whose handedness differs, leaving out (and counting) vertices
+// whose frame is ill-posed to begin with. Last comes a 60k-vertex,
+// 120k-triangle rolling grid, a mesh bigger than any the game ships.
+// No GL, GLUT or Windows.
+//
+// Build:
+//   Visual Studio: TangentBench project in OpenGLMeshLoader.sln
+//   Linux/macOS:   g++ -O2 -std=c++14 bench/TangentBench.cpp Tangents.cpp -o TangentBench
+//
+// Usage: TangentBench [model.3ds ...]   (default: the models LoadAssets
+// loads, from the working directory, which should be the repo root)
+
+#include "../Tangents.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double SecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// One object of a model, as Model_3DS keeps it
+struct Mesh {
+    std::vector<float> positions, normals, texCoords;
+    std::vector<unsigned short> indices;
+};
+
+// ---------------- .3DS READING ----------------
+// Only the chunks CalculateTangents needs: MAIN3DS > EDIT3DS > OBJECT >
+// TRIG_MESH > VERT_LIST, TEX_VERTS, FACE_DESC. Same conventions as
+// Model_3DS: y and z swapped and z negated, v flipped, and normals summed
+// from unnormalized face normals then normalized.
+static unsigned short ReadU16(const unsigned char* p) { return (unsigned short)(p[0] | p[1] << 8); }
+static unsigned int ReadU32(const unsigned char* p) { return p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24; }
+static float ReadF32(const unsigned char* p) { unsigned int u = ReadU32(p); float f; memcpy(&f, &u, 4); return f; }
+
+static void ReadTriMesh(const unsigned char* p, const unsigned char* end, Mesh& m) {
+    while (p + 6 <= end) {
+        const unsigned short id = ReadU16(p);
+        const unsigned int len = ReadU32(p + 2);
+        if (len < 6 || p + len > end) break;
+        const unsigned char* data = p + 6;
+        if (id == 0x4110) {
+            const int n = ReadU16(data);
+            m.positions.resize(n * 3);
+            for (int i = 0; i < n; ++i) {
+                m.positions[i * 3] = ReadF32(data + 2 + i * 12);
+                m.positions[i * 3 + 2] = -ReadF32(data + 2 + i * 12 + 4);
+                m.positions[i * 3 + 1] = ReadF32(data + 2 + i * 12 + 8);
+            }
+        }
+        else if (id == 0x4140) {
+            const int n = ReadU16(data);
+            m.texCoords.resize(n * 2);
+            for (int i = 0; i < n; ++i) {
+                m.texCoords[i * 2] = ReadF32(data + 2 + i * 8);
+                m.texCoords[i * 2 + 1] = 1.0f - ReadF32(data + 2 + i * 8 + 4);
+            }
+        }
+        else if (id == 0x4120) {
+            const int n = ReadU16(data);
+            m.indices.resize(n * 3);
+            for (int i = 0; i < n * 3; ++i) m.indices[i] = ReadU16(data + 2 + (i / 3) * 8 + (i % 3) * 2);
+        }
+        p += len;
+    }
+}
+
+static void ReadChunks(const unsigned char* p, const unsigned char* end, std::vector<Mesh>& meshes) {
+    while (p + 6 <= end) {
+        const unsigned short id = ReadU16(p);
+        const unsigned int len = ReadU32(p + 2);
+        if (len < 6 || p + len > end) break;
+        const unsigned char* data = p + 6;
+        if (id == 0x4D4D || id == 0x3D3D) ReadChunks(data, p + len, meshes);
+        else if (id == 0x4000) {
+            const unsigned char* name = data;
+            while (name < p + len && *name) name++;   // object name
+            std::vector<Mesh> objects;
+            ReadChunks(name + 1, p + len, objects);
+            meshes.insert(meshes.end(), objects.begin(), objects.end());
+        }
+        else if (id == 0x4100) {
+            Mesh m;
+            ReadTriMesh(data, p + len, m);
+            meshes.push_back(m);
+        }
+        p += len;
+    }
+}
+
+static void BuildNormals(Mesh& m) {
+    m.normals.assign(m.positions.size(), 0.0f);
+    const float* v = m.positions.empty() ? nullptr : &m.positions[0];
+    for (size_t f = 0; f + 2 < m.indices.size(); f += 3) {
+        const int a = m.indices[f], b = m.indices[f + 1], c = m.indices[f + 2];
+        const float u[3] = { v[b * 3] - v[c * 3], v[b * 3 + 1] - v[c * 3 + 1], v[b * 3 + 2] - v[c * 3 + 2] };
+        const float w[3] = { v[b * 3] - v[a * 3], v[b * 3 + 1] - v[a * 3 + 1], v[b * 3 + 2] - v[a * 3 + 2] };
+        const float n[3] = { u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0] };
+        for (int k = 0; k < 3; ++k) { m.normals[a * 3 + k] += n[k]; m.normals[b * 3 + k] += n[k]; m.normals[c * 3 + k] += n[k]; }
+    }
+    for (size_t i = 0; i < m.normals.size(); i += 3) {
+        float len = sqrtf(m.normals[i] * m.normals[i] + m.normals[i + 1] * m.normals[i + 1] + m.normals[i + 2] * m.normals[i + 2]);
+        if (len == 0.0f) len = 1.0f;
+        for (int k = 0; k < 3; ++k) m.normals[i + k] /= len;
+    }
+}
+
+// The objects CalculateTangents would give tangents: one texture
+// coordinate per vertex. False if the file cannot be read.
+static bool LoadMeshes(const char* path, std::vector<Mesh>& meshes) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[65536];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0) bytes.insert(bytes.end(), buffer, buffer + got);
+    fclose(f);
+    std::vector<Mesh> all;
+    if (!bytes.empty()) ReadChunks(&bytes[0], &bytes[0] + bytes.size(), all);
+    meshes.clear();
+    for (Mesh& m : all) {
+        if (m.positions.empty() || m.texCoords.size() / 2 != m.positions.size() / 3) continue;
+        BuildNormals(m);
+        meshes.push_back(m);
+    }
+    return true;
+}
+
+// ---------------- REFERENCE ----------------
+// ComputeTangents as it was before the SSE corner batches: per triangle,
+// per corner, with acosf. The final pass is the plain per-vertex one.
+// Leaves the last call's sums (tangent xyz, bitangent xyz per vertex) in
+// g_beforeSums for the comparison.
+static std::vector<float> g_beforeSums;
+static inline float Dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+static bool ProjectToPlane(const float n[3], const float v[3], float out[3]) {
+    const float d = Dot3(n, v);
+    for (int k = 0; k < 3; ++k) out[k] = v[k] - n[k] * d;
+    const float len = sqrtf(Dot3(out, out));
+    if (len < 1e-12f) return false;
+    for (int k = 0; k < 3; ++k) out[k] /= len;
+    return true;
+}
+
+static void ComputeTangentsBefore(const float* positions, const float* normals, const float* texCoords, int vertexCount,
+    const unsigned short* indices, int indexCount, float* tangents) {
+    std::vector<float> acc(vertexCount * 6, 0.0f);
+    for (int f = 0; f + 2 < indexCount; f += 3) {
+        const int v[3] = { indices[f], indices[f + 1], indices[f + 2] };
+        const float* p0 = positions + v[0] * 3; const float* p1 = positions + v[1] * 3; const float* p2 = positions + v[2] * 3;
+        const float* uv0 = texCoords + v[0] * 2; const float* uv1 = texCoords + v[1] * 2; const float* uv2 = texCoords + v[2] * 2;
+        const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] }, e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const float s1 = uv1[0] - uv0[0], t1 = uv1[1] - uv0[1], s2 = uv2[0] - uv0[0], t2 = uv2[1] - uv0[1];
+        const float area = s1 * t2 - s2 * t1;
+        if (fabsf(area) < 1e-20f) continue;
+        float os[3] = { e1[0] * t2 - e2[0] * t1, e1[1] * t2 - e2[1] * t1, e1[2] * t2 - e2[2] * t1 };
+        float ot[3] = { e2[0] * s1 - e1[0] * s2, e2[1] * s1 - e1[1] * s2, e2[2] * s1 - e1[2] * s2 };
+        const float lenS = sqrtf(Dot3(os, os)), lenT = sqrtf(Dot3(ot, ot));
+        const float sign = area > 0.0f ? 1.0f : -1.0f;
+        for (int k = 0; k < 3; ++k) { if (lenS > 0.0f) os[k] *= sign / lenS; if (lenT > 0.0f) ot[k] *= sign / lenT; }
+        for (int c = 0; c < 3; ++c) {
+            const int vi = v[c];
+            const float* n = normals + vi * 3;
+            const float* p = positions + vi * 3;
+            const float* pn = positions + v[(c + 1) % 3] * 3;
+            const float* pp = positions + v[(c + 2) % 3] * 3;
+            const float toNext[3] = { pn[0] - p[0], pn[1] - p[1], pn[2] - p[2] }, toPrev[3] = { pp[0] - p[0], pp[1] - p[1], pp[2] - p[2] };
+            float a[3], b[3], ts[3], tt[3];
+            if (!ProjectToPlane(n, toNext, a) || !ProjectToPlane(n, toPrev, b)) continue;
+            float cosAngle = Dot3(a, b);
+            if (cosAngle > 1.0f) cosAngle = 1.0f;
+            if (cosAngle < -1.0f) cosAngle = -1.0f;
+            const float angle = acosf(cosAngle);
+            float* t = &acc[vi * 6];
+            if (ProjectToPlane(n, os, ts)) for (int k = 0; k < 3; ++k) t[k] += ts[k] * angle;
+            if (ProjectToPlane(n, ot, tt)) for (int k = 0; k < 3; ++k) t[3 + k] += tt[k] * angle;
+        }
+    }
+    for (int i = 0; i < vertexCount; ++i) {
+        const float* n = normals + i * 3;
+        const float* a = &acc[i * 6];
+        float t[3];
+        if (!ProjectToPlane(n, a, t)) {
+            const float side[3] = { fabsf(n[2]) > 0.9f ? 0.0f : n[1], fabsf(n[2]) > 0.9f ? n[2] : -n[0], fabsf(n[2]) > 0.9f ? -n[1] : 0.0f };
+            ProjectToPlane(n, side, t);
+        }
+        const float c[3] = { n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0] };
+        float* out = tangents + i * 4;
+        out[0] = t[0]; out[1] = t[1]; out[2] = t[2];
+        out[3] = Dot3(c, a + 3) < 0.0f ? -1.0f : 1.0f;
+    }
+    g_beforeSums.swap(acc);
+}
+
+// ---------------- TIMING ----------------
+typedef void (*TangentFunction)(const float*, const float*, const float*, int, const unsigned short*, int, float*);
+
+// Best ms over runs of every mesh, at least 0.2 s in all
+static double TimeMeshes(TangentFunction fn, const std::vector<Mesh>& meshes, std::vector<std::vector<float>>& out) {
+    out.resize(meshes.size());
+    double best = 1e30, total = 0.0;
+    for (int run = 0; run < 3 || (total < 0.2 && run < 200); ++run) {
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            const Mesh& m = meshes[i];
+            out[i].assign(m.positions.size() / 3 * 4, 0.0f);
+            fn(&m.positions[0], &m.normals[0], &m.texCoords[0], (int)m.positions.size() / 3, m.indices.empty() ? nullptr : &m.indices[0],
+                (int)m.indices.size(), &out[i][0]);
+        }
+        const double s = SecondsSince(start);
+        total += s;
+        if (s < best) best = s;
+    }
+    return best * 1000.0;
+}
+
+static void Report(const char* name, const std::vector<Mesh>& meshes) {
+    int verts = 0, tris = 0;
+    for (const Mesh& m : meshes) { verts += (int)m.positions.size() / 3; tris += (int)m.indices.size() / 3; }
+    std::vector<std::vector<float>> before, after;
+    const double beforeMs = TimeMeshes(ComputeTangentsBefore, meshes, before);
+    const double afterMs = TimeMeshes(ComputeTangents, meshes, after);
+
+    // Where the sums nearly cancel (both sides of a UV mirror seam, no UV
+    // gradient) or the bitangent lies along the tangent (UVs squashed to a
+    // line) the frame is noise either way; those are counted, not compared
+    float worstDeg = 0.0f;
+    int flipped = 0, illPosed = 0;
+    std::vector<float> check;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Mesh& m = meshes[i];
+        check.assign(before[i].size(), 0.0f);
+        ComputeTangentsBefore(&m.positions[0], &m.normals[0], &m.texCoords[0], (int)m.positions.size() / 3, m.indices.empty() ? nullptr : &m.indices[0],
+            (int)m.indices.size(), &check[0]);
+        for (size_t v = 0; v < before[i].size() / 4; ++v) {
+            const float* a = &before[i][v * 4]; const float* b = &after[i][v * 4];
+            const float* sums = &g_beforeSums[v * 6]; const float* n = &m.normals[v * 3];
+            const float c[3] = { n[1] * a[2] - n[2] * a[1], n[2] * a[0] - n[0] * a[2], n[0] * a[1] - n[1] * a[0] };
+            const float bitangentLen = sqrtf(Dot3(sums + 3, sums + 3));
+            if (sqrtf(Dot3(sums, sums)) < 0.01f || fabsf(Dot3(c, sums + 3)) < 0.001f * bitangentLen) { illPosed++; continue; }
+            float d = Dot3(a, b);
+            d = d > 1.0f ? 1.0f : d < -1.0f ? -1.0f : d;
+            const float deg = acosf(d) * 57.2957795f;
+            if (deg > worstDeg) worstDeg = deg;
+            if (a[3] != b[3]) flipped++;
+        }
+    }
+    printf("%-48s %8d %8d %10.3f %10.3f %7.1fx %10.4f %8d %9d\n", name, verts, tris, beforeMs, afterMs, beforeMs / afterMs, worstDeg, flipped, illPosed);
+}
+
+// A rolling side x side grid, two triangles per cell, uv over the whole
+static Mesh GridMesh(int side) {
+    Mesh m;
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x) {
+            const float fx = (float)x, fz = (float)z;
+            m.positions.push_back(fx); m.positions.push_back(2.0f * sinf(fx * 0.21f) * cosf(fz * 0.17f)); m.positions.push_back(fz);
+            m.texCoords.push_back(fx / (side - 1)); m.texCoords.push_back(fz / (side - 1));
+        }
+    for (int z = 0; z + 1 < side; ++z)
+        for (int x = 0; x + 1 < side; ++x) {
+            const unsigned short a = (unsigned short)(z * side + x), b = (unsigned short)(a + 1), c = (unsigned short)(a + side), d = (unsigned short)(c + 1);
+            const unsigned short quad[6] = { a, c, b, b, c, d };
+            m.indices.insert(m.indices.end(), quad, quad + 6);
+        }
+    BuildNormals(m);
+    return m;
+}
+
+int main(int argc, char** argv) {
+    static const char* gameModels[] = {
+        "models/Key/Key9.3DS", "models/Map/map1.3ds", "models/Rocks/Rock0.3ds", "models/Rocks/Rock1.3ds", "models/Rocks/Rock2.3ds",
+        "models/Rocks/Rock3.3ds", "models/Rocks/Rock4.3ds", "models/Boat/pirateships.3ds", "models/palet/palet.3ds",
+        "models/medieval-structures-wip/MedievalHouses.3ds"
+    };
+    std::vector<const char*> paths;
+    if (argc > 1) paths.assign(argv + 1, argv + argc);
+    else paths.assign(gameModels, gameModels + sizeof(gameModels) / sizeof(gameModels[0]));
+
+    printf("%-48s %8s %8s %10s %10s %8s %10s %8s %9s\n", "model", "verts", "tris", "before ms", "after ms", "speedup", "max deg", "flipped", "ill-posed");
+    std::vector<Mesh> everything;
+    for (const char* path : paths) {
+        std::vector<Mesh> meshes;
+        if (!LoadMeshes(path, meshes)) { printf("%-48s could not be read\n", path); continue; }
+        if (meshes.empty()) { printf("%-48s no textured objects\n", path); continue; }
+        Report(path, meshes);
+        everything.insert(everything.end(), meshes.begin(), meshes.end());
+    }
+    if (everything.size() > 0) Report("all of the above", everything);
+    Report("grid 245 x 245", std::vector<Mesh>(1, GridMesh(245)));
+    return 0;
+}
@@ -0,0 +1,136 @@
+// ---------------- TEXT LAYOUT CHECK ----------------
+// Headless check of the HUD text layout in TextLayout.cpp. Builds a
+// synthetic GlyphAtlas (every glyph its own advance and texture
+// rectangle, an origin inside the cell like the real one) and runs
+// LayoutText and LayoutSolid against it, checking:
+//   - one quad per visible character, none for spaces, appended to out
+//   - the pen advancing by every character's advance, spaces included
+//   - each quad's corners placed from the pen, originX/originY and the
+//     cell size, with the glyph's texture rectangle in GL_QUADS order
+//   - characters outside the atlas drawn, and advanced, as '?'
+//   - a solid triangle repeating its last corner as the quad's fourth,
+//     with the solid texel and the given colour on every vertex
+// No GL, GLUT or Windows. Prints every failed check and exits with 1 if
+// there was one.
+//
+// Build:
+//   Visual Studio: TextLayoutCheck project in OpenGLMeshLoader.sln
+//   Linux/macOS:   g++ -O2 -std=c++14 bench/TextLayoutCheck.cpp TextLayout.cpp -o TextLayoutCheck
+
+#include "../TextBatch.h"
+#include <stdio.h>
+#include <string.h>
+
+static int g_checks = 0, g_failures = 0;
+
+static void Check(bool ok, const char* what) {
+    g_checks++;
+    if (!ok) { g_failures++; printf("FAILED: %s\n", what); }
+}
+
+static bool VertexIs(const TextVertex& v, float x, float y, float u, float t, const unsigned char rgba[4]) {
+    return v.x == x && v.y == y && v.u == u && v.v == t && v.r == rgba[0] && v.g == rgba[1] && v.b == rgba[2] && v.a == rgba[3];
+}
+
+static const unsigned char WHITE[4] = { 255, 255, 255, 255 };
+
+static GlyphAtlas SyntheticAtlas() {
+    GlyphAtlas atlas;
+    memset(&atlas, 0, sizeof(atlas));
+    for (int i = 0; i < TEXT_GLYPH_COUNT; ++i) {
+        // Values exact in float, so the checks can compare with ==
+        GlyphInfo& g = atlas.glyphs[i];
+        g.advance = (float)(4 + i % 9);
+        g.u0 = i / 128.0f; g.u1 = (i + 1) / 128.0f;
+        g.v0 = (i % 8) / 16.0f; g.v1 = (i % 8 + 1) / 16.0f;
+    }
+    atlas.cellWidth = 14.0f; atlas.cellHeight = 26.0f;
+    atlas.originX = 2.0f; atlas.originY = 7.0f;
+    atlas.solidU = 0.9375f; atlas.solidV = 0.96875f;
+    return atlas;
+}
+
+static const GlyphInfo& Glyph(const GlyphAtlas& atlas, char c) { return atlas.glyphs[c - TEXT_FIRST_GLYPH]; }
+
+// The quad LayoutText should write for a glyph g with the pen at (penX, y)
+static bool QuadIs(const GlyphAtlas& atlas, const TextVertex* q, float penX, float y, const GlyphInfo& g) {
+    const float x0 = penX - atlas.originX, y0 = y - atlas.originY;
+    const float x1 = x0 + atlas.cellWidth, y1 = y0 + atlas.cellHeight;
+    return VertexIs(q[0], x0, y0, g.u0, g.v0, WHITE) && VertexIs(q[1], x1, y0, g.u1, g.v0, WHITE) &&
+           VertexIs(q[2], x1, y1, g.u1, g.v1, WHITE) && VertexIs(q[3], x0, y1, g.u0, g.v1, WHITE);
+}
+
+static void CheckText(const GlyphAtlas& atlas) {
+    const float x = 100.0f, y = 40.0f;
+    std::vector<TextVertex> out(3);   // whatever was queued before stays
+    const char* str = "Hi  you!";
+    const int quads = LayoutText(atlas, x, y, str, out);
+    Check(quads == 6, "LayoutText returns one quad per visible character");
+    Check(out.size() == 3 + 6 * 4, "LayoutText appends 4 vertices per quad, none for spaces");
+    if (out.size() != 3 + 6 * 4) return;
+
+    float penX = x;
+    const TextVertex* q = &out[3];
+    bool placed = true;
+    for (const char* c = str; *c != '\0'; c++) {
+        if (*c != ' ') { placed = placed && QuadIs(atlas, q, penX, y, Glyph(atlas, *c)); q += 4; }
+        penX += Glyph(atlas, *c).advance;
+    }
+    Check(QuadIs(atlas, &out[3], x, y, Glyph(atlas, 'H')), "first quad sits at the start pen less originX/originY");
+    Check(placed, "every quad sits at the pen after the advances before it, spaces included");
+
+    std::vector<TextVertex> empty;
+    Check(LayoutText(atlas, x, y, "", empty) == 0 && empty.empty(), "empty string adds nothing");
+    Check(LayoutText(atlas, x, y, "   ", empty) == 0 && empty.empty(), "spaces alone add nothing");
+}
+
+static void CheckSubstitution(const GlyphAtlas& atlas) {
+    const float x = 10.0f, y = 20.0f;
+    const GlyphInfo& question = Glyph(atlas, '?');
+    const char outside[] = { '\t', '\x7f', (char)0xe9, (char)0x80, '\x01' };
+    bool drawn = true, advanced = true;
+    for (char c : outside) {
+        const char str[] = { c, 'A', '\0' };
+        std::vector<TextVertex> out;
+        drawn = drawn && LayoutText(atlas, x, y, str, out) == 2 && QuadIs(atlas, &out[0], x, y, question);
+        advanced = advanced && out.size() == 8 && QuadIs(atlas, &out[4], x + question.advance, y, Glyph(atlas, 'A'));
+    }
+    Check(drawn, "characters outside the atlas are drawn as '?'");
+    Check(advanced, "characters outside the atlas advance the pen like '?'");
+
+    std::vector<TextVertex> out;
+    const char edges[] = { ' ', '~', '!', '\0' };
+    LayoutText(atlas, x, y, edges, out);
+    Check(out.size() == 8 && QuadIs(atlas, &out[0], x + Glyph(atlas, ' ').advance, y, Glyph(atlas, '~')),
+          "'~', the last glyph, is its own and not '?'");
+}
+
+static void CheckSolid(const GlyphAtlas& atlas) {
+    const unsigned char rgba[4] = { 200, 40, 10, 128 };
+    const float tri[3][2] = { { 1.0f, 2.0f }, { 30.0f, 2.0f }, { 15.0f, 25.0f } };
+    std::vector<TextVertex> out(1);
+    LayoutSolid(atlas, tri, 3, rgba, out);
+    Check(out.size() == 5, "a triangle becomes one 4-vertex quad, appended");
+    if (out.size() == 5) {
+        Check(VertexIs(out[1], 1.0f, 2.0f, atlas.solidU, atlas.solidV, rgba) &&
+              VertexIs(out[2], 30.0f, 2.0f, atlas.solidU, atlas.solidV, rgba) &&
+              VertexIs(out[3], 15.0f, 25.0f, atlas.solidU, atlas.solidV, rgba), "triangle corners in order, solid texel, colour");
+        Check(VertexIs(out[4], 15.0f, 25.0f, atlas.solidU, atlas.solidV, rgba), "triangle repeats its last corner");
+    }
+
+    const float quad[4][2] = { { 0.0f, 0.0f }, { 8.0f, 0.0f }, { 8.0f, 6.0f }, { 0.0f, 6.0f } };
+    out.clear();
+    LayoutSolid(atlas, quad, 4, rgba, out);
+    bool corners = out.size() == 4;
+    for (int i = 0; corners && i < 4; ++i) corners = VertexIs(out[i], quad[i][0], quad[i][1], atlas.solidU, atlas.solidV, rgba);
+    Check(corners, "a quad keeps its four corners");
+}
+
+int main() {
+    const GlyphAtlas atlas = SyntheticAtlas();
+    CheckText(atlas);
+    CheckSubstitution(atlas);
+    CheckSolid(atlas);
+    printf("%d checks, %d failed\n", g_checks, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}